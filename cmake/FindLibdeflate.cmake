@@ -0,0 +1,23 @@
+#.rst:
+# FindLibdeflate
+# -------
+#
+# Find libdeflate library
+#
+# Try to find the libdeflate compression library. The following values are
+# defined
+#
+# ::
+#
+#   LIBDEFLATE_FOUND         - True if libdeflate is available
+#   LIBDEFLATE_INCLUDE_DIRS  - Include directories for libdeflate
+#   LIBDEFLATE_LIBRARIES     - List of libraries for libdeflate
+#
+
+find_library(LIBDEFLATE_LIBRARIES NAMES deflate libdeflate)
+find_path(LIBDEFLATE_INCLUDE_DIRS libdeflate.h)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LIBDEFLATE DEFAULT_MSG
+    LIBDEFLATE_INCLUDE_DIRS LIBDEFLATE_LIBRARIES)
+mark_as_advanced(LIBDEFLATE_INCLUDE_DIRS LIBDEFLATE_LIBRARIES)
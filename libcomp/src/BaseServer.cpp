@@ -35,11 +35,13 @@
 #endif // _WIN32
 
 // libcomp Includes
+#include <Constants.h>
 #include <DatabaseMariaDB.h>
 #include <DatabaseSQLite3.h>
 #include <Decrypt.h>
 #include <Log.h>
 #include <MessageInit.h>
+#include <PersistentObject.h>
 #include <ScriptEngine.h>
 #include <ServerCommandLineParser.h>
 #include <ServerConstants.h>
@@ -141,6 +143,14 @@ bool BaseServer::Initialize()
     // Add the init message into the main worker queue.
     msgQueue->Enqueue(new libcomp::Message::Init);
 
+    // Destroyed objects leave their cache entry behind so sweep them out
+    // in the background.
+    mTimerManager.SchedulePeriodicEvent(std::chrono::seconds(
+        PERSISTENT_CACHE_SWEEP_INTERVAL), []()
+        {
+            (void)PersistentObject::SweepCache();
+        });
+
     return true;
 }
 
@@ -414,6 +424,23 @@ bool BaseServer::ReadConfig(std::shared_ptr<objects::ServerConfig> config, tinyx
             log->SetLogPath(config->GetLogFile(), !config->GetLogFileAppend());
             log->SetLogFileTimestampsEnabled(config->GetLogFileTimestamp());
         }
+
+        switch(config->GetLogFileSync())
+        {
+            case objects::ServerConfig::LogFileSync_t::INTERVAL:
+                log->SetSyncPolicy(libcomp::Log::LOG_SYNC_INTERVAL);
+                break;
+            case objects::ServerConfig::LogFileSync_t::BATCH:
+                log->SetSyncPolicy(libcomp::Log::LOG_SYNC_BATCH);
+                break;
+            case objects::ServerConfig::LogFileSync_t::NONE:
+            default:
+                log->SetSyncPolicy(libcomp::Log::LOG_SYNC_NONE);
+                break;
+        }
+
+        log->SetAsyncBufferSize(config->GetLogAsyncBufferSize());
+        log->SetAsyncEnabled(config->GetLogAsync());
     }
 
     return true;
@@ -442,18 +469,25 @@ void BaseServer::CreateWorkers()
         }
     }
 
+    // Every worker must be in the pool before any of them start.
+    mWorkerPool = std::make_shared<WorkerPool>();
+
     for(unsigned int i = 0; i < numberOfWorkers; i++)
     {
-        auto worker = std::shared_ptr<Worker>(new Worker);
-        worker->Start(libcomp::String("worker%1").Arg(i));
-        mWorkers.push_back(worker);
+        mWorkers.push_back(mWorkerPool->CreateWorker());
+    }
+
+    unsigned int i = 0;
+    for(auto worker : mWorkers)
+    {
+        worker->Start(libcomp::String("worker%1").Arg(i++));
     }
 }
 
 bool BaseServer::AssignMessageQueue(const std::shared_ptr<
     libcomp::EncryptedConnection>& connection)
 {
-    std::shared_ptr<libcomp::Worker> worker = mWorkers.size() != 1
+    std::shared_ptr<libcomp::PooledWorker> worker = mWorkers.size() != 1
         ? GetNextConnectionWorker() : mWorkers.front();
 
     if(!worker)
@@ -462,15 +496,15 @@ bool BaseServer::AssignMessageQueue(const std::shared_ptr<
         return false;
     }
 
-    connection->SetMessageQueue(worker->GetMessageQueue());
+    connection->SetMessageQueue(worker->CreateConnectionQueue());
     return true;
 }
 
-std::shared_ptr<libcomp::Worker> BaseServer::GetNextConnectionWorker()
+std::shared_ptr<libcomp::PooledWorker> BaseServer::GetNextConnectionWorker()
 {
-    //By default return the least busy worker by checking shared_ptr message queue use count
+    //By default return the worker with the fewest connections assigned
     long leastConnections = 0;
-    std::shared_ptr<libcomp::Worker> leastBusy = nullptr;
+    std::shared_ptr<libcomp::PooledWorker> leastBusy = nullptr;
     for(auto worker : mWorkers)
     {
         long refCount = worker->AssignmentCount();
@@ -479,9 +513,9 @@ std::shared_ptr<libcomp::Worker> BaseServer::GetNextConnectionWorker()
             leastConnections = refCount;
 
             leastBusy = worker;
-            if(refCount <= 2)
+            if(refCount <= 0)
             {
-                //Only ref is within the worker and the thread
+                //No connections are assigned to the worker
                 break;
             }
         }
@@ -41,6 +41,7 @@
 #include "TcpServer.h"
 #include "TimerManager.h"
 #include "Worker.h"
+#include "WorkerPool.h"
 
 namespace libcomp
 {
@@ -233,7 +234,9 @@ protected:
     /**
      * Create one or many workers to handle connection requests based upon
      * the server config allowing mutliple workers as well as how many cores
-     * are available on the executing machine's CPU.
+     * are available on the executing machine's CPU. The workers share a
+     * @ref WorkerPool so an idle worker can run the connections assigned to
+     * a busy one.
      */
     void CreateWorkers();
 
@@ -241,7 +244,8 @@ protected:
      * Retrieve and assign a message queue to use for a new connection.
      * The method of deciding which worker to use is not contained in this
      * function but the actual assignment and starting of workers not yet
-     * running is handled.
+     * running is handled. Each connection gets its own queue which runs on
+     * the assigned worker unless another worker steals it.
      * @return true on success, false on failure
      */
     bool AssignMessageQueue(const std::shared_ptr<
@@ -254,7 +258,7 @@ protected:
      * @return Pointer to the worker whose message queue should be assigned
      *  to a new connection
      */
-    virtual std::shared_ptr<libcomp::Worker> GetNextConnectionWorker();
+    virtual std::shared_ptr<libcomp::PooledWorker> GetNextConnectionWorker();
 
     /**
      * Dynamicaly instantiate and insert data from an XML config file. Records
@@ -296,7 +300,10 @@ protected:
     libcomp::Worker mQueueWorker;
 
     /// List of workers to handle incoming connection packet based work.
-    std::list<std::shared_ptr<libcomp::Worker>> mWorkers;
+    std::list<std::shared_ptr<libcomp::PooledWorker>> mWorkers;
+
+    /// Scheduler shared by the connection workers.
+    std::shared_ptr<libcomp::WorkerPool> mWorkerPool;
 
     /// Data store for the server.
     libcomp::DataStore mDataStore;
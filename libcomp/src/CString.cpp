@@ -41,6 +41,22 @@ using namespace libcomp;
 
 bool String::mBadArgumentReporting = true;
 
+/**
+ * @internal
+ * Determine if every byte of UTF-8 data is ASCII. Invalid bytes that do
+ * not start or continue a character count as a character of their own
+ * so the character count alone can not tell.
+ * @param str UTF-8 encoded data to check.
+ * @returns true if every byte is ASCII.
+ */
+static bool IsAsciiData(const std::string& str)
+{
+    return std::all_of(str.cbegin(), str.cend(), [](char c)
+        {
+            return 0 == (c & 0x80);
+        });
+}
+
 /**
  * @internal
  * Shared string data oject.
@@ -69,21 +85,24 @@ public:
     /// Number of UTF-8 characters in the data.
     size_t mLength;
 
+    /// true if every byte of the data is ASCII.
+    bool mAscii;
+
     /// UTF-8 encoded string data.
     std::string mString;
 };
 
-String::StringData::StringData() : mLength(0)
+String::StringData::StringData() : mLength(0), mAscii(true)
 {
 }
 
 String::StringData::StringData(const StringData& other) :
-    mLength(other.mLength), mString(other.mString)
+    mLength(other.mLength), mAscii(other.mAscii), mString(other.mString)
 {
 }
 
 String::StringData::StringData(const std::string& str, size_t length) :
-    mLength(length), mString(str)
+    mLength(length), mAscii(IsAsciiData(str)), mString(str)
 {
 }
 
@@ -99,18 +118,21 @@ String::String(const std::string& str) : d(new String::StringData)
 {
     d->mString = str;
     d->mLength = CalculateLength(d->mString);
+    d->mAscii = IsAsciiData(d->mString);
 }
 
 String::String(const char *szString) : d(new String::StringData)
 {
     d->mString = std::string(szString);
     d->mLength = CalculateLength(d->mString);
+    d->mAscii = IsAsciiData(d->mString);
 }
 
 String::String(const char *szString, size_t bytes) : d(new String::StringData)
 {
     d->mString = std::string(szString, bytes);
     d->mLength = CalculateLength(d->mString);
+    d->mAscii = IsAsciiData(d->mString);
 }
 
 String::String(const char *szString, size_t offset, size_t bytes) :
@@ -118,12 +140,14 @@ String::String(const char *szString, size_t offset, size_t bytes) :
 {
     d->mString = std::string(szString, offset, bytes);
     d->mLength = CalculateLength(d->mString);
+    d->mAscii = IsAsciiData(d->mString);
 }
 
 String::String(size_t bytes, char character) : d(new String::StringData)
 {
     d->mString = std::string(bytes, character);
     d->mLength = CalculateLength(d->mString);
+    d->mAscii = IsAsciiData(d->mString);
 }
 
 String String::Left(size_t length) const
@@ -304,61 +328,84 @@ String::CodePoint String::At(size_t position) const
     {
         return 0;
     }
+    else if(IsAscii())
+    {
+        // Every character is a single byte.
+        return (CodePoint)(uint8_t)d->mString[position];
+    }
     else
     {
-        std::string::const_iterator begin;
-
-        position++;
+        ConstIterator it = begin();
 
-        for(begin = d->mString.cbegin(); 0 < position &&
-            begin != d->mString.cend(); ++begin)
+        for(; 0 < position; --position)
         {
-            if((*begin & 0xC0) != 0x80)
-            {
-                position--;
-            }
+            ++it;
         }
 
-        CodePoint cp = 0;
+        return *it;
+    }
+}
 
-        char bytes[4];
+String::ConstIterator String::begin() const
+{
+    const char *pData = d->mString.c_str();
 
-        bytes[0] = *(--begin);
+    return ConstIterator(pData, pData + d->mString.size());
+}
 
-        if(0 == (bytes[0] & 0x80))
-        {
-            cp = bytes[0] & 0x7F;
-        }
-        else if(0xC0 == (bytes[0] & 0xE0))
-        {
-            bytes[1] = *(++begin);
+String::ConstIterator String::end() const
+{
+    const char *pEnd = d->mString.c_str() + d->mString.size();
 
-            cp = (CodePoint)(((bytes[0] & 0x1F) << 6) |
-                (bytes[1] & 0x3F));
-        }
-        else if(0xE0 == (bytes[0] & 0xF0))
-        {
-            bytes[1] = *(++begin);
-            bytes[2] = *(++begin);
+    return ConstIterator(pEnd, pEnd);
+}
 
-            cp = (CodePoint)(((bytes[0] & 0x1F) << 12) |
-                ((bytes[1] & 0x3F) << 6) |
-                (bytes[2] & 0x3F));
-        }
-        else
+String::CodePoint String::DecodeCodePoint(const char *pData,
+    const char *pEnd, size_t& bytes)
+{
+    uint8_t lead = (uint8_t)*pData;
+
+    // Number of bytes the lead byte says the character has.
+    size_t expected = 1;
+
+    CodePoint cp = 0;
+
+    if(0xC0 == (lead & 0xE0))
+    {
+        cp = (CodePoint)(lead & 0x1F);
+        expected = 2;
+    }
+    else if(0xE0 == (lead & 0xF0))
+    {
+        cp = (CodePoint)(lead & 0x0F);
+        expected = 3;
+    }
+    else if(0xF0 == (lead & 0xF8))
+    {
+        cp = (CodePoint)(lead & 0x07);
+        expected = 4;
+    }
+    else
+    {
+        // Not a valid lead byte, return it as is.
+        cp = (CodePoint)lead;
+    }
+
+    // The character ends at the next byte that is not a continuation byte
+    // (the same way CalculateLength counts characters).
+    size_t i = 1;
+
+    for(; (pData + i) < pEnd && 0x80 == ((uint8_t)pData[i] & 0xC0); ++i)
+    {
+        if(i < expected)
         {
-            bytes[1] = *(++begin);
-            bytes[2] = *(++begin);
-            bytes[3] = *(++begin);
-
-            cp = (CodePoint)(((bytes[0] & 0x0F) << 18) |
-                ((bytes[1] & 0x3F) << 12) |
-                ((bytes[2] & 0x3F) << 6) |
-                (bytes[3] & 0x3F));
+            cp = (CodePoint)((cp << 6) | ((uint8_t)pData[i] & 0x3F));
         }
-
-        return cp;
     }
+
+    bytes = i;
+
+    return cp;
 }
 
 std::list<String> String::Split(const String& delimiter) const
@@ -421,6 +468,7 @@ String& String::Append(const String& other)
     Detatch();
 
     d->mLength += other.d->mLength;
+    d->mAscii = d->mAscii && other.d->mAscii;
     d->mString += other.d->mString;
 
     return *this;
@@ -431,6 +479,7 @@ String& String::Prepend(const String& other)
     Detatch();
 
     d->mLength += other.d->mLength;
+    d->mAscii = d->mAscii && other.d->mAscii;
     d->mString = other.d->mString + d->mString;
 
     return *this;
@@ -483,6 +532,11 @@ size_t String::Size() const
     return d->mString.size();
 }
 
+bool String::IsAscii() const
+{
+    return d->mAscii;
+}
+
 bool String::IsEmpty() const
 {
     return 0 == d->mLength;
@@ -30,6 +30,7 @@
 #include <stdint.h>
 
 #include <iomanip>
+#include <iterator>
 #include <limits>
 #include <list>
 #include <memory>
@@ -52,6 +53,121 @@ public:
      */
     typedef uint32_t CodePoint;
 
+    /**
+     * Forward iterator that decodes the code points of a string in a
+     * single pass. Use @ref begin and @ref end (or a range based for loop)
+     * to visit every character instead of calling @ref At in a loop, which
+     * has to walk the string from the start for each character that is
+     * not ASCII.
+     */
+    class ConstIterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef CodePoint value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const CodePoint* pointer;
+        typedef CodePoint reference;
+
+        /**
+         * Create an iterator starting at the given byte.
+         * @param pPosition First byte of the character to start at.
+         * @param pEnd Byte after the end of the string data.
+         */
+        ConstIterator(const char *pPosition, const char *pEnd) :
+            mPosition(pPosition), mEnd(pEnd), mValue(0), mBytes(0)
+        {
+            Decode();
+        }
+
+        /**
+         * Get the code point of the current character.
+         * @returns Code point of the current character.
+         */
+        CodePoint operator*() const
+        {
+            return mValue;
+        }
+
+        /**
+         * Advance to the next character.
+         * @returns Reference to this iterator.
+         */
+        ConstIterator& operator++()
+        {
+            mPosition += mBytes;
+            Decode();
+
+            return *this;
+        }
+
+        /**
+         * Advance to the next character.
+         * @returns Copy of the iterator before it was advanced.
+         */
+        ConstIterator operator++(int)
+        {
+            ConstIterator before(*this);
+            ++(*this);
+
+            return before;
+        }
+
+        /**
+         * Check if two iterators point to the same character.
+         * @param other Iterator to compare to.
+         * @returns true if both point to the same character.
+         */
+        bool operator==(const ConstIterator& other) const
+        {
+            return mPosition == other.mPosition;
+        }
+
+        /**
+         * Check if two iterators point to different characters.
+         * @param other Iterator to compare to.
+         * @returns true if they point to different characters.
+         */
+        bool operator!=(const ConstIterator& other) const
+        {
+            return mPosition != other.mPosition;
+        }
+
+    private:
+        /**
+         * Decode the character at the current position.
+         */
+        void Decode()
+        {
+            if(mPosition >= mEnd)
+            {
+                mValue = 0;
+                mBytes = 0;
+            }
+            else if(0 == (*mPosition & 0x80))
+            {
+                mValue = (CodePoint)*mPosition;
+                mBytes = 1;
+            }
+            else
+            {
+                mValue = DecodeCodePoint(mPosition, mEnd, mBytes);
+            }
+        }
+
+        /// First byte of the current character.
+        const char *mPosition;
+
+        /// Byte after the end of the string data.
+        const char *mEnd;
+
+        /// Code point of the current character.
+        CodePoint mValue;
+
+        /// Number of bytes in the current character.
+        size_t mBytes;
+    };
+
     /**
      * Construct an empty string.
      */
@@ -160,6 +276,18 @@ public:
      */
     CodePoint At(size_t position) const;
 
+    /**
+     * Get an iterator to the first character of the string.
+     * @returns Iterator to the first character.
+     */
+    ConstIterator begin() const;
+
+    /**
+     * Get an iterator past the last character of the string.
+     * @returns Iterator past the last character.
+     */
+    ConstIterator end() const;
+
     /**
      * Split a string by a delimiter.
      * @param delimiter Sub-string to split the string by.
@@ -179,6 +307,13 @@ public:
      */
     size_t Size() const;
 
+    /**
+     * Determine if every byte in the string is ASCII. Each character
+     * is then a single byte so @ref At does not need to decode the string.
+     * @returns true if the string only contains ASCII characters.
+     */
+    bool IsAscii() const;
+
     /**
      * Determine if the string is empty.
      * @returns true if the string is empty.
@@ -631,6 +766,18 @@ private:
      */
     size_t CalculateLength(const std::string& str) const;
 
+    /**
+     * @internal
+     * Decode a multi-byte UTF-8 character. A sequence cut short by the end
+     * of the data is decoded as far as it goes.
+     * @param pData First byte of the character.
+     * @param pEnd Byte after the end of the string data.
+     * @param bytes Set to the number of bytes in the character.
+     * @returns Code point of the character.
+     */
+    static CodePoint DecodeCodePoint(const char *pData, const char *pEnd,
+        size_t& bytes);
+
     /**
      * @internal
      * Shared pointer to the string data.
@@ -47,79 +47,146 @@ ChannelConnection::~ChannelConnection()
 {
 }
 
-void ChannelConnection::PreparePackets(std::list<ReadOnlyPacket>& packets)
+ChannelConnection::EncodedPacket::EncodedPacket(Packet& command) :
+    Command(std::move(command))
 {
-    static const uint32_t headerSize = GetHeaderSize();
+    std::list<ReadOnlyPacket> commands;
+    commands.emplace_back(Command);
 
-    if(STATUS_ENCRYPTED == mStatus)
+    Packet finalPacket;
+    if(BuildCompressedPacket(commands, finalPacket))
     {
-        int retryCount = 0;
-        bool packetOK = false;
+        ReadOnlyPacket compressed(std::move(finalPacket));
+        Compressed = compressed;
+    }
+}
 
-        Packet finalPacket;
+std::shared_ptr<ChannelConnection::EncodedPacket>
+    ChannelConnection::EncodePacket(Packet& packet)
+{
+    return std::make_shared<EncodedPacket>(packet);
+}
+
+void ChannelConnection::SendEncodedPacket(
+    const std::shared_ptr<EncodedPacket>& encoded, bool queue)
+{
+    {
+        std::lock_guard<std::mutex> guard(mOutgoingMutex);
+
+        // Share the command data instead of copying it.
+        ReadOnlyPacket command(encoded->Command);
+        mOutgoingPackets.push_back(std::move(command));
 
-        // We will do this 1-2 times depending on if it compressed right.
-        while(!packetOK && 2 > retryCount++)
+        if(0 < encoded->Compressed.Size())
         {
-            // Reserve space for the sizes.
-            finalPacket.WriteBlank(headerSize);
+            mEncodedPackets.push_back(encoded);
+        }
+    }
 
-            // Now add the packet data.
-            for(auto& packet : packets)
-            {
-                finalPacket.WriteU16Big((uint16_t)(packet.Size() + 2));
-                finalPacket.WriteU16Little((uint16_t)(packet.Size() + 2));
-                finalPacket.WriteArray(packet.ConstData(), packet.Size());
-            }
+    if(!queue)
+    {
+        FlushOutgoing();
+    }
+}
 
-            int32_t originalSize = static_cast<int32_t>(
-                finalPacket.Size() - headerSize);
-            int compressedSize;
+bool ChannelConnection::BuildCompressedPacket(
+    const std::list<ReadOnlyPacket>& packets, Packet& finalPacket)
+{
+    static const uint32_t headerSize = CHANNEL_HEADER_SIZE;
 
-            // Compress the packet if this is the first try.
-            if(1 == retryCount)
-            {
-                finalPacket.Seek(headerSize);
+    int retryCount = 0;
+    bool packetOK = false;
 
-                // Attempt to compress the packet.
-                compressedSize = finalPacket.Compress(originalSize);
+    // We will do this 1-2 times depending on if it compressed right.
+    while(!packetOK && 2 > retryCount++)
+    {
+        // Reserve space for the sizes.
+        finalPacket.WriteBlank(headerSize);
 
-                // If they are equal, this packet might be confused with an
-                // uncompressed one. In such a case, do not compress.
-                if(compressedSize < originalSize && 0 < compressedSize)
-                {
-                    // Packet is OK.
-                    packetOK = true;
-                }
-                else
-                {
-                    // Erase the final packet and create it again.
-                    finalPacket.Clear();
-                    finalPacket.Rewind();
-                }
-            }
-            else
-            {
-                // Same as the uncompressed size.
-                compressedSize = originalSize;
+        // Now add the packet data.
+        for(auto& packet : packets)
+        {
+            finalPacket.WriteU16Big((uint16_t)(packet.Size() + 2));
+            finalPacket.WriteU16Little((uint16_t)(packet.Size() + 2));
+            finalPacket.WriteArray(packet.ConstData(), packet.Size());
+        }
+
+        int32_t originalSize = static_cast<int32_t>(
+            finalPacket.Size() - headerSize);
+        int compressedSize;
+
+        // Compress the packet if this is the first try. Small packets almost
+        // never get any smaller so send them as is (just like a packet that
+        // failed to compress).
+        if(1 == retryCount && CHANNEL_COMPRESS_THRESHOLD <= originalSize)
+        {
+            finalPacket.Seek(headerSize);
+
+            // Attempt to compress the packet.
+            compressedSize = finalPacket.Compress(originalSize);
 
+            // If they are equal, this packet might be confused with an
+            // uncompressed one. In such a case, do not compress.
+            if(compressedSize < originalSize && 0 < compressedSize)
+            {
                 // Packet is OK.
                 packetOK = true;
             }
-
-            // Write the uncompressed and compressed sizes.
-            if(packetOK)
+            else
             {
-                // Move to where the uncompressed and compressed sizes are.
-                finalPacket.Seek(2 * sizeof(uint32_t));
-
-                // Write the sizes.
-                finalPacket.WriteArray("gzip", 4);
-                finalPacket.WriteS32Little(originalSize);
-                finalPacket.WriteS32Little(compressedSize);
-                finalPacket.WriteArray("lv6", 4);
+                // Erase the final packet and create it again.
+                finalPacket.Clear();
+                finalPacket.Rewind();
             }
         }
+        else
+        {
+            // Same as the uncompressed size.
+            compressedSize = originalSize;
+
+            // Packet is OK.
+            packetOK = true;
+        }
+
+        // Write the uncompressed and compressed sizes.
+        if(packetOK)
+        {
+            // Move to where the uncompressed and compressed sizes are.
+            finalPacket.Seek(2 * sizeof(uint32_t));
+
+            // Write the sizes.
+            finalPacket.WriteArray("gzip", 4);
+            finalPacket.WriteS32Little(originalSize);
+            finalPacket.WriteS32Little(compressedSize);
+            finalPacket.WriteArray("lv6", 4);
+        }
+    }
+
+    return packetOK;
+}
+
+void ChannelConnection::PreparePackets(std::list<ReadOnlyPacket>& packets)
+{
+    auto encoded = TakeEncodedPackets(packets);
+
+    if(STATUS_ENCRYPTED == mStatus)
+    {
+        bool packetOK = false;
+
+        Packet finalPacket;
+
+        if(encoded)
+        {
+            // The command is being sent by itself so the data compressed
+            // when it was encoded can be used as is.
+            finalPacket.WriteArray(encoded->Compressed.ConstData(),
+                encoded->Compressed.Size());
+            packetOK = true;
+        }
+        else
+        {
+            packetOK = BuildCompressedPacket(packets, finalPacket);
+        }
 
         // If the packet is OK, encrypt and complete the procedure.
         if(packetOK)
@@ -276,3 +343,29 @@ uint32_t ChannelConnection::GetHeaderSize()
 {
     return CHANNEL_HEADER_SIZE;
 }
+
+std::shared_ptr<ChannelConnection::EncodedPacket>
+    ChannelConnection::TakeEncodedPackets(
+    const std::list<ReadOnlyPacket>& packets)
+{
+    std::shared_ptr<EncodedPacket> single;
+
+    std::lock_guard<std::mutex> guard(mOutgoingMutex);
+
+    for(auto& packet : packets)
+    {
+        // Encoded packets share their command data with the queued copy.
+        if(!mEncodedPackets.empty() && mEncodedPackets.front()->
+            Command.ConstData() == packet.ConstData())
+        {
+            if(1 == packets.size())
+            {
+                single = mEncodedPackets.front();
+            }
+
+            mEncodedPackets.pop_front();
+        }
+    }
+
+    return single;
+}
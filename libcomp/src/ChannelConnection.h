@@ -30,6 +30,9 @@
 // libcomp Includes
 #include "EncryptedConnection.h"
 
+// Standard C++11 Includes
+#include <memory>
+
 namespace libcomp
 {
 
@@ -58,6 +61,56 @@ public:
      */
     virtual ~ChannelConnection();
 
+    /**
+     * Command packet that has been compressed once so it can be sent to
+     * many connections without compressing it again for each of them.
+     */
+    struct EncodedPacket
+    {
+        /**
+         * Compress the supplied command.
+         * @param command Command packet to encode. The data is moved out
+         *  of the packet.
+         */
+        EncodedPacket(Packet& command);
+
+        /// Command data queued in place of the encoded packet
+        ReadOnlyPacket Command;
+
+        /// Complete compressed packet containing only the command before
+        /// encryption or an empty packet if it could not be built
+        ReadOnlyPacket Compressed;
+    };
+
+    /**
+     * Compress a command packet once for sending to multiple connections.
+     * @param packet Command packet to encode. The data is moved out of
+     *  the packet.
+     * @returns Pointer to the encoded packet.
+     */
+    static std::shared_ptr<EncodedPacket> EncodePacket(Packet& packet);
+
+    /**
+     * Send or queue an encoded command packet. If the command ends up
+     * being sent by itself, the compressed data is reused and only needs
+     * to be encrypted. If it is combined with other queued packets, it is
+     * compressed along with them like any other packet.
+     * @param encoded Pointer to the encoded packet
+     * @param queue true if the packet should be queued instead of sent
+     */
+    void SendEncodedPacket(const std::shared_ptr<EncodedPacket>& encoded,
+        bool queue = false);
+
+    /**
+     * Build a complete compressed packet out of a list of commands. The
+     * packet still needs to be encrypted before it can be sent.
+     * @param packets List of command packets to combine
+     * @param finalPacket Output packet to write the combined data to
+     * @returns true if the packet was built, false if it was not
+     */
+    static bool BuildCompressedPacket(const std::list<ReadOnlyPacket>& packets,
+        Packet& finalPacket);
+
 protected:
     virtual void PreparePackets(std::list<ReadOnlyPacket>& packets);
 
@@ -65,6 +118,21 @@ protected:
         uint32_t& paddedSize, uint32_t& realSize, uint32_t& dataStart);
 
     virtual uint32_t GetHeaderSize();
+
+private:
+    /**
+     * Remove the encoded packets matching the list of packets about to be
+     * sent from the pending list.
+     * @param packets List of packets about to be sent
+     * @returns Pointer to the encoded packet if the list only contains a
+     *  single encoded packet, null otherwise
+     */
+    std::shared_ptr<EncodedPacket> TakeEncodedPackets(
+        const std::list<ReadOnlyPacket>& packets);
+
+    /// Encoded packets in the outgoing queue in the order they were added.
+    /// Protected by the outgoing mutex.
+    std::list<std::shared_ptr<EncodedPacket>> mEncodedPackets;
 };
 
 } // namespace libcomp
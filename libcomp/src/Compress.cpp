@@ -29,8 +29,90 @@
 // zlib compression library (http://www.zlib.net)
 #include <zlib.h>
 
+#ifdef HAVE_LIBDEFLATE
+// libdeflate compression library (https://github.com/ebiggers/libdeflate)
+#include <libdeflate.h>
+#endif // HAVE_LIBDEFLATE
+
 using namespace libcomp;
 
+namespace
+{
+
+/// Number of compression levels including the default level (-1).
+const int32_t COMPRESSION_LEVEL_COUNT = 11;
+
+/**
+ * Compression state kept for each thread so every call does not have to
+ * allocate and initialize it again. Each level is initialized the first
+ * time it is used.
+ */
+struct CompressContexts
+{
+    /**
+     * Create the contexts without initializing any of them.
+     */
+    CompressContexts() : InflateReady(false)
+    {
+        for(int32_t i = 0; i < COMPRESSION_LEVEL_COUNT; i++)
+        {
+#ifdef HAVE_LIBDEFLATE
+            Compressors[i] = nullptr;
+#else // HAVE_LIBDEFLATE
+            DeflateReady[i] = false;
+#endif // HAVE_LIBDEFLATE
+        }
+    }
+
+    /**
+     * Free the contexts that were initialized.
+     */
+    ~CompressContexts()
+    {
+        for(int32_t i = 0; i < COMPRESSION_LEVEL_COUNT; i++)
+        {
+#ifdef HAVE_LIBDEFLATE
+            if(nullptr != Compressors[i])
+            {
+                libdeflate_free_compressor(Compressors[i]);
+            }
+#else // HAVE_LIBDEFLATE
+            if(DeflateReady[i])
+            {
+                deflateEnd(&Deflate[i]);
+            }
+#endif // HAVE_LIBDEFLATE
+        }
+
+        if(InflateReady)
+        {
+            inflateEnd(&Inflate);
+        }
+    }
+
+#ifdef HAVE_LIBDEFLATE
+    /// Compressor for each level (offset by one).
+    libdeflate_compressor *Compressors[COMPRESSION_LEVEL_COUNT];
+#else // HAVE_LIBDEFLATE
+    /// zlib stream for each level (offset by one).
+    z_stream Deflate[COMPRESSION_LEVEL_COUNT];
+
+    /// If the zlib stream for each level has been initialized.
+    bool DeflateReady[COMPRESSION_LEVEL_COUNT];
+#endif // HAVE_LIBDEFLATE
+
+    /// zlib stream for decompression.
+    z_stream Inflate;
+
+    /// If the zlib stream for decompression has been initialized.
+    bool InflateReady;
+};
+
+/// Compression state for the current thread.
+thread_local CompressContexts tContexts;
+
+} // namespace
+
 int32_t Compress::Compress(void *pIn, void *pOut, int32_t inSize,
     int32_t outSize, int32_t compLvl)
 {
@@ -42,24 +124,64 @@ int32_t Compress::Compress(void *pIn, void *pOut, int32_t inSize,
         return -1;
     }
 
+    size_t contextIndex = (size_t)(compLvl + 1);
+
+#ifdef HAVE_LIBDEFLATE
+    auto& pCompressor = tContexts.Compressors[contextIndex];
+
+    // Create the compressor the first time the level is used. libdeflate
+    // has no default level so use the same level zlib defaults to.
+    if(nullptr == pCompressor)
+    {
+        pCompressor = libdeflate_alloc_compressor(-1 == compLvl ? 6 : compLvl);
+
+        if(nullptr == pCompressor)
+        {
+            return -2;
+        }
+    }
+
+    // The output is a zlib stream just like deflate would write so it is
+    // read back the same way. Zero means it did not fit in the buffer.
+    size_t written = libdeflate_zlib_compress(pCompressor, pIn,
+        (size_t)inSize, pOut, (size_t)outSize);
+
+    if(0 == written)
+    {
+        return -3;
+    }
+
+    // Success! Return how many bytes were written to the output buffer.
+    return (int32_t)written;
+#else // HAVE_LIBDEFLATE
     // If the compression level is -1, use the default compression level.
     if(-1 == compLvl)
     {
         compLvl = Z_DEFAULT_COMPRESSION;
     }
 
-    // Allocate the zlib stream object to store the state of the compression.
-    z_stream strm;
+    // The zlib stream object stores the state of the compression. Reuse the
+    // one for this thread and level instead of allocating it every time.
+    z_stream& strm = tContexts.Deflate[contextIndex];
+
+    if(!tContexts.DeflateReady[contextIndex])
+    {
+        // Initialize the unset variables to null.
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
 
-    // Initialize the unset variables to null.
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
+        // Make sure the zlib stream initializes properly.
+        if(Z_OK != deflateInit(&strm, compLvl))
+        {
+            return -2;
+        }
 
-    // Make sure the zlib stream initializes properly.
-    if(Z_OK != deflateInit(&strm, compLvl))
+        tContexts.DeflateReady[contextIndex] = true;
+    }
+    else if(Z_OK != deflateReset(&strm))
     {
-        return -2;
+        return -4;
     }
 
     // Tell zlib about the input buffer and how many bytes it contains.
@@ -76,17 +198,9 @@ int32_t Compress::Compress(void *pIn, void *pOut, int32_t inSize,
         return -3;
     }
 
-    // Save how many bytes of the output buffer were written to.
-    int32_t written = (int32_t)strm.total_out;
-
-    // Cleanup the zlib stream object (so it may free memory).
-    if(Z_OK != deflateEnd(&strm))
-    {
-        return -4;
-    }
-
     // Success! Return how many bytes were written to the output buffer.
-    return written;
+    return (int32_t)strm.total_out;
+#endif // HAVE_LIBDEFLATE
 }
 
 int32_t Compress::Decompress(void *pIn, void *pOut,
@@ -99,24 +213,36 @@ int32_t Compress::Decompress(void *pIn, void *pOut,
         return -1;
     }
 
-    // Allocate the zlib stream object to store the state of the decompression.
-    z_stream strm;
+    // The zlib stream object stores the state of the decompression. Reuse
+    // the one for this thread instead of allocating it every time.
+    z_stream& strm = tContexts.Inflate;
 
-    // Initialize the unset variables to null.
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
+    if(!tContexts.InflateReady)
+    {
+        // Initialize the unset variables to null.
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+        strm.avail_in = 0;
+        strm.next_in = Z_NULL;
 
-    // Tell zlib about the input buffer and how many bytes it contains.
-    strm.avail_in = (uInt)inSize;
-    strm.next_in = (Bytef*)pIn;
+        // Make sure the zlib stream initializes properly.
+        if(Z_OK != inflateInit(&strm))
+        {
+            return -2;
+        }
 
-    // Make sure the zlib stream initializes properly.
-    if(Z_OK != inflateInit(&strm))
+        tContexts.InflateReady = true;
+    }
+    else if(Z_OK != inflateReset(&strm))
     {
-        return -2;
+        return -4;
     }
 
+    // Tell zlib about the input buffer and how many bytes it contains.
+    strm.avail_in = (uInt)inSize;
+    strm.next_in = (Bytef*)pIn;
+
     // Tell zlib about the output buffer and how many bytes it contains.
     strm.avail_out = (uInt)outSize;
     strm.next_out = (Bytef*)pOut;
@@ -130,12 +256,6 @@ int32_t Compress::Decompress(void *pIn, void *pOut,
     // Save how many bytes of the output buffer were written to.
     int32_t written = (int32_t)strm.total_out;
 
-    // Cleanup the zlib stream object (so it may free memory).
-    if(Z_OK != inflateEnd(&strm))
-    {
-        return -4;
-    }
-
     // Success! Return how many bytes were written to the output buffer.
     return written;
 }
@@ -33,7 +33,10 @@ namespace libcomp
 {
 
 /**
- * Routines to compress and decompress data using zlib.
+ * Routines to compress and decompress data using zlib. The compression
+ * state is kept for each thread and reset between calls instead of being
+ * allocated every time. If libcomp is built with USE_LIBDEFLATE the data is
+ * compressed with libdeflate instead; the output is still a zlib stream.
  */
 namespace Compress
 {
@@ -56,8 +59,8 @@ namespace Compress
  * to the output buffer; negative numbers indicate an error. The errors are:
  * @retval -1 Invalid arguments
  * @retval -2 Initialization error
- * @retval -3 Decompression error
- * @retval -4 Cleanup error
+ * @retval -3 Compression error (or the output buffer is too small)
+ * @retval -4 Reset error
  */
 int32_t Compress(void *pIn, void *pOut, int32_t inSize, int32_t outSize,
     int32_t compressionLevel = -1);
@@ -77,7 +80,7 @@ int32_t Compress(void *pIn, void *pOut, int32_t inSize, int32_t outSize,
  * @retval -1 Invalid arguments
  * @retval -2 Initialization error
  * @retval -3 Decompression error
- * @retval -4 Cleanup error
+ * @retval -4 Reset error
  */
 int32_t Decompress(void *pIn, void *pOut, int32_t inSize, int32_t outSize);
 
@@ -34,11 +34,10 @@
 
 #include <limits.h>
 #include <stdint.h>
+#include <string.h>
 
 using namespace libcomp;
 
-#define ARRAY_SIZE(arr) (sizeof(arr)/sizeof(arr[0]))
-
 /**
  * Convert a CP-1252 encoded string to a @ref String.
  * @param szString The string to convert.
@@ -56,22 +55,32 @@ static String FromCP1252Encoding(const uint8_t *szString, int size);
 static String FromCP932Encoding(const uint8_t *szString, int size);
 
 /**
- * Convert the @ref String to a CP-1252 encoded string.
+ * Encode a @ref String as CP-1252 in a single pass over the string.
  * @param str String to convert.
- * @param nullTerminator Indicates if a null terminator should be added.
- * @returns The converted string.
+ * @param pDestination Buffer to write the converted string into or null to
+ *   only count the number of bytes needed. No null terminator is written.
+ * @returns Number of bytes in the converted string.
  */
-static std::vector<char> ToCP1252Encoding(const String& str,
-    bool nullTerminator = true);
+static size_t EncodeCP1252(const String& str, char *pDestination);
 
 /**
- * Convert the @ref String to a CP-932 encoded string.
+ * Encode a @ref String as CP-932 in a single pass over the string.
  * @param str String to convert.
- * @param nullTerminator Indicates if a null terminator should be added.
- * @returns The converted string.
+ * @param pDestination Buffer to write the converted string into or null to
+ *   only count the number of bytes needed. No null terminator is written.
+ * @returns Number of bytes in the converted string.
  */
-static std::vector<char> ToCP932Encoding(const String& str,
-    bool nullTerminator = true);
+static size_t EncodeCP932(const String& str, char *pDestination);
+
+/**
+ * Copy the UTF-8 data of a @ref String. ASCII maps to itself in every
+ * supported encoding so this also converts strings that are pure ASCII.
+ * @param str String to convert.
+ * @param pDestination Buffer to write the converted string into or null to
+ *   only count the number of bytes needed. No null terminator is written.
+ * @returns Number of bytes in the converted string.
+ */
+static size_t CopyUtf8(const String& str, char *pDestination);
 
 static String FromCP1252Encoding(const uint8_t *szString, int size)
 {
@@ -195,69 +204,68 @@ static String FromCP932Encoding(const uint8_t *szString, int size)
     return final;
 }
 
-static std::vector<char> ToCP1252Encoding(const String& str,
-    bool nullTerminator)
+static size_t EncodeCP1252(const String& str, char *pDestination)
 {
     // Obtain a pointer to the lookup table so it may be used as an array of
     // unsigned 16-bit values.
     const uint16_t *pMappingTo = (uint16_t*)LookupTableCP1252;
 
-    // Used to add a null terminator to the end of the byte array.
-    char zero = 0;
+    // Every character is converted to a single byte.
+    if(!pDestination)
+    {
+        return str.Length();
+    }
 
-    // String to store the converted string into.
-    std::vector<char> final;
+    size_t i = 0;
 
     // Loop over every character in the source string.
-    for(size_t i = 0; i < str.Length(); ++i)
+    for(String::CodePoint unicode : str)
     {
-        // Get the Unicode code point for the current character.
-        String::CodePoint unicode = str.At(i);
+        // Sanity check the code point is inside the table.
+        if((String::CodePoint)0xFFFF < unicode)
+        {
+            LOG_ERROR(String("Invalid character %1 in string: %2\n").Arg(
+                i).Arg(str));
 
-        // Find the mapped code point for the desired encoding.
-        uint16_t cp1252 = pMappingTo[unicode];
+            pDestination[i++] = '?';
+            continue;
+        }
 
-        // Add the converted character to the final string.
-        final.push_back((char)(cp1252 & 0xFF));
+        // Find the mapped code point and add it to the final string.
+        pDestination[i++] = (char)(pMappingTo[unicode] & 0xFF);
     }
 
-    // Append a null terminator to the end of the final string.
-    if(nullTerminator)
-    {
-        final.push_back(zero);
-    }
-
-    // Return the converted string.
-    return final;
+    return i;
 }
 
-static std::vector<char> ToCP932Encoding(const String& str,
-    bool nullTerminator)
+static size_t EncodeCP932(const String& str, char *pDestination)
 {
     // Obtain a pointer to the lookup table so it may be used as an array of
     // unsigned 16-bit values.
     const uint16_t *pMappingTo = (uint16_t*)LookupTableCP932;
 
-    // Used to add a null terminator to the end of the byte array.
-    char zero = 0;
+    // Number of bytes in the converted string.
+    size_t size = 0;
 
-    // String to store the converted string into.
-    std::vector<char> final;
+    // Index of the current character (for error reporting).
+    size_t i = 0;
 
     // Loop over every character in the source string.
-    for(size_t i = 0; i < str.Length(); ++i)
+    for(String::CodePoint unicode : str)
     {
-        // Get the Unicode code point for the current character.
-        String::CodePoint unicode = str.At(i);
-
-        // Sanity check the code point is inside the array.
-        if(ARRAY_SIZE(LookupTableCP932) <= unicode ||
-            (String::CodePoint)0xFFFF < unicode)
+        // Sanity check the code point is inside the table.
+        if((String::CodePoint)0xFFFF < unicode)
         {
-            LOG_ERROR(String("Invalid character %1 in string: %2\n").Arg(
-                i).Arg(str));
+            if(pDestination)
+            {
+                LOG_ERROR(String("Invalid character %1 in string: %2\n").Arg(
+                    i).Arg(str));
+
+                pDestination[size] = '?';
+            }
 
-            final.push_back('?');
+            size++;
+            i++;
             continue;
         }
 
@@ -268,28 +276,43 @@ static std::vector<char> ToCP932Encoding(const String& str,
         // multi-byte codepoint.
         if(0xFF < cp932)
         {
-            // Double byte, ensure the value is in big endian host order.
-            cp932 = htobe16(cp932);
+            if(pDestination)
+            {
+                // Double byte, ensure the value is in big endian host order.
+                cp932 = htobe16(cp932);
 
-            // Write two bytes to the final string.
-            final.push_back((char)(cp932 & 0xFF));
-            final.push_back((char)((cp932 >> 8) & 0xFF));
+                // Write two bytes to the final string.
+                pDestination[size] = (char)(cp932 & 0xFF);
+                pDestination[size + 1] = (char)((cp932 >> 8) & 0xFF);
+            }
+
+            size += 2;
         }
         else
         {
-            // Single byte, write one byte to the final string.
-            final.push_back((char)(cp932 & 0xFF));
+            if(pDestination)
+            {
+                // Single byte, write one byte to the final string.
+                pDestination[size] = (char)(cp932 & 0xFF);
+            }
+
+            size++;
         }
+
+        i++;
     }
 
-    // Append a null terminator to the end of the final string.
-    if(nullTerminator)
+    return size;
+}
+
+static size_t CopyUtf8(const String& str, char *pDestination)
+{
+    if(pDestination && !str.IsEmpty())
     {
-        final.push_back(zero);
+        memcpy(pDestination, str.C(), str.Size());
     }
 
-    // Return the converted string.
-    return final;
+    return str.Size();
 }
 
 String Convert::FromEncoding(Encoding_t encoding,
@@ -325,33 +348,91 @@ String Convert::FromEncoding(Encoding_t encoding, const std::vector<char>& str)
 std::vector<char> Convert::ToEncoding(Encoding_t encoding, const String& str,
     bool nullTerminator)
 {
+    // Default to a UTF-8 encoded string.
+    if(ENCODING_CP932 != encoding && ENCODING_CP1252 != encoding)
+    {
+        return str.Data(nullTerminator);
+    }
+
+    // The converted string is never bigger than the UTF-8 data so allocate
+    // that much once and trim it to what was written.
+    std::vector<char> final(str.Size() + 1, 0);
+
+    size_t size = EncodeTo(encoding, str, &final[0], nullTerminator);
+    final.resize(size);
+
+    // Return the converted string.
+    return final;
+}
+
+size_t Convert::EncodeTo(Encoding_t encoding, const String& str,
+    char *szDestination, bool nullTerminator)
+{
+    size_t size;
+
     // Determine the function to call based on the encoding requested.
-    switch(encoding)
+    if(str.IsAscii())
     {
-        case ENCODING_CP932:
-            return ToCP932Encoding(str, nullTerminator);
-        case ENCODING_CP1252:
-            return ToCP1252Encoding(str, nullTerminator);
-        default:
-            break;
+        size = CopyUtf8(str, szDestination);
+    }
+    else
+    {
+        switch(encoding)
+        {
+            case ENCODING_CP932:
+                size = EncodeCP932(str, szDestination);
+                break;
+            case ENCODING_CP1252:
+                size = EncodeCP1252(str, szDestination);
+                break;
+            default:
+                // Default to a UTF-8 encoded string.
+                size = CopyUtf8(str, szDestination);
+                break;
+        }
     }
 
-    // Default to a UTF-8 encoded string.
-    return str.Data(nullTerminator);
+    // Append a null terminator to the end of the final string.
+    if(nullTerminator)
+    {
+        szDestination[size++] = 0;
+    }
+
+    return size;
 }
 
 size_t Convert::SizeEncoded(Encoding_t encoding, const String& str,
     size_t align)
 {
-    // Convert the string to determine the size of the encoded result.
-    std::vector<char> out = ToEncoding(encoding, str, false);
+    size_t size;
+
+    // Count the bytes the string would be converted to without writing it.
+    if(str.IsAscii())
+    {
+        size = str.Size();
+    }
+    else
+    {
+        switch(encoding)
+        {
+            case ENCODING_CP932:
+                size = EncodeCP932(str, nullptr);
+                break;
+            case ENCODING_CP1252:
+                size = EncodeCP1252(str, nullptr);
+                break;
+            default:
+                size = str.Size();
+                break;
+        }
+    }
 
     // If the string should be aligned, calculate the aligned size.
     if(0 < align)
     {
-        return ((out.size() + align - 1) / align) * align;
+        return ((size + align - 1) / align) * align;
     }
 
     // Return the size of the encoded string without alignment.
-    return out.size();
+    return size;
 }
@@ -93,6 +93,25 @@ String FromEncoding(Encoding_t encoding, const std::vector<char>& str);
 std::vector<char> ToEncoding(Encoding_t encoding, const String& str,
     bool nullTerminator = true);
 
+/**
+ * Convert a String to the specified @em encoding, writing the result into
+ * an existing buffer instead of allocating one.
+ * @param encoding Encoding to use. Can be one of:
+ * - ENCODING_UTF8 (Unicode)
+ * - ENCODING_CP932 (Japanese)
+ * - ENCODING_CP1252 (US English)
+ * @param str String to convert.
+ * @param szDestination Buffer to write the converted string into. It must
+ *   have room for @ref SizeEncoded bytes plus the null terminator (if one
+ *   is added).
+ * @param nullTerminator Indicates if a null terminator should be added.
+ * @returns Number of bytes written to the buffer.
+ * @sa libcomp::Convert::ToEncoding
+ * @sa libcomp::Convert::SizeEncoded
+ */
+size_t EncodeTo(Encoding_t encoding, const String& str, char *szDestination,
+    bool nullTerminator = true);
+
 /**
  * Determine the size of a String if it was converted to the specified
  * @em encoding. If @em align is specified, the size will be rounded up to a
@@ -274,6 +274,18 @@ int64_t DataStore::FileSize(const libcomp::String& path)
     return size;
 }
 
+int64_t DataStore::ModifiedTime(const libcomp::String& path)
+{
+    PHYSFS_Stat stat;
+
+    if(0 == PHYSFS_stat(path.C(), &stat))
+    {
+        return -1;
+    }
+
+    return stat.modtime;
+}
+
 bool DataStore::Delete(const libcomp::String& path, bool recursive)
 {
     const char *szPath = path.C();
@@ -27,14 +27,39 @@
 #include "DataSyncManager.h"
 
 // libcomp Includes
+#include "DatabaseBind.h"
+#include "DatabaseQueryRow.h"
 #include "Log.h"
 #include "Packet.h"
 #include "PacketCodes.h"
 #include "PersistentObject.h"
 #include "ScriptEngine.h"
 
+// Standard C++11 Includes
+#include <algorithm>
+
 using namespace libcomp;
 
+namespace
+{
+
+/// Persistent record sent as just its UUID to be reloaded from the
+/// database.
+const uint8_t SYNC_RECORD_UUID = 0;
+
+/// Persistent record sent with every field value.
+const uint8_t SYNC_RECORD_FULL = 1;
+
+/// Persistent record sent with the field values changed since it was
+/// last sent.
+const uint8_t SYNC_RECORD_DELTA = 2;
+
+/// Minimum number of synced records kept before expired records are
+/// pruned.
+const size_t SYNCED_RECORD_PRUNE_MIN = 1024;
+
+} // namespace
+
 namespace libcomp
 {
     template<>
@@ -56,7 +81,8 @@ namespace libcomp
     }
 }
 
-DataSyncManager::DataSyncManager()
+DataSyncManager::DataSyncManager() :
+    mSyncedRecordPruneSize(SYNCED_RECORD_PRUNE_MIN)
 {
 }
 
@@ -137,17 +163,40 @@ void DataSyncManager::SyncOutgoing()
 
         for(std::string type : allTypes)
         {
+            auto& updates = mOutboundUpdates[type];
+            auto& removes = mOutboundRemoves[type];
+            if(updates.size() == 0 && removes.size() == 0) continue;
+
             String lType(type);
 
-            QueueOutgoing(lType, pair.first, mOutboundUpdates[type],
-                mOutboundRemoves[type]);
+            // Every connection synchronizing the type gets the same
+            // records so only the changed fields need to be sent
+            libcomp::Packet p;
+            BuildOutgoing(p, lType, updates, removes, true);
+
+            pair.first->QueuePacket(p);
         }
 
         pair.first->FlushOutgoing();
     }
 
+    for(auto& pair : mOutboundRemoves)
+    {
+        for(auto& record : pair.second)
+        {
+            auto pObj = std::dynamic_pointer_cast<PersistentObject>(record);
+            if(pObj)
+            {
+                mSyncedRecords.erase(pObj->GetUUID().ToString());
+            }
+        }
+    }
+
     mOutboundUpdates.clear();
     mOutboundRemoves.clear();
+    mEncodedRecords.clear();
+
+    PruneSyncedRecords();
 }
 
 bool DataSyncManager::SyncIncoming(libcomp::ReadOnlyPacket& p,
@@ -212,27 +261,23 @@ bool DataSyncManager::SyncIncoming(libcomp::ReadOnlyPacket& p,
         std::list<std::shared_ptr<libcomp::Object>> records;
         if(isPersistent)
         {
-            // Load by UUID
+            // Apply the field values sent or load by UUID
             for(uint16_t k = 0; k < recordsCount; k++)
             {
-                String uidStr(p.ReadString16Little(
-                    libcomp::Convert::ENCODING_UTF8, true));
-
-                libobjgen::UUID uid(uidStr.C());
-                if(!uid.IsNull())
+                bool valid = true;
+                auto obj = ReadPersistentRecord(p, typeHash, config->DB,
+                    valid);
+                if(!valid)
                 {
-                    auto obj = PersistentObject::LoadObjectByUUID(typeHash,
-                        mRegisteredTypes[type]->DB, uid, true);
-                    if(obj)
-                    {
-                        records.push_back(obj);
-                    }
+                    LOG_ERROR(libcomp::String("Invalid update data stream"
+                        " received from persistent object of type: %1\n")
+                        .Arg(type));
+                    return false;
                 }
-                else
+
+                if(obj)
                 {
-                    // Skip null UIDs
-                    LOG_ERROR(libcomp::String("Null UID encountered for"
-                        " updated sync record of type: %1\n").Arg(type));
+                    records.push_back(obj);
                 }
             }
         }
@@ -314,6 +359,8 @@ bool DataSyncManager::SyncIncoming(libcomp::ReadOnlyPacket& p,
                     auto obj = config->ServerOwned && db
                         ? PersistentObject::LoadObjectByUUID(typeHash, db, uid)
                         : PersistentObject::GetObjectByUUID(uid);
+                    mSyncedRecords.erase(uid.ToString());
+
                     if(obj)
                     {
                         // Remove from the queues
@@ -488,6 +535,16 @@ void DataSyncManager::QueueOutgoing(const libcomp::String& type,
     if(updates.size() == 0 && removes.size() == 0) return;
 
     libcomp::Packet p;
+    BuildOutgoing(p, type, updates, removes);
+
+    connection->QueuePacket(p);
+}
+
+void DataSyncManager::BuildOutgoing(libcomp::Packet& p,
+    const libcomp::String& type,
+    const std::set<std::shared_ptr<libcomp::Object>>& updates,
+    const std::set<std::shared_ptr<libcomp::Object>>& removes, bool delta)
+{
     p.WritePacketCode(InternalPacketCode_t::PACKET_DATA_SYNC);
 
     bool isPersistent = false;
@@ -496,10 +553,25 @@ void DataSyncManager::QueueOutgoing(const libcomp::String& type,
     p.WriteString16Little(libcomp::Convert::ENCODING_UTF8,
         type, true);
 
-    WriteOutgoingRecords(p, isPersistent, updates);
-    WriteOutgoingRecords(p, isPersistent, removes);
+    if(isPersistent)
+    {
+        auto configIter = mRegisteredTypes.find(type.C());
+        bool fields = configIter != mRegisteredTypes.end() &&
+            configIter->second->DeltaSync;
 
-    connection->QueuePacket(p);
+        p.WriteU16Little((uint16_t)updates.size());
+        for(auto obj : updates)
+        {
+            WritePersistentRecord(p, std::dynamic_pointer_cast<
+                PersistentObject>(obj), fields, delta);
+        }
+    }
+    else
+    {
+        WriteOutgoingRecords(p, isPersistent, updates);
+    }
+
+    WriteOutgoingRecords(p, isPersistent, removes);
 }
 
 void DataSyncManager::WriteOutgoingRecord(libcomp::Packet& p, bool isPersistent,
@@ -512,11 +584,13 @@ void DataSyncManager::WriteOutgoingRecord(libcomp::Packet& p, bool isPersistent,
 
     if(isPersistent)
     {
-        // Write the UUID
-        auto pObj = std::dynamic_pointer_cast<
-            PersistentObject>(record);
-        p.WriteString16Little(libcomp::Convert::ENCODING_UTF8,
-            pObj->GetUUID().ToString(), true);
+        // Write the UUID and the field values if configured
+        auto configIter = mRegisteredTypes.find(type.C());
+        bool fields = configIter != mRegisteredTypes.end() &&
+            configIter->second->DeltaSync;
+
+        WritePersistentRecord(p, std::dynamic_pointer_cast<
+            PersistentObject>(record), fields, false);
     }
     else
     {
@@ -550,4 +624,242 @@ void DataSyncManager::WriteOutgoingRecords(libcomp::Packet& p,
             obj->SavePacket(p, false);
         }
     }
-}
\ No newline at end of file
+}
+
+void DataSyncManager::WritePersistentRecord(libcomp::Packet& p,
+    const std::shared_ptr<PersistentObject>& record, bool fields, bool delta)
+{
+    if(delta && fields)
+    {
+        // The record has already been compared against the last values
+        // sent for another connection
+        auto it = mEncodedRecords.find(record);
+        if(it != mEncodedRecords.end())
+        {
+            p.WriteArray(it->second);
+            return;
+        }
+    }
+
+    auto uuid = record->GetUUID().ToString();
+
+    libcomp::Packet r;
+    r.WriteString16Little(libcomp::Convert::ENCODING_UTF8, uuid, true);
+
+    if(!fields)
+    {
+        r.WriteU8(SYNC_RECORD_UUID);
+    }
+    else
+    {
+        auto row = GetRecordRow(record);
+        auto& columns = row->GetColumns();
+
+        std::list<std::pair<std::string, const std::vector<char>*>> changed;
+
+        auto syncedIter = delta ? mSyncedRecords.find(uuid)
+            : mSyncedRecords.end();
+        if(syncedIter != mSyncedRecords.end() &&
+            syncedIter->second.Record.lock() == record)
+        {
+            auto& synced = syncedIter->second.Columns;
+            for(auto& column : columns)
+            {
+                auto it = synced.find(column.first);
+                if(it == synced.end() || it->second != column.second)
+                {
+                    changed.push_back(std::make_pair(column.first,
+                        &column.second));
+                }
+            }
+
+            r.WriteU8(SYNC_RECORD_DELTA);
+        }
+        else
+        {
+            for(auto& column : columns)
+            {
+                changed.push_back(std::make_pair(column.first,
+                    &column.second));
+            }
+
+            r.WriteU8(SYNC_RECORD_FULL);
+        }
+
+        r.WriteU16Little((uint16_t)changed.size());
+        for(auto& column : changed)
+        {
+            r.WriteString16Little(libcomp::Convert::ENCODING_UTF8,
+                column.first, true);
+            r.WriteU32Little((uint32_t)column.second->size());
+            r.WriteArray(*column.second);
+        }
+
+        if(delta)
+        {
+            // Every connection has now been sent these values
+            auto& synced = mSyncedRecords[uuid];
+            synced.Record = record;
+            synced.Columns = columns;
+        }
+    }
+
+    std::vector<char> data(r.ConstData(), r.ConstData() + r.Size());
+    p.WriteArray(data);
+
+    if(delta && fields)
+    {
+        mEncodedRecords[record] = data;
+    }
+}
+
+std::shared_ptr<PersistentObject> DataSyncManager::ReadPersistentRecord(
+    libcomp::ReadOnlyPacket& p, size_t typeHash,
+    const std::shared_ptr<Database>& db, bool& valid)
+{
+    if(p.Left() < 2 || p.Left() < (uint32_t)(2 + p.PeekU16Little()))
+    {
+        valid = false;
+        return nullptr;
+    }
+
+    String uidStr(p.ReadString16Little(
+        libcomp::Convert::ENCODING_UTF8, true));
+
+    if(p.Left() < 1)
+    {
+        valid = false;
+        return nullptr;
+    }
+
+    uint8_t format = p.ReadU8();
+
+    auto row = std::make_shared<DatabaseQueryRow>();
+    if(SYNC_RECORD_UUID != format)
+    {
+        if(p.Left() < 2)
+        {
+            valid = false;
+            return nullptr;
+        }
+
+        uint16_t columnCount = p.ReadU16Little();
+        for(uint16_t i = 0; i < columnCount; i++)
+        {
+            if(p.Left() < 2 || p.Left() < (uint32_t)(2 + p.PeekU16Little()))
+            {
+                valid = false;
+                return nullptr;
+            }
+
+            String name(p.ReadString16Little(
+                libcomp::Convert::ENCODING_UTF8, true));
+
+            if(p.Left() < 4 || p.Left() < (4 + p.PeekU32Little()))
+            {
+                valid = false;
+                return nullptr;
+            }
+
+            row->SetColumn(name.C(), p.ReadArray(p.ReadU32Little()));
+        }
+    }
+
+    libobjgen::UUID uid(uidStr.C());
+    if(uid.IsNull())
+    {
+        // Skip null UIDs
+        auto metadata = PersistentObject::GetRegisteredMetadata(typeHash);
+        LOG_ERROR(libcomp::String("Null UID encountered for"
+            " updated sync record of type: %1\n").Arg(
+            metadata ? metadata->GetName() : std::string()));
+
+        return nullptr;
+    }
+
+    auto obj = SYNC_RECORD_UUID != format
+        ? PersistentObject::GetObjectByUUID(uid) : nullptr;
+    if(!obj && SYNC_RECORD_FULL != format)
+    {
+        // Either only the UUID was sent or the record is not loaded here
+        // and only some of the fields were sent
+        return PersistentObject::LoadObjectByUUID(typeHash, db, uid, true);
+    }
+
+    bool isNew = false;
+    if(!obj)
+    {
+        obj = PersistentObject::New(typeHash);
+        isNew = true;
+    }
+    else if(SYNC_RECORD_DELTA == format)
+    {
+        // Keep the current values of the fields that were not sent
+        auto current = GetRecordRow(obj);
+        for(auto& column : current->GetColumns())
+        {
+            if(row->GetColumns().find(column.first) ==
+                row->GetColumns().end())
+            {
+                row->SetColumn(column.first, column.second);
+            }
+        }
+    }
+
+    row->Bind("UID", uid);
+
+    DatabaseQuery query(row);
+    if(!obj || !obj->LoadDatabaseValues(query))
+    {
+        LOG_ERROR(libcomp::String("Failed to apply sync record: %1\n")
+            .Arg(uidStr));
+
+        return nullptr;
+    }
+
+    if(isNew)
+    {
+        PersistentObject::Register(obj);
+    }
+
+    return obj;
+}
+
+std::shared_ptr<DatabaseQueryRow> DataSyncManager::GetRecordRow(
+    const std::shared_ptr<PersistentObject>& record)
+{
+    auto row = std::make_shared<DatabaseQueryRow>();
+    DatabaseQuery query(row);
+
+    // Leave the dirty fields alone so the record is still saved
+    for(auto value : record->GetMemberBindValues(true, false))
+    {
+        value->Bind(query);
+        delete value;
+    }
+
+    return row;
+}
+
+void DataSyncManager::PruneSyncedRecords()
+{
+    if(mSyncedRecords.size() < mSyncedRecordPruneSize)
+    {
+        return;
+    }
+
+    for(auto it = mSyncedRecords.begin(); it != mSyncedRecords.end();)
+    {
+        if(it->second.Record.expired())
+        {
+            it = mSyncedRecords.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    mSyncedRecordPruneSize = std::max(SYNCED_RECORD_PRUNE_MIN,
+        mSyncedRecords.size() * 2);
+}
@@ -34,12 +34,15 @@
 // Standard C++11 Includes
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace libcomp
 {
 
 class Database;
+class DatabaseQueryRow;
 class Packet;
+class PersistentObject;
 class ReadOnlyPacket;
 
 /**
@@ -214,7 +217,7 @@ protected:
         /**
          * Create a new empty ObjectConfig.
          */
-        ObjectConfig() : ServerOwned(false)
+        ObjectConfig() : ServerOwned(false), DeltaSync(false)
         {
         }
 
@@ -229,7 +232,7 @@ protected:
         ObjectConfig(const libcomp::String& name, bool serverOwned,
             std::shared_ptr<Database> database = nullptr)
             : Name(name), DB(database), ServerOwned(serverOwned),
-            DynamicHandler(false)
+            DynamicHandler(false), DeltaSync(false)
         {
         }
 
@@ -248,6 +251,14 @@ protected:
         /// always be called when an update is passed to the manager
         bool DynamicHandler;
 
+        /// Specifies that updates to a persistent object should be sent
+        /// with the field values instead of just the UUID so the other
+        /// servers do not need to reload the record from the database.
+        /// Records already sent are only sent with the fields that have
+        /// changed since. Non-persistent objects are always sent as their
+        /// full datastream and ignore this.
+        bool DeltaSync;
+
         /// Pointer to the function to use when the record is being updated.
         /// Parameters are as follows:
         /// 1) Object type name
@@ -291,6 +302,23 @@ protected:
         const std::set<std::shared_ptr<libcomp::Object>>& updates,
         const std::set<std::shared_ptr<libcomp::Object>>& removes);
 
+    /**
+     * Write a complete data sync packet based upon the supplied type and
+     * record sets.
+     * @param p Packet to write the changes to
+     * @param type Type name of the object being synchronized
+     * @param updates Set of all inserts and updates that have been made
+     * @param removes Set of all removes that have been made
+     * @param delta true if persistent records configured for delta sync
+     *  that have been sent before should only include the fields changed
+     *  since they were last sent. This is only valid when the packet is
+     *  sent to every connection synchronizing the type.
+     */
+    void BuildOutgoing(libcomp::Packet& p, const libcomp::String& type,
+        const std::set<std::shared_ptr<libcomp::Object>>& updates,
+        const std::set<std::shared_ptr<libcomp::Object>>& removes,
+        bool delta = false);
+
     /**
      * Write complete outgoing record packet to send from one record.
      * @param p Packet to write the changes to
@@ -312,6 +340,19 @@ protected:
     std::mutex mLock;
 
 private:
+    /**
+     * Field values of a persistent record as they were last sent to every
+     * connection synchronizing the type.
+     */
+    struct SyncedRecord
+    {
+        /// Record the values belong to
+        std::weak_ptr<libcomp::Object> Record;
+
+        /// Encoded field values by column name
+        std::unordered_map<std::string, std::vector<char>> Columns;
+    };
+
     /**
      * Write outgoing records to the supplied packet as part of a sync
      * operation.
@@ -324,6 +365,47 @@ private:
     void WriteOutgoingRecords(libcomp::Packet& p, bool isPersistent,
         const std::set<std::shared_ptr<libcomp::Object>>& records);
 
+    /**
+     * Write an updated persistent record to the supplied packet.
+     * @param p Packet to write the record to
+     * @param record Record to write to the packet
+     * @param fields true if the field values should be written, false if
+     *  only the UUID should be written
+     * @param delta true if only the fields changed since the record was
+     *  last sent should be written
+     */
+    void WritePersistentRecord(libcomp::Packet& p, const std::shared_ptr<
+        PersistentObject>& record, bool fields, bool delta);
+
+    /**
+     * Read an updated persistent record from the supplied packet, loading
+     * it from the database only if the field values were not included.
+     * @param p Packet to read the record from
+     * @param typeHash C++ type hash of the record
+     * @param db Database to load the record from if needed
+     * @param valid Output parameter set to false if the packet data is
+     *  not valid
+     * @return Pointer to the updated record or null if it could not be
+     *  loaded
+     */
+    std::shared_ptr<PersistentObject> ReadPersistentRecord(
+        libcomp::ReadOnlyPacket& p, size_t typeHash,
+        const std::shared_ptr<Database>& db, bool& valid);
+
+    /**
+     * Capture the field values of a persistent record.
+     * @param record Record to capture the values of
+     * @return Row containing every field value of the record
+     */
+    static std::shared_ptr<DatabaseQueryRow> GetRecordRow(
+        const std::shared_ptr<PersistentObject>& record);
+
+    /**
+     * Remove the field values last sent for records that no longer exist
+     * once enough have been added since the last time this ran.
+     */
+    void PruneSyncedRecords();
+
     /// Map of all record inserts and updates queued for synchronization
     std::unordered_map<std::string,
         std::set<std::shared_ptr<libcomp::Object>>> mOutboundUpdates;
@@ -336,6 +418,18 @@ private:
     /// object types
     std::unordered_map<std::shared_ptr<InternalConnection>,
         std::set<std::string>> mConnections;
+
+    /// Field values last sent for delta synchronized records by UUID
+    std::unordered_map<std::string, SyncedRecord> mSyncedRecords;
+
+    /// Number of entries in mSyncedRecords that triggers a prune
+    size_t mSyncedRecordPruneSize;
+
+    /// Records encoded during the current @ref SyncOutgoing call so each
+    /// record is only compared against the values last sent once no
+    /// matter how many connections it is sent to
+    std::unordered_map<std::shared_ptr<libcomp::Object>,
+        std::vector<char>> mEncodedRecords;
 };
 
 } // namspace libcomp
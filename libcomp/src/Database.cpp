@@ -28,19 +28,96 @@
 
 // libcomp Includes
 #include "BaseServer.h"
+#include "Constants.h"
 #include "DataStore.h"
+#include "DatabaseBind.h"
+#include "DatabaseStatementCache.h"
 #include "Log.h"
 #include "ScriptEngine.h"
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
 using namespace libcomp;
 
+namespace
+{
+
+/**
+ * Drop repeated writes of the same object from a change set. Updates to
+ * objects also being inserted or deleted are dropped as well since the
+ * insert already writes every field and the delete removes the record.
+ * @param changes Change set to coalesce
+ * @param coalesced Incremented by the number of writes dropped
+ * @return Pointer to the coalesced change set
+ */
+std::shared_ptr<DBStandardChangeSet> CoalesceChangeSet(
+    const std::shared_ptr<DBStandardChangeSet>& changes,
+    uint64_t& coalesced)
+{
+    auto result = std::make_shared<DBStandardChangeSet>(
+        changes->GetTransactionUUID());
+
+    std::set<std::shared_ptr<PersistentObject>> seen;
+    std::set<std::shared_ptr<PersistentObject>> deletes;
+    for(auto obj : changes->GetDeletes())
+    {
+        if(deletes.insert(obj).second)
+        {
+            result->Delete(obj);
+        }
+        else
+        {
+            coalesced++;
+        }
+    }
+
+    for(auto obj : changes->GetInserts())
+    {
+        if(seen.insert(obj).second)
+        {
+            result->Insert(obj);
+        }
+        else
+        {
+            coalesced++;
+        }
+    }
+
+    for(auto obj : changes->GetUpdates())
+    {
+        if(deletes.find(obj) == deletes.end() && seen.insert(obj).second)
+        {
+            result->Update(obj);
+        }
+        else
+        {
+            coalesced++;
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
 Database::Database(const std::shared_ptr<objects::DatabaseConfig>& config)
+    : mStatementCacheCapacity(DatabaseStatementCache::DEFAULT_CAPACITY),
+    mWriteBehindRunning(false), mFlushRequested(false),
+    mQueuedObjectCount(0), mTransactionStats()
 {
     mConfig = config;
 }
 
 Database::~Database()
 {
+    // Derived classes should stop the thread first since it calls back
+    // into them but do not leave it running
+    StopWriteBehind();
 }
 
 bool Database::Execute(const String& query)
@@ -96,6 +173,56 @@ std::shared_ptr<PersistentObject> Database::LoadSingleObject(size_t typeHash,
     return objects.size() > 0 ? objects.front() : nullptr;
 }
 
+std::list<std::shared_ptr<PersistentObject>> Database::LoadObjectsByUUID(
+    size_t typeHash, const String& column,
+    const std::list<libobjgen::UUID>& uuids)
+{
+    std::vector<libobjgen::UUID> unique;
+    std::unordered_set<libobjgen::UUID> seen;
+
+    for(auto& uuid : uuids)
+    {
+        if(!uuid.IsNull() && seen.insert(uuid).second)
+        {
+            unique.push_back(uuid);
+        }
+    }
+
+    std::list<std::shared_ptr<PersistentObject>> objects;
+
+    for(size_t offset = 0; offset < unique.size();
+        offset += DATABASE_PREFETCH_BATCH_SIZE)
+    {
+        size_t count = std::min(unique.size() - offset,
+            (size_t)DATABASE_PREFETCH_BATCH_SIZE);
+
+        // Pad the batch to a power of two by repeating the last UUID so
+        // only a handful of distinct statements are ever prepared.
+        size_t padded = 1;
+        while(padded < count)
+        {
+            padded <<= 1;
+        }
+
+        std::list<DatabaseBind*> values;
+        for(size_t i = 0; i < padded; i++)
+        {
+            values.push_back(new DatabaseBindUUID(String("%1%2").Arg(
+                column).Arg((uint32_t)i), unique[offset +
+                std::min(i, count - 1)]));
+        }
+
+        objects.splice(objects.end(), LoadObjects(typeHash, column, values));
+
+        for(auto pValue : values)
+        {
+            delete pValue;
+        }
+    }
+
+    return objects;
+}
+
 bool Database::DeleteSingleObject(std::shared_ptr<PersistentObject>& obj)
 {
     std::list<std::shared_ptr<PersistentObject>> objs;
@@ -171,6 +298,11 @@ bool Database::QueueChangeSet(const std::shared_ptr<
 
             mTransactionQueue[key] = queueEntry;
 
+            mQueuedObjectCount += (uint64_t)(
+                standardChanges->GetInserts().size() +
+                standardChanges->GetUpdates().size() +
+                standardChanges->GetDeletes().size());
+
             return true;
         }
     }
@@ -179,6 +311,98 @@ bool Database::QueueChangeSet(const std::shared_ptr<
 }
 
 std::list<libobjgen::UUID> Database::ProcessTransactionQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mTransactionLock);
+        if(mWriteBehindRunning)
+        {
+            // Let the write-behind thread do the work and report back
+            // anything that failed since the last call
+            std::list<libobjgen::UUID> failures;
+            failures.swap(mWriteBehindFailures);
+
+            if(!mTransactionQueue.empty())
+            {
+                mFlushRequested = true;
+                mTransactionCondition.notify_one();
+            }
+
+            return failures;
+        }
+    }
+
+    return FlushTransactionQueue();
+}
+
+bool Database::StartWriteBehind()
+{
+    std::lock_guard<std::mutex> lock(mTransactionLock);
+    if(mWriteBehindRunning)
+    {
+        return false;
+    }
+
+    mWriteBehindRunning = true;
+    mFlushRequested = false;
+    mWriteBehindThread = std::thread([this]()
+    {
+#if !defined(_WIN32)
+        pthread_setname_np(pthread_self(), "db_write");
+#endif // !defined(_WIN32)
+
+        WriteBehindLoop();
+    });
+
+    return true;
+}
+
+void Database::StopWriteBehind()
+{
+    {
+        std::lock_guard<std::mutex> lock(mTransactionLock);
+        if(!mWriteBehindRunning)
+        {
+            return;
+        }
+
+        mWriteBehindRunning = false;
+        mTransactionCondition.notify_one();
+    }
+
+    mWriteBehindThread.join();
+
+    // Write anything queued after the thread stopped
+    for(auto failedUUID : FlushTransactionQueue())
+    {
+        LOG_ERROR(String("Queued database changes failed to save after"
+            " the write-behind thread stopped: %1\n").Arg(
+            failedUUID.ToString()));
+    }
+}
+
+Database::TransactionQueueStats Database::ResetTransactionQueueStats()
+{
+    std::lock_guard<std::mutex> lock(mTransactionLock);
+
+    TransactionQueueStats stats = mTransactionStats;
+    stats.QueueDepth = mQueuedObjectCount;
+
+    mTransactionStats = TransactionQueueStats();
+
+    return stats;
+}
+
+size_t Database::GetStatementCacheCapacity() const
+{
+    return mStatementCacheCapacity;
+}
+
+void Database::SetStatementCacheCapacity(size_t capacity)
+{
+    mStatementCacheCapacity = capacity;
+}
+
+std::list<libobjgen::UUID> Database::FlushTransactionQueue()
 {
     std::list<libobjgen::UUID> failures;
 
@@ -192,15 +416,19 @@ std::list<libobjgen::UUID> Database::ProcessTransactionQueue()
             return failures;
         }
 
-        queue = mTransactionQueue;
-        mTransactionQueue.clear();
+        queue.swap(mTransactionQueue);
+        mQueuedObjectCount = 0;
     }
 
+    auto start = std::chrono::steady_clock::now();
+
+    uint64_t coalesced = 0;
+
     // Process the general queue transaction first
     auto nullKey = NULLUUID.ToString();
     if(queue.find(nullKey) != queue.end())
     {
-        if(!ProcessChangeSet(queue[nullKey]))
+        if(!ProcessChangeSet(CoalesceChangeSet(queue[nullKey], coalesced)))
         {
             failures.push_back(nullKey);
         }
@@ -210,15 +438,49 @@ std::list<libobjgen::UUID> Database::ProcessTransactionQueue()
     // Process the remaining transactions
     for(auto kv : queue)
     {
-        if(!ProcessChangeSet(kv.second))
+        if(!ProcessChangeSet(CoalesceChangeSet(kv.second, coalesced)))
         {
             failures.push_back(kv.second->GetTransactionUUID());
         }
     }
 
+    uint64_t elapsed = (uint64_t)std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::steady_clock::now() -
+        start).count();
+
+    std::lock_guard<std::mutex> lock(mTransactionLock);
+    mTransactionStats.FlushCount++;
+    mTransactionStats.FlushTime += elapsed;
+    mTransactionStats.Coalesced += coalesced;
+    if(mTransactionStats.MaxFlushTime < elapsed)
+    {
+        mTransactionStats.MaxFlushTime = elapsed;
+    }
+
     return failures;
 }
 
+void Database::WriteBehindLoop()
+{
+    std::unique_lock<std::mutex> lock(mTransactionLock);
+
+    while(mWriteBehindRunning)
+    {
+        mTransactionCondition.wait(lock, [this]()
+        {
+            return mFlushRequested || !mWriteBehindRunning;
+        });
+
+        mFlushRequested = false;
+
+        lock.unlock();
+        auto failures = FlushTransactionQueue();
+        lock.lock();
+
+        mWriteBehindFailures.splice(mWriteBehindFailures.end(), failures);
+    }
+}
+
 bool Database::ProcessChangeSet(const std::shared_ptr<DatabaseChangeSet>& changes)
 {
     auto opChanges = std::dynamic_pointer_cast<DBOperationalChangeSet>(changes);
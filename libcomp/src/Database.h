@@ -34,6 +34,11 @@
 #include "DatabaseChangeSet.h"
 #include "PersistentObject.h"
 
+// Standard C++11 Includes
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
 namespace libcomp
 {
 
@@ -52,6 +57,27 @@ class DataStore;
 class Database : public std::enable_shared_from_this<Database>
 {
 public:
+    /**
+     * Snapshot of the transaction queue counters.
+     */
+    struct TransactionQueueStats
+    {
+        /// Number of objects queued and not yet written
+        uint64_t QueueDepth;
+
+        /// Number of times the queue was flushed
+        uint64_t FlushCount;
+
+        /// Total time spent flushing the queue in microseconds
+        uint64_t FlushTime;
+
+        /// Longest time spent on a single flush in microseconds
+        uint64_t MaxFlushTime;
+
+        /// Number of repeated writes of the same object dropped
+        uint64_t Coalesced;
+    };
+
     /**
      * Create a new Database connection.
      * @param config Pointer to a database configuration
@@ -141,6 +167,34 @@ public:
     virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
        size_t typeHash, DatabaseBind *pValue) = 0;
 
+    /**
+     * Load multiple @ref PersistentObject instances where a single database
+     * column matches any one of a list of bound values. Each value must be
+     * bound under its own parameter name. If no values are supplied every
+     * object of the type is loaded.
+     * @param typeHash C++ type hash representing the object type to load
+     * @param column Name of the column to select upon
+     * @param values Database agnostic bindings for each value to match
+     * @return List of pointers to loaded objects from the query results
+     */
+    virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
+       size_t typeHash, const String& column,
+       const std::list<DatabaseBind*>& values) = 0;
+
+    /**
+     * Load every @ref PersistentObject of a type with a UUID column that
+     * matches one of the supplied UUIDs. The UUIDs are matched in batches
+     * of up to DATABASE_PREFETCH_BATCH_SIZE so a whole level of an object
+     * graph takes one query instead of one query per object.
+     * @param typeHash C++ type hash representing the object type to load
+     * @param column Name of the UUID column to select upon
+     * @param uuids UUIDs to match (null and duplicate UUIDs are skipped)
+     * @return List of pointers to loaded objects from the query results
+     */
+    std::list<std::shared_ptr<PersistentObject>> LoadObjectsByUUID(
+        size_t typeHash, const String& column,
+        const std::list<libobjgen::UUID>& uuids);
+
     /**
      * Load one @ref PersistentObject instance from a single bound
      * database column and value to select upon.  This simply filters
@@ -238,10 +292,50 @@ public:
 
     /**
      * Pop and process all transactions stored in the transaction queue.
+     * If the write-behind thread is running, this only signals it to
+     * flush the queue and returns the failures from flushes that have
+     * completed since the last call.
      * @return List of all transaction group UUIDs that failed to process
      */
     std::list<libobjgen::UUID> ProcessTransactionQueue();
 
+    /**
+     * Start a dedicated thread (and connection) that writes the
+     * transaction queue so callers of @ref ProcessTransactionQueue do
+     * not have to wait on the database.
+     * @return true if the thread was started, false if it was already
+     *  running
+     */
+    bool StartWriteBehind();
+
+    /**
+     * Write anything left in the transaction queue and stop the
+     * write-behind thread if it is running.
+     */
+    void StopWriteBehind();
+
+    /**
+     * Get the transaction queue counters and reset them to zero. The
+     * queue depth is not reset.
+     * @return Snapshot of the counters before they were reset
+     */
+    TransactionQueueStats ResetTransactionQueueStats();
+
+    /**
+     * Get the number of prepared statements kept for each connection.
+     * @return Maximum number of statements cached per connection
+     */
+    size_t GetStatementCacheCapacity() const;
+
+    /**
+     * Set the number of prepared statements kept for each connection.
+     * Statements used to insert and update objects are cached by their
+     * query text so they are only prepared once per connection.
+     * @param capacity Maximum number of statements cached per connection
+     *  or zero to prepare every statement again
+     */
+    void SetStatementCacheCapacity(size_t capacity);
+
     /**
      * Process one or many database changes as a single transaction.
      * @param changes Grouping of changes to apply to the database
@@ -311,13 +405,52 @@ protected:
     /// Pointer to the config file used to configure the database connection
     std::shared_ptr<objects::DatabaseConfig> mConfig;
 
+    /// Maximum number of prepared statements cached per connection
+    std::atomic<size_t> mStatementCacheCapacity;
+
 private:
+    /**
+     * Pop and process all transactions stored in the transaction queue on
+     * the current thread.
+     * @return List of all transaction group UUIDs that failed to process
+     */
+    std::list<libobjgen::UUID> FlushTransactionQueue();
+
+    /**
+     * Wait for flush requests and write the transaction queue until
+     * @ref StopWriteBehind is called.
+     */
+    void WriteBehindLoop();
+
     /// Map of transaction pointers by UUID
     std::unordered_map<std::string,
         std::shared_ptr<DBStandardChangeSet>> mTransactionQueue;
 
     /// Mutex to lock accessing the transaction queue
     std::mutex mTransactionLock;
+
+    /// Signaled when a flush is requested or the write-behind thread
+    /// should stop
+    std::condition_variable mTransactionCondition;
+
+    /// Thread writing the transaction queue
+    std::thread mWriteBehindThread;
+
+    /// Indicates the write-behind thread is running
+    bool mWriteBehindRunning;
+
+    /// Indicates a flush has been requested
+    bool mFlushRequested;
+
+    /// Transaction group UUIDs that failed to process on the write-behind
+    /// thread and have not been returned yet
+    std::list<libobjgen::UUID> mWriteBehindFailures;
+
+    /// Number of objects queued and not yet taken by a flush
+    uint64_t mQueuedObjectCount;
+
+    /// Counters reported by @ref ResetTransactionQueueStats
+    TransactionQueueStats mTransactionStats;
 };
 
 } // namespace libcomp
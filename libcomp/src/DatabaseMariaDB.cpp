@@ -33,6 +33,10 @@
 #include "DataStore.h"
 #include "Log.h"
 
+// Standard C++11 Includes
+#include <map>
+#include <sstream>
+
 // config-win.h and my_global.h redefine bool unless explicitly defined
 #define bool bool
 
@@ -41,6 +45,9 @@
 
 using namespace libcomp;
 
+/// Maximum number of rows written by a single batched statement.
+static const size_t MAX_BATCH_ROWS = 50;
+
 static libcomp::String ConnectionString(MYSQL *pConnection)
 {
     return libcomp::String("{%1-%2}").Arg(
@@ -56,6 +63,9 @@ DatabaseMariaDB::DatabaseMariaDB(const std::shared_ptr<
 
 DatabaseMariaDB::~DatabaseMariaDB()
 {
+    // The write-behind thread calls back into this class
+    StopWriteBehind();
+
     Close();
 }
 
@@ -69,6 +79,10 @@ bool DatabaseMariaDB::Close()
     bool result = true;
 
     std::lock_guard<std::mutex> lock(mConnectionLock);
+
+    // Statements must be closed before their connection
+    mStatementCaches.clear();
+
     for(auto kv : mConnections)
     {
         result &= Close(kv.second);
@@ -307,6 +321,21 @@ bool DatabaseMariaDB::Use()
 
 std::list<std::shared_ptr<PersistentObject>> DatabaseMariaDB::LoadObjects(
     size_t typeHash, DatabaseBind *pValue)
+{
+    std::list<DatabaseBind*> values;
+
+    if(nullptr != pValue)
+    {
+        values.push_back(pValue);
+    }
+
+    return LoadObjects(typeHash, nullptr != pValue ? pValue->GetColumn()
+        : String(), values);
+}
+
+std::list<std::shared_ptr<PersistentObject>> DatabaseMariaDB::LoadObjects(
+    size_t typeHash, const String& column,
+    const std::list<DatabaseBind*>& values)
 {
     std::list<std::shared_ptr<PersistentObject>> objects;
 
@@ -319,13 +348,26 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseMariaDB::LoadObjects(
         return {};
     }
 
-    String sql = String("SELECT * FROM `%1`%2").Arg(
-        metaObject->GetName()).Arg(
-        (nullptr != pValue
-            ? String(" WHERE `%1` = :%1").Arg(pValue->GetColumn())
-            : ""));
+    String sql = String("SELECT * FROM `%1`").Arg(metaObject->GetName());
 
-    DatabaseQuery query = Prepare(sql);
+    if(1 == values.size() && values.front()->GetColumn() == column)
+    {
+        sql += String(" WHERE `%1` = :%1").Arg(column);
+    }
+    else if(!values.empty())
+    {
+        std::list<String> params;
+        for(auto pValue : values)
+        {
+            params.push_back(String(":%1").Arg(pValue->GetColumn()));
+        }
+
+        sql += String(" WHERE `%1` IN (%2)").Arg(column).Arg(
+            String::Join(params, ", "));
+    }
+
+    // Batched loads are padded to a few sizes so they can reuse statements
+    DatabaseQuery query = PrepareCached(sql);
 
     if(!query.IsValid())
     {
@@ -335,13 +377,16 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseMariaDB::LoadObjects(
         return {};
     }
 
-    if(nullptr != pValue && !pValue->Bind(query))
+    for(auto pValue : values)
     {
-        LOG_ERROR(String("Failed to bind value: %1\n").Arg(
-            pValue->GetColumn()));
-        LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+        if(!pValue->Bind(query))
+        {
+            LOG_ERROR(String("Failed to bind value: %1\n").Arg(
+                pValue->GetColumn()));
+            LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
-        return {};
+            return {};
+        }
     }
 
     if(!query.Execute())
@@ -412,7 +457,7 @@ bool DatabaseMariaDB::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
         String::Join(columnNames, ", ")).Arg(
         String::Join(columnBinds, ", "));
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(sql);
 
     if(!query.IsValid())
     {
@@ -457,19 +502,21 @@ bool DatabaseMariaDB::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
 
 bool DatabaseMariaDB::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
 {
-    auto metaObject = obj->GetObjectMetadata();
-
-    std::stringstream objstream;
-    if(!obj->Save(objstream))
+    if(obj->GetUUID().IsNull())
     {
         return false;
     }
 
-    if(obj->GetUUID().IsNull())
+    if(!obj->IsDirty())
     {
-        return false;
+        //Nothing updated, nothing to do
+        return true;
     }
 
+    auto metaObject = obj->GetObjectMetadata();
+
+    // Only the updated columns are bound so the rest of the object is
+    // never serialized
     auto values = obj->GetMemberBindValues();
     if(values.size() == 0)
     {
@@ -488,7 +535,7 @@ bool DatabaseMariaDB::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
         metaObject->GetName()).Arg(
         String::Join(columnNames, ", "));
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(sql);
 
     if(!query.IsValid())
     {
@@ -911,27 +958,8 @@ bool DatabaseMariaDB::ProcessStandardChangeSet(const std::shared_ptr<
         return false;
     }
 
-    bool result = true;
-    for(auto obj : changes->GetInserts())
-    {
-        if(!InsertSingleObject(obj))
-        {
-            result = false;
-            break;
-        }
-    }
-
-    if(result)
-    {
-        for(auto obj : changes->GetUpdates())
-        {
-            if(!UpdateSingleObject(obj))
-            {
-                result = false;
-                break;
-            }
-        }
-    }
+    bool result = WriteObjects(changes->GetInserts(), true) &&
+        WriteObjects(changes->GetUpdates(), false);
 
     auto deletes = changes->GetDeletes();
     if(result && deletes.size())
@@ -984,6 +1012,257 @@ bool DatabaseMariaDB::ProcessStandardChangeSet(const std::shared_ptr<
     return result;
 }
 
+bool DatabaseMariaDB::WriteObjects(const std::list<std::shared_ptr<
+    PersistentObject>>& objs, bool insert)
+{
+    /**
+     * Row of column bindings for one object in a batched statement.
+     */
+    struct BatchRow
+    {
+        /// UUID of the object
+        libobjgen::UUID UUID;
+
+        /// Bindings for each column being written
+        std::list<DatabaseBind*> Values;
+    };
+
+    // Group the rows by table and column set so each group can share
+    // a statement. Ordered so the tables are always written in the same
+    // order.
+    std::map<std::string, std::list<BatchRow>> groups;
+    std::map<std::string, String> groupTables;
+
+    auto freeGroups = [&groups]()
+    {
+        for(auto& pair : groups)
+        {
+            for(auto& row : pair.second)
+            {
+                for(auto value : row.Values)
+                {
+                    delete value;
+                }
+            }
+        }
+    };
+
+    for(auto obj : objs)
+    {
+        // Updates only bind the changed columns so there is no need to
+        // serialize the whole object
+        std::stringstream objstream;
+        if(insert && !obj->Save(objstream))
+        {
+            freeGroups();
+            return false;
+        }
+
+        if(obj->GetUUID().IsNull() && (!insert || !obj->Register(obj)))
+        {
+            freeGroups();
+            return false;
+        }
+
+        if(!insert && !obj->IsDirty())
+        {
+            // Nothing updated, nothing to do
+            continue;
+        }
+
+        BatchRow row;
+        row.UUID = obj->GetUUID();
+        row.Values = obj->GetMemberBindValues(insert);
+        if(!insert && row.Values.size() == 0)
+        {
+            // Nothing updated, nothing to do
+            continue;
+        }
+
+        String table = obj->GetObjectMetadata()->GetName();
+
+        std::stringstream key;
+        key << table.C();
+        for(auto value : row.Values)
+        {
+            key << ":" << value->GetColumn().C();
+        }
+
+        groups[key.str()].push_back(row);
+        groupTables[key.str()] = table;
+    }
+
+    bool result = true;
+    for(auto& pair : groups)
+    {
+        String table = groupTables[pair.first];
+
+        auto it = pair.second.begin();
+        while(result && it != pair.second.end())
+        {
+            std::list<BatchRow> batch;
+            while(it != pair.second.end() && batch.size() < MAX_BATCH_ROWS)
+            {
+                batch.push_back(*it);
+                it++;
+            }
+
+            std::list<String> columnNames;
+            for(auto value : batch.front().Values)
+            {
+                columnNames.push_back(value->GetColumn());
+            }
+
+            // Give every row its own parameter names
+            std::list<std::list<String>> rowBinds;
+            uint32_t rowIdx = 0;
+            for(auto& row : batch)
+            {
+                std::list<String> binds;
+                binds.push_back(String(":UID_%1").Arg(rowIdx));
+
+                for(auto value : row.Values)
+                {
+                    value->SetColumn(String("%1_%2").Arg(
+                        value->GetColumn()).Arg(rowIdx));
+                    binds.push_back(String(":%1").Arg(value->GetColumn()));
+                }
+
+                rowBinds.push_back(binds);
+                rowIdx++;
+            }
+
+            String sql;
+            if(insert)
+            {
+                std::list<String> columns;
+                columns.push_back("`UID`");
+                for(auto& column : columnNames)
+                {
+                    columns.push_back(String("`%1`").Arg(column));
+                }
+
+                std::list<String> rows;
+                for(auto& binds : rowBinds)
+                {
+                    rows.push_back(String("(%1)").Arg(
+                        String::Join(binds, ", ")));
+                }
+
+                sql = String("INSERT INTO `%1` (%2) VALUES %3;").Arg(
+                    table).Arg(String::Join(columns, ", ")).Arg(
+                    String::Join(rows, ", "));
+            }
+            else if(batch.size() == 1)
+            {
+                std::list<String> sets;
+                for(auto& column : columnNames)
+                {
+                    sets.push_back(String("`%1` = :%1_0").Arg(column));
+                }
+
+                sql = String("UPDATE `%1` SET %2 WHERE `UID` = :UID_0;")
+                    .Arg(table).Arg(String::Join(sets, ", "));
+            }
+            else
+            {
+                // Join the table against the rows to update so every row
+                // can be updated with one statement. Only the first row
+                // needs to name the columns.
+                auto& firstBinds = rowBinds.front();
+                auto bindIt = firstBinds.begin();
+
+                std::list<String> named;
+                named.push_back(String("%1 AS `UID`").Arg(*bindIt++));
+
+                std::list<String> sets;
+                for(auto& column : columnNames)
+                {
+                    named.push_back(String("%1 AS `%2`").Arg(*bindIt++)
+                        .Arg(column));
+                    sets.push_back(String("`%1`.`%2` = `batch`.`%2`")
+                        .Arg(table).Arg(column));
+                }
+
+                std::list<String> selects;
+                for(auto& binds : rowBinds)
+                {
+                    selects.push_back(String("SELECT %1").Arg(
+                        selects.empty() ? String::Join(named, ", ")
+                        : String::Join(binds, ", ")));
+                }
+
+                sql = String("UPDATE `%1` JOIN (%2) AS `batch` ON"
+                    " `%1`.`UID` = `batch`.`UID` SET %3;").Arg(table)
+                    .Arg(String::Join(selects, " UNION ALL ")).Arg(
+                    String::Join(sets, ", "));
+            }
+
+            DatabaseQuery query = PrepareCached(sql);
+            if(!query.IsValid())
+            {
+                LOG_ERROR(String("Failed to prepare SQL query: %1\n")
+                    .Arg(sql));
+                LOG_ERROR(String("Database said: %1\n").Arg(
+                    GetLastError()));
+
+                result = false;
+                break;
+            }
+
+            rowIdx = 0;
+            for(auto& row : batch)
+            {
+                if(!query.Bind(String("UID_%1").Arg(rowIdx++), row.UUID))
+                {
+                    LOG_ERROR("Failed to bind value: UID\n");
+                    LOG_ERROR(String("Database said: %1\n").Arg(
+                        GetLastError()));
+
+                    result = false;
+                    break;
+                }
+
+                for(auto value : row.Values)
+                {
+                    if(!value->Bind(query))
+                    {
+                        LOG_ERROR(String("Failed to bind value: %1\n").Arg(
+                            value->GetColumn()));
+                        LOG_ERROR(String("Database said: %1\n").Arg(
+                            GetLastError()));
+
+                        result = false;
+                        break;
+                    }
+                }
+
+                if(!result)
+                {
+                    break;
+                }
+            }
+
+            if(result && !query.Execute())
+            {
+                LOG_ERROR(String("Failed to execute query: %1\n").Arg(sql));
+                LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+
+                result = false;
+            }
+        }
+
+        if(!result)
+        {
+            break;
+        }
+    }
+
+    freeGroups();
+
+    return result;
+}
+
 bool DatabaseMariaDB::ProcessOperationalChangeSet(const std::shared_ptr<
     DBOperationalChangeSet>& changes)
 {
@@ -1277,6 +1556,55 @@ MYSQL*& DatabaseMariaDB::GetConnection(bool autoConnect)
     return mConnections[threadID];
 }
 
+DatabaseQuery DatabaseMariaDB::PrepareCached(const String& query)
+{
+    auto connection = GetConnection(true);
+    if(nullptr == connection)
+    {
+        return Prepare(query);
+    }
+
+    // Resetting a cached statement makes a round trip to the server so a
+    // dropped connection is found here and the statement is prepared
+    // again (reconnecting) instead of failing to execute
+    auto impl = GetStatementCache(connection).Get(query);
+    if(impl)
+    {
+        return DatabaseQuery(impl);
+    }
+
+    impl = std::make_shared<DatabaseQueryMariaDB>(connection,
+        mConfig->GetDatabaseDebug());
+
+    DatabaseQuery q(impl);
+    if(q.Prepare(query))
+    {
+        GetStatementCache(connection).Add(query, impl);
+    }
+
+    return q;
+}
+
+DatabaseStatementCache& DatabaseMariaDB::GetStatementCache(MYSQL* connection)
+{
+    // The server thread ID changes when the connection is re-established
+    // (including an automatic reconnect) so compare it to the ID the
+    // statements were prepared with
+    unsigned long connectionID = mysql_thread_id(connection);
+
+    std::lock_guard<std::mutex> lock(mConnectionLock);
+    auto& cache = mStatementCaches[std::this_thread::get_id()];
+    if(cache.ConnectionID != connectionID)
+    {
+        cache.Statements.Clear();
+        cache.ConnectionID = connectionID;
+    }
+
+    cache.Statements.SetCapacity(mStatementCacheCapacity);
+
+    return cache.Statements;
+}
+
 String DatabaseMariaDB::GetVariableType(const std::shared_ptr
     <libobjgen::MetaVariable> var)
 {
@@ -30,6 +30,7 @@
  // libcomp Includes
 #include "Database.h"
 #include "DatabaseConfigMariaDB.h"
+#include "DatabaseStatementCache.h"
 
 // libobjgen Includes
 #include <MetaVariable.h>
@@ -95,6 +96,9 @@ public:
 
     virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
         size_t typeHash, DatabaseBind *pValue);
+    virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
+        size_t typeHash, const String& column,
+        const std::list<DatabaseBind*>& values);
 
     virtual bool InsertSingleObject(std::shared_ptr<PersistentObject>& obj);
     virtual bool UpdateSingleObject(std::shared_ptr<PersistentObject>& obj);
@@ -135,6 +139,17 @@ protected:
         DBOperationalChangeSet>& changes);
 
 private:
+    /**
+     * Insert or update many objects using as few statements as possible.
+     * Objects are grouped by table (and by changed columns for updates)
+     * and each group is written with multi-row statements.
+     * @param objs List of objects to write
+     * @param insert true to insert the objects, false to update them
+     * @return true on success, false on failure
+     */
+    bool WriteObjects(const std::list<std::shared_ptr<
+        PersistentObject>>& objs, bool insert);
+
     /**
      * Process and explicit update to a single record, checking each column's
      * state before and verifying it set to the expected value afterwards.
@@ -160,6 +175,22 @@ private:
      */
     MYSQL*& GetConnection(bool autoConnect);
 
+    /**
+     * Prepare a query using the statement cache for the executing
+     * thread's connection so the statement is only prepared once.
+     * @param query Query text to prepare
+     * @return Database query, which may have failed to prepare
+     */
+    DatabaseQuery PrepareCached(const String& query);
+
+    /**
+     * Get the statement cache for the executing thread's connection,
+     * clearing it first if the connection has been re-established.
+     * @param connection Executing thread's connection
+     * @return Statement cache for the executing thread
+     */
+    DatabaseStatementCache& GetStatementCache(MYSQL* connection);
+
     /**
      * Get the MariaDB type represented by a MetaVariable type.
      * @param var Metadata variable containing a type to conver to a MariaDB type
@@ -175,6 +206,24 @@ private:
     /// throughout the class as they are not removed or modified until the database
     /// is closed.
     std::unordered_map<std::thread::id, MYSQL*> mConnections;
+
+    /**
+     * Prepared statements for one thread's connection.
+     */
+    struct StatementCache
+    {
+        /// Server thread ID of the connection the statements were
+        /// prepared on. A different ID means the connection has been
+        /// re-established and the statements are no longer valid.
+        unsigned long ConnectionID = 0;
+
+        /// Statements prepared on the connection
+        DatabaseStatementCache Statements;
+    };
+
+    /// Prepared statements per thread. The map is locked by
+    /// mConnectionLock and each cache is only used by its own thread.
+    std::unordered_map<std::thread::id, StatementCache> mStatementCaches;
 };
 
 } // namespace libcomp
@@ -77,15 +77,19 @@ DatabaseQuery::DatabaseQuery(DatabaseQueryImpl *pImpl, const String& query) :
     Prepare(query);
 }
 
-DatabaseQuery::DatabaseQuery(DatabaseQuery&& other) : mImpl(other.mImpl)
+DatabaseQuery::DatabaseQuery(const std::shared_ptr<DatabaseQueryImpl>& impl) :
+    mImpl(impl)
+{
+}
+
+DatabaseQuery::DatabaseQuery(DatabaseQuery&& other) :
+    mImpl(std::move(other.mImpl))
 {
-    other.mImpl = nullptr;
 }
 
 DatabaseQuery::~DatabaseQuery()
 {
-    delete mImpl;
-    mImpl = nullptr;
+    mImpl.reset();
 }
 
 bool DatabaseQuery::Prepare(const String& query)
@@ -573,10 +577,7 @@ int64_t DatabaseQuery::AffectedRowCount() const
 
 DatabaseQuery& DatabaseQuery::operator=(DatabaseQuery&& other)
 {
-    delete mImpl;
-
-    mImpl = other.mImpl;
-    other.mImpl = nullptr;
+    mImpl = std::move(other.mImpl);
 
     return *this;
 }
@@ -34,6 +34,7 @@
 #include "CString.h"
 
 // Standard C++11 Includes
+#include <memory>
 #include <unordered_map>
 
 namespace libcomp
@@ -78,6 +79,14 @@ public:
      */
     virtual bool Next() = 0;
 
+    /**
+     * Reset a previously prepared query so it can be bound and executed
+     * again without being prepared again. Any bound values and the
+     * current result set are cleared.
+     * @return true on success, false on failure
+     */
+    virtual bool Reset() = 0;
+
     /**
      * Bind a string column value by its index.
      * @param index The column's index
@@ -404,6 +413,13 @@ public:
      */
     DatabaseQuery(DatabaseQueryImpl *pImpl, const String& query);
 
+    /**
+     * Create a database query sharing an implementation that has already
+     * been prepared, such as one held in a statement cache.
+     * @param impl Database specific implementation
+     */
+    DatabaseQuery(const std::shared_ptr<DatabaseQueryImpl>& impl);
+
     /**
      * Disable the default copy constructor.
      * @param other The other query to copy
@@ -750,7 +766,7 @@ public:
 
 protected:
     /// Database specific implementation
-    DatabaseQueryImpl *mImpl;
+    std::shared_ptr<DatabaseQueryImpl> mImpl;
 };
 
 } // namespace libcomp
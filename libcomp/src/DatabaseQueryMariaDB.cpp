@@ -84,17 +84,26 @@ bool DatabaseQueryMariaDB::Prepare(const String& query)
     // the query to prepare will need to have named parameters that
     // we will replace here in case the query needs access to the
     // named parameter binding functionality
-    std::string transformed(query.C());
+    std::string source(query.C());
     std::regex namedParam(":(?:[a-zA-Z0-9_]+)");
 
+    // Replace the parameters in a single pass so batched statements with
+    // many parameters do not rescan the query for each one
+    std::string transformed;
+    transformed.reserve(source.size());
+
     mParamNames.clear();
-    std::smatch match;
-    while(std::regex_search(transformed, match, namedParam))
+    auto last = source.cbegin();
+    for(std::sregex_iterator it(source.begin(), source.end(), namedParam),
+        end; it != end; it++)
     {
+        auto& match = *it;
+        transformed.append(last, match[0].first);
+        transformed.append("?");
         mParamNames.push_back(match.str().substr(1));
-        transformed = std::regex_replace(transformed,
-            namedParam, "?", std::regex_constants::format_first_only);
+        last = match[0].second;
     }
+    transformed.append(last, source.cend());
 
     mStatement = mysql_stmt_init(mDatabase);
 
@@ -324,6 +333,44 @@ bool DatabaseQueryMariaDB::Next()
     return MYSQL_NO_DATA != mStatus && IsValid();
 }
 
+bool DatabaseQueryMariaDB::Reset()
+{
+    if(nullptr == mStatement)
+    {
+        return false;
+    }
+
+    mysql_stmt_free_result(mStatement);
+    mStatus = mysql_stmt_reset(mStatement) ? -1 : 0;
+
+    if(mStatus && mDatabaseDebug)
+    {
+        LOG_DEBUG(libcomp::String(
+            "mysql_stmt_reset of statement %1 failed for connection %2\n"
+            ).Arg(ConnectionString(mStatement)
+            ).Arg(ConnectionString(mDatabase)));
+        LOG_DEBUG(libcomp::String("Last SQL error: %1\n").Arg(
+            GetLastError(mDatabase)));
+    }
+
+    // The bindings point into the buffers so clear them all together
+    mBindings.clear();
+    mResultBindings.clear();
+    mResultColumnNames.clear();
+    mResultColumnTypes.clear();
+    mBufferInt.clear();
+    mBufferBigInt.clear();
+    mBufferFloat.clear();
+    mBufferDouble.clear();
+    mBufferBlob.clear();
+    mBufferBool.clear();
+    mBufferNulls.clear();
+    mBufferLengths.clear();
+    mAffectedRowCount = 0;
+
+    return IsValid();
+}
+
 bool DatabaseQueryMariaDB::Bind(size_t index, const String& value)
 {
     auto bind = PrepareBinding(index, MYSQL_TYPE_STRING);
@@ -66,6 +66,7 @@ public:
     virtual bool Prepare(const String& query);
     virtual bool Execute();
     virtual bool Next();
+    virtual bool Reset();
 
     virtual bool Bind(size_t index, const String& value);
     virtual bool Bind(const String& name, const String& value);
@@ -0,0 +1,481 @@
+/**
+ * @file libcomp/src/DatabaseQueryRow.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief In memory row of named database values.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseQueryRow.h"
+
+// Standard C++11 Includes
+#include <cstring>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Column types stored in the first byte of an encoded column.
+enum ColumnType_t : uint8_t
+{
+    COLUMN_TEXT = 0,
+    COLUMN_BLOB,
+    COLUMN_UUID,
+    COLUMN_INT,
+    COLUMN_BIGINT,
+    COLUMN_FLOAT,
+    COLUMN_DOUBLE,
+    COLUMN_BOOL,
+};
+
+} // namespace
+
+DatabaseQueryRow::DatabaseQueryRow()
+{
+}
+
+DatabaseQueryRow::~DatabaseQueryRow()
+{
+}
+
+bool DatabaseQueryRow::Prepare(const String& query)
+{
+    (void)query;
+
+    return true;
+}
+
+bool DatabaseQueryRow::Execute()
+{
+    return true;
+}
+
+bool DatabaseQueryRow::Next()
+{
+    // There is only ever the one row
+    return false;
+}
+
+bool DatabaseQueryRow::Reset()
+{
+    mColumns.clear();
+
+    return true;
+}
+
+bool DatabaseQueryRow::Bind(size_t index, const String& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::Bind(const String& name, const String& value)
+{
+    return SetValue(name, COLUMN_TEXT, value.C(), value.Size());
+}
+
+bool DatabaseQueryRow::Bind(size_t index, const std::vector<char>& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::Bind(const String& name,
+    const std::vector<char>& value)
+{
+    return SetValue(name, COLUMN_BLOB, value.data(), value.size());
+}
+
+bool DatabaseQueryRow::Bind(size_t index, const libobjgen::UUID& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::Bind(const String& name,
+    const libobjgen::UUID& value)
+{
+    std::string uuid = value.ToString();
+
+    return SetValue(name, COLUMN_UUID, uuid.c_str(), uuid.size());
+}
+
+bool DatabaseQueryRow::Bind(size_t index, int32_t value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::Bind(const String& name, int32_t value)
+{
+    return SetValue(name, COLUMN_INT, &value, sizeof(value));
+}
+
+bool DatabaseQueryRow::Bind(size_t index, int64_t value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::Bind(const String& name, int64_t value)
+{
+    return SetValue(name, COLUMN_BIGINT, &value, sizeof(value));
+}
+
+bool DatabaseQueryRow::Bind(size_t index, float value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::Bind(const String& name, float value)
+{
+    return SetValue(name, COLUMN_FLOAT, &value, sizeof(value));
+}
+
+bool DatabaseQueryRow::Bind(size_t index, double value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::Bind(const String& name, double value)
+{
+    return SetValue(name, COLUMN_DOUBLE, &value, sizeof(value));
+}
+
+bool DatabaseQueryRow::Bind(size_t index, bool value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::Bind(const String& name, bool value)
+{
+    uint8_t data = value ? 1 : 0;
+
+    return SetValue(name, COLUMN_BOOL, &data, sizeof(data));
+}
+
+bool DatabaseQueryRow::GetValue(size_t index, String& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::GetValue(const String& name, String& value)
+{
+    uint8_t type;
+    const char *pData;
+    size_t size;
+
+    if(!GetRaw(name, type, pData, size) ||
+        (COLUMN_TEXT != type && COLUMN_UUID != type))
+    {
+        return false;
+    }
+
+    value = String(std::string(pData, size));
+
+    return true;
+}
+
+bool DatabaseQueryRow::GetValue(size_t index, std::vector<char>& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::GetValue(const String& name,
+    std::vector<char>& value)
+{
+    uint8_t type;
+    const char *pData;
+    size_t size;
+
+    if(!GetRaw(name, type, pData, size) ||
+        (COLUMN_BLOB != type && COLUMN_TEXT != type))
+    {
+        return false;
+    }
+
+    value.assign(pData, pData + size);
+
+    return true;
+}
+
+bool DatabaseQueryRow::GetValue(size_t index, libobjgen::UUID& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::GetValue(const String& name, libobjgen::UUID& value)
+{
+    uint8_t type;
+    const char *pData;
+    size_t size;
+
+    if(!GetRaw(name, type, pData, size) ||
+        (COLUMN_UUID != type && COLUMN_TEXT != type))
+    {
+        return false;
+    }
+
+    value = libobjgen::UUID(std::string(pData, size));
+
+    return true;
+}
+
+bool DatabaseQueryRow::GetValue(size_t index, int32_t& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::GetValue(const String& name, int32_t& value)
+{
+    int64_t intValue;
+    double floatValue;
+
+    if(!GetNumber(name, intValue, floatValue))
+    {
+        return false;
+    }
+
+    value = (int32_t)intValue;
+
+    return true;
+}
+
+bool DatabaseQueryRow::GetValue(size_t index, int64_t& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::GetValue(const String& name, int64_t& value)
+{
+    double floatValue;
+
+    return GetNumber(name, value, floatValue);
+}
+
+bool DatabaseQueryRow::GetValue(size_t index, float& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::GetValue(const String& name, float& value)
+{
+    int64_t intValue;
+    double floatValue;
+
+    if(!GetNumber(name, intValue, floatValue))
+    {
+        return false;
+    }
+
+    value = (float)floatValue;
+
+    return true;
+}
+
+bool DatabaseQueryRow::GetValue(size_t index, double& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::GetValue(const String& name, double& value)
+{
+    int64_t intValue;
+
+    return GetNumber(name, intValue, value);
+}
+
+bool DatabaseQueryRow::GetValue(size_t index, bool& value)
+{
+    (void)index;
+    (void)value;
+
+    return false;
+}
+
+bool DatabaseQueryRow::GetValue(const String& name, bool& value)
+{
+    int64_t intValue;
+    double floatValue;
+
+    if(!GetNumber(name, intValue, floatValue))
+    {
+        return false;
+    }
+
+    value = 0 != intValue;
+
+    return true;
+}
+
+bool DatabaseQueryRow::IsValid() const
+{
+    return true;
+}
+
+const std::unordered_map<std::string, std::vector<char>>&
+    DatabaseQueryRow::GetColumns() const
+{
+    return mColumns;
+}
+
+void DatabaseQueryRow::SetColumn(const std::string& name,
+    const std::vector<char>& data)
+{
+    mColumns[name] = data;
+}
+
+bool DatabaseQueryRow::SetValue(const String& name, uint8_t type,
+    const void *pData, size_t size)
+{
+    auto& column = mColumns[name.ToUtf8()];
+    column.resize(size + 1);
+    column[0] = (char)type;
+
+    if(0 < size)
+    {
+        memcpy(&column[1], pData, size);
+    }
+
+    return true;
+}
+
+bool DatabaseQueryRow::GetRaw(const String& name, uint8_t& type,
+    const char*& pData, size_t& size) const
+{
+    auto it = mColumns.find(name.ToUtf8());
+    if(it == mColumns.end() || it->second.empty())
+    {
+        return false;
+    }
+
+    type = (uint8_t)it->second[0];
+    pData = it->second.data() + 1;
+    size = it->second.size() - 1;
+
+    return true;
+}
+
+bool DatabaseQueryRow::GetNumber(const String& name, int64_t& intValue,
+    double& floatValue) const
+{
+    uint8_t type;
+    const char *pData;
+    size_t size;
+
+    if(!GetRaw(name, type, pData, size))
+    {
+        return false;
+    }
+
+    switch(type)
+    {
+        case COLUMN_INT:
+            if(sizeof(int32_t) == size)
+            {
+                int32_t value;
+                memcpy(&value, pData, size);
+                intValue = value;
+                floatValue = (double)value;
+                return true;
+            }
+            break;
+        case COLUMN_BIGINT:
+            if(sizeof(int64_t) == size)
+            {
+                memcpy(&intValue, pData, size);
+                floatValue = (double)intValue;
+                return true;
+            }
+            break;
+        case COLUMN_FLOAT:
+            if(sizeof(float) == size)
+            {
+                float value;
+                memcpy(&value, pData, size);
+                intValue = (int64_t)value;
+                floatValue = value;
+                return true;
+            }
+            break;
+        case COLUMN_DOUBLE:
+            if(sizeof(double) == size)
+            {
+                memcpy(&floatValue, pData, size);
+                intValue = (int64_t)floatValue;
+                return true;
+            }
+            break;
+        case COLUMN_BOOL:
+            if(sizeof(uint8_t) == size)
+            {
+                intValue = 0 != pData[0] ? 1 : 0;
+                floatValue = (double)intValue;
+                return true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return false;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file libcomp/src/DatabaseQueryRow.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief In memory row of named database values.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_DATABASEQUERYROW_H
+#define LIBCOMP_SRC_DATABASEQUERYROW_H
+
+// libcomp Includes
+#include "DatabaseQuery.h"
+
+namespace libcomp
+{
+
+/**
+ * Query implementation that holds a single row of named values in memory
+ * instead of talking to a database. Values bound by name become the row
+ * read back by name so the bind values of a @ref PersistentObject can be
+ * captured, sent to another server and loaded into an object there with
+ * @ref PersistentObject::LoadDatabaseValues without a database query.
+ * Each column is stored encoded with its type so columns can be compared
+ * and copied as raw bytes. Only named bindings are supported.
+ */
+class DatabaseQueryRow : public DatabaseQueryImpl
+{
+public:
+    /**
+     * Create an empty row.
+     */
+    DatabaseQueryRow();
+
+    /**
+     * Clean up the row.
+     */
+    virtual ~DatabaseQueryRow();
+
+    virtual bool Prepare(const String& query);
+    virtual bool Execute();
+    virtual bool Next();
+    virtual bool Reset();
+
+    virtual bool Bind(size_t index, const String& value);
+    virtual bool Bind(const String& name, const String& value);
+    virtual bool Bind(size_t index, const std::vector<char>& value);
+    virtual bool Bind(const String& name, const std::vector<char>& value);
+    virtual bool Bind(size_t index, const libobjgen::UUID& value);
+    virtual bool Bind(const String& name, const libobjgen::UUID& value);
+    virtual bool Bind(size_t index, int32_t value);
+    virtual bool Bind(const String& name, int32_t value);
+    virtual bool Bind(size_t index, int64_t value);
+    virtual bool Bind(const String& name, int64_t value);
+    virtual bool Bind(size_t index, float value);
+    virtual bool Bind(const String& name, float value);
+    virtual bool Bind(size_t index, double value);
+    virtual bool Bind(const String& name, double value);
+    virtual bool Bind(size_t index, bool value);
+    virtual bool Bind(const String& name, bool value);
+
+    virtual bool GetValue(size_t index, String& value);
+    virtual bool GetValue(const String& name, String& value);
+    virtual bool GetValue(size_t index, std::vector<char>& value);
+    virtual bool GetValue(const String& name, std::vector<char>& value);
+    virtual bool GetValue(size_t index, libobjgen::UUID& value);
+    virtual bool GetValue(const String& name, libobjgen::UUID& value);
+    virtual bool GetValue(size_t index, int32_t& value);
+    virtual bool GetValue(const String& name, int32_t& value);
+    virtual bool GetValue(size_t index, int64_t& value);
+    virtual bool GetValue(const String& name, int64_t& value);
+    virtual bool GetValue(size_t index, float& value);
+    virtual bool GetValue(const String& name, float& value);
+    virtual bool GetValue(size_t index, double& value);
+    virtual bool GetValue(const String& name, double& value);
+    virtual bool GetValue(size_t index, bool& value);
+    virtual bool GetValue(const String& name, bool& value);
+
+    virtual bool IsValid() const;
+
+    /**
+     * Get the encoded columns in the row.
+     * @return Map of encoded column values by column name
+     */
+    const std::unordered_map<std::string, std::vector<char>>&
+        GetColumns() const;
+
+    /**
+     * Set an encoded column value copied from another row.
+     * @param name Name of the column
+     * @param data Encoded column value
+     */
+    void SetColumn(const std::string& name, const std::vector<char>& data);
+
+private:
+    /**
+     * Store a column value encoded with its type.
+     * @param name Name of the column
+     * @param type Type of the value
+     * @param pData Pointer to the value bytes
+     * @param size Number of value bytes
+     * @return true on success, false on failure
+     */
+    bool SetValue(const String& name, uint8_t type, const void *pData,
+        size_t size);
+
+    /**
+     * Get the type and bytes of a column value.
+     * @param name Name of the column
+     * @param type Output parameter set to the type of the value
+     * @param pData Output parameter set to the value bytes
+     * @param size Output parameter set to the number of value bytes
+     * @return true if the column exists, false if it does not
+     */
+    bool GetRaw(const String& name, uint8_t& type, const char*& pData,
+        size_t& size) const;
+
+    /**
+     * Get a numeric column value converting between numeric types.
+     * @param name Name of the column
+     * @param intValue Output parameter set to the value as an integer
+     * @param floatValue Output parameter set to the value as a double
+     * @return true if the column exists and is numeric, false otherwise
+     */
+    bool GetNumber(const String& name, int64_t& intValue,
+        double& floatValue) const;
+
+    /// Encoded column values by column name
+    std::unordered_map<std::string, std::vector<char>> mColumns;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_DATABASEQUERYROW_H
@@ -113,6 +113,26 @@ bool DatabaseQuerySQLite3::Next()
     return IsValid() && SQLITE_DONE != mStatus;
 }
 
+bool DatabaseQuerySQLite3::Reset()
+{
+    if(nullptr == mStatement)
+    {
+        return false;
+    }
+
+    // The return value of sqlite3_reset is the status of the last step
+    // which has already been reported by Execute or Next
+    (void)sqlite3_reset(mStatement);
+
+    mStatus = sqlite3_clear_bindings(mStatement);
+    mDidJustExecute = false;
+    mResultColumnNames.clear();
+    mResultColumnTypes.clear();
+    mAffectedRowCount = 0;
+
+    return IsValid();
+}
+
 bool DatabaseQuerySQLite3::Bind(size_t index, const String& value)
 {
     int idx = (int)index;
@@ -47,6 +47,9 @@ DatabaseSQLite3::DatabaseSQLite3(const std::shared_ptr<
 
 DatabaseSQLite3::~DatabaseSQLite3()
 {
+    // The write-behind thread calls back into this class
+    StopWriteBehind();
+
     Close();
 }
 
@@ -56,6 +59,12 @@ bool DatabaseSQLite3::Open()
 
     bool result = true;
 
+    {
+        // Statements from a previous connection are no longer valid
+        std::lock_guard<std::mutex> lock(mStatementCacheLock);
+        mStatementCache.Clear();
+    }
+
     if(SQLITE_OK != sqlite3_open(filepath.C(), &mDatabase))
     {
         result = false;
@@ -73,6 +82,12 @@ bool DatabaseSQLite3::Close()
 {
     bool result = true;
 
+    {
+        // The connection will not close with statements left unfinalized
+        std::lock_guard<std::mutex> lock(mStatementCacheLock);
+        mStatementCache.Clear();
+    }
+
     if(nullptr != mDatabase)
     {
         if(SQLITE_OK != sqlite3_close(mDatabase))
@@ -283,6 +298,21 @@ bool DatabaseSQLite3::TableHasRows(const String& table)
 
 std::list<std::shared_ptr<PersistentObject>> DatabaseSQLite3::LoadObjects(
     size_t typeHash, DatabaseBind *pValue)
+{
+    std::list<DatabaseBind*> values;
+
+    if(nullptr != pValue)
+    {
+        values.push_back(pValue);
+    }
+
+    return LoadObjects(typeHash, nullptr != pValue ? pValue->GetColumn()
+        : String(), values);
+}
+
+std::list<std::shared_ptr<PersistentObject>> DatabaseSQLite3::LoadObjects(
+    size_t typeHash, const String& column,
+    const std::list<DatabaseBind*>& values)
 {
     std::list<std::shared_ptr<PersistentObject>> objects;
 
@@ -295,13 +325,26 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseSQLite3::LoadObjects(
         return {};
     }
 
-    String sql = String("SELECT * FROM %1%2").Arg(
-        metaObject->GetName()).Arg(
-        (nullptr != pValue
-            ? String(" WHERE %1 = :%1").Arg(pValue->GetColumn())
-            : ""));
+    String sql = String("SELECT * FROM %1").Arg(metaObject->GetName());
 
-    DatabaseQuery query = Prepare(sql);
+    if(1 == values.size() && values.front()->GetColumn() == column)
+    {
+        sql += String(" WHERE %1 = :%1").Arg(column);
+    }
+    else if(!values.empty())
+    {
+        std::list<String> params;
+        for(auto pValue : values)
+        {
+            params.push_back(String(":%1").Arg(pValue->GetColumn()));
+        }
+
+        sql += String(" WHERE %1 IN (%2)").Arg(column).Arg(
+            String::Join(params, ", "));
+    }
+
+    // Batched loads are padded to a few sizes so they can reuse statements
+    DatabaseQuery query = PrepareCached(sql);
 
     if(!query.IsValid())
     {
@@ -311,13 +354,16 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseSQLite3::LoadObjects(
         return {};
     }
 
-    if(nullptr != pValue && !pValue->Bind(query))
+    for(auto pValue : values)
     {
-        LOG_ERROR(String("Failed to bind value: %1\n").Arg(
-            pValue->GetColumn()));
-        LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+        if(!pValue->Bind(query))
+        {
+            LOG_ERROR(String("Failed to bind value: %1\n").Arg(
+                pValue->GetColumn()));
+            LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
-        return {};
+            return {};
+        }
     }
 
     if(!query.Execute())
@@ -388,7 +434,7 @@ bool DatabaseSQLite3::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
         String::Join(columnNames, ", ")).Arg(
         String::Join(columnBinds, ", "));
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(sql);
 
     if(!query.IsValid())
     {
@@ -433,19 +479,21 @@ bool DatabaseSQLite3::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
 
 bool DatabaseSQLite3::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
 {
-    auto metaObject = obj->GetObjectMetadata();
-
-    std::stringstream objstream;
-    if(!obj->Save(objstream))
+    if(obj->GetUUID().IsNull())
     {
         return false;
     }
 
-    if(obj->GetUUID().IsNull())
+    if(!obj->IsDirty())
     {
-        return false;
+        //Nothing updated, nothing to do
+        return true;
     }
 
+    auto metaObject = obj->GetObjectMetadata();
+
+    // Only the updated columns are bound so the rest of the object is
+    // never serialized
     auto values = obj->GetMemberBindValues();
     if(values.size() == 0)
     {
@@ -464,7 +512,7 @@ bool DatabaseSQLite3::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
         metaObject->GetName()).Arg(
         String::Join(columnNames, ", "));
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(sql);
 
     if(!query.IsValid())
     {
@@ -1091,6 +1139,35 @@ String DatabaseSQLite3::GetFilepath() const
         .Arg(directory.Right(1) == "/" ? "" : "/").Arg(filename);
 }
 
+DatabaseQuery DatabaseSQLite3::PrepareCached(const String& query)
+{
+    std::shared_ptr<DatabaseQueryImpl> impl;
+    {
+        std::lock_guard<std::mutex> lock(mStatementCacheLock);
+        mStatementCache.SetCapacity(mStatementCacheCapacity);
+
+        impl = mStatementCache.Get(query);
+    }
+
+    if(impl)
+    {
+        return DatabaseQuery(impl);
+    }
+
+    auto config = std::dynamic_pointer_cast<objects::DatabaseConfigSQLite3>(mConfig);
+    impl = std::make_shared<DatabaseQuerySQLite3>(mDatabase,
+        config->GetMaxRetryCount(), config->GetRetryDelay());
+
+    DatabaseQuery q(impl);
+    if(q.Prepare(query))
+    {
+        std::lock_guard<std::mutex> lock(mStatementCacheLock);
+        mStatementCache.Add(query, impl);
+    }
+
+    return q;
+}
+
 String DatabaseSQLite3::GetVariableType(const std::shared_ptr
     <libobjgen::MetaVariable> var)
 {
@@ -30,10 +30,14 @@
  // libcomp Includes
 #include "Database.h"
 #include "DatabaseConfigSQLite3.h"
+#include "DatabaseStatementCache.h"
 
 // libobjgen Includes
 #include <MetaVariable.h>
 
+// Standard C++11 Includes
+#include <mutex>
+
 typedef struct sqlite3 sqlite3;
 
 namespace libcomp
@@ -92,6 +96,9 @@ public:
 
     virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
         size_t typeHash, DatabaseBind *pValue);
+    virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
+        size_t typeHash, const String& column,
+        const std::list<DatabaseBind*>& values);
 
     virtual bool InsertSingleObject(std::shared_ptr<PersistentObject>& obj);
     virtual bool UpdateSingleObject(std::shared_ptr<PersistentObject>& obj);
@@ -134,6 +141,14 @@ private:
      */
     String GetFilepath() const;
 
+    /**
+     * Prepare a query using the statement cache for the connection so
+     * the statement is only prepared once.
+     * @param query Query text to prepare
+     * @return Database query, which may have failed to prepare
+     */
+    DatabaseQuery PrepareCached(const String& query);
+
     /**
      * Get the SQLite3 type represented by a MetaVariable type.
      * @param var Metadata variable containing a type to conver to a SQLite3 type
@@ -143,6 +158,13 @@ private:
 
     /// Pointer to the SQLite3 representation of the database file connection
     sqlite3 *mDatabase;
+
+    /// Mutex to lock access to the statement cache
+    std::mutex mStatementCacheLock;
+
+    /// Statements prepared on the connection. These must be finalized
+    /// before the connection can be closed.
+    DatabaseStatementCache mStatementCache;
 };
 
 } // namespace libcomp
@@ -0,0 +1,168 @@
+/**
+ * @file libcomp/src/DatabaseStatementCache.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Cache of prepared statements for a database connection.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseStatementCache.h"
+
+// Standard C++11 Includes
+#include <atomic>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Number of statements reused from a cache.
+std::atomic<uint64_t> gHits(0);
+
+/// Number of statements that had to be prepared.
+std::atomic<uint64_t> gMisses(0);
+
+/// Number of statements removed to make room for another.
+std::atomic<uint64_t> gEvictions(0);
+
+} // namespace
+
+DatabaseStatementCache::DatabaseStatementCache(size_t capacity) :
+    mCapacity(capacity)
+{
+}
+
+std::shared_ptr<DatabaseQueryImpl> DatabaseStatementCache::Get(
+    const String& query)
+{
+    auto it = mLookup.find(query.ToUtf8());
+    if(it == mLookup.end())
+    {
+        gMisses++;
+
+        return nullptr;
+    }
+
+    auto entry = it->second;
+    auto impl = entry->second;
+
+    // A statement can only be used by one query at a time so if it is
+    // still held elsewhere a new statement has to be prepared instead
+    if(impl.use_count() > 2)
+    {
+        gMisses++;
+
+        return nullptr;
+    }
+
+    if(!impl->Reset())
+    {
+        mEntries.erase(entry);
+        mLookup.erase(it);
+
+        gMisses++;
+
+        return nullptr;
+    }
+
+    mEntries.splice(mEntries.begin(), mEntries, entry);
+
+    gHits++;
+
+    return impl;
+}
+
+void DatabaseStatementCache::Add(const String& query,
+    const std::shared_ptr<DatabaseQueryImpl>& impl)
+{
+    if(0 == mCapacity || !impl)
+    {
+        return;
+    }
+
+    std::string key = query.ToUtf8();
+
+    auto it = mLookup.find(key);
+    if(it != mLookup.end())
+    {
+        // Keep the statement already cached
+        return;
+    }
+
+    mEntries.push_front(Entry_t(key, impl));
+    mLookup[key] = mEntries.begin();
+
+    Trim();
+}
+
+void DatabaseStatementCache::Clear()
+{
+    mLookup.clear();
+    mEntries.clear();
+}
+
+size_t DatabaseStatementCache::Size() const
+{
+    return mEntries.size();
+}
+
+size_t DatabaseStatementCache::GetCapacity() const
+{
+    return mCapacity;
+}
+
+void DatabaseStatementCache::SetCapacity(size_t capacity)
+{
+    mCapacity = capacity;
+
+    Trim();
+}
+
+DatabaseStatementCache::Stats DatabaseStatementCache::GetStats()
+{
+    Stats stats;
+    stats.Hits = gHits;
+    stats.Misses = gMisses;
+    stats.Evictions = gEvictions;
+
+    return stats;
+}
+
+DatabaseStatementCache::Stats DatabaseStatementCache::ResetStats()
+{
+    Stats stats;
+    stats.Hits = gHits.exchange(0);
+    stats.Misses = gMisses.exchange(0);
+    stats.Evictions = gEvictions.exchange(0);
+
+    return stats;
+}
+
+void DatabaseStatementCache::Trim()
+{
+    while(mEntries.size() > mCapacity)
+    {
+        mLookup.erase(mEntries.back().first);
+        mEntries.pop_back();
+
+        gEvictions++;
+    }
+}
@@ -0,0 +1,161 @@
+/**
+ * @file libcomp/src/DatabaseStatementCache.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Cache of prepared statements for a database connection.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_DATABASESTATEMENTCACHE_H
+#define LIBCOMP_SRC_DATABASESTATEMENTCACHE_H
+
+// libcomp Includes
+#include "DatabaseQuery.h"
+
+// Standard C++11 Includes
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace libcomp
+{
+
+/**
+ * Least recently used cache of prepared statements belonging to a single
+ * database connection. The statements written when saving objects are
+ * built from the table name and the set of columns being written so the
+ * same few statements are prepared over and over again. Keeping them
+ * prepared lets the database skip parsing and planning them each time.
+ * The cache is not thread safe and must only be used by the thread that
+ * owns the connection (or while holding a lock for the connection).
+ * The cache must be cleared before the connection it belongs to is
+ * closed or reconnected.
+ */
+class DatabaseStatementCache
+{
+public:
+    /// Default number of statements kept for each connection.
+    static const size_t DEFAULT_CAPACITY = 128;
+
+    /**
+     * Snapshot of the counters for all statement caches.
+     */
+    struct Stats
+    {
+        /// Number of statements reused from a cache.
+        uint64_t Hits;
+
+        /// Number of statements that had to be prepared.
+        uint64_t Misses;
+
+        /// Number of statements removed to make room for another.
+        uint64_t Evictions;
+    };
+
+    /**
+     * Create an empty statement cache.
+     * @param capacity Maximum number of statements to keep. A capacity
+     *  of zero disables the cache.
+     */
+    explicit DatabaseStatementCache(size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * Get a cached statement for the supplied query text and reset it so
+     * it is ready to be bound again.
+     * @param query Query text the statement was prepared from
+     * @returns Statement to use or null if the statement is not cached or
+     *  is still being used by another @ref DatabaseQuery
+     */
+    std::shared_ptr<DatabaseQueryImpl> Get(const String& query);
+
+    /**
+     * Add a statement that has been successfully prepared to the cache,
+     * removing the least recently used statement if the cache is full.
+     * @param query Query text the statement was prepared from
+     * @param impl Prepared statement to cache
+     */
+    void Add(const String& query,
+        const std::shared_ptr<DatabaseQueryImpl>& impl);
+
+    /**
+     * Remove all statements from the cache.
+     */
+    void Clear();
+
+    /**
+     * Get the number of statements in the cache.
+     * @returns Number of statements in the cache
+     */
+    size_t Size() const;
+
+    /**
+     * Get the maximum number of statements kept by the cache.
+     * @returns Maximum number of statements kept by the cache
+     */
+    size_t GetCapacity() const;
+
+    /**
+     * Set the maximum number of statements kept by the cache, removing
+     * the least recently used statements that no longer fit.
+     * @param capacity Maximum number of statements to keep. A capacity
+     *  of zero disables the cache.
+     */
+    void SetCapacity(size_t capacity);
+
+    /**
+     * Get the current counters for all statement caches.
+     * @returns Snapshot of the counters.
+     */
+    static Stats GetStats();
+
+    /**
+     * Get the current counters for all statement caches and reset them
+     * to zero.
+     * @returns Snapshot of the counters before they were reset.
+     */
+    static Stats ResetStats();
+
+private:
+    /**
+     * Remove the least recently used statements until the cache fits in
+     * the capacity.
+     */
+    void Trim();
+
+    /// Cached statement and the query text it was prepared from.
+    typedef std::pair<std::string,
+        std::shared_ptr<DatabaseQueryImpl>> Entry_t;
+
+    /// Maximum number of statements to keep.
+    size_t mCapacity;
+
+    /// Cached statements ordered from most to least recently used.
+    std::list<Entry_t> mEntries;
+
+    /// Position of each cached statement in mEntries by query text.
+    std::unordered_map<std::string,
+        std::list<Entry_t>::iterator> mLookup;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_DATABASESTATEMENTCACHE_H
@@ -0,0 +1,161 @@
+/**
+ * @file libcomp/src/DefinitionLookup.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Read only lookup table of definitions by ID.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_DEFINITIONLOOKUP_H
+#define LIBCOMP_SRC_DEFINITIONLOOKUP_H
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libcomp
+{
+
+/**
+ * Read only lookup table of definitions by ID built once the definitions
+ * have been loaded. Most definition IDs are dense integers so they are
+ * stored in an array indexed by the ID which makes a lookup a bounds check
+ * and a load. If the IDs are too spread out for an array to be worth the
+ * memory the definitions are stored in a sorted array that is searched
+ * instead. Lookups return a raw pointer to the definition so no reference
+ * count is touched. The definitions are owned by the map the table was
+ * built from and the pointers stay valid until the table is built again.
+ */
+template<typename K, typename T>
+class DefinitionLookup
+{
+public:
+    /// Maximum number of array slots per definition before the sorted
+    /// array is used instead.
+    static const size_t DENSE_SLOTS_PER_RECORD = 4;
+
+    /**
+     * Create an empty lookup table.
+     */
+    DefinitionLookup() : mMinID(0)
+    {
+    }
+
+    /**
+     * Build the lookup table from the map that owns the definitions.
+     * @param records Definitions by ID
+     */
+    void Build(const std::unordered_map<K, std::shared_ptr<T>>& records)
+    {
+        mDense.clear();
+        mSparse.clear();
+        mMinID = 0;
+
+        if(records.empty())
+        {
+            return;
+        }
+
+        int64_t minID = (int64_t)records.begin()->first;
+        int64_t maxID = minID;
+
+        for(auto& pair : records)
+        {
+            minID = std::min(minID, (int64_t)pair.first);
+            maxID = std::max(maxID, (int64_t)pair.first);
+        }
+
+        uint64_t span = (uint64_t)(maxID - minID) + 1;
+
+        if(span <= (uint64_t)(records.size() * DENSE_SLOTS_PER_RECORD))
+        {
+            mMinID = minID;
+            mDense.resize((size_t)span, nullptr);
+
+            for(auto& pair : records)
+            {
+                mDense[(size_t)((int64_t)pair.first - minID)] =
+                    pair.second.get();
+            }
+        }
+        else
+        {
+            mSparse.reserve(records.size());
+
+            for(auto& pair : records)
+            {
+                mSparse.push_back(std::make_pair(pair.first,
+                    pair.second.get()));
+            }
+
+            std::sort(mSparse.begin(), mSparse.end());
+        }
+    }
+
+    /**
+     * Get a definition by ID.
+     * @param id ID of the definition
+     * @returns Pointer to the definition or null if it does not exist
+     */
+    const T* Get(K id) const
+    {
+        if(!mDense.empty())
+        {
+            uint64_t index = (uint64_t)((int64_t)id - mMinID);
+
+            return index < (uint64_t)mDense.size()
+                ? mDense[(size_t)index] : nullptr;
+        }
+
+        auto it = std::lower_bound(mSparse.begin(), mSparse.end(),
+            std::make_pair(id, (T*)nullptr));
+
+        return (it != mSparse.end() && it->first == id) ? it->second
+            : nullptr;
+    }
+
+    /**
+     * Check if the definitions are stored in an array indexed by ID.
+     * @returns true if the array is indexed by ID, false if it is searched
+     *  or empty
+     */
+    bool IsDense() const
+    {
+        return !mDense.empty();
+    }
+
+private:
+    /// Definitions indexed by ID minus the lowest ID.
+    std::vector<T*> mDense;
+
+    /// Lowest ID in the dense array.
+    int64_t mMinID;
+
+    /// Definitions sorted by ID when the IDs are too spread out.
+    std::vector<std::pair<K, T*>> mSparse;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_DEFINITIONLOOKUP_H
@@ -29,6 +29,7 @@
 // libcomp Includes
 #include "Log.h"
 #include "ScriptEngine.h"
+#include "TaskGroup.h"
 
 // object Includes
 #include <EnchantSetData.h>
@@ -105,6 +106,9 @@
 #include <QmpFile.h>
 #include <Tokusei.h>
 
+// Standard C++11 Includes
+#include <chrono>
+
 using namespace libcomp;
 
 DefinitionManager::DefinitionManager()
@@ -209,6 +213,12 @@ std::shared_ptr<objects::MiDevilData>
     return GetRecordByID(id, mDevilData);
 }
 
+const objects::MiDevilData* DefinitionManager::LookupDevilData(
+    uint32_t id) const
+{
+    return mDevilLookup.Get(id);
+}
+
 const std::shared_ptr<objects::MiDevilData>
     DefinitionManager::GetDevilData(const libcomp::String& name)
 {
@@ -448,6 +458,12 @@ const std::shared_ptr<objects::MiItemData>
     return GetRecordByID(id, mItemData);
 }
 
+const objects::MiItemData* DefinitionManager::LookupItemData(
+    uint32_t id) const
+{
+    return mItemLookup.Get(id);
+}
+
 const std::shared_ptr<objects::MiMissionData>
     DefinitionManager::GetMissionData(uint32_t id)
 {
@@ -592,6 +608,12 @@ const std::shared_ptr<objects::MiSkillData>
     return GetRecordByID(id, mSkillData);
 }
 
+const objects::MiSkillData* DefinitionManager::LookupSkillData(
+    uint32_t id) const
+{
+    return mSkillLookup.Get(id);
+}
+
 std::set<uint32_t> DefinitionManager::GetFunctionIDSkills(uint16_t fid) const
 {
     auto it = mFunctionIDSkills.find(fid);
@@ -790,6 +812,12 @@ const std::shared_ptr<objects::Tokusei>
     return GetRecordByID(id, mTokuseiData);
 }
 
+const objects::Tokusei* DefinitionManager::LookupTokuseiData(
+    int32_t id) const
+{
+    return mTokuseiLookup.Get(id);
+}
+
 const std::unordered_map<int32_t, std::shared_ptr<objects::Tokusei>>
     DefinitionManager::GetAllTokuseiData()
 {
@@ -1808,69 +1836,107 @@ namespace libcomp
     }
 }
 
+/// Add a task that loads the binary data definitions of the type
+#define LOAD_DATA_TASK(type) tasks.Add(#type, [this, pDataStore]() { \
+        return LoadData<objects::type>(pDataStore); })
+
 bool DefinitionManager::LoadAllData(DataStore *pDataStore)
 {
     LOG_INFO("Loading binary data definitions...\n");
 
-    bool success = true;
-    success &= LoadData<objects::MiAIData>(pDataStore);
-    success &= LoadData<objects::MiBlendData>(pDataStore);
-    success &= LoadData<objects::MiBlendExtData>(pDataStore);
-    success &= LoadData<objects::MiCHouraiData>(pDataStore);
-    success &= LoadData<objects::MiCItemData>(pDataStore);
-    success &= LoadData<objects::MiCultureItemData>(pDataStore);
-    success &= LoadData<objects::MiDevilData>(pDataStore);
-    success &= LoadData<objects::MiDevilBookData>(pDataStore);
-    success &= LoadData<objects::MiDevilBoostData>(pDataStore);
-    success &= LoadData<objects::MiDevilBoostExtraData>(pDataStore);
-    success &= LoadData<objects::MiDevilBoostItemData>(pDataStore);
-    success &= LoadData<objects::MiDevilBoostLotData>(pDataStore);
-    success &= LoadData<objects::MiDevilEquipmentData>(pDataStore);
-    success &= LoadData<objects::MiDevilEquipmentItemData>(pDataStore);
-    success &= LoadData<objects::MiDevilFusionData>(pDataStore);
-    success &= LoadData<objects::MiDevilLVUpRateData>(pDataStore);
-    success &= LoadData<objects::MiDisassemblyData>(pDataStore);
-    success &= LoadData<objects::MiDisassemblyTriggerData>(pDataStore);
-    success &= LoadData<objects::MiDynamicMapData>(pDataStore);
-    success &= LoadData<objects::MiEnchantData>(pDataStore);
-    success &= LoadData<objects::MiEquipmentSetData>(pDataStore);
-    success &= LoadData<objects::MiExchangeData>(pDataStore);
-    success &= LoadData<objects::MiExpertData>(pDataStore);
-    success &= LoadData<objects::MiGuardianAssistData>(pDataStore);
-    success &= LoadData<objects::MiGuardianLevelData>(pDataStore);
-    success &= LoadData<objects::MiGuardianSpecialData>(pDataStore);
-    success &= LoadData<objects::MiGuardianUnlockData>(pDataStore);
-    success &= LoadData<objects::MiHNPCData>(pDataStore);
-    success &= LoadData<objects::MiItemData>(pDataStore);
-    success &= LoadData<objects::MiMissionData>(pDataStore);
-    success &= LoadData<objects::MiMitamaReunionBonusData>(pDataStore);
-    success &= LoadData<objects::MiMitamaReunionSetBonusData>(pDataStore);
-    success &= LoadData<objects::MiMitamaUnionBonusData>(pDataStore);
-    success &= LoadData<objects::MiModificationData>(pDataStore);
-    success &= LoadData<objects::MiModificationExtEffectData>(pDataStore);
-    success &= LoadData<objects::MiModificationExtRecipeData>(pDataStore);
-    success &= LoadData<objects::MiModificationTriggerData>(pDataStore);
-    success &= LoadData<objects::MiModifiedEffectData>(pDataStore);
-    success &= LoadData<objects::MiNPCBarterData>(pDataStore);
-    success &= LoadData<objects::MiONPCData>(pDataStore);
-    success &= LoadData<objects::MiQuestBonusCodeData>(pDataStore);
-    success &= LoadData<objects::MiQuestData>(pDataStore);
-    success &= LoadData<objects::MiShopProductData>(pDataStore);
-    success &= LoadData<objects::MiSItemData>(pDataStore);
-    success &= LoadData<objects::MiSkillData>(pDataStore);
-    success &= LoadData<objects::MiStatusData>(pDataStore);
-    success &= LoadData<objects::MiSynthesisData>(pDataStore);
-    success &= LoadData<objects::MiTankData>(pDataStore);
-    success &= LoadData<objects::MiTimeLimitData>(pDataStore);
-    success &= LoadData<objects::MiTitleData>(pDataStore);
-    success &= LoadData<objects::MiTriUnionSpecialData>(pDataStore);
-    success &= LoadData<objects::MiUraFieldTowerData>(pDataStore);
-    success &= LoadData<objects::MiWarpPointData>(pDataStore);
-    success &= LoadData<objects::MiZoneData>(pDataStore);
+    auto start = std::chrono::steady_clock::now();
+
+    if(!mSnapshotPath.IsEmpty())
+    {
+        mSnapshot.reset(new DefinitionSnapshot);
+
+        if(!mSnapshot->Open(mSnapshotPath))
+        {
+            LOG_INFO(libcomp::String("Building definition snapshot: %1\n")
+                .Arg(mSnapshotPath));
+        }
+    }
+
+    // Each table only writes its own members (including lookups built
+    // from that table alone) so the tables can be loaded in parallel
+    TaskGroup tasks;
+    LOAD_DATA_TASK(MiAIData);
+    LOAD_DATA_TASK(MiBlendData);
+    LOAD_DATA_TASK(MiBlendExtData);
+    LOAD_DATA_TASK(MiCHouraiData);
+    LOAD_DATA_TASK(MiCItemData);
+    LOAD_DATA_TASK(MiCultureItemData);
+    LOAD_DATA_TASK(MiDevilData);
+    LOAD_DATA_TASK(MiDevilBookData);
+    LOAD_DATA_TASK(MiDevilBoostData);
+    LOAD_DATA_TASK(MiDevilBoostExtraData);
+    LOAD_DATA_TASK(MiDevilBoostItemData);
+    LOAD_DATA_TASK(MiDevilBoostLotData);
+    LOAD_DATA_TASK(MiDevilEquipmentData);
+    LOAD_DATA_TASK(MiDevilEquipmentItemData);
+    LOAD_DATA_TASK(MiDevilFusionData);
+    LOAD_DATA_TASK(MiDevilLVUpRateData);
+    LOAD_DATA_TASK(MiDisassemblyData);
+    LOAD_DATA_TASK(MiDisassemblyTriggerData);
+    LOAD_DATA_TASK(MiDynamicMapData);
+    LOAD_DATA_TASK(MiEnchantData);
+    LOAD_DATA_TASK(MiEquipmentSetData);
+    LOAD_DATA_TASK(MiExchangeData);
+    LOAD_DATA_TASK(MiExpertData);
+    LOAD_DATA_TASK(MiGuardianAssistData);
+    LOAD_DATA_TASK(MiGuardianLevelData);
+    LOAD_DATA_TASK(MiGuardianSpecialData);
+    LOAD_DATA_TASK(MiGuardianUnlockData);
+    LOAD_DATA_TASK(MiHNPCData);
+    LOAD_DATA_TASK(MiItemData);
+    LOAD_DATA_TASK(MiMissionData);
+    LOAD_DATA_TASK(MiMitamaReunionBonusData);
+    LOAD_DATA_TASK(MiMitamaReunionSetBonusData);
+    LOAD_DATA_TASK(MiMitamaUnionBonusData);
+    LOAD_DATA_TASK(MiModificationData);
+    LOAD_DATA_TASK(MiModificationExtEffectData);
+    LOAD_DATA_TASK(MiModificationExtRecipeData);
+    LOAD_DATA_TASK(MiModificationTriggerData);
+    LOAD_DATA_TASK(MiModifiedEffectData);
+    LOAD_DATA_TASK(MiNPCBarterData);
+    LOAD_DATA_TASK(MiONPCData);
+    LOAD_DATA_TASK(MiQuestBonusCodeData);
+    LOAD_DATA_TASK(MiQuestData);
+    LOAD_DATA_TASK(MiShopProductData);
+    LOAD_DATA_TASK(MiSItemData);
+    LOAD_DATA_TASK(MiSkillData);
+    LOAD_DATA_TASK(MiStatusData);
+    LOAD_DATA_TASK(MiSynthesisData);
+    LOAD_DATA_TASK(MiTankData);
+    LOAD_DATA_TASK(MiTimeLimitData);
+    LOAD_DATA_TASK(MiTitleData);
+    LOAD_DATA_TASK(MiTriUnionSpecialData);
+    LOAD_DATA_TASK(MiUraFieldTowerData);
+    LOAD_DATA_TASK(MiWarpPointData);
+    LOAD_DATA_TASK(MiZoneData);
+
+#undef LOAD_DATA_TASK
+
+    bool success = tasks.Run();
+    tasks.LogTimes("Loaded definitions");
+
+    if(success && mSnapshot && mSnapshot->IsStale())
+    {
+        mSnapshot->Save(mSnapshotPath);
+    }
+
+    // The records own their data so the snapshot is no longer needed
+    mSnapshot.reset();
+
+    BuildLookups();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
 
     if(success)
     {
-        LOG_INFO("Definition loading complete.\n");
+        LOG_INFO(libcomp::String("Definition loading complete in %1 ms.\n")
+            .Arg((int64_t)elapsed));
     }
     else
     {
@@ -1880,6 +1946,19 @@ bool DefinitionManager::LoadAllData(DataStore *pDataStore)
     return success;
 }
 
+void DefinitionManager::SetSnapshotPath(const libcomp::String& path)
+{
+    mSnapshotPath = path;
+}
+
+void DefinitionManager::BuildLookups()
+{
+    mDevilLookup.Build(mDevilData);
+    mItemLookup.Build(mItemData);
+    mSkillLookup.Build(mSkillData);
+    mTokuseiLookup.Build(mTokuseiData);
+}
+
 namespace libcomp
 {
     template<>
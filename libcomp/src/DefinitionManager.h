@@ -36,10 +36,13 @@
 #include "CString.h"
 #include "DataStore.h"
 #include "Decrypt.h"
+#include "DefinitionLookup.h"
+#include "DefinitionSnapshot.h"
 #include "MiCorrectTbl.h"
 #include "Object.h"
 
 // Standard C++11 Includes
+#include <memory>
 #include <set>
 #include <unordered_map>
 
@@ -226,6 +229,15 @@ public:
      */
     std::shared_ptr<objects::MiDevilData> GetDevilData(uint32_t id);
 
+    /**
+     * Get the devil definition corresponding to an ID without copying the
+     * pointer to it. Prefer this in code that runs often.
+     * @param id Devil ID to retrieve
+     * @return Pointer to the matching devil definition, null if it does
+     *  not exist
+     */
+    const objects::MiDevilData* LookupDevilData(uint32_t id) const;
+
     /**
      * Get a devil definition corresponding to a name
      * @param name Devil name to retrieve
@@ -465,6 +477,15 @@ public:
      */
     const std::shared_ptr<objects::MiItemData> GetItemData(uint32_t id);
 
+    /**
+     * Get the item definition corresponding to an ID without copying the
+     * pointer to it. Prefer this in code that runs often.
+     * @param id Item ID to retrieve
+     * @return Pointer to the matching item definition, null if it does
+     *  not exist
+     */
+    const objects::MiItemData* LookupItemData(uint32_t id) const;
+
     /**
      * Get the item definition corresponding to a name
      * @param name Item name to retrieve
@@ -633,6 +654,15 @@ public:
      */
     const std::shared_ptr<objects::MiSkillData> GetSkillData(uint32_t id);
 
+    /**
+     * Get the skill definition corresponding to an ID without copying the
+     * pointer to it. Prefer this in code that runs often.
+     * @param id Skill ID to retrieve
+     * @return Pointer to the matching skill definition, null if it does
+     *  not exist
+     */
+    const objects::MiSkillData* LookupSkillData(uint32_t id) const;
+
     /**
      * Get all skill definition IDs that are mapped to the supplied function ID
      * @param fid Skill function ID
@@ -792,6 +822,14 @@ public:
      */
     const std::shared_ptr<objects::Tokusei> GetTokuseiData(int32_t id);
 
+    /**
+     * Get a tokusei by definition ID without copying the pointer to it.
+     * Prefer this in code that runs often.
+     * @param id Definition ID of a tokusei to load
+     * @return Pointer to the tokusei matching the specified id
+     */
+    const objects::Tokusei* LookupTokuseiData(int32_t id) const;
+
     /**
      * Get all tokusei definitions by ID
      * @return Map of all tokusei definitions by ID
@@ -806,6 +844,22 @@ public:
      */
     bool LoadAllData(DataStore *pDataStore);
 
+    /**
+     * Set the path to the snapshot of the decrypted binary data files
+     * used by @ref LoadAllData. The snapshot is mapped instead of loading
+     * each file from the datastore and is rebuilt when a file changes.
+     * @param path Path to the snapshot file on the native file system or
+     *  an empty string to load every file from the datastore
+     */
+    void SetSnapshotPath(const libcomp::String& path);
+
+    /**
+     * Build the lookup tables used by the Lookup functions from the loaded
+     * definitions. This is called by @ref LoadAllData and must be called
+     * again once the server side definitions have been registered.
+     */
+    void BuildLookups();
+
     /**
      * Load the binary data definitions of the specified type
      * @param pDataStore Pointer to the datastore to load binary file from
@@ -857,29 +911,53 @@ private:
         bool printResults = true)
     {
         std::vector<char> data;
+        const char *pData = nullptr;
+        size_t dataSize = 0;
+        int64_t sourceSize = 0;
+        int64_t sourceTime = 0;
 
         auto path = libcomp::String("/BinaryData/") + binaryFile;
 
-        if(decrypt)
-        {
-            data = pDataStore->DecryptFile(path);
-        }
-        else
+        if(mSnapshot)
         {
-            data = pDataStore->ReadFile(path);
+            sourceSize = pDataStore->FileSize(path);
+            sourceTime = pDataStore->ModifiedTime(path);
+
+            if(0 <= sourceSize)
+            {
+                mSnapshot->GetTable(binaryFile, sourceSize, sourceTime,
+                    pData, dataSize);
+            }
         }
 
-        if(data.empty())
+        if(nullptr == pData)
         {
-            if(printResults)
+            if(decrypt)
             {
-                PrintLoadResult(binaryFile, false, 0, 0);
+                data = pDataStore->DecryptFile(path);
             }
-            return false;
+            else
+            {
+                data = pDataStore->ReadFile(path);
+            }
+
+            if(data.empty())
+            {
+                if(printResults)
+                {
+                    PrintLoadResult(binaryFile, false, 0, 0);
+                }
+                return false;
+            }
+
+            pData = data.data();
+            dataSize = data.size();
         }
 
-        std::stringstream ss(std::string(data.begin(), data.end()));
-        libcomp::ObjectInStream ois(ss);
+        // Read straight from the file contents instead of copying them
+        MemoryStreamBuffer buffer(pData, dataSize);
+        std::istream in(&buffer);
+        libcomp::ObjectInStream ois(in);
 
         uint16_t entryCount, tableCount;
         if(!LoadBinaryDataHeader(ois, binaryFile, tablesExpected,
@@ -919,6 +997,12 @@ private:
             PrintLoadResult(binaryFile, success, entryCount, records.size());
         }
 
+        if(success && mSnapshot && !data.empty() && 0 <= sourceSize)
+        {
+            mSnapshot->AddTable(binaryFile, sourceSize, sourceTime,
+                std::move(data));
+        }
+
         return success;
     }
 
@@ -1255,6 +1339,25 @@ private:
     /// Map of tokusei definitions by ID
     std::unordered_map<int32_t,
         std::shared_ptr<objects::Tokusei>> mTokuseiData;
+
+    /// Lookup table of devil definitions by ID
+    DefinitionLookup<uint32_t, objects::MiDevilData> mDevilLookup;
+
+    /// Lookup table of item definitions by ID
+    DefinitionLookup<uint32_t, objects::MiItemData> mItemLookup;
+
+    /// Lookup table of skill definitions by ID
+    DefinitionLookup<uint32_t, objects::MiSkillData> mSkillLookup;
+
+    /// Lookup table of tokusei definitions by ID
+    DefinitionLookup<int32_t, objects::Tokusei> mTokuseiLookup;
+
+    /// Path to the snapshot of the decrypted binary data files
+    libcomp::String mSnapshotPath;
+
+    /// Snapshot of the decrypted binary data files, only set while
+    /// LoadAllData is running
+    std::unique_ptr<DefinitionSnapshot> mSnapshot;
 };
 
 } // namspace libcomp
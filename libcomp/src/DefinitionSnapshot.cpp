@@ -0,0 +1,523 @@
+/**
+ * @file libcomp/src/DefinitionSnapshot.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Memory mapped snapshot of the decrypted binary data files.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DefinitionSnapshot.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else // !WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+// libcomp Includes
+#include "Log.h"
+
+// Standard C++11 Includes
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Identifies a definition snapshot file.
+const char SNAPSHOT_MAGIC[4] = { 'C', 'D', 'S', 'S' };
+
+/// Version of the snapshot layout. Increase this when the layout or the
+/// format of a binary data file changes.
+const uint32_t SNAPSHOT_VERSION = 1;
+
+/// Maximum length of a table name including the null terminator.
+const size_t SNAPSHOT_NAME_SIZE = 64;
+
+/// Alignment of each table in the file.
+const size_t SNAPSHOT_ALIGNMENT = 8;
+
+/**
+ * Header at the start of the snapshot file.
+ */
+struct SnapshotHeader
+{
+    /// Must match SNAPSHOT_MAGIC.
+    char Magic[4];
+
+    /// Must match SNAPSHOT_VERSION.
+    uint32_t Version;
+
+    /// Number of entries in the offset table.
+    uint32_t TableCount;
+
+    /// Unused, keeps the offset table aligned.
+    uint32_t Reserved;
+};
+
+/**
+ * Entry in the offset table that follows the header.
+ */
+struct SnapshotEntry
+{
+    /// Null terminated name of the binary data file.
+    char Name[SNAPSHOT_NAME_SIZE];
+
+    /// Size of the source file.
+    int64_t SourceSize;
+
+    /// Modification time of the source file.
+    int64_t SourceTime;
+
+    /// Offset of the table contents from the start of the file.
+    uint64_t Offset;
+
+    /// Size of the table contents.
+    uint64_t Size;
+};
+
+/**
+ * Round a size up to the table alignment.
+ * @param size Size to align
+ * @returns Aligned size
+ */
+size_t Align(size_t size)
+{
+    return (size + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1);
+}
+
+/**
+ * Create an empty file with a unique name next to the snapshot so two
+ * processes saving at the same time never write to the same file and the
+ * rename never crosses a file system.
+ * @param path Path to the snapshot file
+ * @return Path to the new file or an empty string on failure
+ */
+String CreateTempFile(const String& path)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    std::random_device rd;
+
+    for(int attempt = 0; attempt < 16; attempt++)
+    {
+        String tempPath = String("%1.%2.%3.tmp").Arg(path).Arg(
+            (uint32_t)GetCurrentProcessId()).Arg((uint32_t)rd());
+
+        HANDLE hFile = CreateFileA(tempPath.C(), GENERIC_WRITE, 0, NULL,
+            CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+
+        if(INVALID_HANDLE_VALUE != hFile)
+        {
+            CloseHandle(hFile);
+
+            return tempPath;
+        }
+    }
+
+    return String();
+#else // !WIN32
+    std::string tempTemplate = path.ToUtf8() + ".XXXXXX";
+    std::vector<char> szPath(tempTemplate.begin(), tempTemplate.end());
+    szPath.push_back(0);
+
+    int fd = mkstemp(szPath.data());
+    if(0 > fd)
+    {
+        return String();
+    }
+
+    close(fd);
+
+    return String(szPath.data());
+#endif // WIN32
+}
+
+} // namespace
+
+MemoryStreamBuffer::MemoryStreamBuffer(const char *pData, size_t size)
+{
+    // The get area is never written to.
+    char *pStart = const_cast<char*>(pData);
+
+    setg(pStart, pStart, pStart + size);
+}
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(off_type off,
+    std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if(!(which & std::ios_base::in))
+    {
+        return pos_type(off_type(-1));
+    }
+
+    off_type pos;
+
+    switch(dir)
+    {
+        case std::ios_base::beg:
+            pos = off;
+            break;
+        case std::ios_base::cur:
+            pos = (gptr() - eback()) + off;
+            break;
+        default:
+            pos = (egptr() - eback()) + off;
+            break;
+    }
+
+    if(0 > pos || (egptr() - eback()) < pos)
+    {
+        return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + pos, egptr());
+
+    return pos_type(pos);
+}
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(pos_type pos,
+    std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+DefinitionSnapshot::DefinitionSnapshot() : mData(nullptr), mSize(0),
+#if defined(_WIN32) || defined(_WIN64)
+    mMapping(nullptr),
+#endif // defined(_WIN32) || defined(_WIN64)
+    mStale(false)
+{
+}
+
+DefinitionSnapshot::~DefinitionSnapshot()
+{
+    Close();
+}
+
+bool DefinitionSnapshot::Open(const String& path)
+{
+    Close();
+
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE file = CreateFileA(path.C(), GENERIC_READ, FILE_SHARE_READ |
+        FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if(INVALID_HANDLE_VALUE == file)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if(!GetFileSizeEx(file, &fileSize) || 0 >= fileSize.QuadPart)
+    {
+        CloseHandle(file);
+
+        return false;
+    }
+
+    mMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    CloseHandle(file);
+
+    if(NULL == mMapping)
+    {
+        mMapping = nullptr;
+
+        return false;
+    }
+
+    mData = reinterpret_cast<const char*>(MapViewOfFile(mMapping,
+        FILE_MAP_READ, 0, 0, 0));
+
+    if(nullptr == mData)
+    {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+
+        return false;
+    }
+
+    mSize = (size_t)fileSize.QuadPart;
+#else // !WIN32
+    int fd = open(path.C(), O_RDONLY);
+
+    if(0 > fd)
+    {
+        return false;
+    }
+
+    struct stat info;
+
+    if(0 != fstat(fd, &info) || 0 >= info.st_size)
+    {
+        close(fd);
+
+        return false;
+    }
+
+    void *pMap = mmap(nullptr, (size_t)info.st_size, PROT_READ,
+        MAP_SHARED, fd, 0);
+
+    // The mapping stays valid after the file is closed.
+    close(fd);
+
+    if(MAP_FAILED == pMap)
+    {
+        return false;
+    }
+
+    mData = reinterpret_cast<const char*>(pMap);
+    mSize = (size_t)info.st_size;
+#endif // WIN32
+
+    const SnapshotHeader *pHeader = reinterpret_cast<
+        const SnapshotHeader*>(mData);
+
+    if(sizeof(SnapshotHeader) > mSize ||
+        0 != memcmp(pHeader->Magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) ||
+        SNAPSHOT_VERSION != pHeader->Version ||
+        (mSize - sizeof(SnapshotHeader)) / sizeof(SnapshotEntry) <
+            pHeader->TableCount)
+    {
+        LOG_WARNING(String("Ignoring invalid definition snapshot: %1\n")
+            .Arg(path));
+
+        Close();
+
+        return false;
+    }
+
+    const SnapshotEntry *pEntries = reinterpret_cast<const SnapshotEntry*>(
+        mData + sizeof(SnapshotHeader));
+
+    for(size_t i = 0; i < pHeader->TableCount; i++)
+    {
+        const SnapshotEntry& entry = pEntries[i];
+
+        if(entry.Offset > mSize || entry.Size > (mSize - entry.Offset) ||
+            '\0' != entry.Name[SNAPSHOT_NAME_SIZE - 1])
+        {
+            LOG_WARNING(String("Ignoring corrupt definition snapshot: %1\n")
+                .Arg(path));
+
+            Close();
+
+            return false;
+        }
+
+        mEntries[entry.Name] = i;
+    }
+
+    return true;
+}
+
+void DefinitionSnapshot::Close()
+{
+    mEntries.clear();
+    mTables.clear();
+    mStale = false;
+
+    if(nullptr == mData)
+    {
+        return;
+    }
+
+#if defined(_WIN32) || defined(_WIN64)
+    UnmapViewOfFile(mData);
+    CloseHandle(mMapping);
+    mMapping = nullptr;
+#else // !WIN32
+    munmap(const_cast<char*>(mData), mSize);
+#endif // WIN32
+
+    mData = nullptr;
+    mSize = 0;
+}
+
+bool DefinitionSnapshot::GetTable(const String& name, int64_t sourceSize,
+    int64_t sourceTime, const char*& pData, size_t& size)
+{
+    std::string key = name.ToUtf8();
+
+    auto it = mEntries.find(key);
+    if(it == mEntries.end())
+    {
+        return false;
+    }
+
+    const SnapshotEntry& entry = reinterpret_cast<const SnapshotEntry*>(
+        mData + sizeof(SnapshotHeader))[it->second];
+
+    if(entry.SourceSize != sourceSize || entry.SourceTime != sourceTime)
+    {
+        return false;
+    }
+
+    pData = mData + entry.Offset;
+    size = (size_t)entry.Size;
+
+    Table table;
+    table.Name = key;
+    table.SourceSize = sourceSize;
+    table.SourceTime = sourceTime;
+    table.pData = pData;
+    table.Size = size;
+
+    std::lock_guard<std::mutex> lock(mLock);
+    mTables.push_back(std::move(table));
+
+    return true;
+}
+
+void DefinitionSnapshot::AddTable(const String& name, int64_t sourceSize,
+    int64_t sourceTime, std::vector<char>&& data)
+{
+    Table table;
+    table.Name = name.ToUtf8();
+    table.SourceSize = sourceSize;
+    table.SourceTime = sourceTime;
+    table.pData = nullptr;
+    table.Size = data.size();
+    table.Data = std::move(data);
+
+    if(SNAPSHOT_NAME_SIZE <= table.Name.size())
+    {
+        // The name does not fit so the table is never cached.
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mLock);
+    mTables.push_back(std::move(table));
+    mStale = true;
+}
+
+bool DefinitionSnapshot::IsStale() const
+{
+    return mStale;
+}
+
+bool DefinitionSnapshot::Save(const String& path)
+{
+    String tempPath = CreateTempFile(path);
+    if(tempPath.IsEmpty())
+    {
+        LOG_ERROR(String("Failed to create a temporary file for the "
+            "definition snapshot: %1\n").Arg(path));
+
+        return false;
+    }
+
+    std::ofstream out(tempPath.C(), std::ofstream::out |
+        std::ofstream::binary | std::ofstream::trunc);
+
+    if(!out.good())
+    {
+        LOG_ERROR(String("Failed to write definition snapshot: %1\n")
+            .Arg(tempPath));
+
+        return false;
+    }
+
+    SnapshotHeader header;
+    memcpy(header.Magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.Version = SNAPSHOT_VERSION;
+    header.TableCount = (uint32_t)mTables.size();
+    header.Reserved = 0;
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    size_t offset = Align(sizeof(SnapshotHeader) +
+        sizeof(SnapshotEntry) * mTables.size());
+
+    for(auto& table : mTables)
+    {
+        SnapshotEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        memcpy(entry.Name, table.Name.c_str(), table.Name.size());
+        entry.SourceSize = table.SourceSize;
+        entry.SourceTime = table.SourceTime;
+        entry.Offset = offset;
+        entry.Size = table.Size;
+
+        out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+
+        offset = Align(offset + table.Size);
+    }
+
+    const char padding[SNAPSHOT_ALIGNMENT] = { 0 };
+
+    std::streamoff written = out.tellp();
+    out.write(padding, (std::streamsize)(Align((size_t)written) -
+        (size_t)written));
+
+    for(auto& table : mTables)
+    {
+        const char *pData = table.pData ? table.pData : table.Data.data();
+
+        out.write(pData, (std::streamsize)table.Size);
+        out.write(padding, (std::streamsize)(Align(table.Size) -
+            table.Size));
+    }
+
+    out.close();
+
+    if(!out.good())
+    {
+        LOG_ERROR(String("Failed to write definition snapshot: %1\n")
+            .Arg(tempPath));
+
+        (void)std::remove(tempPath.C());
+
+        return false;
+    }
+
+#if defined(_WIN32) || defined(_WIN64)
+    if(!MoveFileExA(tempPath.C(), path.C(), MOVEFILE_REPLACE_EXISTING))
+#else // !WIN32
+    if(0 != std::rename(tempPath.C(), path.C()))
+#endif // WIN32
+    {
+        LOG_ERROR(String("Failed to replace definition snapshot: %1\n")
+            .Arg(path));
+
+        (void)std::remove(tempPath.C());
+
+        return false;
+    }
+
+    mStale = false;
+
+    return true;
+}
+
+size_t DefinitionSnapshot::GetMappedSize() const
+{
+    return mSize;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file libcomp/src/DefinitionSnapshot.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Memory mapped snapshot of the decrypted binary data files.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_DEFINITIONSNAPSHOT_H
+#define LIBCOMP_SRC_DEFINITIONSNAPSHOT_H
+
+// libcomp Includes
+#include "CString.h"
+
+// Standard C++11 Includes
+#include <list>
+#include <mutex>
+#include <streambuf>
+#include <unordered_map>
+#include <vector>
+
+namespace libcomp
+{
+
+/**
+ * Read only stream buffer over a block of memory that is owned elsewhere.
+ * This lets a std::istream read from a memory mapped file or an existing
+ * buffer without copying it into a std::string first.
+ */
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+    /**
+     * Create the stream buffer.
+     * @param pData Start of the memory to read
+     * @param size Number of bytes that may be read
+     */
+    MemoryStreamBuffer(const char *pData, size_t size);
+
+protected:
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+        std::ios_base::openmode which = std::ios_base::in);
+    virtual pos_type seekpos(pos_type pos,
+        std::ios_base::openmode which = std::ios_base::in);
+};
+
+/**
+ * Snapshot of the decrypted binary data files loaded by the
+ * @ref DefinitionManager. Decrypting every file through the data store and
+ * copying it around takes most of the time spent loading definitions so
+ * the decrypted contents are written once to a single file on disk. Later
+ * loads map the file read only which lets every server on the host share
+ * the same pages from the page cache. Each table records the size and
+ * modification time of the file it was built from and is ignored when the
+ * source file changes. The snapshot is saved again when any table was
+ * stale or missing.
+ *
+ * Tables may be read and added from more than one thread at a time but
+ * the snapshot must only be opened, saved or closed by one thread.
+ *
+ * The file starts with a header and a fixed size offset table followed by
+ * the table contents. The layout uses the native byte order as it is only
+ * ever read on the host that wrote it.
+ */
+class DefinitionSnapshot
+{
+public:
+    /**
+     * Create a snapshot with no file mapped.
+     */
+    DefinitionSnapshot();
+
+    /**
+     * Unmap the snapshot file.
+     */
+    ~DefinitionSnapshot();
+
+    /**
+     * Map a snapshot file read only. A missing or invalid file is not an
+     * error as the snapshot will be built from the source files.
+     * @param path Path to the snapshot file on the native file system
+     * @returns true if the file was mapped, false otherwise
+     */
+    bool Open(const String& path);
+
+    /**
+     * Unmap the snapshot file and discard any tables added to it.
+     */
+    void Close();
+
+    /**
+     * Get the contents of a table in the mapped snapshot. The memory stays
+     * valid until the snapshot is closed.
+     * @param name Name of the binary data file
+     * @param sourceSize Size of the source file
+     * @param sourceTime Modification time of the source file
+     * @param pData Output pointer to the table contents
+     * @param size Output size of the table contents
+     * @returns true if the table is in the snapshot and is up to date,
+     *  false if it must be loaded from the source file
+     */
+    bool GetTable(const String& name, int64_t sourceSize, int64_t sourceTime,
+        const char*& pData, size_t& size);
+
+    /**
+     * Add a table loaded from the source file so it is included the next
+     * time the snapshot is saved.
+     * @param name Name of the binary data file
+     * @param sourceSize Size of the source file
+     * @param sourceTime Modification time of the source file
+     * @param data Decrypted contents of the file
+     */
+    void AddTable(const String& name, int64_t sourceSize, int64_t sourceTime,
+        std::vector<char>&& data);
+
+    /**
+     * Check if any table was added since the snapshot was opened.
+     * @returns true if the snapshot should be saved again
+     */
+    bool IsStale() const;
+
+    /**
+     * Write every table that was read or added to a new snapshot file.
+     * The file is written to a temporary path first and then renamed over
+     * the old one so processes that still have it mapped are not affected.
+     * @param path Path to the snapshot file on the native file system
+     * @returns true if the snapshot was saved, false otherwise
+     */
+    bool Save(const String& path);
+
+    /**
+     * Get the size of the mapped snapshot file.
+     * @returns Number of bytes mapped
+     */
+    size_t GetMappedSize() const;
+
+private:
+    /**
+     * Table that will be written when the snapshot is saved.
+     */
+    struct Table
+    {
+        /// Name of the binary data file.
+        std::string Name;
+
+        /// Size of the source file.
+        int64_t SourceSize;
+
+        /// Modification time of the source file.
+        int64_t SourceTime;
+
+        /// Contents of the table in the mapped file or null if the table
+        /// was added.
+        const char *pData;
+
+        /// Size of the table contents.
+        size_t Size;
+
+        /// Contents of a table that was added.
+        std::vector<char> Data;
+    };
+
+    /// Start of the mapped file or null if no file is mapped.
+    const char *mData;
+
+    /// Size of the mapped file.
+    size_t mSize;
+
+#if defined(_WIN32) || defined(_WIN64)
+    /// Handle to the file mapping object.
+    void *mMapping;
+#endif // defined(_WIN32) || defined(_WIN64)
+
+    /// Offset table entries in the mapped file by table name.
+    std::unordered_map<std::string, size_t> mEntries;
+
+    /// Tables to write when the snapshot is saved.
+    std::list<Table> mTables;
+
+    /// Lock for the tables to write.
+    std::mutex mLock;
+
+    /// Indicates a table was added since the snapshot was opened.
+    bool mStale;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_DEFINITIONSNAPSHOT_H
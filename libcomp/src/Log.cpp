@@ -26,10 +26,12 @@
 
 #include "Log.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <chrono>
 #include <thread>
+#include <vector>
 
 #include <cstdio>
 #include <cstdlib>
@@ -39,6 +41,7 @@
 #include <wincon.h>
 #include <shlwapi.h>
 #else
+#include <fcntl.h>
 #include <unistd.h>
 #endif // _WIN32
 
@@ -53,6 +56,120 @@ using namespace libcomp;
  */
 static Log *gLogInst = nullptr;
 
+/**
+ * @internal
+ * Default number of messages each thread can queue for the writer thread.
+ */
+static const size_t DEFAULT_ASYNC_BUFFER_SIZE = 4096;
+
+/**
+ * @internal
+ * Longest time the writer thread waits before writing queued messages.
+ */
+static const std::chrono::milliseconds ASYNC_WRITE_INTERVAL(10);
+
+/**
+ * @internal
+ * Shortest time between synchronizing the log file with LOG_SYNC_INTERVAL.
+ */
+static const std::chrono::seconds SYNC_INTERVAL(1);
+
+namespace libcomp
+{
+
+/**
+ * @internal
+ * Message queued by a thread for the asynchronous writer thread.
+ */
+struct LogEntry
+{
+    /// Logging level of the message.
+    Log::Level_t Level;
+
+    /// The message to log without the level prefix.
+    String Message;
+
+    /// Time the message was logged.
+    std::chrono::system_clock::time_point Time;
+
+    /// Order the message was queued in across all threads.
+    uint64_t Sequence;
+};
+
+/**
+ * @internal
+ * Fixed size ring buffer of messages written by a single thread and read by
+ * the asynchronous writer thread. Neither side takes a lock.
+ */
+class LogBuffer
+{
+public:
+    /**
+     * Create the buffer.
+     * @param owner Log the buffer belongs to.
+     * @param capacity Number of messages the buffer can hold.
+     */
+    LogBuffer(Log *owner, size_t capacity) : Owner(owner),
+        Entries(std::max(capacity, (size_t)1)), Head(0), Tail(0),
+        Closed(false)
+    {
+    }
+
+    /// Log the buffer belongs to.
+    Log *Owner;
+
+    /// Messages in the buffer.
+    std::vector<LogEntry> Entries;
+
+    /// Position of the next message the writer thread will read.
+    std::atomic<size_t> Head;
+
+    /// Position the next message will be written to.
+    std::atomic<size_t> Tail;
+
+    /// Set once the thread that owns the buffer has exited.
+    std::atomic<bool> Closed;
+};
+
+} // namespace libcomp
+
+/**
+ * @internal
+ * Holds the buffer of the current thread and marks it closed when the
+ * thread exits so the writer thread can remove it once it is empty.
+ */
+struct ThreadLogBuffer
+{
+    ~ThreadLogBuffer()
+    {
+        if(Buffer)
+        {
+            Buffer->Closed = true;
+        }
+    }
+
+    /// Buffer of the current thread.
+    std::shared_ptr<LogBuffer> Buffer;
+};
+
+/**
+ * @internal
+ * Buffer for the current thread.
+ */
+static thread_local ThreadLogBuffer tLogBuffer;
+
+/**
+ * @internal
+ * Write all queued messages when the application exits.
+ */
+static void StopAsyncLog()
+{
+    if(nullptr != gLogInst)
+    {
+        gLogInst->SetAsyncEnabled(false);
+    }
+}
+
 /*
  * Black       0;30     Dark Gray     1;30
  * Blue        0;34     Light Blue    1;34
@@ -166,7 +283,10 @@ static void LogToStandardOutput(Log::Level_t level,
     std::cout.flush();
 }
 
-Log::Log() : mLogFile(nullptr), mLastLog(-1337)
+Log::Log() : mLogFile(nullptr), mLastLog(-1337), mAsyncEnabled(false),
+    mAsyncBufferSize(DEFAULT_ASYNC_BUFFER_SIZE), mSyncPolicy(LOG_SYNC_NONE),
+    mDroppedCount(0), mDroppedReported(0), mSequence(0), mAsyncProducers(0),
+    mAsyncStop(false)
 {
 #ifdef _WIN32
     CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
@@ -201,6 +321,9 @@ Log::Log() : mLogFile(nullptr), mLastLog(-1337)
 
 Log::~Log()
 {
+    // Write any queued messages before the log file is closed.
+    SetAsyncEnabled(false);
+
     // Lock the muxtex.
     std::lock_guard<std::mutex> lock(mLock);
 
@@ -236,15 +359,6 @@ Log* Log::GetSingletonPtr()
 
 void Log::LogMessage(Log::Level_t level, const String& msg)
 {
-    // Prepend these to messages.
-    static const String gLogMessages[Log::LOG_LEVEL_COUNT] = {
-        "DEBUG: %1",
-        "%1",
-        "WARNING: %1",
-        "ERROR: %1",
-        "CRITICAL: %1",
-    };
-
     // Log a critical error message. If the configuration option is true, log
     // the message to the log file. Regardless, pass the message to all the
     // log hooks for processing. Critical messages have the text "CRITICAL: "
@@ -252,16 +366,103 @@ void Log::LogMessage(Log::Level_t level, const String& msg)
     if(0 > level || LOG_LEVEL_COUNT <= level || !mLogEnables[level])
         return;
 
-    String final = String(gLogMessages[level]).Arg(msg);
+    auto now = std::chrono::system_clock::now();
+
+    if(mAsyncEnabled)
+    {
+        if(LOG_LEVEL_CRITICAL == level)
+        {
+            // Critical messages are usually the last thing logged before
+            // the server goes down so write everything queued before it
+            // and then write it directly instead of queueing it.
+            DrainBuffers();
+        }
+        else
+        {
+            // Count this thread as queueing so turning asynchronous
+            // logging off waits for the message to reach the buffer before
+            // the last drain. The flag is checked again after the count is
+            // raised in case it was cleared in between.
+            mAsyncProducers++;
+
+            bool queued = mAsyncEnabled;
+            if(queued)
+            {
+                QueueMessage(level, msg, now);
+            }
+
+            mAsyncProducers--;
+
+            if(queued)
+            {
+                return;
+            }
+        }
+    }
 
     // Lock the muxtex.
     std::lock_guard<std::mutex> lock(mLock);
 
+    WriteMessage(level, msg, now);
+
+    if(nullptr != mLogFile)
+    {
+        mLogFile->flush();
+    }
+}
+
+void Log::QueueMessage(Log::Level_t level, const String& msg,
+    const std::chrono::system_clock::time_point& time)
+{
+    // Queue the message for the writer thread. The message is formatted
+    // by the writer thread.
+    auto buffer = GetThreadBuffer();
+
+    size_t tail = buffer->Tail.load(std::memory_order_relaxed);
+    size_t head = buffer->Head.load(std::memory_order_acquire);
+    size_t capacity = buffer->Entries.size();
+
+    if(capacity <= (tail - head))
+    {
+        // Never block the thread on the writer.
+        mDroppedCount++;
+
+        return;
+    }
+
+    LogEntry& entry = buffer->Entries[tail % capacity];
+    entry.Level = level;
+    entry.Message = msg;
+    entry.Time = time;
+    entry.Sequence = mSequence++;
+
+    buffer->Tail.store(tail + 1, std::memory_order_release);
+
+    // Wake the writer early if the buffer is filling up.
+    if((capacity / 2) == (tail + 1 - head))
+    {
+        mAsyncCondition.notify_one();
+    }
+}
+
+void Log::WriteMessage(Log::Level_t level, const String& msg,
+    const std::chrono::system_clock::time_point& time)
+{
+    // Prepend these to messages.
+    static const String gLogMessages[Log::LOG_LEVEL_COUNT] = {
+        "DEBUG: %1",
+        "%1",
+        "WARNING: %1",
+        "ERROR: %1",
+        "CRITICAL: %1",
+    };
+
+    String final = String(gLogMessages[level]).Arg(msg);
+
     if(nullptr != mLogFile)
     {
-        auto now = std::chrono::system_clock::now();
         auto duration = std::chrono::duration_cast< std::chrono::duration<
-            int64_t, std::ratio<86400>> >( now.time_since_epoch() ).count();
+            int64_t, std::ratio<86400>> >( time.time_since_epoch() ).count();
 
         if(mLogRotationEnabled && mLogRotationDays <= (duration - mLastLog))
         {
@@ -270,9 +471,9 @@ void Log::LogMessage(Log::Level_t level, const String& msg)
 
         mLastLog = duration;
 
-        if(mLogFileTimestampEnabled)
+        if(mLogFileTimestampEnabled && nullptr != mLogFile)
         {
-            auto currentTime = std::chrono::system_clock::to_time_t(now);
+            auto currentTime = std::chrono::system_clock::to_time_t(time);
 
             std::stringstream ss;
             ss << std::put_time(std::localtime(&currentTime), "%Y/%m/%d %T");
@@ -283,9 +484,11 @@ void Log::LogMessage(Log::Level_t level, const String& msg)
                 (std::streamsize)(formattedTime.Size() * sizeof(char)));
         }
 
-        mLogFile->write(final.C(),
-            (std::streamsize)(final.Size() * sizeof(char)));
-        mLogFile->flush();
+        if(nullptr != mLogFile)
+        {
+            mLogFile->write(final.C(),
+                (std::streamsize)(final.Size() * sizeof(char)));
+        }
     }
 
     // Call all hooks.
@@ -301,6 +504,132 @@ void Log::LogMessage(Log::Level_t level, const String& msg)
     }
 }
 
+std::shared_ptr<LogBuffer> Log::GetThreadBuffer()
+{
+    auto buffer = tLogBuffer.Buffer;
+    if(buffer && buffer->Owner == this)
+    {
+        return buffer;
+    }
+
+    if(buffer)
+    {
+        buffer->Closed = true;
+    }
+
+    buffer = std::make_shared<LogBuffer>(this, mAsyncBufferSize.load());
+    tLogBuffer.Buffer = buffer;
+
+    std::lock_guard<std::mutex> lock(mBuffersLock);
+    mBuffers.push_back(buffer);
+
+    return buffer;
+}
+
+void Log::AsyncWriterMain()
+{
+    std::unique_lock<std::mutex> lock(mAsyncLock);
+
+    while(!mAsyncStop)
+    {
+        mAsyncCondition.wait_for(lock, ASYNC_WRITE_INTERVAL);
+
+        lock.unlock();
+        DrainBuffers();
+        lock.lock();
+    }
+}
+
+void Log::DrainBuffers()
+{
+    std::lock_guard<std::mutex> drainLock(mDrainLock);
+
+    std::list<std::shared_ptr<LogBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(mBuffersLock);
+
+        // Remove the buffers of threads that have exited once the
+        // remaining messages have been read below.
+        for(auto it = mBuffers.begin(); it != mBuffers.end();)
+        {
+            auto buffer = *it;
+            buffers.push_back(buffer);
+
+            if(buffer->Closed)
+            {
+                it = mBuffers.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    std::vector<LogEntry> batch;
+
+    for(auto buffer : buffers)
+    {
+        size_t head = buffer->Head.load(std::memory_order_relaxed);
+        size_t tail = buffer->Tail.load(std::memory_order_acquire);
+        size_t capacity = buffer->Entries.size();
+
+        for(; head != tail; head++)
+        {
+            batch.push_back(std::move(buffer->Entries[head % capacity]));
+        }
+
+        buffer->Head.store(head, std::memory_order_release);
+    }
+
+    uint64_t dropped = mDroppedCount;
+
+    if(batch.empty() && dropped == mDroppedReported)
+    {
+        return;
+    }
+
+    // Keep the messages from every thread in the order they were logged.
+    std::sort(batch.begin(), batch.end(), [](const LogEntry& a,
+        const LogEntry& b)
+    {
+        return a.Sequence < b.Sequence;
+    });
+
+    // Lock the muxtex.
+    std::lock_guard<std::mutex> lock(mLock);
+
+    for(auto& entry : batch)
+    {
+        WriteMessage(entry.Level, entry.Message, entry.Time);
+    }
+
+    if(dropped != mDroppedReported)
+    {
+        WriteMessage(LOG_LEVEL_WARNING, String("%1 log message(s) were "
+            "dropped because the log buffer was full.\n").Arg(
+            dropped - mDroppedReported), std::chrono::system_clock::now());
+
+        mDroppedReported = dropped;
+    }
+
+    if(nullptr != mLogFile)
+    {
+        mLogFile->flush();
+
+        auto policy = (SyncPolicy_t)mSyncPolicy.load();
+        auto now = std::chrono::steady_clock::now();
+
+        if(LOG_SYNC_BATCH == policy || (LOG_SYNC_INTERVAL == policy &&
+            SYNC_INTERVAL <= (now - mLastSync)))
+        {
+            FileSync(mLogPath);
+
+            mLastSync = now;
+        }
+    }
+}
+
 String Log::GetLogPath() const
 {
     return mLogPath;
@@ -463,6 +792,95 @@ void Log::SetLogRotationCount(int count)
     mLogRotationCount = count;
 }
 
+bool Log::GetAsyncEnabled() const
+{
+    return mAsyncEnabled;
+}
+
+void Log::SetAsyncEnabled(bool enabled)
+{
+    static std::once_flag registerExit;
+
+    std::unique_lock<std::mutex> lock(mAsyncLock);
+
+    if(enabled == mAsyncThread.joinable())
+    {
+        return;
+    }
+
+    if(enabled)
+    {
+        // Make sure the messages logged just before the application
+        // exits are still written.
+        std::call_once(registerExit, []()
+        {
+            std::atexit(&StopAsyncLog);
+        });
+
+        mAsyncStop = false;
+        mAsyncEnabled = true;
+        mAsyncThread = std::thread([this]()
+        {
+            AsyncWriterMain();
+        });
+    }
+    else
+    {
+        // New messages are written directly from here on.
+        mAsyncEnabled = false;
+        mAsyncStop = true;
+        mAsyncCondition.notify_one();
+
+        auto thread = std::move(mAsyncThread);
+        lock.unlock();
+
+        thread.join();
+
+        // Wait for any thread that saw asynchronous logging still enabled
+        // to finish queueing its message.
+        while(0 != mAsyncProducers)
+        {
+            std::this_thread::yield();
+        }
+
+        // Write the messages queued after the last batch.
+        DrainBuffers();
+    }
+}
+
+size_t Log::GetAsyncBufferSize() const
+{
+    return mAsyncBufferSize;
+}
+
+void Log::SetAsyncBufferSize(size_t size)
+{
+    mAsyncBufferSize = size;
+}
+
+Log::SyncPolicy_t Log::GetSyncPolicy() const
+{
+    return (SyncPolicy_t)mSyncPolicy.load();
+}
+
+void Log::SetSyncPolicy(SyncPolicy_t policy)
+{
+    mSyncPolicy = policy;
+}
+
+uint64_t Log::GetDroppedMessageCount() const
+{
+    return mDroppedCount;
+}
+
+void Log::Flush()
+{
+    if(mAsyncEnabled)
+    {
+        DrainBuffers();
+    }
+}
+
 int Log::GetLogRotationDays() const
 {
     return mLogRotationDays;
@@ -595,3 +1013,34 @@ bool Log::FileDelete(const libcomp::String& file)
     return 0 == unlink(file.C());
 #endif
 }
+
+bool Log::FileSync(const libcomp::String& file)
+{
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(file.Replace("/", "\\").C(), GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if(INVALID_HANDLE_VALUE == hFile)
+    {
+        return false;
+    }
+
+    bool result = FALSE != FlushFileBuffers(hFile);
+    CloseHandle(hFile);
+
+    return result;
+#else
+    int fd = open(file.C(), O_WRONLY | O_APPEND);
+
+    if(0 > fd)
+    {
+        return false;
+    }
+
+    bool result = 0 == fsync(fd);
+    close(fd);
+
+    return result;
+#endif
+}
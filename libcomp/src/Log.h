@@ -29,15 +29,22 @@
 
 #include "CString.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <fstream>
 #include <functional>
+#include <thread>
 #include <unordered_map>
 
 namespace libcomp
 {
 
+class LogBuffer;
+
 /**
  * Logging interface capable of logging messages to the terminal or a file.
  * The Log class is implemented as a singleton. The constructor should not be
@@ -64,6 +71,17 @@ namespace libcomp
  * log level, the message, and the user data provided by the @ref AddLogHook
  * method. For more information on the function prototype, see the docs for
  * @ref Log::Hook_t and @ref AddLogHook.
+ *
+ * By default each message is written to the log file and passed to the hooks
+ * on the thread that logged it. When @ref SetAsyncEnabled is turned on, the
+ * message is instead placed in a fixed size ring buffer owned by the logging
+ * thread and a single writer thread formats, writes and flushes the messages
+ * in batches. When the buffer of a thread is full, new messages from that
+ * thread are dropped and counted (see @ref GetDroppedMessageCount) instead of
+ * blocking the thread. Critical messages are never queued; everything
+ * queued before one is written first and then it is written directly. The
+ * logging macros check that the level is enabled before the message
+ * argument is built.
  */
 class Log
 {
@@ -81,6 +99,19 @@ public:
         LOG_LEVEL_COUNT,
     } Level_t;
 
+    /**
+     * When the log file is synchronized to disk with asynchronous logging.
+     */
+    typedef enum
+    {
+        /// Leave writing the log file to disk up to the operating system
+        LOG_SYNC_NONE = 0,
+        /// Synchronize the log file at most once every second
+        LOG_SYNC_INTERVAL,
+        /// Synchronize the log file after every batch of messages
+        LOG_SYNC_BATCH,
+    } SyncPolicy_t;
+
     /**
      * Prototype of a function to be called when a log event occurs. When a log
      * message is generated, @em level describes the error level of the message,
@@ -229,6 +260,60 @@ public:
      */
     void SetLogRotationDays(int days);
 
+    /**
+     * Get if messages are written by the asynchronous writer thread.
+     * @return true if asynchronous logging is enabled.
+     */
+    bool GetAsyncEnabled() const;
+
+    /**
+     * Set if messages are written by the asynchronous writer thread. This
+     * starts or stops the writer thread. When it is stopped, all messages
+     * that have been queued are written first.
+     * @param enabled If asynchronous logging is enabled.
+     */
+    void SetAsyncEnabled(bool enabled);
+
+    /**
+     * Get the number of messages each thread can queue for the writer
+     * thread before new messages are dropped.
+     * @return Number of messages each thread can queue.
+     */
+    size_t GetAsyncBufferSize() const;
+
+    /**
+     * Set the number of messages each thread can queue for the writer
+     * thread before new messages are dropped. This only applies to
+     * threads that have not logged a message asynchronously yet.
+     * @param size Number of messages each thread can queue.
+     */
+    void SetAsyncBufferSize(size_t size);
+
+    /**
+     * Get when the log file is synchronized to disk by the writer thread.
+     * @return Synchronization policy of the log file.
+     */
+    SyncPolicy_t GetSyncPolicy() const;
+
+    /**
+     * Set when the log file is synchronized to disk by the writer thread.
+     * @param policy Synchronization policy of the log file.
+     */
+    void SetSyncPolicy(SyncPolicy_t policy);
+
+    /**
+     * Get the number of messages dropped because the buffer of the thread
+     * that logged them was full.
+     * @return Number of messages dropped.
+     */
+    uint64_t GetDroppedMessageCount() const;
+
+    /**
+     * Write all messages queued for the writer thread before returning.
+     * This does nothing if asynchronous logging is disabled.
+     */
+    void Flush();
+
 protected:
     /**
      * @internal
@@ -268,6 +353,55 @@ protected:
      */
     static bool FileDelete(const libcomp::String& file);
 
+    /**
+     * @internal
+     * Synchronize the contents of a file to disk.
+     * @return true if the file was synchronized; false otherwise.
+     */
+    static bool FileSync(const libcomp::String& file);
+
+    /**
+     * @internal
+     * Write a message to the log file and pass it to the hooks. The log
+     * mutex must be locked when this is called.
+     * @param level Logging level of the message.
+     * @param msg The message to log.
+     * @param time Time the message was logged.
+     */
+    void WriteMessage(Level_t level, const String& msg,
+        const std::chrono::system_clock::time_point& time);
+
+    /**
+     * @internal
+     * Queue a message in the buffer of the current thread for the writer
+     * thread or count it as dropped if the buffer is full.
+     * @param level Log level of the message.
+     * @param msg Message to queue.
+     * @param time Time the message was logged.
+     */
+    void QueueMessage(Level_t level, const String& msg,
+        const std::chrono::system_clock::time_point& time);
+
+    /**
+     * @internal
+     * Get the buffer the current thread queues messages in, creating it if
+     * needed.
+     * @return Pointer to the buffer for the current thread.
+     */
+    std::shared_ptr<LogBuffer> GetThreadBuffer();
+
+    /**
+     * @internal
+     * Main loop of the asynchronous writer thread.
+     */
+    void AsyncWriterMain();
+
+    /**
+     * @internal
+     * Write every message queued in the thread buffers.
+     */
+    void DrainBuffers();
+
     /**
      * @internal
      * Path to the log file.
@@ -341,6 +475,97 @@ protected:
      */
     int64_t mLastLog;
 
+    /**
+     * @internal
+     * Whether messages are written by the asynchronous writer thread.
+     */
+    std::atomic<bool> mAsyncEnabled;
+
+    /**
+     * @internal
+     * Number of messages each thread can queue for the writer thread.
+     */
+    std::atomic<size_t> mAsyncBufferSize;
+
+    /**
+     * @internal
+     * When the log file is synchronized to disk by the writer thread.
+     */
+    std::atomic<int> mSyncPolicy;
+
+    /**
+     * @internal
+     * Number of messages dropped because a thread buffer was full.
+     */
+    std::atomic<uint64_t> mDroppedCount;
+
+    /**
+     * @internal
+     * Number of dropped messages that have been reported in the log.
+     */
+    uint64_t mDroppedReported;
+
+    /**
+     * @internal
+     * Sequence number of the next message queued so the writer thread can
+     * keep messages from different threads in order.
+     */
+    std::atomic<uint64_t> mSequence;
+
+    /**
+     * @internal
+     * Number of threads currently queueing a message.
+     */
+    std::atomic<uint32_t> mAsyncProducers;
+
+    /**
+     * @internal
+     * Buffers of every thread that has queued a message.
+     */
+    std::list<std::shared_ptr<LogBuffer>> mBuffers;
+
+    /**
+     * @internal
+     * Mutex for the list of thread buffers.
+     */
+    std::mutex mBuffersLock;
+
+    /**
+     * @internal
+     * Mutex held while the thread buffers are being drained.
+     */
+    std::mutex mDrainLock;
+
+    /**
+     * @internal
+     * Mutex for starting, stopping and waking the writer thread.
+     */
+    std::mutex mAsyncLock;
+
+    /**
+     * @internal
+     * Condition used to wake the writer thread early.
+     */
+    std::condition_variable mAsyncCondition;
+
+    /**
+     * @internal
+     * Set when the writer thread should exit.
+     */
+    bool mAsyncStop;
+
+    /**
+     * @internal
+     * Asynchronous writer thread.
+     */
+    std::thread mAsyncThread;
+
+    /**
+     * @internal
+     * Time the log file was last synchronized to disk.
+     */
+    std::chrono::steady_clock::time_point mLastSync;
+
 #ifdef _WIN32
     /**
      * @internal
@@ -352,14 +577,28 @@ protected:
 
 } // namespace libcomp
 
+/**
+ * %Log a message if the level is enabled. The message is only built if the
+ * level is enabled.
+ * @param level Logging level of the message.
+ * @param msg The message to log.
+ * @sa Log::LogMessage
+ * @relates Log
+ */
+#define LOG_MESSAGE(level, msg) do { \
+    libcomp::Log *pLogInst_ = libcomp::Log::GetSingletonPtr(); \
+    if(pLogInst_->GetLogLevelEnabled(level)) \
+    { \
+        pLogInst_->LogMessage(level, msg); \
+    } } while(0)
+
 /**
  * %Log a critical error message.
  * @param msg The message to log.
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_CRITICAL(msg) libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_CRITICAL, msg)
+#define LOG_CRITICAL(msg) LOG_MESSAGE(libcomp::Log::LOG_LEVEL_CRITICAL, msg)
 
 /**
  * %Log an error message.
@@ -367,8 +606,7 @@ protected:
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_ERROR(msg)    libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_ERROR, msg)
+#define LOG_ERROR(msg)    LOG_MESSAGE(libcomp::Log::LOG_LEVEL_ERROR, msg)
 
 /**
  * %Log a warning message.
@@ -376,8 +614,7 @@ protected:
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_WARNING(msg)  libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_WARNING, msg)
+#define LOG_WARNING(msg)  LOG_MESSAGE(libcomp::Log::LOG_LEVEL_WARNING, msg)
 
 /**
  * %Log a informational message.
@@ -385,8 +622,7 @@ protected:
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_INFO(msg)     libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_INFO, msg)
+#define LOG_INFO(msg)     LOG_MESSAGE(libcomp::Log::LOG_LEVEL_INFO, msg)
 
 /**
  * %Log a debug message.
@@ -394,7 +630,6 @@ protected:
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_DEBUG(msg)    libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_DEBUG, msg)
+#define LOG_DEBUG(msg)    LOG_MESSAGE(libcomp::Log::LOG_LEVEL_DEBUG, msg)
 
 #endif // LIBCOMP_SRC_LOG_H
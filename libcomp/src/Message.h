@@ -44,6 +44,8 @@ enum class MessageType
     MESSAGE_TYPE_SYSTEM,        //!< Message is a special system message type.
     MESSAGE_TYPE_PACKET,        //!< Message is of type @ref MessagePacket.
     MESSAGE_TYPE_CONNECTION,    //!< Message is of type @ref ConnectionMessage.
+    MESSAGE_TYPE_SHUTDOWN,      //!< Message is of type @ref Shutdown.
+    MESSAGE_TYPE_EXECUTE,       //!< Message is of type @ref Execute.
 };
 
 /**
@@ -86,7 +86,7 @@ public:
 
     virtual MessageType GetType() const
     {
-        return MessageType::MESSAGE_TYPE_SYSTEM;
+        return MessageType::MESSAGE_TYPE_EXECUTE;
     }
 
     virtual libcomp::String Dump() const override
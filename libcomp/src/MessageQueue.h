@@ -27,9 +27,17 @@
 #ifndef LIBCOMP_SRC_MESSAGEQUEUE_H
 #define LIBCOMP_SRC_MESSAGEQUEUE_H
 
+// Standard C++11 Includes
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <list>
 #include <mutex>
-#include <condition_variable>
+#include <utility>
+#include <vector>
 
 namespace libcomp
 {
@@ -39,27 +47,58 @@ namespace libcomp
  * handled by a server. Messages queues are shared by both server
  * @ref Worker instances as well as each @ref EncryptedConnection that
  * connects to the server but is not limited to this usage.
+ *
+ * Any number of threads may enqueue but only one thread may dequeue.
+ * Producers claim a cell of a fixed size ring with a compare and swap and
+ * move their message into it so an enqueue never takes a lock or allocates.
+ * A list of messages is spliced into a single cell instead. If the ring
+ * fills up messages spill into a locked overflow deque (allocated a block
+ * at a time) until the consumer empties the ring so the queue is never
+ * bounded. The consumer keeps the messages it has taken in a vector that is
+ * reused between calls. The consumer is only signalled by the first
+ * enqueue after it starts waiting.
+ *
+ * Instead of a thread waiting on the queue a ready handler may be set which
+ * is called by the first enqueue after the queue was released. The handler
+ * is expected to hand the queue to a single consumer which dequeues and
+ * releases it again. This lets a pool of workers run a queue without more
+ * than one of them dequeuing from it at the same time.
  */
 template<class T>
 class MessageQueue
 {
 public:
+    /**
+     * Create an empty queue.
+     */
+    MessageQueue() : mEnqueuePosition(0), mOverflowing(false),
+        mConsumerWaiting(false), mDequeuePosition(0), mPendingStart(0)
+    {
+        for(size_t i = 0; i < CELL_COUNT; i++)
+        {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MessageQueue(const MessageQueue& other) = delete;
+    MessageQueue& operator=(const MessageQueue& other) = delete;
+
     /**
      * Enqueue a message.
      * @param Message to add
      */
     void Enqueue(T item)
     {
-        mQueueLock.lock();
-        bool wasEmpty = mQueue.empty();
-        mQueue.push_back(item);
-        mQueueLock.unlock();
-
-        if(wasEmpty)
+        // Once the ring has spilled keep using the overflow deque so the
+        // messages from each producer stay in order.
+        if(mOverflowing.load() || !TryPush(item))
         {
-            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
-            mEmptyCondition.notify_one();
+            std::lock_guard<std::mutex> lock(mOverflowLock);
+            mOverflow.push_back(std::move(item));
+            mOverflowing.store(true);
         }
+
+        Signal();
     }
 
     /**
@@ -68,37 +107,45 @@ public:
      */
     void Enqueue(std::list<T>& items)
     {
-        mQueueLock.lock();
-        bool wasEmpty = mQueue.empty();
-        mQueue.splice(mQueue.end(), items);
-        mQueueLock.unlock();
+        if(items.empty())
+        {
+            return;
+        }
 
-        if(wasEmpty)
+        if(mOverflowing.load() || !TryPush(items))
         {
-            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
-            mEmptyCondition.notify_one();
+            std::lock_guard<std::mutex> lock(mOverflowLock);
+
+            for(auto& item : items)
+            {
+                mOverflow.push_back(std::move(item));
+            }
+
+            items.clear();
+            mOverflowing.store(true);
         }
+
+        Signal();
     }
 
     /**
      * Dequeue the first message added and wait if empty.
      * @return The first message added
+     * @note Only one thread may dequeue from the queue.
      */
     T Dequeue()
     {
-        mQueueLock.lock();
+        if(mPendingStart == mPending.size())
+        {
+            Take();
+        }
 
-        if(mQueue.empty())
+        if(mPendingStart == mPending.size())
         {
-            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
-            mQueueLock.unlock();
-            mEmptyCondition.wait(uniqueLock);
-            mQueueLock.lock();
+            Wait();
         }
 
-        T item = mQueue.front();
-        mQueue.pop_front();
-        mQueueLock.unlock();
+        T item = std::move(mPending[mPendingStart++]);
 
         return item;
     }
@@ -106,54 +153,359 @@ public:
     /**
      * Dequeue all the messages and wait if its empty.
      * @param List to add the messages to
+     * @note Only one thread may dequeue from the queue.
      */
     void DequeueAll(std::list<T>& destinationQueue)
     {
-        std::list<T> tempQueue;
+        Take();
+        Wait();
+        MovePending(destinationQueue);
+    }
+
+    /**
+     * Dequeue all the messages and wait if its empty. Unlike the list
+     * version this does not allocate once the vector has grown to fit.
+     * @param Vector to add the messages to
+     * @note Only one thread may dequeue from the queue.
+     */
+    void DequeueAll(std::vector<T>& destinationQueue)
+    {
+        Take();
+        Wait();
+        MovePending(destinationQueue);
+    }
+
+    /**
+     * Dequeue all the current messages.
+     * @param List to add the messages to
+     * @note Only one thread may dequeue from the queue.
+     */
+    void DequeueAny(std::list<T>& destinationQueue)
+    {
+        Take();
+        MovePending(destinationQueue);
+    }
+
+    /**
+     * Dequeue all the current messages. Unlike the list version this does
+     * not allocate once the vector has grown to fit.
+     * @param Vector to add the messages to
+     * @note Only one thread may dequeue from the queue.
+     */
+    void DequeueAny(std::vector<T>& destinationQueue)
+    {
+        Take();
+        MovePending(destinationQueue);
+    }
+
+    /**
+     * Set a function to call when a message is enqueued to the queue after
+     * it has been released instead of waking a waiting consumer. The queue
+     * starts out released.
+     * @param handler Function to call when the queue has messages again
+     * @note This must be set before any messages are enqueued.
+     */
+    void SetReadyHandler(const std::function<void()>& handler)
+    {
+        mReadyHandler = handler;
+        mConsumerWaiting.store(true);
+    }
+
+    /**
+     * Release the queue after dequeuing from it so the next enqueue calls
+     * the ready handler.
+     * @return true if messages were enqueued before the queue could be
+     *  released and the caller is still the consumer; false if the queue
+     *  was released
+     * @sa SetReadyHandler
+     */
+    bool Release()
+    {
+        mConsumerWaiting.store(true);
+
+        return (mPendingStart != mPending.size() || HasMessages()) &&
+            mConsumerWaiting.exchange(false);
+    }
+
+private:
+    /// Number of cells in the ring (must be a power of two)
+    static const size_t CELL_COUNT = 256;
+
+    /**
+     * Messages added by a single call to @ref Enqueue.
+     */
+    struct Cell
+    {
+        /// Position the cell is free for or one past the position it
+        /// holds messages for
+        std::atomic<size_t> sequence;
+
+        /// Message added on its own
+        T item;
+
+        /// Messages added together in the order they were added or empty
+        /// if the cell holds a single message
+        std::list<T> items;
+    };
+
+    /**
+     * Claim the next cell of the ring.
+     * @param position Set to the position of the cell claimed
+     * @return Cell claimed or nullptr if the ring is full
+     */
+    Cell* Claim(size_t& position)
+    {
+        position = mEnqueuePosition.load(std::memory_order_relaxed);
+
+        for(;;)
+        {
+            Cell *pCell = &mCells[position & (CELL_COUNT - 1)];
+
+            intptr_t diff = (intptr_t)pCell->sequence.load(
+                std::memory_order_acquire) - (intptr_t)position;
+
+            if(0 == diff)
+            {
+                if(mEnqueuePosition.compare_exchange_weak(position,
+                    position + 1, std::memory_order_relaxed))
+                {
+                    return pCell;
+                }
+            }
+            else if(0 > diff)
+            {
+                return nullptr;
+            }
+            else
+            {
+                position = mEnqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Claim the next cell of the ring and move the message into it.
+     * @param item Message to move; left alone if the ring is full
+     * @return true if a cell was free; false if the ring is full
+     */
+    bool TryPush(T& item)
+    {
+        size_t position;
+        Cell *pCell = Claim(position);
+
+        if(!pCell)
+        {
+            return false;
+        }
 
-        mQueueLock.lock();
+        pCell->item = std::move(item);
+        pCell->sequence.store(position + 1);
+
+        return true;
+    }
+
+    /**
+     * Claim the next cell of the ring and move the messages into it.
+     * @param items Messages to move; left alone if the ring is full
+     * @return true if a cell was free; false if the ring is full
+     */
+    bool TryPush(std::list<T>& items)
+    {
+        size_t position;
+        Cell *pCell = Claim(position);
 
-        if(mQueue.empty())
+        if(!pCell)
         {
-            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
-            mQueueLock.unlock();
-            mEmptyCondition.wait(uniqueLock);
-            mQueueLock.lock();
+            return false;
         }
 
-        mQueue.swap(tempQueue);
-        mQueueLock.unlock();
+        pCell->items.splice(pCell->items.end(), items);
+        pCell->sequence.store(position + 1);
 
-        destinationQueue.splice(destinationQueue.end(), tempQueue);
+        return true;
     }
 
     /**
-     * Dequeue all the current messages.
-     * @param List to add the messages to
+     * Wake the consumer or call the ready handler if this is the first
+     * enqueue since the consumer started waiting.
      */
-    void DequeueAny(std::list<T>& destinationQueue)
+    void Signal()
+    {
+        // Only the first enqueue after the consumer starts waiting will
+        // find the flag set.
+        if(mConsumerWaiting.load() && mConsumerWaiting.exchange(false))
+        {
+            if(mReadyHandler)
+            {
+                mReadyHandler();
+            }
+            else
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mWaitLock);
+                }
+
+                mWaitCondition.notify_one();
+            }
+        }
+    }
+
+    /**
+     * Check if there is anything for the consumer to take.
+     * @return true if a call to @ref Take will not come back empty
+     */
+    bool HasMessages() const
     {
-        std::list<T> tempQueue;
+        const Cell& cell = mCells[mDequeuePosition & (CELL_COUNT - 1)];
 
-        mQueueLock.lock();
-        mQueue.swap(tempQueue);
-        mQueueLock.unlock();
+        if(cell.sequence.load() == mDequeuePosition + 1)
+        {
+            return true;
+        }
 
-        destinationQueue.splice(destinationQueue.end(), tempQueue);
+        // The overflow deque is only taken once the ring is empty.
+        return mOverflowing.load() &&
+            mEnqueuePosition.load() == mDequeuePosition;
     }
 
-private:
-    /// The list of messages
-    std::list<T> mQueue;
+    /**
+     * Move everything enqueued so far onto the end of the pending vector.
+     */
+    void Take()
+    {
+        // Reuse the space of the messages already dequeued.
+        if(mPendingStart == mPending.size())
+        {
+            mPending.clear();
+            mPendingStart = 0;
+        }
+
+        for(;;)
+        {
+            Cell& cell = mCells[mDequeuePosition & (CELL_COUNT - 1)];
 
-    /// Mutex lock to use when modifying the queue
-    std::mutex mQueueLock;
+            if(cell.sequence.load(std::memory_order_acquire) !=
+                mDequeuePosition + 1)
+            {
+                break;
+            }
 
-    /// Mutix lock to use when waiting for a message to be queued
-    std::mutex mEmptyConditionLock;
+            if(cell.items.empty())
+            {
+                mPending.push_back(std::move(cell.item));
+            }
+            else
+            {
+                for(auto& item : cell.items)
+                {
+                    mPending.push_back(std::move(item));
+                }
+
+                cell.items.clear();
+            }
+
+            cell.sequence.store(mDequeuePosition + CELL_COUNT,
+                std::memory_order_release);
+            mDequeuePosition++;
+        }
+
+        // Every message in the overflow deque was added after the messages
+        // in the ring from the same producer.
+        if(mOverflowing.load() && mEnqueuePosition.load() == mDequeuePosition)
+        {
+            std::lock_guard<std::mutex> lock(mOverflowLock);
+
+            for(auto& item : mOverflow)
+            {
+                mPending.push_back(std::move(item));
+            }
+
+            mOverflow.clear();
+            mOverflowing.store(false);
+        }
+    }
+
+    /**
+     * Move the messages taken but not dequeued yet onto the end of a
+     * container.
+     * @param destinationQueue Container to add the messages to
+     */
+    template<typename Container>
+    void MovePending(Container& destinationQueue)
+    {
+        for(size_t i = mPendingStart; i < mPending.size(); i++)
+        {
+            destinationQueue.push_back(std::move(mPending[i]));
+        }
+
+        mPending.clear();
+        mPendingStart = 0;
+    }
+
+    /**
+     * Wait until something is enqueued and take it.
+     */
+    void Wait()
+    {
+        while(mPendingStart == mPending.size())
+        {
+            {
+                std::unique_lock<std::mutex> lock(mWaitLock);
+
+                // Setting the flag before each check pairs with the
+                // enqueue publishing the message before it checks the flag
+                // so one of the two always sees the other.
+                mWaitCondition.wait(lock, [this]()
+                {
+                    mConsumerWaiting.store(true);
+
+                    return HasMessages();
+                });
+
+                mConsumerWaiting.store(false);
+            }
+
+            Take();
+        }
+    }
+
+    /// Ring of cells producers add messages to
+    std::array<Cell, CELL_COUNT> mCells;
+
+    /// Position the next producer will claim
+    std::atomic<size_t> mEnqueuePosition;
+
+    /// Messages added after the ring was full
+    std::deque<T> mOverflow;
+
+    /// Mutex lock to use when modifying the overflow deque
+    std::mutex mOverflowLock;
+
+    /// Indicates the overflow deque has messages
+    std::atomic<bool> mOverflowing;
+
+    /// Indicates the consumer is waiting for a message to be queued or the
+    /// queue has been released
+    std::atomic<bool> mConsumerWaiting;
+
+    /// Mutex lock to use when waiting for a message to be queued
+    std::mutex mWaitLock;
 
     /// Blocking condition to wait for when no messages are queued
-    std::condition_variable mEmptyCondition;
+    std::condition_variable mWaitCondition;
+
+    /// Function to call instead of waking the consumer
+    std::function<void()> mReadyHandler;
+
+    /// Position of the next cell the consumer will take
+    size_t mDequeuePosition;
+
+    /// Messages taken by the consumer; the ones before the start have
+    /// already been dequeued
+    std::vector<T> mPending;
+
+    /// Index of the first message in the pending vector not dequeued yet
+    size_t mPendingStart;
 };
 
 } // namespace libcomp
@@ -38,7 +38,7 @@ Message::Shutdown::~Shutdown()
 
 Message::MessageType Message::Shutdown::GetType() const
 {
-    return MessageType::MESSAGE_TYPE_SYSTEM;
+    return MessageType::MESSAGE_TYPE_SHUTDOWN;
 }
 
 libcomp::String Message::Shutdown::Dump() const
@@ -86,6 +86,123 @@ public:
     std::list<uint16_t> dynamicSizes;
 };
 
+/**
+ * Mutex that locks access to the fields of a generated object. The lock is
+ * declared by each generated object that is not derived from another one
+ * and is not immutable so objects that never change after they are loaded
+ * do not carry a mutex at all. The lock is recursive so the object may be
+ * read from the thread holding an @ref ObjectFieldView of it. Copying an
+ * object must not copy the state of the lock so a copy always gets a new
+ * unlocked mutex.
+ */
+class ObjectFieldLock : public std::recursive_mutex
+{
+public:
+    /**
+     * Create an unlocked mutex.
+     */
+    ObjectFieldLock() { }
+
+    /**
+     * Create an unlocked mutex for a copy of an object.
+     * @param other Lock of the object being copied
+     */
+    ObjectFieldLock(const ObjectFieldLock& other) : std::recursive_mutex()
+    {
+        (void)other;
+    }
+
+    /**
+     * Keep the current mutex when an object is assigned to.
+     * @param other Lock of the object being assigned from
+     * @return Reference to this lock
+     */
+    ObjectFieldLock& operator=(const ObjectFieldLock& other)
+    {
+        (void)other;
+
+        return *this;
+    }
+};
+
+/**
+ * Read only view of a container field of a generated object. The field lock
+ * of the object is held for as long as the view exists so the container can
+ * be read in place instead of being copied. The view is meant to be used as
+ * a temporary in a range based for loop or kept in a short lived local.
+ * The thread holding the view may still read the object but must not
+ * change the container being viewed. The view must not be held across a
+ * call that can lock another object or two threads viewing each other's
+ * objects can deadlock; copy the values out first instead. Views of
+ * immutable objects do not lock. The lock type may be changed for views of
+ * fields that are guarded by some other mutex.
+ */
+template<typename T, typename Mutex = std::recursive_mutex>
+class ObjectFieldView
+{
+public:
+    /**
+     * Create a view of a field of an immutable object.
+     * @param field Container being viewed
+     */
+    ObjectFieldView(const T& field) : mField(field)
+    {
+    }
+
+    /**
+     * Create a view of a field and hold the field lock.
+     * @param lock Field lock of the object
+     * @param field Container being viewed
+     */
+    ObjectFieldView(Mutex& lock, const T& field) : mLock(lock),
+        mField(field)
+    {
+    }
+
+    /**
+     * Get the container being viewed.
+     * @return Reference to the container
+     */
+    const T& operator*() const
+    {
+        return mField;
+    }
+
+    /**
+     * Access the container being viewed.
+     * @return Pointer to the container
+     */
+    const T* operator->() const
+    {
+        return &mField;
+    }
+
+    /**
+     * Get an iterator to the start of the container.
+     * @return Iterator to the first element
+     */
+    typename T::const_iterator begin() const
+    {
+        return mField.begin();
+    }
+
+    /**
+     * Get an iterator to the end of the container.
+     * @return Iterator past the last element
+     */
+    typename T::const_iterator end() const
+    {
+        return mField.end();
+    }
+
+private:
+    /// Field lock held by the view or an empty lock for immutable objects
+    std::unique_lock<Mutex> mLock;
+
+    /// Container being viewed
+    const T& mField;
+};
+
 /**
  * Abstract base class that represents any object that can be defined
  * via a MetaObject definition and corresonding value assignment
@@ -103,8 +220,7 @@ public:
     Object();
 
     /**
-     * Explicitly defined copy constructor necessary due to removal
-     *  of implicit constructor from non-copyable mutex member.
+     * Create a copy of an object.
      * @param other The other object to copy
      */
     Object(const Object& other);
@@ -279,9 +395,6 @@ protected:
      * @return true if the stream is still good after writing
      */
     bool WritePadding(std::ostream& stream, uint8_t count) const;
-
-    /// Mutex to lock accessing the object fields
-    std::mutex mFieldLock;
 };
 
 } // namespace libcomp
@@ -241,10 +241,8 @@ public:
      */
     static bool Unload(const libobjgen::UUID& uuid)
     {
-        std::string uuidStr = uuid.ToString();
-
         std::lock_guard<std::mutex> lock(mReferenceLock);
-        auto iter = sData.find(uuidStr);
+        auto iter = sData.find(uuid);
         if(iter != sData.end())
         {
             bool loaded = iter->second->mRef != nullptr;
@@ -341,26 +339,24 @@ protected:
 
         if(!uuid.IsNull())
         {
-            std::string uuidStr = uuid.ToString();
-
             std::lock_guard<std::mutex> lock(mReferenceLock);
-            auto iter = sData.find(uuidStr);
-            if(iter == sData.end())
+            auto& data = sData[uuid];
+            if(data == nullptr)
             {
-                sData[uuidStr] = std::shared_ptr<ObjectReferenceData>(
+                data = std::shared_ptr<ObjectReferenceData>(
                     new ObjectReferenceData(ref, uuid));
             }
-            else if(sData[uuidStr]->mRef == nullptr)
+            else if(data->mRef == nullptr)
             {
-                sData[uuidStr]->mRef = ref;
+                data->mRef = ref;
             }
 
             if(ref == nullptr && setLoadFailure)
             {
-                sData[uuidStr]->mLoadFailed = true;
+                data->mLoadFailed = true;
             }
 
-            mData = sData[uuidStr];
+            mData = data;
         }
         else
         {
@@ -385,14 +381,15 @@ protected:
     {
         if(mData != nullptr && !mData->mUUID.IsNull())
         {
-            std::string uuidStr = mData->mUUID.ToString();
+            auto uuid = mData->mUUID;
 
             std::lock_guard<std::mutex> lock(mReferenceLock);
             mData = sNull;
 
-            if(sData[uuidStr].use_count() == 1)
+            auto iter = sData.find(uuid);
+            if(iter != sData.end() && iter->second.use_count() == 1)
             {
-                sData.erase(uuidStr);
+                sData.erase(iter);
             }
         }
         else
@@ -405,7 +402,7 @@ protected:
     std::shared_ptr<ObjectReferenceData> mData;
 
     /// Static cache of non-null UUIDs to persistent objects
-    static std::unordered_map<std::string,
+    static std::unordered_map<libobjgen::UUID,
         std::shared_ptr<ObjectReferenceData>> sData;
 
     /// Default value of mData instantiated once to avoid newing up
@@ -417,7 +414,7 @@ protected:
 };
 
 template<class T>
-std::unordered_map<std::string, std::shared_ptr<ObjectReferenceData>>
+std::unordered_map<libobjgen::UUID, std::shared_ptr<ObjectReferenceData>>
     ObjectReference<T>::sData;
 
 template<class T>
@@ -29,6 +29,7 @@
 #include "Compress.h"
 #include "Endian.h"
 #include "Log.h"
+#include "PacketBufferPool.h"
 #include "PacketException.h"
 #include "ScriptEngine.h"
 
@@ -42,9 +43,33 @@
 
 #include <cstring>
 #include <cstdio>
+#include <vector>
 
 using namespace libcomp;
 
+namespace
+{
+
+/// Scratch buffer used when compressing or decompressing on this thread.
+thread_local std::vector<uint8_t> tScratch;
+
+/**
+ * Get the scratch buffer for the thread.
+ * @param sz Minimum size of the buffer
+ * @return Pointer to the scratch buffer
+ */
+uint8_t* Scratch(size_t sz)
+{
+    if(tScratch.size() < sz)
+    {
+        tScratch.resize(sz);
+    }
+
+    return &tScratch[0];
+}
+
+} // namespace
+
 Packet::Packet() : ReadOnlyPacket()
 {
     // Ensure the packet is clear and the variables are set.
@@ -52,9 +77,9 @@ Packet::Packet() : ReadOnlyPacket()
 }
 
 Packet::Packet(const Packet& other) : ReadOnlyPacket(other.mPosition,
-    other.mSize, nullptr, nullptr)
+    other.mSize, 0, nullptr, nullptr)
 {
-    Allocate();
+    Reserve(other.mSize);
 
     // Make sure the data pointer is valid first.
     if(nullptr != mData)
@@ -64,10 +89,11 @@ Packet::Packet(const Packet& other) : ReadOnlyPacket(other.mPosition,
 }
 
 Packet::Packet(Packet&& other) : ReadOnlyPacket(other.mPosition, other.mSize,
-    other.mData, other.mDataRef)
+    other.mCapacity, other.mData, other.mDataRef)
 {
     other.mPosition = 0;
     other.mSize = 0;
+    other.mCapacity = 0;
     other.mDataRef.reset();
     other.mData = nullptr;
 
@@ -148,7 +174,9 @@ void Packet::GrowPacket(uint32_t sz)
     }
     else
     {
-        // The new packet size is valid, set it.
+        // The new packet size is valid, make sure the buffer can hold it
+        // and set it.
+        Reserve(newSize);
         mSize = newSize;
     }
 }
@@ -203,74 +231,118 @@ void Packet::WriteArray(const void *pData, uint32_t sz)
 void Packet::WriteString(Convert::Encoding_t encoding, const String& str,
     bool nullTerminate)
 {
-    // Convert the string to the requested encoding and write it.
-    WriteArray(Convert::ToEncoding(encoding, str, nullTerminate));
+    // Convert the string to the requested encoding straight into the
+    // packet and skip over it.
+    SkipWritten(EncodeString(encoding, str, nullTerminate, 0));
 }
 
 void Packet::WriteString32(Convert::Encoding_t encoding, const String& str,
     bool nullTerminate)
 {
-    // Convert the string to the requested encoding.
-    std::vector<char> strd = Convert::ToEncoding(encoding, str, nullTerminate);
+    // Convert the string to the requested encoding straight into the
+    // packet after the size of the string data.
+    uint32_t sz = EncodeString(encoding, str, nullTerminate, 4);
 
-    // Write the size of the string data and the string.
-    WriteU32((uint32_t)strd.size());
-    WriteArray(strd);
+    // Write the size of the string data and skip over the string.
+    WriteU32(sz);
+    SkipWritten(sz);
 }
 
 void Packet::WriteString32Big(Convert::Encoding_t encoding, const String& str,
     bool nullTerminate)
 {
-    // Convert the string to the requested encoding.
-    std::vector<char> strd = Convert::ToEncoding(encoding, str, nullTerminate);
+    // Convert the string to the requested encoding straight into the
+    // packet after the size of the string data.
+    uint32_t sz = EncodeString(encoding, str, nullTerminate, 4);
 
-    // Write the size of the string data and the string.
-    WriteU32Big((uint32_t)strd.size());
-    WriteArray(strd);
+    // Write the size of the string data and skip over the string.
+    WriteU32Big(sz);
+    SkipWritten(sz);
 }
 
 void Packet::WriteString32Little(Convert::Encoding_t encoding,
     const String& str, bool nullTerminate)
 {
-    // Convert the string to the requested encoding.
-    std::vector<char> strd = Convert::ToEncoding(encoding, str, nullTerminate);
+    // Convert the string to the requested encoding straight into the
+    // packet after the size of the string data.
+    uint32_t sz = EncodeString(encoding, str, nullTerminate, 4);
 
-    // Write the size of the string data and the string.
-    WriteU32Little((uint32_t)strd.size());
-    WriteArray(strd);
+    // Write the size of the string data and skip over the string.
+    WriteU32Little(sz);
+    SkipWritten(sz);
 }
 
 void Packet::WriteString16(Convert::Encoding_t encoding, const String& str,
     bool nullTerminate)
 {
-    // Convert the string to the requested encoding.
-    std::vector<char> strd = Convert::ToEncoding(encoding, str, nullTerminate);
+    // Convert the string to the requested encoding straight into the
+    // packet after the size of the string data.
+    uint32_t sz = EncodeString(encoding, str, nullTerminate, 2);
 
-    // Write the size of the string data and the string.
-    WriteU16((uint16_t)strd.size());
-    WriteArray(strd);
+    // Write the size of the string data and skip over the string.
+    WriteU16((uint16_t)sz);
+    SkipWritten(sz);
 }
 
 void Packet::WriteString16Big(Convert::Encoding_t encoding, const String& str,
     bool nullTerminate)
 {
-    // Convert the string to the requested encoding.
-    std::vector<char> strd = Convert::ToEncoding(encoding, str, nullTerminate);
+    // Convert the string to the requested encoding straight into the
+    // packet after the size of the string data.
+    uint32_t sz = EncodeString(encoding, str, nullTerminate, 2);
 
-    // Write the size of the string data and the string.
-    WriteU16Big((uint16_t)strd.size());
-    WriteArray(strd);
+    // Write the size of the string data and skip over the string.
+    WriteU16Big((uint16_t)sz);
+    SkipWritten(sz);
 }
 
 void Packet::WriteString16Little(Convert::Encoding_t encoding,
     const String& str, bool nullTerminate)
 {
-    // Convert the string to the requested encoding.
-    std::vector<char> strd = Convert::ToEncoding(encoding, str, nullTerminate);
+    // Convert the string to the requested encoding straight into the
+    // packet after the size of the string data.
+    uint32_t sz = EncodeString(encoding, str, nullTerminate, 2);
 
-    // Write the size of the string data and the string.
-    WriteU16Little((uint16_t)strd.size());
-    WriteArray(strd);
+    // Write the size of the string data and skip over the string.
+    WriteU16Little((uint16_t)sz);
+    SkipWritten(sz);
+}
+
+uint32_t Packet::EncodeString(Convert::Encoding_t encoding,
+    const String& str, bool nullTerminate, uint32_t offset)
+{
+    uint32_t start = mPosition + offset;
+
+    // The converted string is never bigger than the UTF-8 data so make
+    // room for that much. If that would not fit in a packet count the
+    // actual size first.
+    size_t maxSize = str.Size() + 1;
+
+    if(MAX_PACKET_SIZE < (start + maxSize))
+    {
+        maxSize = Convert::SizeEncoded(encoding, str) + 1;
+    }
+
+    // Make sure the buffer can hold the string (this will throw if the
+    // string can't fit in the packet) and convert it.
+    Reserve((uint32_t)(start + maxSize));
+
+    return (uint32_t)Convert::EncodeTo(encoding, str,
+        (char*)(mData + start), nullTerminate);
+}
+
+void Packet::SkipWritten(uint32_t sz)
+{
+    // If nothing was written, do nothing.
+    if(0 == sz)
+    {
+        return;
+    }
+
+    // Grow the packet by the number of bytes written and advance the
+    // current position by that many bytes.
+    GrowPacket(sz);
+    Skip(sz);
 }
 
 void Packet::WriteU8(uint8_t value)
@@ -448,7 +520,7 @@ void Packet::Clear()
     uint32_t deadbeef = 0xEFBEADDE;
 
     // Fill the buffer with "dead beef" so you can see what is and isn't data.
-    for(uint32_t i = 0; i < MAX_PACKET_SIZE; i += 4)
+    for(uint32_t i = 0; i < mCapacity; i += 4)
     {
         memcpy(mData + i, &deadbeef, 4);
     }
@@ -487,13 +559,42 @@ char* Packet::Direct(uint32_t sz)
             "size of the packet").Arg(sz), this);
     }
 
-    // Set the new size of the packet.
+    // Make sure the buffer can hold the new size then set it.
+    Reserve(sz);
     mSize = sz;
 
     // Return the pointer to the packet data.
     return reinterpret_cast<char*>(mData);
 }
 
+void Packet::Reserve(uint32_t sz)
+{
+    // Allocate the packet data (if needed).
+    Allocate();
+
+    // If the buffer is already big enough, do nothing.
+    if(sz <= mCapacity)
+    {
+        return;
+    }
+
+    if(MAX_PACKET_SIZE < sz)
+    {
+        PACKET_EXCEPTION(String("Attempted to reserve %1 bytes for the "
+            "packet; however, this size exceeds the MAX_PACKET_SIZE").Arg(
+            sz), this);
+    }
+
+    // Move the existing data into a buffer from a bigger size class.
+    uint32_t capacity = 0;
+    auto dataRef = PacketBufferPool::Acquire(sz, capacity);
+    memcpy(dataRef.get(), mData, mCapacity);
+
+    mDataRef = dataRef;
+    mData = mDataRef.get();
+    mCapacity = capacity;
+}
+
 void Packet::Split(Packet& other, uint32_t sz)
 {
     // If there is no data to split simply clear the other packet and return.
@@ -536,17 +637,13 @@ int32_t Packet::Decompress(int32_t sz)
             "packet").Arg(sz), this);
     }
 
-    // Allocate the compressed copy.
-    uint8_t *pData = new uint8_t[sz];
-
-    if(nullptr == pData)
-    {
-        return 0;
-    }
-
-    // Copy the data to decompress.
+    // Copy the data to decompress into the scratch buffer for the thread.
+    uint8_t *pData = Scratch((size_t)sz);
     memcpy(pData, mData + mPosition, (size_t)sz);
 
+    // The output could be as large as the maximum packet size.
+    Reserve(MAX_PACKET_SIZE);
+
     // Update the size of the packet.
     mSize = mPosition;
 
@@ -557,9 +654,6 @@ int32_t Packet::Decompress(int32_t sz)
     // Update the size.
     mSize += (uint32_t)written;
 
-    // Free the compressed copy.
-    delete[] pData;
-
     return written;
 }
 
@@ -580,29 +674,29 @@ int32_t Packet::Compress(int32_t sz)
             "packet").Arg(sz), this);
     }
 
-    // Allocate the compressed copy.
-    uint8_t *pData = new uint8_t[sz];
+    // Compress into the scratch buffer for the thread so the packet data
+    // does not have to be copied into a new allocation first.
+    int32_t bound = (int32_t)compressBound((uLong)sz);
+    uint8_t *pData = Scratch((size_t)bound);
+
+    // Compress the data
+    int32_t written = Compress::Compress(mData + mPosition, pData,
+        sz, bound);
 
-    if(nullptr == pData)
+    // Leave the packet as it was if the compression failed or the
+    // compressed data does not fit.
+    if(0 >= written || MAX_PACKET_SIZE < mPosition + (uint32_t)written)
     {
-        return 0;
+        return 0 < written ? -1 : written;
     }
 
-    // Copy the data to compress.
-    memcpy(pData, mData + mPosition, (size_t)sz);
-
-    // Update the size.
-    mSize = mPosition;
+    Reserve(mPosition + (uint32_t)written);
 
-    // Compress the data
-    int32_t written = Compress::Compress(pData, mData + mPosition,
-        sz, (int32_t)(MAX_PACKET_SIZE - mSize));
+    // Replace the uncompressed data.
+    memcpy(mData + mPosition, pData, (size_t)written);
 
     // Update the size.
-    mSize += (uint32_t)written;
-
-    // Free the uncompressed copy.
-    delete[] pData;
+    mSize = mPosition + (uint32_t)written;
 
     return written;
 }
@@ -611,11 +705,13 @@ Packet& Packet::operator=(Packet&& other)
 {
     mPosition = other.mPosition;
     mSize = other.mSize;
+    mCapacity = other.mCapacity;
     mDataRef = other.mDataRef;
     mData = other.mData;
 
     other.mPosition = 0;
     other.mSize = 0;
+    other.mCapacity = 0;
     other.mDataRef.reset();
     other.mData = nullptr;
 
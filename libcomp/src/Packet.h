@@ -525,6 +525,15 @@ public:
      */
     char* Direct(uint32_t sz);
 
+    /**
+     * Make sure the packet data buffer can hold at least @em sz bytes
+     * without changing the size of the packet. Use this before writing to
+     * the buffer returned by @ref Data() past the end of the packet. If
+     * @em sz exceeds MAX_PACKET_SIZE, a PacketException will be thrown.
+     * @param sz Number of bytes the buffer must be able to hold.
+     */
+    void Reserve(uint32_t sz);
+
     /**
      * %Decompress from the cursor position @em sz bytes. After the
      * decompression the current position will remain the same.
@@ -554,6 +563,26 @@ private:
      * @param count Number of bytes to add to the packet.
      */
     void GrowPacket(uint32_t count);
+
+    /**
+     * Convert a string to the requested encoding straight into the packet
+     * data without changing the size or position of the packet.
+     * @param encoding Encoding to convert the string to.
+     * @param str String to convert.
+     * @param nullTerminate Indicates if a null terminator should be written.
+     * @param offset Number of bytes after the current position to write
+     *   the string at (to leave room for the size of the string).
+     * @returns Number of bytes written.
+     */
+    uint32_t EncodeString(Convert::Encoding_t encoding, const String& str,
+        bool nullTerminate, uint32_t offset);
+
+    /**
+     * Grow the packet to include data already written at the current
+     * position and advance the position past it.
+     * @param sz Number of bytes that were written.
+     */
+    void SkipWritten(uint32_t sz);
 };
 
 } // namespace libcomp
@@ -0,0 +1,207 @@
+/**
+ * @file libcomp/src/PacketBufferPool.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pool of reusable packet data buffers.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PacketBufferPool.h"
+
+#include <atomic>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Number of buffer size classes.
+const size_t SIZE_CLASS_COUNT = 3;
+
+/// Capacity of each size class.
+const uint32_t SIZE_CLASS_CAPACITY[SIZE_CLASS_COUNT] = {
+    PacketBufferPool::SMALL_BUFFER_SIZE,
+    PacketBufferPool::MEDIUM_BUFFER_SIZE,
+    PacketBufferPool::LARGE_BUFFER_SIZE,
+};
+
+/// Maximum number of free buffers kept per thread for each size class.
+const size_t SIZE_CLASS_FREE_LIMIT[SIZE_CLASS_COUNT] = { 512, 128, 32 };
+
+/// Number of buffers handed out.
+std::atomic<uint64_t> gAcquired(0);
+
+/// Number of buffers allocated from the heap.
+std::atomic<uint64_t> gAllocated(0);
+
+/// Number of bytes allocated from the heap.
+std::atomic<uint64_t> gAllocatedBytes(0);
+
+/// Set once the free lists for the thread have been destroyed so buffers
+/// released during thread shutdown are deleted instead.
+thread_local bool tFreeListsDestroyed = false;
+
+/**
+ * Free buffers for each size class owned by a single thread.
+ */
+struct FreeLists
+{
+    /**
+     * Delete all buffers still in the free lists.
+     */
+    ~FreeLists()
+    {
+        tFreeListsDestroyed = true;
+
+        for(auto& buffers : Buffers)
+        {
+            for(uint8_t *pBuffer : buffers)
+            {
+                delete[] pBuffer;
+            }
+        }
+    }
+
+    /// Free buffers for each size class.
+    std::vector<uint8_t*> Buffers[SIZE_CLASS_COUNT];
+};
+
+/// Free lists for the current thread.
+thread_local FreeLists tFreeLists;
+
+/**
+ * Deleter that returns a buffer to the free list of the releasing thread.
+ */
+struct BufferRelease
+{
+    /// Size class the buffer belongs to.
+    size_t SizeClass;
+
+    /**
+     * Return the buffer to the pool or delete it if the free list is full.
+     * @param pBuffer Buffer to release.
+     */
+    void operator()(uint8_t *pBuffer) const
+    {
+        if(!tFreeListsDestroyed)
+        {
+            auto& buffers = tFreeLists.Buffers[SizeClass];
+            if(buffers.size() < SIZE_CLASS_FREE_LIMIT[SizeClass])
+            {
+                buffers.push_back(pBuffer);
+                return;
+            }
+        }
+
+        delete[] pBuffer;
+    }
+};
+
+/**
+ * Calculate the bytes saved compared to allocating a new MAX_PACKET_SIZE
+ * buffer for every buffer acquired.
+ * @param stats Counters to calculate the savings for.
+ * @returns Number of bytes saved.
+ */
+uint64_t GetSavedBytes(const PacketBufferPool::Stats& stats)
+{
+    uint64_t unpooled = stats.Acquired * MAX_PACKET_SIZE;
+
+    // The counters are not read atomically together so guard against the
+    // allocation counters getting ahead of the acquire counter
+    return unpooled > stats.AllocatedBytes ?
+        (unpooled - stats.AllocatedBytes) : 0;
+}
+
+} // namespace
+
+uint32_t PacketBufferPool::GetCapacity(uint32_t size)
+{
+    for(uint32_t capacity : SIZE_CLASS_CAPACITY)
+    {
+        if(size <= capacity)
+        {
+            return capacity;
+        }
+    }
+
+    return 0;
+}
+
+std::shared_ptr<uint8_t> PacketBufferPool::Acquire(uint32_t size,
+    uint32_t& capacity)
+{
+    size_t sizeClass = 0;
+    while(sizeClass < SIZE_CLASS_COUNT &&
+        size > SIZE_CLASS_CAPACITY[sizeClass])
+    {
+        sizeClass++;
+    }
+
+    if(SIZE_CLASS_COUNT <= sizeClass)
+    {
+        capacity = 0;
+        return nullptr;
+    }
+
+    capacity = SIZE_CLASS_CAPACITY[sizeClass];
+
+    gAcquired++;
+
+    uint8_t *pBuffer = nullptr;
+    if(!tFreeListsDestroyed && !tFreeLists.Buffers[sizeClass].empty())
+    {
+        pBuffer = tFreeLists.Buffers[sizeClass].back();
+        tFreeLists.Buffers[sizeClass].pop_back();
+    }
+    else
+    {
+        pBuffer = new uint8_t[capacity];
+
+        gAllocated++;
+        gAllocatedBytes += capacity;
+    }
+
+    return std::shared_ptr<uint8_t>(pBuffer, BufferRelease{ sizeClass });
+}
+
+PacketBufferPool::Stats PacketBufferPool::GetStats()
+{
+    Stats stats;
+    stats.Acquired = gAcquired;
+    stats.Allocated = gAllocated;
+    stats.AllocatedBytes = gAllocatedBytes;
+    stats.SavedBytes = GetSavedBytes(stats);
+
+    return stats;
+}
+
+PacketBufferPool::Stats PacketBufferPool::ResetStats()
+{
+    Stats stats;
+    stats.Acquired = gAcquired.exchange(0);
+    stats.Allocated = gAllocated.exchange(0);
+    stats.AllocatedBytes = gAllocatedBytes.exchange(0);
+    stats.SavedBytes = GetSavedBytes(stats);
+
+    return stats;
+}
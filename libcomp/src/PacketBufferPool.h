@@ -0,0 +1,115 @@
+/**
+ * @file libcomp/src/PacketBufferPool.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pool of reusable packet data buffers.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_PACKETBUFFERPOOL_H
+#define LIBCOMP_SRC_PACKETBUFFERPOOL_H
+
+#include "Constants.h"
+
+#include <memory>
+
+#include <stdint.h>
+
+namespace libcomp
+{
+
+/**
+ * Pool of packet data buffers split into small, medium and large size
+ * classes with the large class holding a full MAX_PACKET_SIZE buffer. Most
+ * packets are only a few dozen bytes so drawing a small buffer and only
+ * growing it when needed avoids allocating the full maximum for every
+ * packet. Released buffers are kept on a free list owned by the thread
+ * that released them so buffers can be reused without any locking.
+ */
+class PacketBufferPool
+{
+public:
+    /// Capacity of a small buffer.
+    static const uint32_t SMALL_BUFFER_SIZE = 256;
+
+    /// Capacity of a medium buffer.
+    static const uint32_t MEDIUM_BUFFER_SIZE = 2048;
+
+    /// Capacity of a large buffer.
+    static const uint32_t LARGE_BUFFER_SIZE = MAX_PACKET_SIZE;
+
+    /**
+     * Snapshot of the pool counters.
+     */
+    struct Stats
+    {
+        /// Number of buffers handed out by the pool.
+        uint64_t Acquired;
+
+        /// Number of buffers that had to be allocated from the heap.
+        uint64_t Allocated;
+
+        /// Total bytes allocated from the heap.
+        uint64_t AllocatedBytes;
+
+        /// Bytes that would have been allocated if every buffer acquired
+        /// had been a new MAX_PACKET_SIZE buffer, minus the bytes that
+        /// were actually allocated.
+        uint64_t SavedBytes;
+    };
+
+    /**
+     * Get the capacity of the smallest size class that will fit the
+     * requested size.
+     * @param size Number of bytes the buffer must hold.
+     * @returns Capacity of the size class or 0 if the size is larger than
+     *  MAX_PACKET_SIZE.
+     */
+    static uint32_t GetCapacity(uint32_t size);
+
+    /**
+     * Get a buffer that will hold at least the requested size. The buffer
+     * contents are not initialized. The buffer is returned to the pool
+     * once the last reference to it is released.
+     * @param size Number of bytes the buffer must hold.
+     * @param capacity Output parameter set to the capacity of the buffer.
+     * @returns Pointer to the buffer or null if the size is larger than
+     *  MAX_PACKET_SIZE.
+     */
+    static std::shared_ptr<uint8_t> Acquire(uint32_t size,
+        uint32_t& capacity);
+
+    /**
+     * Get the current pool counters.
+     * @returns Snapshot of the counters.
+     */
+    static Stats GetStats();
+
+    /**
+     * Get the current pool counters and reset them to zero.
+     * @returns Snapshot of the counters before they were reset.
+     */
+    static Stats ResetStats();
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_PACKETBUFFERPOOL_H
@@ -27,6 +27,7 @@
 #include "PersistentObject.h"
 
 // libcomp Includes
+#include "Constants.h"
 #include "Database.h"
 #include "DatabaseBind.h"
 #include "Log.h"
@@ -69,10 +70,83 @@
 #include "UBResult.h"
 #include "UBTournament.h"
 
+// Standard C++11 Includes
+#include <chrono>
+
 using namespace libcomp;
 
-std::unordered_map<std::string, std::weak_ptr<PersistentObject>> PersistentObject::sCached;
-std::mutex PersistentObject::mCacheLock;
+namespace
+{
+
+/**
+ * Part of the object cache with its own lock. Objects are spread over the
+ * shards by the hash of their UUID.
+ */
+struct CacheShard
+{
+    /// Mutex to lock accessing the shard
+    std::mutex Lock;
+
+    /// Map of instantiated objects listed by their UUID
+    std::unordered_map<libobjgen::UUID,
+        std::weak_ptr<PersistentObject>> Objects;
+
+    /// Number of lookups since the counters were reset
+    uint64_t Lookups;
+
+    /// Number of lookups that found a live object
+    uint64_t Hits;
+
+    /// Number of times the lock was already held
+    uint64_t Contended;
+
+    /// Number of expired entries removed
+    uint64_t Swept;
+};
+
+static_assert(0 == (PERSISTENT_CACHE_SHARDS & (PERSISTENT_CACHE_SHARDS - 1)),
+    "PERSISTENT_CACHE_SHARDS must be a power of two");
+
+/// Shards of the object cache
+CacheShard gCacheShards[PERSISTENT_CACHE_SHARDS];
+
+/// Mutex to lock resetting the cache counters
+std::mutex gCacheStatsLock;
+
+/// Time the cache counters were last reset
+std::chrono::steady_clock::time_point gCacheStatsReset =
+    std::chrono::steady_clock::now();
+
+/**
+ * Get the shard an object belongs in.
+ * @param uuid UUID of the object
+ * @return Shard the object is cached in
+ */
+CacheShard& GetCacheShard(const libobjgen::UUID& uuid)
+{
+    return gCacheShards[uuid.Hash() & (PERSISTENT_CACHE_SHARDS - 1)];
+}
+
+/**
+ * Lock a shard and count it if another thread already had it locked.
+ * @param shard Shard to lock
+ * @return Lock on the shard
+ */
+std::unique_lock<std::mutex> LockCacheShard(CacheShard& shard)
+{
+    std::unique_lock<std::mutex> lock(shard.Lock, std::try_to_lock);
+
+    if(!lock.owns_lock())
+    {
+        lock.lock();
+        shard.Contended++;
+    }
+
+    return lock;
+}
+
+} // namespace
+
 PersistentObject::TypeMap PersistentObject::sTypeMap;
 std::unordered_map<std::string, size_t> PersistentObject::sTypeNames;
 std::unordered_map<size_t, std::function<PersistentObject*()>> PersistentObject::sFactory;
@@ -92,16 +166,6 @@ PersistentObject::PersistentObject(const PersistentObject& other) : Object(), mU
 
 PersistentObject::~PersistentObject()
 {
-    if(!mUUID.IsNull() && !IsDeleted())
-    {
-        std::lock_guard<std::mutex> lock(mCacheLock);
-
-        std::string strUUID = mUUID.ToString();
-        if(sCached.find(strUUID) != sCached.end())
-        {
-            sCached.erase(strUUID);
-        }
-    }
 }
 
 libobjgen::UUID PersistentObject::GetUUID() const
@@ -114,18 +178,18 @@ bool PersistentObject::Register(const std::shared_ptr<PersistentObject>& self,
 {
     if(!self->IsDeleted())
     {
-        bool registered = false;
-
         libobjgen::UUID& uuid = self->mUUID;
 
-        std::lock_guard<std::mutex> lock(mCacheLock);
         if(!pUuid.IsNull() && !uuid.IsNull())
         {
             // Unregister old UUID, keep if making a copy
-            auto it = sCached.find(uuid.ToString());
-            if(it != sCached.end() && it->second.lock() == self)
+            auto& shard = GetCacheShard(uuid);
+            auto lock = LockCacheShard(shard);
+
+            auto it = shard.Objects.find(uuid);
+            if(it != shard.Objects.end() && it->second.lock() == self)
             {
-                sCached.erase(it);
+                shard.Objects.erase(it);
             }
         }
 
@@ -136,28 +200,27 @@ bool PersistentObject::Register(const std::shared_ptr<PersistentObject>& self,
         else if(uuid.IsNull())
         {
             uuid = libobjgen::UUID::Random();
-            registered = true;
         }
 
-        if(!registered && sCached.find(uuid.ToString()) == sCached.end())
         {
-            registered = true;
-        }
+            auto& shard = GetCacheShard(uuid);
+            auto lock = LockCacheShard(shard);
 
-        std::string uuidString = uuid.ToString();
+            // An entry for an object that has been destroyed but not swept
+            // yet does not count as a duplicate.
+            auto& entry = shard.Objects[uuid];
 
-        if(registered)
-        {
-            self->mSelf = self;
-            sCached[uuidString] = self;
+            if(entry.expired())
+            {
+                self->mSelf = self;
+                entry = self;
 
-            return true;
-        }
-        else
-        {
-            LOG_ERROR(String("Duplicate object detected: %1\n").Arg(
-                uuidString));
+                return true;
+            }
         }
+
+        LOG_ERROR(String("Duplicate object detected: %1\n").Arg(
+            uuid.ToString()));
     }
 
     return false;
@@ -167,13 +230,10 @@ void PersistentObject::Unregister()
 {
     mDeleted = true;
 
-    std::lock_guard<std::mutex> lock(mCacheLock);
+    auto& shard = GetCacheShard(mUUID);
+    auto lock = LockCacheShard(shard);
 
-    auto iter = sCached.find(mUUID.ToString());
-    if(iter != sCached.end())
-    {
-        sCached.erase(iter);
-    }
+    shard.Objects.erase(mUUID);
 }
 
 bool PersistentObject::IsDeleted()
@@ -181,14 +241,89 @@ bool PersistentObject::IsDeleted()
     return mDeleted;
 }
 
+size_t PersistentObject::SweepCache()
+{
+    size_t swept = 0;
+
+    // Only one shard is locked at a time so lookups in the others carry on.
+    for(auto& shard : gCacheShards)
+    {
+        auto lock = LockCacheShard(shard);
+
+        for(auto it = shard.Objects.begin(); it != shard.Objects.end();)
+        {
+            if(it->second.expired())
+            {
+                it = shard.Objects.erase(it);
+                shard.Swept++;
+                swept++;
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    return swept;
+}
+
+PersistentObject::CacheStats PersistentObject::ResetCacheStats()
+{
+    CacheStats stats;
+    stats.Lookups = 0;
+    stats.Hits = 0;
+    stats.Contended = 0;
+    stats.Swept = 0;
+    stats.Cached = 0;
+
+    std::lock_guard<std::mutex> statsLock(gCacheStatsLock);
+
+    for(auto& shard : gCacheShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.Lock);
+
+        stats.Lookups += shard.Lookups;
+        stats.Hits += shard.Hits;
+        stats.Contended += shard.Contended;
+        stats.Swept += shard.Swept;
+        stats.Cached += (uint64_t)shard.Objects.size();
+
+        shard.Lookups = 0;
+        shard.Hits = 0;
+        shard.Contended = 0;
+        shard.Swept = 0;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        now - gCacheStatsReset).count();
+    gCacheStatsReset = now;
+
+    stats.LookupsPerSecond = 0 < elapsed ? (uint64_t)((double)stats.Lookups *
+        1000000.0 / (double)elapsed) : 0;
+
+    return stats;
+}
+
 std::shared_ptr<PersistentObject> PersistentObject::GetObjectByUUID(const libobjgen::UUID& uuid)
 {
-    std::lock_guard<std::mutex> lock(mCacheLock);
+    auto& shard = GetCacheShard(uuid);
+    auto lock = LockCacheShard(shard);
+
+    shard.Lookups++;
 
-    auto iter = sCached.find(uuid.ToString());
-    if(iter != sCached.end())
+    auto iter = shard.Objects.find(uuid);
+    if(iter != shard.Objects.end())
     {
-        return iter->second.lock();
+        auto obj = iter->second.lock();
+
+        if(nullptr != obj)
+        {
+            shard.Hits++;
+        }
+
+        return obj;
     }
 
     return nullptr;
@@ -218,6 +353,28 @@ std::shared_ptr<PersistentObject> PersistentObject::LoadObjectByUUID(
     return obj;
 }
 
+std::list<std::shared_ptr<PersistentObject>> PersistentObject::Prefetch(
+    size_t typeHash, const std::shared_ptr<Database>& db,
+    const std::list<libobjgen::UUID>& uuids)
+{
+    std::list<libobjgen::UUID> uncached;
+
+    for(auto& uuid : uuids)
+    {
+        if(!uuid.IsNull() && nullptr == GetObjectByUUID(uuid))
+        {
+            uncached.push_back(uuid);
+        }
+    }
+
+    if(nullptr == db || uncached.empty())
+    {
+        return std::list<std::shared_ptr<PersistentObject>>();
+    }
+
+    return db->LoadObjectsByUUID(typeHash, "UID", uncached);
+}
+
 std::shared_ptr<PersistentObject> PersistentObject::LoadObject(
     size_t typeHash, const std::shared_ptr<Database>& db,
     DatabaseBind *pValue)
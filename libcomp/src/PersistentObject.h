@@ -36,6 +36,7 @@
 #include <UUID.h>
 
 // Standard C++ 11 Includes
+#include <bitset>
 #include <typeindex>
 
 namespace libcomp
@@ -61,6 +62,34 @@ public:
     typedef std::unordered_map<size_t,
         std::shared_ptr<libobjgen::MetaObject>> TypeMap;
 
+    /// Maximum number of fields a persistent object type can have.
+    static const size_t MAX_FIELDS = 128;
+
+    /**
+     * Snapshot of the object cache counters.
+     */
+    struct CacheStats
+    {
+        /// Number of objects looked up by UUID.
+        uint64_t Lookups;
+
+        /// Number of lookups that found a live object.
+        uint64_t Hits;
+
+        /// Number of times a shard was already locked by another thread.
+        uint64_t Contended;
+
+        /// Number of expired entries removed by sweeps.
+        uint64_t Swept;
+
+        /// Number of entries in the cache (including expired ones that
+        /// have not been swept yet).
+        uint64_t Cached;
+
+        /// Lookups per second since the counters were last reset.
+        uint64_t LookupsPerSecond;
+    };
+
     /**
      * Create a persistent object with no UUID.
      */
@@ -73,7 +102,8 @@ public:
     PersistentObject(const PersistentObject& other);
 
     /**
-     * Clean up the object and remove it from the UUID cache.
+     * Clean up the object. The UUID cache entry is left for
+     * @ref SweepCache to remove.
      */
     ~PersistentObject();
 
@@ -101,6 +131,12 @@ public:
     virtual std::list<libcomp::DatabaseBind*> GetMemberBindValues(
         bool retrieveAll = false, bool clearChanges = true) = 0;
 
+    /**
+     * Check if any field has been updated since the last save operation.
+     * @return true if there are changes to save, false if there are not
+     */
+    virtual bool IsDirty() const = 0;
+
     /**
      * Load the object from a successfully executed query.
      * @param query Database query that has executed to load from
@@ -139,6 +175,20 @@ public:
      */
     static bool Initialize();
 
+    /**
+     * Remove the cache entries of objects that have been destroyed. Objects
+     * do not remove themselves when they are destroyed so this should be
+     * called periodically.
+     * @return Number of entries removed
+     */
+    static size_t SweepCache();
+
+    /**
+     * Get the object cache counters and reset them to zero.
+     * @return Snapshot of the counters before they were reset
+     */
+    static CacheStats ResetCacheStats();
+
     /**
      * Retrieve an object by its UUID but do not load from the database.
      * @param uuid UUID to retrieve from the cache
@@ -205,6 +255,44 @@ public:
         const libobjgen::UUID& uuid, bool reload = false,
         bool reportError = false);
 
+    /**
+     * Load every object of the specified type in a list of UUIDs that is
+     * not already cached using batched queries. The loaded objects are
+     * cached so later calls to @ref LoadObjectByUUID (and references to
+     * them) do not query the database again as long as the returned
+     * pointers are held.
+     * @param db Database to load from
+     * @param uuids UUIDs of the objects to load
+     * @return List of pointers to the objects that were loaded
+     */
+    template<class T> static std::list<std::shared_ptr<T>> Prefetch(
+        const std::shared_ptr<Database>& db,
+        const std::list<libobjgen::UUID>& uuids)
+    {
+        std::list<std::shared_ptr<T>> retval;
+        if(std::is_base_of<PersistentObject, T>::value)
+        {
+            for(auto obj : Prefetch(typeid(T).hash_code(), db, uuids))
+            {
+                retval.push_back(std::dynamic_pointer_cast<T>(obj));
+            }
+        }
+
+        return retval;
+    }
+
+    /**
+     * Load every object of the specified type ID in a list of UUIDs that
+     * is not already cached using batched queries.
+     * @param typeHash C++ type hash representing the object type to load
+     * @param db Database to load from
+     * @param uuids UUIDs of the objects to load
+     * @return List of pointers to the objects that were loaded
+     */
+    static std::list<std::shared_ptr<PersistentObject>> Prefetch(
+        size_t typeHash, const std::shared_ptr<Database>& db,
+        const std::list<libobjgen::UUID>& uuids);
+
     /**
      * Get all PersistentObject derived class MetaObject definitions.
      * @return Map of MetaObject definitions by the source object's C++ type
@@ -398,17 +486,11 @@ protected:
     /// UUID associated to the object
     libobjgen::UUID mUUID;
 
-    /// Set of fields that have been updated since the last save operation
-    std::set<std::string> mDirtyFields;
+    /// Fields that have been updated since the last save operation by
+    /// the ordinal of the field in the object
+    std::bitset<MAX_FIELDS> mDirtyFields;
 
 private:
-    /// Map of intantiated objects listed by their UUID
-    static std::unordered_map<std::string,
-        std::weak_ptr<PersistentObject>> sCached;
-
-    /// Mutex to lock accessing the cache
-    static std::mutex mCacheLock;
-
     /// Static map of MetaObject definitions by the source object's C++ type hash
     static TypeMap sTypeMap;
 
@@ -28,11 +28,10 @@
 
 #include "Endian.h"
 #include "Log.h"
+#include "PacketBufferPool.h"
 #include "PacketException.h"
 #include "ScriptEngine.h"
 
-#include <array>
-
 #ifdef _WIN32
 #include <windows.h>
 #else // _WIN32
@@ -44,7 +43,8 @@
 
 using namespace libcomp;
 
-ReadOnlyPacket::ReadOnlyPacket() : mPosition(0), mSize(0), mData(nullptr)
+ReadOnlyPacket::ReadOnlyPacket() : mPosition(0), mSize(0), mCapacity(0),
+    mData(nullptr)
 {
     // The max packet size should be evenly divisible by 4 bytes.
     static_assert(0 == (MAX_PACKET_SIZE % 4),
@@ -52,20 +52,21 @@ ReadOnlyPacket::ReadOnlyPacket() : mPosition(0), mSize(0), mData(nullptr)
 }
 
 ReadOnlyPacket::ReadOnlyPacket(uint32_t position, uint32_t size,
-    uint8_t *pData, std::shared_ptr<PacketArray> dataRef) :
-    mPosition(position), mSize(size), mData(pData), mDataRef(dataRef)
+    uint32_t capacity, uint8_t *pData, std::shared_ptr<uint8_t> dataRef) :
+    mPosition(position), mSize(size), mCapacity(capacity), mData(pData),
+    mDataRef(dataRef)
 {
 }
 
 ReadOnlyPacket::ReadOnlyPacket(const ReadOnlyPacket& other) :
-    mPosition(other.mPosition), mSize(other.mSize), mData(other.mData),
-    mDataRef(other.mDataRef)
+    mPosition(other.mPosition), mSize(other.mSize),
+    mCapacity(other.mCapacity), mData(other.mData), mDataRef(other.mDataRef)
 {
 }
 
 ReadOnlyPacket::ReadOnlyPacket(const ReadOnlyPacket& other,
     uint32_t start, uint32_t size) : mPosition(0), mSize(size),
-    mData(&other.mData[start]), mDataRef(other.mDataRef)
+    mCapacity(size), mData(&other.mData[start]), mDataRef(other.mDataRef)
 {
     if((start + size) > other.mSize)
     {
@@ -75,11 +76,12 @@ ReadOnlyPacket::ReadOnlyPacket(const ReadOnlyPacket& other,
 }
 
 ReadOnlyPacket::ReadOnlyPacket(Packet&& other) :
-    mPosition(other.mPosition), mSize(other.mSize), mData(other.mData),
-    mDataRef(other.mDataRef)
+    mPosition(other.mPosition), mSize(other.mSize),
+    mCapacity(other.mCapacity), mData(other.mData), mDataRef(other.mDataRef)
 {
     other.mPosition = 0;
     other.mSize = 0;
+    other.mCapacity = 0;
     other.mDataRef.reset();
     other.mData = nullptr;
 
@@ -96,8 +98,8 @@ void ReadOnlyPacket::Allocate()
     // Ensure the packet data buffer is allocated.
     if(nullptr == mData)
     {
-        mDataRef = std::shared_ptr<PacketArray>(new PacketArray);
-        mData = mDataRef.get()->data();
+        mDataRef = PacketBufferPool::Acquire(0, mCapacity);
+        mData = mDataRef.get();
     }
 }
 
@@ -924,6 +926,7 @@ ReadOnlyPacket& ReadOnlyPacket::operator=(ReadOnlyPacket& other)
 {
     mPosition = other.mPosition;
     mSize = other.mSize;
+    mCapacity = other.mCapacity;
     mDataRef = other.mDataRef;
     mData = other.mData;
 
@@ -84,9 +84,6 @@ class PacketException;
  */
 class ReadOnlyPacket
 {
-private:
-    typedef std::array<uint8_t, MAX_PACKET_SIZE> PacketArray;
-
 public:
     /// This class needs to directly access data in the Packet class.
     friend class PacketException;
@@ -731,7 +728,9 @@ public:
     const char* ConstData() const;
 
     /**
-     * @brief Ensure the packet data buffer is allocated.
+     * @brief Ensure the packet data buffer is allocated. A new buffer is
+     * drawn from the smallest size class of the @ref PacketBufferPool and
+     * grows as data is written.
      */
     void Allocate();
 
@@ -750,7 +749,7 @@ public:
 protected:
     /// Protected constructor for use by subclasses.
     explicit ReadOnlyPacket(uint32_t position, uint32_t size,
-        uint8_t *pData, std::shared_ptr<PacketArray> dataRef);
+        uint32_t capacity, uint8_t *pData, std::shared_ptr<uint8_t> dataRef);
 
     /// Current position in the packet.
     uint32_t mPosition;
@@ -758,12 +757,16 @@ protected:
     /// Size of the packet.
     uint32_t mSize;
 
+    /// Number of bytes the packet data buffer can hold.
+    uint32_t mCapacity;
+
     /// Pointer to the packet data.
     uint8_t *mData;
 
     /// Reference to the underlying buffer (which could be shared between
-    /// read only packets).
-    std::shared_ptr<PacketArray> mDataRef;
+    /// read only packets). The buffer is returned to the
+    /// @ref PacketBufferPool once every reference is released.
+    std::shared_ptr<uint8_t> mDataRef;
 };
 
 } // namespace libcomp
@@ -47,6 +47,7 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstring>
 
 #include <sqstdaux.h>
 
@@ -84,6 +85,74 @@ static std::shared_ptr<objects::Demon> ToDemon(const std::shared_ptr<
     return std::dynamic_pointer_cast<objects::Demon>(obj);
 }
 
+/**
+ * Position in a bytecode buffer being read by @ref BytecodeRead.
+ */
+struct BytecodeReader
+{
+    /// Bytecode being read
+    const std::vector<char> *pBytecode;
+
+    /// Offset of the next byte to read
+    size_t Offset;
+};
+
+static SQInteger BytecodeWrite(SQUserPointer pUserData, SQUserPointer pData,
+    SQInteger size)
+{
+    auto pBytecode = reinterpret_cast<std::vector<char>*>(pUserData);
+    auto pBytes = reinterpret_cast<const char*>(pData);
+
+    pBytecode->insert(pBytecode->end(), pBytes, pBytes + size);
+
+    return size;
+}
+
+static SQInteger BytecodeRead(SQUserPointer pUserData, SQUserPointer pData,
+    SQInteger size)
+{
+    auto pReader = reinterpret_cast<BytecodeReader*>(pUserData);
+
+    size_t remaining = pReader->pBytecode->size() - pReader->Offset;
+    if(0 >= size || remaining < (size_t)size)
+    {
+        return -1;
+    }
+
+    memcpy(pData, pReader->pBytecode->data() + pReader->Offset,
+        (size_t)size);
+    pReader->Offset += (size_t)size;
+
+    return size;
+}
+
+static std::set<std::string> GetRootSlots(HSQUIRRELVM vm)
+{
+    std::set<std::string> slots;
+
+    SQInteger top = sq_gettop(vm);
+
+    sq_pushroottable(vm);
+    sq_pushnull(vm);
+
+    while(SQ_SUCCEEDED(sq_next(vm, -2)))
+    {
+        const SQChar *szKey = nullptr;
+        if(OT_STRING == sq_gettype(vm, -2) &&
+            SQ_SUCCEEDED(sq_getstring(vm, -2, &szKey)))
+        {
+            slots.insert(szKey);
+        }
+
+        // Pop the key and value
+        sq_pop(vm, 2);
+    }
+
+    sq_settop(vm, top);
+
+    return slots;
+}
+
 static bool ScriptInclude(HSQUIRRELVM vm, const char *szPath)
 {
     return ScriptEngine::Self(vm)->Include(szPath);
@@ -278,6 +347,85 @@ bool ScriptEngine::Eval(const String& source, const String& sourceName)
     return result;
 }
 
+bool ScriptEngine::Compile(const String& source,
+    std::vector<char>& bytecode, const String& sourceName)
+{
+    bool result = false;
+
+    SQInteger top = sq_gettop(mVM);
+
+    bytecode.clear();
+
+    if(SQ_SUCCEEDED(sq_compilebuffer(mVM, source.C(),
+        (SQInteger)source.Size(), sourceName.C(), 1)))
+    {
+        result = SQ_SUCCEEDED(sq_writeclosure(mVM, &BytecodeWrite,
+            &bytecode));
+    }
+
+    sq_settop(mVM, top);
+
+    if(!result)
+    {
+        bytecode.clear();
+    }
+
+    return result;
+}
+
+bool ScriptEngine::EvalBytecode(const std::vector<char>& bytecode)
+{
+    bool result = false;
+
+    SQInteger top = sq_gettop(mVM);
+
+    BytecodeReader reader;
+    reader.pBytecode = &bytecode;
+    reader.Offset = 0;
+
+    if(SQ_SUCCEEDED(sq_readclosure(mVM, &BytecodeRead, &reader)))
+    {
+        sq_pushroottable(mVM);
+
+        if(SQ_SUCCEEDED(sq_call(mVM, ONE_PARAM,
+            NO_RETURN_VALUE, RAISE_ERROR)))
+        {
+            result = true;
+        }
+    }
+
+    sq_settop(mVM, top);
+
+    return result;
+}
+
+void ScriptEngine::SaveRootState()
+{
+    mSavedRootSlots = GetRootSlots(mVM);
+    mSavedBindings = mBindings;
+    mSavedImports = mImports;
+}
+
+void ScriptEngine::ResetRootState()
+{
+    SQInteger top = sq_gettop(mVM);
+
+    for(auto& slot : GetRootSlots(mVM))
+    {
+        if(mSavedRootSlots.find(slot) == mSavedRootSlots.end())
+        {
+            sq_pushroottable(mVM);
+            sq_pushstring(mVM, slot.c_str(), -1);
+            sq_deleteslot(mVM, -2, SQFalse);
+            sq_settop(mVM, top);
+        }
+    }
+
+    // Anything bound since the save was removed with the root slots
+    mBindings = mSavedBindings;
+    mImports = mSavedImports;
+}
+
 HSQUIRRELVM ScriptEngine::GetVM()
 {
     return mVM;
@@ -43,6 +43,7 @@
 #include <functional>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace libcomp
 {
@@ -106,6 +107,39 @@ public:
      */
     bool Eval(const String& source, const String& sourceName = String());
 
+    /**
+     * Compile a Squirrel script block to bytecode without running it. The
+     * bytecode can be loaded into any VM with @ref EvalBytecode to skip
+     * compiling the source again.
+     * @param source Squirrel script block as a string
+     * @param bytecode Output buffer to write the bytecode to
+     * @param sourceName Name of the source used in error messages
+     * @return true on success, false on failure
+     */
+    bool Compile(const String& source, std::vector<char>& bytecode,
+        const String& sourceName = String());
+
+    /**
+     * Evaluate a Squirrel script block previously compiled with
+     * @ref Compile.
+     * @param bytecode Compiled script block
+     * @return true on success, false on failure
+     */
+    bool EvalBytecode(const std::vector<char>& bytecode);
+
+    /**
+     * Save the current contents of the root table, bindings and imports
+     * so the engine can be reset back to this state with
+     * @ref ResetRootState before it is reused for another script.
+     */
+    void SaveRootState();
+
+    /**
+     * Remove everything added to the root table since the last call to
+     * @ref SaveRootState along with any bindings and imports made since.
+     */
+    void ResetRootState();
+
     /**
      * Import a Squirrel binding module into the virtual machine.
      * @param module Name of the module to import.
@@ -164,6 +198,15 @@ private:
     /// Imports that have already been made.
     std::set<std::string> mImports;
 
+    /// Root table slots saved by @ref SaveRootState
+    std::set<std::string> mSavedRootSlots;
+
+    /// Bindings saved by @ref SaveRootState
+    std::set<std::string> mSavedBindings;
+
+    /// Imports saved by @ref SaveRootState
+    std::set<std::string> mSavedImports;
+
     /// If the logging system should be used or not.
     bool mUseRawPrint;
 
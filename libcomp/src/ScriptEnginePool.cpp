@@ -0,0 +1,223 @@
+/**
+ * @file libcomp/src/ScriptEnginePool.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pool of reusable script engines.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScriptEnginePool.h"
+
+// libcomp Includes
+#include "ServerDataManager.h"
+
+// Standard C++11 Includes
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Maximum number of free engines kept per thread for each profile.
+const size_t FREE_ENGINE_LIMIT = 4;
+
+/// Number of engines handed out.
+std::atomic<uint64_t> gAcquired(0);
+
+/// Number of engines created.
+std::atomic<uint64_t> gCreated(0);
+
+/// Number of scripts evaluated from bytecode.
+std::atomic<uint64_t> gBytecodeHits(0);
+
+/// Number of scripts compiled from source.
+std::atomic<uint64_t> gSourceCompiles(0);
+
+/// Set once the free lists for the thread have been destroyed so engines
+/// released during thread shutdown are deleted instead.
+thread_local bool tFreeListsDestroyed = false;
+
+/**
+ * Free engines for each profile owned by a single thread.
+ */
+struct FreeLists
+{
+    /**
+     * Mark the free lists as destroyed.
+     */
+    ~FreeLists()
+    {
+        tFreeListsDestroyed = true;
+    }
+
+    /// Free engines for each profile.
+    std::unordered_map<std::string,
+        std::list<std::shared_ptr<ScriptEngine>>> Engines;
+};
+
+/// Free lists for the current thread.
+thread_local FreeLists tFreeLists;
+
+/**
+ * Deleter that resets an engine and returns it to the free list of the
+ * releasing thread.
+ */
+struct EngineRelease
+{
+    /// Engine being handed out.
+    std::shared_ptr<ScriptEngine> Engine;
+
+    /// Profile the engine belongs to.
+    std::string Profile;
+
+    /**
+     * Return the engine to the pool or let it be deleted if the free list
+     * is full.
+     * @param pEngine Engine being released (owned by Engine).
+     */
+    void operator()(ScriptEngine *pEngine)
+    {
+        (void)pEngine;
+
+        if(!tFreeListsDestroyed)
+        {
+            auto& engines = tFreeLists.Engines[Profile];
+            if(engines.size() < FREE_ENGINE_LIMIT)
+            {
+                Engine->ResetRootState();
+                engines.push_back(Engine);
+            }
+        }
+
+        Engine.reset();
+    }
+};
+
+} // namespace
+
+std::shared_ptr<ScriptEngine> ScriptEnginePool::Acquire(
+    const std::string& profile,
+    const std::function<void(ScriptEngine&)>& prepare)
+{
+    gAcquired++;
+
+    std::shared_ptr<ScriptEngine> engine;
+    if(!tFreeListsDestroyed)
+    {
+        auto it = tFreeLists.Engines.find(profile);
+        if(it != tFreeLists.Engines.end() && !it->second.empty())
+        {
+            engine = it->second.back();
+            it->second.pop_back();
+        }
+    }
+
+    if(!engine)
+    {
+        engine = std::make_shared<ScriptEngine>();
+        prepare(*engine);
+        engine->SaveRootState();
+
+        gCreated++;
+    }
+
+    ScriptEngine *pEngine = engine.get();
+
+    return std::shared_ptr<ScriptEngine>(pEngine,
+        EngineRelease{ std::move(engine), profile });
+}
+
+bool ScriptEnginePool::EvalScript(
+    const std::shared_ptr<ScriptEngine>& engine, const ServerScript& script)
+{
+    auto pRelease = std::get_deleter<EngineRelease>(engine);
+    if(!pRelease)
+    {
+        gSourceCompiles++;
+
+        return engine->Eval(script.Source, script.Path);
+    }
+
+    std::shared_ptr<const std::vector<char>> bytecode;
+    {
+        std::lock_guard<std::mutex> lock(script.BytecodeLock);
+
+        auto it = script.Bytecode.find(pRelease->Profile);
+        if(it != script.Bytecode.end())
+        {
+            bytecode = it->second;
+        }
+    }
+
+    if(bytecode)
+    {
+        gBytecodeHits++;
+
+        return engine->EvalBytecode(*bytecode);
+    }
+
+    gSourceCompiles++;
+
+    // Compile on the engine that will run the script so constants bound
+    // by the profile (such as Result_t) are resolved the same way every
+    // later run will see them
+    auto compiled = std::make_shared<std::vector<char>>();
+    if(!engine->Compile(script.Source, *compiled, script.Path))
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(script.BytecodeLock);
+
+        // Another thread may have compiled it first, either is valid
+        script.Bytecode.insert(std::make_pair(pRelease->Profile,
+            compiled));
+    }
+
+    return engine->EvalBytecode(*compiled);
+}
+
+ScriptEnginePool::Stats ScriptEnginePool::GetStats()
+{
+    Stats stats;
+    stats.Acquired = gAcquired;
+    stats.Created = gCreated;
+    stats.BytecodeHits = gBytecodeHits;
+    stats.SourceCompiles = gSourceCompiles;
+
+    return stats;
+}
+
+ScriptEnginePool::Stats ScriptEnginePool::ResetStats()
+{
+    Stats stats;
+    stats.Acquired = gAcquired.exchange(0);
+    stats.Created = gCreated.exchange(0);
+    stats.BytecodeHits = gBytecodeHits.exchange(0);
+    stats.SourceCompiles = gSourceCompiles.exchange(0);
+
+    return stats;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file libcomp/src/ScriptEnginePool.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pool of reusable script engines.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_SCRIPTENGINEPOOL_H
+#define LIBCOMP_SRC_SCRIPTENGINEPOOL_H
+
+// libcomp Includes
+#include "ScriptEngine.h"
+
+// Standard C++11 Includes
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace libcomp
+{
+
+struct ServerScript;
+
+/**
+ * Pool of script engines that have already had their bindings made. Every
+ * engine belongs to a named profile that identifies the set of bindings
+ * made by the prepare function supplied when the engine was created. Once
+ * the last reference to an acquired engine is released, anything the
+ * script added to the root table is removed and the engine is kept on a
+ * free list owned by the releasing thread so the next script run on that
+ * thread with the same profile can skip creating the VM and binding the
+ * types again.
+ */
+class ScriptEnginePool
+{
+public:
+    /**
+     * Snapshot of the pool counters.
+     */
+    struct Stats
+    {
+        /// Number of engines handed out by the pool.
+        uint64_t Acquired;
+
+        /// Number of engines that had to be created.
+        uint64_t Created;
+
+        /// Number of scripts loaded from their precompiled bytecode.
+        uint64_t BytecodeHits;
+
+        /// Number of scripts that had to be compiled or evaluated from
+        /// source.
+        uint64_t SourceCompiles;
+    };
+
+    /**
+     * Get a script engine for the supplied profile.
+     * @param profile Name of the set of bindings made by the prepare
+     *  function. Every caller using the same profile must supply a
+     *  prepare function that makes the same bindings.
+     * @param prepare Function to make the bindings on a new engine
+     * @returns Pointer to the engine which is returned to the pool once
+     *  the last reference to it is released
+     */
+    static std::shared_ptr<ScriptEngine> Acquire(const std::string& profile,
+        const std::function<void(ScriptEngine&)>& prepare);
+
+    /**
+     * Evaluate a server script on the supplied engine. The first time the
+     * script is run with an engine from a profile it is compiled on that
+     * engine so any constant tables bound by the profile are resolved
+     * exactly as they would be at run time. The bytecode is kept on the
+     * script and loaded by every later run with the same profile. Engines
+     * that did not come from the pool always evaluate the source.
+     * @param engine Script engine to evaluate the script on
+     * @param script Script to evaluate
+     * @return true on success, false on failure
+     */
+    static bool EvalScript(const std::shared_ptr<ScriptEngine>& engine,
+        const ServerScript& script);
+
+    /**
+     * Get the current pool counters.
+     * @returns Snapshot of the counters.
+     */
+    static Stats GetStats();
+
+    /**
+     * Get the current pool counters and reset them to zero.
+     * @returns Snapshot of the counters before they were reset.
+     */
+    static Stats ResetStats();
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_SCRIPTENGINEPOOL_H
@@ -30,6 +30,7 @@
 #include "DefinitionManager.h"
 #include "Log.h"
 #include "ScriptEngine.h"
+#include "TaskGroup.h"
 
 // object Includes
 #include <Action.h>
@@ -515,6 +516,12 @@ bool ServerDataManager::LoadData(DataStore *pDataStore,
             &ServerDataManager::LoadScript);
     }
 
+    if(!failure && definitionManager)
+    {
+        // Include the server side definitions registered above
+        definitionManager->BuildLookups();
+    }
+
     return !failure;
 }
 
@@ -707,25 +714,93 @@ bool ServerDataManager::LoadScripts(gsl::not_null<DataStore*> pDataStore,
     (void)pDataStore->GetListing(datastorePath, files, dirs, symLinks,
         true, true);
 
+    std::vector<libcomp::String> paths;
     for (auto path : files)
     {
         if (path.Matches("^.*\\.nut$"))
         {
-            std::vector<char> data = pDataStore->ReadFile(path);
-            if(!handler(*this, path, std::string(data.begin(), data.end())))
+            paths.push_back(path);
+        }
+    }
+
+    // Read the files in parallel but hand them to the handler in order
+    std::vector<std::vector<char>> sources(paths.size());
+
+    TaskGroup tasks;
+    for(size_t i = 0; i < paths.size(); i++)
+    {
+        tasks.Add(paths[i], [pDataStore, &paths, &sources, i]()
             {
-                LOG_ERROR(libcomp::String("Failed to load script file: %1\n").Arg(path));
-                return false;
-            }
+                sources[i] = pDataStore->ReadFile(paths[i]);
 
-            LOG_DEBUG(libcomp::String("Loaded script file: %1\n").Arg(path));
-        }
+                return true;
+            });
     }
 
+    tasks.Run();
+    tasks.LogTimes(libcomp::String("Read %1").Arg(datastorePath), false);
+
+    for(size_t i = 0; i < paths.size(); i++)
+    {
+        auto& path = paths[i];
+        auto& data = sources[i];
+
+        if(!handler(*this, path, std::string(data.begin(), data.end())))
+        {
+            LOG_ERROR(libcomp::String("Failed to load script file: %1\n").Arg(path));
+            return false;
+        }
+
+        LOG_DEBUG(libcomp::String("Loaded script file: %1\n").Arg(path));
+    }
 
     return true;
 }
 
+bool ServerDataManager::ParseXmlFiles(gsl::not_null<DataStore*> pDataStore,
+    const libcomp::String& datastorePath,
+    const std::vector<libcomp::String>& paths,
+    std::vector<std::shared_ptr<tinyxml2::XMLDocument>>& docs)
+{
+    docs.clear();
+    docs.resize(paths.size());
+
+    TaskGroup tasks;
+    for(size_t i = 0; i < paths.size(); i++)
+    {
+        tasks.Add(paths[i], [pDataStore, &paths, &docs, i]()
+            {
+                auto& path = paths[i];
+
+                std::vector<char> data = pDataStore->ReadFile(path);
+
+                if(data.empty())
+                {
+                    LOG_WARNING(libcomp::String("File does not exist or is"
+                        " empty: %1\n").Arg(path));
+                    return true;
+                }
+
+                auto doc = std::make_shared<tinyxml2::XMLDocument>();
+                if(tinyxml2::XML_SUCCESS != doc->Parse(&data[0], data.size()))
+                {
+                    LOG_ERROR(libcomp::String("Failed to parse XML file:"
+                        " %1\n").Arg(path));
+                    return false;
+                }
+
+                docs[i] = doc;
+
+                return true;
+            });
+    }
+
+    bool success = tasks.Run();
+    tasks.LogTimes(libcomp::String("Parsed %1").Arg(datastorePath), false);
+
+    return success;
+}
+
 namespace libcomp
 {
     template<>
@@ -1448,7 +1523,11 @@ bool ServerDataManager::LoadScript(const libcomp::String& path,
 {
     ScriptEngine engine;
     engine.Using<ServerScript>();
-    if(!engine.Eval(source))
+
+    // The script is only checked here. It is compiled to bytecode the
+    // first time it is run by the script engine pool so any constants
+    // bound by the engine running it are resolved correctly.
+    if(!engine.Eval(source, path))
     {
         LOG_ERROR(libcomp::String("Improperly formatted script encountered: %1\n")
             .Arg(path));
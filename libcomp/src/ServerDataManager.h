@@ -43,8 +43,11 @@
 #include "PopIgnore.h"
 
 // Standard C++11 Includes
+#include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace objects
 {
@@ -76,6 +79,16 @@ struct ServerScript
     String Path;
     String Source;
     String Type;
+
+    /// Bytecode compiled for each script engine pool profile the script
+    /// has been run with. Constants bound by the profile are resolved
+    /// when the script is compiled so the bytecode is only valid for
+    /// engines from the same profile.
+    mutable std::unordered_map<std::string,
+        std::shared_ptr<const std::vector<char>>> Bytecode;
+
+    /// Lock for the compiled bytecode
+    mutable std::mutex BytecodeLock;
 };
 
 /**
@@ -349,20 +362,41 @@ private:
         (void)pDataStore->GetListing(datastorePath, files, dirs, symLinks,
             recursive, true);
 
-        bool loaded = false;
+        std::vector<libcomp::String> paths;
         for(auto path : files)
         {
             if(path.Matches("^.*\\.xml$"))
             {
-                if(LoadObjectsFromFile<T>(pDataStore, path,
-                    definitionManager))
-                {
-                    loaded = true;
-                }
-                else
-                {
-                    return false;
-                }
+                paths.push_back(path);
+            }
+        }
+
+        // Read and parse the files in parallel but load the objects from
+        // them in order as objects can depend on ones loaded before them
+        std::vector<std::shared_ptr<tinyxml2::XMLDocument>> docs;
+        if(!ParseXmlFiles(pDataStore, datastorePath, paths, docs))
+        {
+            return false;
+        }
+
+        bool loaded = false;
+        for(size_t i = 0; i < paths.size(); i++)
+        {
+            if(!docs[i])
+            {
+                // Empty files are skipped but still count as loaded
+                loaded = true;
+                continue;
+            }
+
+            if(LoadObjectsFromDocument<T>(*docs[i], paths[i],
+                definitionManager))
+            {
+                loaded = true;
+            }
+            else
+            {
+                return false;
             }
         }
 
@@ -408,6 +442,24 @@ private:
             return false;
         }
 
+        return LoadObjectsFromDocument<T>(objsDoc, filePath,
+            definitionManager);
+    }
+
+    /**
+     * Load all objects from a parsed XML file
+     * @param objsDoc XML document to load from
+     * @param filePath File path within the data store the document was
+     *  loaded from
+     * @param definitionManager Pointer to the definition manager which
+     *  will be loaded with any server side definitions
+     * @return true on success, false on failure
+     */
+    template <class T>
+    bool LoadObjectsFromDocument(const tinyxml2::XMLDocument& objsDoc,
+        const libcomp::String& filePath,
+        DefinitionManager* definitionManager)
+    {
         const tinyxml2::XMLElement *rootNode = objsDoc.RootElement();
         const tinyxml2::XMLElement *objNode = rootNode->FirstChildElement("object");
 
@@ -428,6 +480,21 @@ private:
         return true;
     }
 
+    /**
+     * Read and parse XML files from the datastore in parallel
+     * @param pDataStore Pointer to the datastore to use
+     * @param datastorePath Path within the data store the files are in,
+     *  used when reporting how long the files took to load
+     * @param paths File paths within the data store to load
+     * @param docs Output list of parsed documents in the same order as
+     *  the paths with a null document for each empty file
+     * @return true on success, false if any file failed to parse
+     */
+    bool ParseXmlFiles(gsl::not_null<DataStore*> pDataStore,
+        const libcomp::String& datastorePath,
+        const std::vector<libcomp::String>& paths,
+        std::vector<std::shared_ptr<tinyxml2::XMLDocument>>& docs);
+
     /**
      * Load an object of the templated type from an XML node
      * @param doc XML document being loaded from
@@ -0,0 +1,404 @@
+/**
+ * @file libcomp/src/SpatialGrid.h
+ * @ingroup libcomp
+ *
+ * @author HACKfrost
+ *
+ * @brief Uniform grid spatial index for 2D bounding box queries.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_SPATIALGRID_H
+#define LIBCOMP_SRC_SPATIALGRID_H
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace libcomp
+{
+
+/**
+ * Uniform grid used to index keyed entries by an axis aligned bounding box.
+ * Each entry is stored in every cell its bounding box overlaps so queries
+ * only need to visit the cells that overlap the query area. Coordinates
+ * outside of the configured bounds are clamped to the edge cells so the
+ * grid never loses track of an entry, it just becomes less selective for
+ * entries that stray outside of the expected area. Query results are a
+ * superset of the entries whose boxes overlap the query area and each
+ * entry is only returned once per query. This class is not thread safe.
+ */
+template<typename K>
+class SpatialGrid
+{
+public:
+    /**
+     * Create a new grid with a single cell. @ref Reset must be called
+     * before the grid will be selective.
+     */
+    SpatialGrid() : mMinX(0.f), mMinY(0.f), mInvCellSize(0.f),
+        mColumns(1), mRows(1)
+    {
+        mCells.resize(1);
+    }
+
+    /**
+     * Clear all entries and resize the grid to cover the supplied bounds.
+     * @param minX Minimum X coordinate of the area to cover
+     * @param minY Minimum Y coordinate of the area to cover
+     * @param maxX Maximum X coordinate of the area to cover
+     * @param maxY Maximum Y coordinate of the area to cover
+     * @param cellSize Width and height of each cell
+     * @param maxCells Upper bound on the cell count in each direction
+     *  used to keep very large areas from allocating huge grids
+     */
+    void Reset(float minX, float minY, float maxX, float maxY,
+        float cellSize, size_t maxCells = 256)
+    {
+        if(maxX < minX)
+        {
+            std::swap(minX, maxX);
+        }
+
+        if(maxY < minY)
+        {
+            std::swap(minY, maxY);
+        }
+
+        float width = std::max(maxX - minX, 1.f);
+        float height = std::max(maxY - minY, 1.f);
+
+        // Grow the cell size if either direction would exceed the maximum
+        float largest = std::max(width, height);
+        if(cellSize <= 0.f || largest / cellSize > (float)maxCells)
+        {
+            cellSize = largest / (float)maxCells;
+        }
+
+        mMinX = minX;
+        mMinY = minY;
+        mInvCellSize = 1.f / cellSize;
+        mColumns = std::max((int32_t)std::ceil(width * mInvCellSize), 1);
+        mRows = std::max((int32_t)std::ceil(height * mInvCellSize), 1);
+
+        mCells.clear();
+        mCells.resize((size_t)(mColumns * mRows));
+        mEntries.clear();
+    }
+
+    /**
+     * Add or move an entry to cover the supplied bounding box.
+     * @param key Key of the entry to add or update
+     * @param minX Minimum X coordinate of the entry's bounding box
+     * @param minY Minimum Y coordinate of the entry's bounding box
+     * @param maxX Maximum X coordinate of the entry's bounding box
+     * @param maxY Maximum Y coordinate of the entry's bounding box
+     */
+    void Update(const K& key, float minX, float minY, float maxX,
+        float maxY)
+    {
+        CellRange range = GetRange(minX, minY, maxX, maxY);
+
+        auto it = mEntries.find(key);
+        if(it != mEntries.end())
+        {
+            if(it->second == range)
+            {
+                // Same cells, nothing to do
+                return;
+            }
+
+            RemoveFromCells(key, it->second);
+            it->second = range;
+        }
+        else
+        {
+            mEntries[key] = range;
+        }
+
+        for(int32_t y = range.MinY; y <= range.MaxY; y++)
+        {
+            for(int32_t x = range.MinX; x <= range.MaxX; x++)
+            {
+                mCells[GetCellIndex(x, y)].push_back(
+                    CellEntry(key, range.MinX, range.MinY));
+            }
+        }
+    }
+
+    /**
+     * Remove an entry from the grid.
+     * @param key Key of the entry to remove
+     * @return true if the entry existed, false if it did not
+     */
+    bool Remove(const K& key)
+    {
+        auto it = mEntries.find(key);
+        if(it == mEntries.end())
+        {
+            return false;
+        }
+
+        RemoveFromCells(key, it->second);
+        mEntries.erase(it);
+
+        return true;
+    }
+
+    /**
+     * Remove all entries from the grid without changing its dimensions.
+     */
+    void Clear()
+    {
+        for(auto& cell : mCells)
+        {
+            cell.clear();
+        }
+
+        mEntries.clear();
+    }
+
+    /**
+     * Check if an entry exists in the grid.
+     * @param key Key of the entry to check
+     * @return true if the entry exists, false if it does not
+     */
+    bool Contains(const K& key) const
+    {
+        return mEntries.find(key) != mEntries.end();
+    }
+
+    /**
+     * Get the number of entries in the grid.
+     * @return Number of entries in the grid
+     */
+    size_t Count() const
+    {
+        return mEntries.size();
+    }
+
+    /**
+     * Gather the keys of all entries in cells overlapping the supplied
+     * bounding box. Each key is added only once.
+     * @param minX Minimum X coordinate of the query area
+     * @param minY Minimum Y coordinate of the query area
+     * @param maxX Maximum X coordinate of the query area
+     * @param maxY Maximum Y coordinate of the query area
+     * @param results Output list to append the keys to
+     */
+    void Query(float minX, float minY, float maxX, float maxY,
+        std::vector<K>& results) const
+    {
+        CellRange range = GetRange(minX, minY, maxX, maxY);
+
+        for(int32_t y = range.MinY; y <= range.MaxY; y++)
+        {
+            for(int32_t x = range.MinX; x <= range.MaxX; x++)
+            {
+                for(const CellEntry& entry : mCells[GetCellIndex(x, y)])
+                {
+                    // Entries spanning multiple cells are only reported
+                    // from the first cell both ranges share
+                    if(std::max(entry.MinX, range.MinX) == x &&
+                        std::max(entry.MinY, range.MinY) == y)
+                    {
+                        results.push_back(entry.Key);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Gather the keys of all entries in cells overlapping the square
+     * containing the supplied circle.
+     * @param x X coordinate of the center of the circle
+     * @param y Y coordinate of the center of the circle
+     * @param radius Radius of the circle
+     * @param results Output list to append the keys to
+     */
+    void QueryRadius(float x, float y, float radius,
+        std::vector<K>& results) const
+    {
+        Query(x - radius, y - radius, x + radius, y + radius, results);
+    }
+
+private:
+    /**
+     * Inclusive range of cell coordinates.
+     */
+    struct CellRange
+    {
+        /// Minimum cell column
+        int32_t MinX;
+
+        /// Minimum cell row
+        int32_t MinY;
+
+        /// Maximum cell column
+        int32_t MaxX;
+
+        /// Maximum cell row
+        int32_t MaxY;
+
+        /**
+         * Check if the range matches another range
+         * @param other Other range to compare against
+         * @return true if they are the same, false if they differ
+         */
+        bool operator==(const CellRange& other) const
+        {
+            return MinX == other.MinX && MinY == other.MinY &&
+                MaxX == other.MaxX && MaxY == other.MaxY;
+        }
+    };
+
+    /**
+     * Entry stored in each cell an indexed bounding box overlaps.
+     */
+    struct CellEntry
+    {
+        /**
+         * Create a new cell entry
+         * @param key Key of the indexed entry
+         * @param minX Minimum cell column of the indexed entry
+         * @param minY Minimum cell row of the indexed entry
+         */
+        CellEntry(const K& key, int32_t minX, int32_t minY) : Key(key),
+            MinX(minX), MinY(minY)
+        {
+        }
+
+        /// Key of the indexed entry
+        K Key;
+
+        /// Minimum cell column of the indexed entry
+        int32_t MinX;
+
+        /// Minimum cell row of the indexed entry
+        int32_t MinY;
+    };
+
+    /**
+     * Convert a coordinate to a clamped cell column or row.
+     * @param val Coordinate to convert
+     * @param min Minimum coordinate of the grid in the same direction
+     * @param count Number of cells in the same direction
+     * @return Cell column or row
+     */
+    int32_t ToCell(float val, float min, int32_t count) const
+    {
+        float cell = std::floor((val - min) * mInvCellSize);
+        if(!(cell >= 0.f))
+        {
+            // Also catches NaN
+            return 0;
+        }
+        else if(cell >= (float)count)
+        {
+            return count - 1;
+        }
+
+        return (int32_t)cell;
+    }
+
+    /**
+     * Get the range of cells overlapped by a bounding box.
+     * @param minX Minimum X coordinate of the bounding box
+     * @param minY Minimum Y coordinate of the bounding box
+     * @param maxX Maximum X coordinate of the bounding box
+     * @param maxY Maximum Y coordinate of the bounding box
+     * @return Range of cells overlapped
+     */
+    CellRange GetRange(float minX, float minY, float maxX,
+        float maxY) const
+    {
+        CellRange range;
+        range.MinX = ToCell(std::min(minX, maxX), mMinX, mColumns);
+        range.MinY = ToCell(std::min(minY, maxY), mMinY, mRows);
+        range.MaxX = ToCell(std::max(minX, maxX), mMinX, mColumns);
+        range.MaxY = ToCell(std::max(minY, maxY), mMinY, mRows);
+        return range;
+    }
+
+    /**
+     * Get the index of a cell in the cell list.
+     * @param x Cell column
+     * @param y Cell row
+     * @return Index of the cell
+     */
+    size_t GetCellIndex(int32_t x, int32_t y) const
+    {
+        return (size_t)(y * mColumns + x);
+    }
+
+    /**
+     * Remove an entry from each cell in a range.
+     * @param key Key of the entry to remove
+     * @param range Range of cells the entry is stored in
+     */
+    void RemoveFromCells(const K& key, const CellRange& range)
+    {
+        for(int32_t y = range.MinY; y <= range.MaxY; y++)
+        {
+            for(int32_t x = range.MinX; x <= range.MaxX; x++)
+            {
+                auto& cell = mCells[GetCellIndex(x, y)];
+                for(size_t i = 0; i < cell.size(); i++)
+                {
+                    if(cell[i].Key == key)
+                    {
+                        // Order does not matter, swap with the back
+                        cell[i] = cell.back();
+                        cell.pop_back();
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    /// Minimum X coordinate covered by the grid
+    float mMinX;
+
+    /// Minimum Y coordinate covered by the grid
+    float mMinY;
+
+    /// Inverse of the width and height of each cell
+    float mInvCellSize;
+
+    /// Number of cell columns
+    int32_t mColumns;
+
+    /// Number of cell rows
+    int32_t mRows;
+
+    /// Entries stored in each cell in row major order
+    std::vector<std::vector<CellEntry>> mCells;
+
+    /// Map of entry keys to the range of cells they are stored in
+    std::unordered_map<K, CellRange> mEntries;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_SPATIALGRID_H
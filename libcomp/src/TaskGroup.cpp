@@ -0,0 +1,135 @@
+/**
+ * @file libcomp/src/TaskGroup.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Group of independent tasks run in parallel.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TaskGroup.h"
+
+// libcomp Includes
+#include "Log.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <thread>
+
+using namespace libcomp;
+
+TaskGroup::TaskGroup() : mElapsed(0), mThreadCount(0)
+{
+}
+
+void TaskGroup::Add(const String& name, const std::function<bool()>& task)
+{
+    Task t;
+    t.Name = name;
+    t.Function = task;
+    t.Success = false;
+    t.Time = 0;
+
+    mTasks.push_back(t);
+}
+
+bool TaskGroup::Run(size_t threadCount)
+{
+    if(0 == threadCount)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    threadCount = std::max(std::min(threadCount, mTasks.size()), (size_t)1);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]()
+    {
+        for(size_t i = next++; i < mTasks.size(); i = next++)
+        {
+            auto& task = mTasks[i];
+            auto taskStart = std::chrono::steady_clock::now();
+
+            task.Success = task.Function();
+            task.Time = std::chrono::duration_cast<
+                std::chrono::microseconds>(std::chrono::steady_clock::now()
+                    - taskStart).count();
+        }
+    };
+
+    std::list<std::thread> threads;
+
+    for(size_t i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(worker);
+    }
+
+    // The calling thread does its share of the work too
+    worker();
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    mElapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    mThreadCount = threadCount;
+
+    bool success = true;
+
+    for(auto& task : mTasks)
+    {
+        success &= task.Success;
+    }
+
+    return success;
+}
+
+void TaskGroup::LogTimes(const String& title, bool eachTask) const
+{
+    int64_t total = 0;
+
+    for(auto& task : mTasks)
+    {
+        if(eachTask)
+        {
+            LOG_DEBUG(String("%1 %2: %3 ms%4\n").Arg(title).Arg(task.Name)
+                .Arg(task.Time / 1000).Arg(task.Success ? "" : " (failed)"));
+        }
+
+        total += task.Time;
+    }
+
+    LOG_DEBUG(String("%1: %2 task(s) took %3 ms on %4 thread(s) (%5 ms"
+        " if run one at a time).\n").Arg(title).Arg((uint64_t)mTasks.size())
+        .Arg(mElapsed / 1000).Arg((uint64_t)mThreadCount).Arg(total / 1000));
+}
+
+size_t TaskGroup::Size() const
+{
+    return mTasks.size();
+}
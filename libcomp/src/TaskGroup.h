@@ -0,0 +1,118 @@
+/**
+ * @file libcomp/src/TaskGroup.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Group of independent tasks run in parallel.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_TASKGROUP_H
+#define LIBCOMP_SRC_TASKGROUP_H
+
+// libcomp Includes
+#include "CString.h"
+
+// Standard C++11 Includes
+#include <functional>
+#include <vector>
+
+namespace libcomp
+{
+
+/**
+ * Group of independent tasks that are run in parallel by a set of
+ * short-lived threads and then waited on. This is meant for loading data
+ * at startup where each task (such as loading one definition table) does
+ * not touch the state written by any other task. Work that depends on the
+ * result of more than one task must be done after @ref Run returns.
+ */
+class TaskGroup
+{
+public:
+    /**
+     * Create an empty task group.
+     */
+    TaskGroup();
+
+    /**
+     * Add a task to the group.
+     * @param name Name of the task used when reporting how long it took
+     * @param task Function to run that returns false if it failed
+     */
+    void Add(const String& name, const std::function<bool()>& task);
+
+    /**
+     * Run every task in the group and wait for them to finish. Tasks are
+     * started in the order they were added. Every task is run even if an
+     * earlier one fails.
+     * @param threadCount Number of threads to run the tasks on. Zero uses
+     *  one thread for each hardware thread. One runs every task on the
+     *  calling thread.
+     * @returns true if every task succeeded, false otherwise
+     */
+    bool Run(size_t threadCount = 0);
+
+    /**
+     * Log how long the tasks took at debug level.
+     * @param title Description of the tasks in the group
+     * @param eachTask true to log the time of each task before the total,
+     *  false to only log the total
+     */
+    void LogTimes(const String& title, bool eachTask = true) const;
+
+    /**
+     * Get the number of tasks in the group.
+     * @returns Number of tasks in the group
+     */
+    size_t Size() const;
+
+private:
+    /**
+     * Task and the result of running it.
+     */
+    struct Task
+    {
+        /// Name of the task.
+        String Name;
+
+        /// Function to run.
+        std::function<bool()> Function;
+
+        /// Indicates the task succeeded.
+        bool Success;
+
+        /// Time the task took in microseconds.
+        int64_t Time;
+    };
+
+    /// Tasks in the order they were added.
+    std::vector<Task> mTasks;
+
+    /// Time the last call to Run took in microseconds.
+    int64_t mElapsed;
+
+    /// Number of threads used by the last call to Run.
+    size_t mThreadCount;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_TASKGROUP_H
@@ -192,6 +192,13 @@ bool TcpConnection::RequestPacket(size_t size)
     }
 #endif // COMP_HACK_DEBUG
 
+    if(0 != size && MAX_PACKET_SIZE >= (mReceivedPacket.Size() + size))
+    {
+        // Make sure the buffer can hold the data being requested.
+        mReceivedPacket.Reserve(mReceivedPacket.Size() +
+            static_cast<uint32_t>(size));
+    }
+
     // Get direct access to the buffer.
     char *pDestination = mReceivedPacket.Data();
 
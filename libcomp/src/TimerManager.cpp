@@ -29,41 +29,48 @@
 namespace libcomp
 {
 
-class TimerEvent
+/**
+ * Message sent to a worker queue each time a periodic event expires. The
+ * event keeps the code so the worker only gets a reference to it.
+ */
+class TimerExecute : public libcomp::Message::Execute
 {
-    friend class TimerEventComp;
-    friend class TimerManager;
+public:
+    /**
+     * Create the message.
+     * @param msg Code of the event to run
+     */
+    explicit TimerExecute(
+        const std::shared_ptr<libcomp::Message::Execute>& msg) : mMessage(msg)
+    {
+    }
+
+    virtual libcomp::Message::MessageType GetType() const
+    {
+        return libcomp::Message::MessageType::MESSAGE_TYPE_EXECUTE;
+    }
+
+    virtual libcomp::String Dump() const override
+    {
+        return mMessage->Dump();
+    }
 
-protected:
-    TimerEvent();
-    ~TimerEvent();
+    virtual void Run()
+    {
+        mMessage->Run();
+    }
 
-    std::chrono::steady_clock::time_point time;
-    std::chrono::milliseconds period;
-    libcomp::Message::Execute *msg;
-    bool mIsPeriodic;
+private:
+    /// Code of the event to run
+    std::shared_ptr<libcomp::Message::Execute> mMessage;
 };
 
 } // namespace libcomp
 
 using namespace libcomp;
 
-TimerEvent::TimerEvent() : msg(nullptr), mIsPeriodic(false)
-{
-}
-
-TimerEvent::~TimerEvent()
-{
-    delete msg;
-}
-
-bool TimerEventComp::operator()(const TimerEvent *lhs,
-    const TimerEvent *rhs) const
-{
-    return lhs->time < rhs->time;
-}
-
-TimerManager::TimerManager() : mRunning(true), mProcessingEvents(false)
+TimerManager::TimerManager() : mRunning(true),
+    mStart(std::chrono::steady_clock::now()), mWakeTick(0)
 {
     mRunThread = std::thread([&]()
     {
@@ -83,74 +90,87 @@ TimerManager::TimerManager() : mRunning(true), mProcessingEvents(false)
 
 TimerManager::~TimerManager()
 {
-    mRunning = false;
+    {
+        std::lock_guard<std::mutex> lock(mEventLock);
+        mRunning = false;
+    }
 
     mEventCondition.notify_all();
 
     mRunThread.join();
-
-    for(TimerEvent *pEvent : mEvents)
-    {
-        delete pEvent;
-    }
 }
 
 void TimerManager::ProcessEvents(std::unique_lock<std::mutex>& lock)
 {
-    auto now = std::chrono::steady_clock::now();
+    uint64_t now = (uint64_t)std::chrono::duration_cast<
+        std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+        mStart).count();
 
-    std::list<TimerEvent*> periodicals;
+    std::list<std::shared_ptr<libcomp::Message::Execute>> run;
 
-    mProcessingEvents = true;
+    // Nobody has to wake the thread until it waits again.
+    mWakeTick = 0;
 
-    while(!mEvents.empty())
+    mEvents.Advance(now, [&run](TimerEvent& event, uint64_t& expiry)
     {
-        auto it = mEvents.begin();
-
-        TimerEvent *pEvent = *it;
-
-        if(pEvent->time > now)
-        {
-            break;
-        }
-        else
+        if(event.queue)
         {
-            mEvents.erase(it++);
-
-            if(pEvent->msg)
-            {
-                // Unlock the mutex in the case the callback waits on another
-                // mutex that waits on the timer or the callback tries to
-                // register a new timer event. We don't like deadlocks.
-                lock.unlock();
-                pEvent->msg->Run();
-                lock.lock();
-            }
-
-            if(pEvent->mIsPeriodic)
+            if(event.period)
             {
-                pEvent->time += pEvent->period;
-
-                periodicals.push_back(pEvent);
+                event.queue->Enqueue(new TimerExecute(event.msg));
             }
             else
             {
-                delete pEvent;
+                // Nothing else has the message once it runs so give the
+                // worker the one the event has.
+                event.queue->Enqueue(new TimerExecute(std::move(event.msg)));
             }
         }
-    }
+        else
+        {
+            run.push_back(event.msg);
+        }
 
-    for(TimerEvent *pEvent : periodicals)
+        if(event.period)
+        {
+            expiry += event.period;
+
+            return true;
+        }
+
+        return false;
+    });
+
+    if(!run.empty())
     {
-        mEvents.insert(pEvent);
-    }
+        // Unlock the mutex in the case the callback waits on another
+        // mutex that waits on the timer or the callback tries to
+        // register a new timer event. We don't like deadlocks.
+        lock.unlock();
+
+        for(auto& msg : run)
+        {
+            msg->Run();
+        }
 
-    mProcessingEvents = false;
+        run.clear();
+
+        lock.lock();
+    }
 }
 
 void TimerManager::WaitForEvent(std::unique_lock<std::mutex>& lock)
 {
-    if(mEvents.empty())
+    if(!mRunning)
+    {
+        return;
+    }
+
+    uint64_t next = mEvents.GetNextTick();
+
+    mWakeTick = next;
+
+    if(UINT64_MAX == next)
     {
         // Wait for at least one event.
         mEventCondition.wait(lock);
@@ -158,61 +178,84 @@ void TimerManager::WaitForEvent(std::unique_lock<std::mutex>& lock)
     else
     {
         // We don't care why we wake we'll check everything anyway.
-        (void)mEventCondition.wait_until(lock, (*mEvents.begin())->time);
+        (void)mEventCondition.wait_until(lock, mStart +
+            std::chrono::milliseconds(next));
     }
-
 }
 
-TimerEvent* TimerManager::RegisterEvent(const std::chrono::steady_clock::time_point& time, libcomp::Message::Execute *pMessage)
+TimerManager::EventHandle TimerManager::AddEvent(uint64_t tick,
+    TimerEvent&& event)
 {
-    TimerEvent *pEvent = new TimerEvent;
-    pEvent->time = time;
-    pEvent->msg = pMessage;
-
     std::unique_lock<std::mutex> lock(mEventLock);
 
-    mEvents.insert(pEvent);
-    mEventCondition.notify_all();
+    auto handle = mEvents.Schedule(tick, std::move(event));
 
-    return pEvent;
+    // Only wake the thread if the event is due before it would wake.
+    if(tick < mWakeTick)
+    {
+        mWakeTick = 0;
+        mEventCondition.notify_one();
+    }
+
+    return handle;
 }
 
-TimerEvent* TimerManager::RegisterPeriodicEvent(const std::chrono::milliseconds& period, libcomp::Message::Execute *pMessage)
+TimerManager::EventHandle TimerManager::RegisterEvent(
+    const std::chrono::steady_clock::time_point& time,
+    libcomp::Message::Execute *pMessage,
+    const std::shared_ptr<Queue_t>& queue)
 {
-    TimerEvent *pEvent = new TimerEvent;
-    pEvent->time = std::chrono::steady_clock::now() + period;
-    pEvent->period = period;
-    pEvent->mIsPeriodic = true;
-    pEvent->msg = pMessage;
+    TimerEvent event;
+    event.msg.reset(pMessage);
+    event.queue = queue;
+    event.period = 0;
 
-    std::unique_lock<std::mutex> lock(mEventLock);
+    // Round up so the event never runs before the time.
+    uint64_t tick = 0;
 
-    mEvents.insert(pEvent);
-    mEventCondition.notify_all();
+    if(time > mStart)
+    {
+        auto offset = time - mStart;
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            offset);
 
-    return pEvent;
+        tick = (uint64_t)ms.count() + (ms < offset ? 1 : 0);
+    }
+
+    return AddEvent(tick, std::move(event));
 }
 
-void TimerManager::CancelEvent(TimerEvent *pEvent)
+TimerManager::EventHandle TimerManager::RegisterPeriodicEvent(
+    const std::chrono::milliseconds& period,
+    libcomp::Message::Execute *pMessage,
+    const std::shared_ptr<Queue_t>& queue)
 {
-    std::unique_lock<std::mutex> lock(mEventLock);
+    TimerEvent event;
+    event.msg.reset(pMessage);
+    event.queue = queue;
+    event.period = period.count() > 0 ? (uint64_t)period.count() : 1;
 
-    // If the event is being processed we can't cancel but if the event
-    // is periodic we can keep it from happening next time.
-    if(mProcessingEvents)
-    {
-        pEvent->mIsPeriodic = false;
-        return;
-    }
+    uint64_t now = (uint64_t)std::chrono::duration_cast<
+        std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+        mStart).count();
 
-    auto it = mEvents.find(pEvent);
+    return AddEvent(now + event.period, std::move(event));
+}
+
+bool TimerManager::CancelEvent(const EventHandle& handle)
+{
+    TimerEvent event;
 
-    if(mEvents.end() != it)
     {
-        mEvents.erase(it);
+        std::unique_lock<std::mutex> lock(mEventLock);
 
-        delete pEvent;
+        if(!mEvents.Cancel(handle, &event))
+        {
+            return false;
+        }
     }
 
-    mEventCondition.notify_all();
+    // The message is freed here outside of the lock (unless it is running
+    // right now in which case it is freed when the run is done).
+    return true;
 }
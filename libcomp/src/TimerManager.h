@@ -29,10 +29,12 @@
 
 // libcomp Includes
 #include "MessageExecute.h"
+#include "MessageQueue.h"
+#include "TimingWheel.h"
 
 #include <chrono>
 #include <list>
-#include <set>
+#include <memory>
 
 #include <condition_variable>
 #include <thread>
@@ -40,36 +42,77 @@
 namespace libcomp
 {
 
-class TimerEvent;
-
-class TimerEventComp
+/**
+ * Event waiting in the timer wheel.
+ */
+class TimerEvent
 {
 public:
-    bool operator()(const TimerEvent *lhs, const TimerEvent *rhs) const;
+    /// Code to run when the event expires
+    std::shared_ptr<libcomp::Message::Execute> msg;
+
+    /// Queue to send the code to or null to run it on the timer thread
+    std::shared_ptr<MessageQueue<libcomp::Message::Message*>> queue;
+
+    /// Number of milliseconds between runs or 0 if the event only runs once
+    uint64_t period;
 };
 
 class TimerManager
 {
 public:
+    /// Handle to a scheduled event that may be used to cancel it
+    typedef TimingWheel<TimerEvent>::Handle EventHandle;
+
+    /// Queue expired events may be sent to
+    typedef MessageQueue<libcomp::Message::Message*> Queue_t;
+
     TimerManager();
     ~TimerManager();
 
-    TimerEvent* RegisterEvent(
+    /**
+     * Register an event to run at a given time.
+     * @param time Time to run the event at
+     * @param pMessage Code to run (the manager takes ownership)
+     * @param queue Optional queue to send the code to when the event
+     *  expires. If this is null the code is run on the timer thread.
+     * @return Handle to cancel the event with
+     */
+    EventHandle RegisterEvent(
         const std::chrono::steady_clock::time_point& time,
-        libcomp::Message::Execute *pMessage);
-    TimerEvent* RegisterPeriodicEvent(
+        libcomp::Message::Execute *pMessage,
+        const std::shared_ptr<Queue_t>& queue = {});
+
+    /**
+     * Register an event to run repeatedly.
+     * @param period Time from now until the first run and between runs
+     * @param pMessage Code to run (the manager takes ownership)
+     * @param queue Optional queue to send the code to each time the event
+     *  expires. If this is null the code is run on the timer thread.
+     * @return Handle to cancel the event with
+     */
+    EventHandle RegisterPeriodicEvent(
         const std::chrono::milliseconds& period,
-        libcomp::Message::Execute *pMessage);
-    void CancelEvent(TimerEvent *pEvent);
+        libcomp::Message::Execute *pMessage,
+        const std::shared_ptr<Queue_t>& queue = {});
 
     /**
-     * Executes code in the worker thread.
-     * @param f Function (lambda) to execute in the worker thread.
+     * Cancel an event. If the event is running now the current run will
+     * finish but a periodic event will not run again.
+     * @param handle Handle returned when the event was registered
+     * @return true if the event was cancelled; false if it already ran or
+     *  was cancelled
+     */
+    bool CancelEvent(const EventHandle& handle);
+
+    /**
+     * Executes code in the timer thread.
+     * @param f Function (lambda) to execute in the timer thread.
      * @param args Arguments to pass to the function when it is executed.
-     * @return true on success, false on failure
+     * @return Handle to cancel the event with
      */
     template<typename Function, typename... Args>
-    TimerEvent* ScheduleEvent(
+    EventHandle ScheduleEvent(
         const std::chrono::steady_clock::time_point& time,
         Function&& f, Args&&... args)
     {
@@ -80,13 +123,13 @@ public:
     }
 
     /**
-     * Executes code in the worker thread.
-     * @param f Function (lambda) to execute in the worker thread.
+     * Executes code in the timer thread.
+     * @param f Function (lambda) to execute in the timer thread.
      * @param args Arguments to pass to the function when it is executed.
-     * @return true on success, false on failure
+     * @return Handle to cancel the event with
      */
     template<typename Function, typename... Args>
-    TimerEvent* ScheduleEventIn(int seconds,
+    EventHandle ScheduleEventIn(int seconds,
         Function&& f, Args&&... args)
     {
         auto msg = new libcomp::Message::ExecuteImpl<Args...>(
@@ -97,13 +140,13 @@ public:
     }
 
     /**
-     * Executes code in the worker thread.
-     * @param f Function (lambda) to execute in the worker thread.
+     * Executes code in the timer thread.
+     * @param f Function (lambda) to execute in the timer thread.
      * @param args Arguments to pass to the function when it is executed.
-     * @return true on success, false on failure
+     * @return Handle to cancel the event with
      */
     template<typename Function, typename... Args>
-    TimerEvent* SchedulePeriodicEvent(
+    EventHandle SchedulePeriodicEvent(
         const std::chrono::milliseconds& period,
         Function&& f, Args&&... args)
     {
@@ -113,13 +156,77 @@ public:
         return RegisterPeriodicEvent(period, msg);
     }
 
+    /**
+     * Executes code in the worker that owns a queue once the time has
+     * passed. The timer thread only queues the code.
+     * @param queue Queue of the worker to execute the code in.
+     * @param f Function (lambda) to execute in the worker thread.
+     * @param args Arguments to pass to the function when it is executed.
+     * @return Handle to cancel the event with
+     */
+    template<typename Function, typename... Args>
+    EventHandle QueueEvent(const std::shared_ptr<Queue_t>& queue,
+        const std::chrono::steady_clock::time_point& time,
+        Function&& f, Args&&... args)
+    {
+        auto msg = new libcomp::Message::ExecuteImpl<Args...>(
+            std::forward<Function>(f), std::forward<Args>(args)...);
+
+        return RegisterEvent(time, msg, queue);
+    }
+
+    /**
+     * Executes code in the worker that owns a queue once a number of
+     * seconds has passed. The timer thread only queues the code.
+     * @param queue Queue of the worker to execute the code in.
+     * @param f Function (lambda) to execute in the worker thread.
+     * @param args Arguments to pass to the function when it is executed.
+     * @return Handle to cancel the event with
+     */
+    template<typename Function, typename... Args>
+    EventHandle QueueEventIn(const std::shared_ptr<Queue_t>& queue,
+        int seconds, Function&& f, Args&&... args)
+    {
+        auto msg = new libcomp::Message::ExecuteImpl<Args...>(
+            std::forward<Function>(f), std::forward<Args>(args)...);
+
+        return RegisterEvent(std::chrono::steady_clock::now() +
+            std::chrono::seconds(seconds), msg, queue);
+    }
+
+    /**
+     * Executes code in the worker that owns a queue each time the period
+     * passes. The timer thread only queues the code.
+     * @param queue Queue of the worker to execute the code in.
+     * @param f Function (lambda) to execute in the worker thread.
+     * @param args Arguments to pass to the function when it is executed.
+     * @return Handle to cancel the event with
+     */
+    template<typename Function, typename... Args>
+    EventHandle QueuePeriodicEvent(const std::shared_ptr<Queue_t>& queue,
+        const std::chrono::milliseconds& period,
+        Function&& f, Args&&... args)
+    {
+        auto msg = new libcomp::Message::ExecuteImpl<Args...>(
+            std::forward<Function>(f), std::forward<Args>(args)...);
+
+        return RegisterPeriodicEvent(period, msg, queue);
+    }
+
 private:
+    EventHandle AddEvent(uint64_t tick, TimerEvent&& event);
     void ProcessEvents(std::unique_lock<std::mutex>& lock);
     void WaitForEvent(std::unique_lock<std::mutex>& lock);
 
     volatile bool mRunning;
-    volatile bool mProcessingEvents;
-    std::multiset<TimerEvent*, TimerEventComp> mEvents;
+
+    /// Time tick 0 of the wheel is at (each tick is a millisecond)
+    std::chrono::steady_clock::time_point mStart;
+
+    /// Tick the timer thread is waiting for or 0 if it is not waiting
+    uint64_t mWakeTick;
+
+    TimingWheel<TimerEvent> mEvents;
     std::condition_variable mEventCondition;
     std::mutex mEventLock;
     std::thread mRunThread;
@@ -0,0 +1,603 @@
+/**
+ * @file libcomp/src/TimingWheel.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Hierarchical timing wheel for scheduling work by tick.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_TIMINGWHEEL_H
+#define LIBCOMP_SRC_TIMINGWHEEL_H
+
+// Standard C++11 Includes
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <utility>
+#include <vector>
+
+namespace libcomp
+{
+
+/**
+ * Values scheduled to expire at an absolute tick. What a tick means is up
+ * to the owner (the timer manager uses milliseconds). Scheduling and
+ * cancelling are constant time: each value lives in an intrusive list in
+ * one slot of one of four wheels of 256 slots. The first wheel holds the
+ * next 256 ticks, each slot of the next wheel holds 256 ticks of the first
+ * and so on. When the first wheel comes back around the matching slot of
+ * the next wheel is cascaded down into it. Values further out than the
+ * last wheel can hold are parked in it and cascaded again until they fit.
+ * Each slot is kept sorted by the order given when a value is scheduled
+ * and then by when it was scheduled, so values due on the same tick expire
+ * in that order even if some were cascaded down from a higher wheel after
+ * others were added straight to the first wheel.
+ *
+ * Values are kept in a slab so a @ref Handle is just an index and the
+ * generation of the slot in the slab. A handle to a value that expired or
+ * was cancelled will not match a reused slot so it is always safe to
+ * cancel with an old handle.
+ *
+ * The wheel is not thread safe. The owner must lock around it.
+ */
+template<class T>
+class TimingWheel
+{
+public:
+    /**
+     * Handle to a scheduled value that can be used to cancel it.
+     */
+    struct Handle
+    {
+        /// Index of the value in the slab
+        uint32_t Index;
+
+        /// Generation of the slab entry when the value was scheduled
+        uint32_t Generation;
+
+        /**
+         * Create a handle that does not refer to any value.
+         */
+        Handle() : Index(NIL), Generation(0)
+        {
+        }
+
+        /**
+         * Check if the handle was returned by @ref Schedule.
+         * @return true if the handle refers to a value that was scheduled
+         * @note This does not mean the value has not expired yet.
+         */
+        bool IsValid() const
+        {
+            return NIL != Index;
+        }
+    };
+
+    /**
+     * Create an empty wheel.
+     * @param now Current tick; nothing can be scheduled at or before it
+     */
+    explicit TimingWheel(uint64_t now = 0) : mCurrent(now), mFree(NIL),
+        mSize(0), mSequence(0)
+    {
+        for(uint32_t& head : mHeads)
+        {
+            head = NIL;
+        }
+
+        for(uint32_t& tail : mTails)
+        {
+            tail = NIL;
+        }
+
+        for(uint64_t& bits : mOccupied)
+        {
+            bits = 0;
+        }
+    }
+
+    /**
+     * Schedule a value.
+     * @param expiry Tick the value should expire on. If this is not after
+     *  the current tick the value expires on the next tick.
+     * @param value Value to return when it expires
+     * @param order Values due on the same tick expire from the lowest order
+     *  to the highest and then in the order they were scheduled. This lets
+     *  the owner keep finer timestamps in order within a tick.
+     * @return Handle that may be used to cancel the value
+     */
+    Handle Schedule(uint64_t expiry, T value, uint64_t order = 0)
+    {
+        uint32_t index = mFree;
+
+        if(NIL != index)
+        {
+            mFree = mNodes[index].Next;
+        }
+        else
+        {
+            index = (uint32_t)mNodes.size();
+            mNodes.emplace_back();
+            mNodes.back().Generation = 0;
+        }
+
+        Node& node = mNodes[index];
+        node.Value = std::move(value);
+        node.Expiry = expiry > mCurrent ? expiry : mCurrent + 1;
+        node.Order = order;
+        node.Sequence = mSequence++;
+
+        Link(index);
+        mSize++;
+
+        Handle handle;
+        handle.Index = index;
+        handle.Generation = node.Generation;
+
+        return handle;
+    }
+
+    /**
+     * Cancel a value that has not expired yet.
+     * @param handle Handle returned when the value was scheduled
+     * @param pValue Optional pointer to move the cancelled value into
+     * @return true if the value was cancelled; false if it had already
+     *  expired or been cancelled
+     */
+    bool Cancel(const Handle& handle, T *pValue = nullptr)
+    {
+        if(!IsScheduled(handle))
+        {
+            return false;
+        }
+
+        Unlink(handle.Index);
+
+        if(nullptr != pValue)
+        {
+            *pValue = std::move(mNodes[handle.Index].Value);
+        }
+
+        Free(handle.Index);
+
+        return true;
+    }
+
+    /**
+     * Check if a value is still waiting to expire.
+     * @param handle Handle returned when the value was scheduled
+     * @return true if the value has not expired or been cancelled
+     */
+    bool IsScheduled(const Handle& handle) const
+    {
+        return handle.Index < mNodes.size() &&
+            mNodes[handle.Index].Generation == handle.Generation &&
+            FREE != mNodes[handle.Index].Slot;
+    }
+
+    /**
+     * Advance the wheel and expire every value due at or before a tick.
+     * Values are expired in tick order. Ticks with nothing to expire or
+     * cascade are skipped.
+     * @param now Tick to advance to
+     * @param expire Function called with each expired value and the tick it
+     *  was scheduled for. If the function updates the tick and returns true
+     *  the value is scheduled again and keeps the same handle and order.
+     *  The function must not schedule or cancel anything on the wheel.
+     */
+    template<typename Function>
+    void Advance(uint64_t now, Function&& expire)
+    {
+        while(mCurrent < now)
+        {
+            uint64_t next = GetNextTick();
+
+            if(next > now)
+            {
+                mCurrent = now;
+                break;
+            }
+
+            mCurrent = next;
+
+            // Cascade from the last wheel down so everything due this tick
+            // is in the first wheel before it is expired.
+            for(uint32_t level = LEVEL_COUNT - 1; 0 < level; level--)
+            {
+                if(0 == (mCurrent & (((uint64_t)1 << (SLOT_BITS * level)) - 1)))
+                {
+                    uint32_t index = TakeSlot(level, mCurrent);
+
+                    while(NIL != index)
+                    {
+                        uint32_t nextIndex = mNodes[index].Next;
+                        Link(index);
+                        index = nextIndex;
+                    }
+                }
+            }
+
+            uint32_t index = TakeSlot(0, mCurrent);
+
+            while(NIL != index)
+            {
+                Node& node = mNodes[index];
+                uint32_t nextIndex = node.Next;
+
+                if(expire(node.Value, node.Expiry))
+                {
+                    if(node.Expiry <= mCurrent)
+                    {
+                        node.Expiry = mCurrent + 1;
+                    }
+
+                    node.Sequence = mSequence++;
+                    Link(index);
+                }
+                else
+                {
+                    Free(index);
+                }
+
+                index = nextIndex;
+            }
+        }
+    }
+
+    /**
+     * Advance the wheel and collect every value due at or before a tick.
+     * @param now Tick to advance to
+     * @param expired List to add the expired values to in tick order
+     */
+    void Advance(uint64_t now, std::list<T>& expired)
+    {
+        Advance(now, [&expired](T& value, uint64_t& expiry)
+        {
+            (void)expiry;
+
+            expired.push_back(std::move(value));
+
+            return false;
+        });
+    }
+
+    /**
+     * Remove every value without expiring it.
+     * @param values List to add the values to
+     */
+    void Clear(std::list<T>& values)
+    {
+        for(uint32_t index = 0; index < (uint32_t)mNodes.size(); index++)
+        {
+            if(FREE != mNodes[index].Slot)
+            {
+                Unlink(index);
+                values.push_back(std::move(mNodes[index].Value));
+                Free(index);
+            }
+        }
+    }
+
+    /**
+     * Get the next tick @ref Advance has to stop on: either a tick values
+     * expire on or a tick a slot is cascaded on. Waiting until this tick
+     * never misses a value and skips any stretch of empty ticks.
+     * @return Next tick with work to do or UINT64_MAX if the wheel is empty
+     */
+    uint64_t GetNextTick() const
+    {
+        uint64_t next = UINT64_MAX;
+
+        if(0 == mSize)
+        {
+            return next;
+        }
+
+        for(uint32_t level = 0; level < LEVEL_COUNT; level++)
+        {
+            uint32_t shift = SLOT_BITS * level;
+            uint64_t block = mCurrent >> shift;
+            uint32_t current = (uint32_t)(block & (SLOT_COUNT - 1));
+
+            uint32_t slot = FindSlot(level, current + 1);
+
+            if(NIL == slot)
+            {
+                // Wrap around to the slots behind the current one.
+                slot = FindSlot(level, 0);
+            }
+
+            if(NIL != slot)
+            {
+                uint64_t distance = (slot - current) & (SLOT_COUNT - 1);
+                uint64_t tick = (block + (distance ? distance : SLOT_COUNT))
+                    << shift;
+
+                if(tick < next)
+                {
+                    next = tick;
+                }
+            }
+        }
+
+        return next;
+    }
+
+    /**
+     * Get the tick the wheel has advanced to.
+     * @return Current tick
+     */
+    uint64_t GetCurrentTick() const
+    {
+        return mCurrent;
+    }
+
+    /**
+     * Get the number of values waiting to expire.
+     * @return Number of scheduled values
+     */
+    size_t Size() const
+    {
+        return mSize;
+    }
+
+private:
+    /// Number of bits of the tick each wheel covers
+    static const uint32_t SLOT_BITS = 8;
+
+    /// Number of slots in each wheel
+    static const uint32_t SLOT_COUNT = 1 << SLOT_BITS;
+
+    /// Number of wheels
+    static const uint32_t LEVEL_COUNT = 4;
+
+    /// Furthest a value can be scheduled from the current tick before it
+    /// has to be cascaded more than once
+    static const uint64_t MAX_DISTANCE =
+        ((uint64_t)1 << (SLOT_BITS * LEVEL_COUNT)) - 1;
+
+    /// Index used for the end of a list
+    static const uint32_t NIL = UINT32_MAX;
+
+    /// Slot stored in an entry of the slab that is not in use
+    static const uint16_t FREE = UINT16_MAX;
+
+    /**
+     * Entry in the slab for a scheduled value.
+     */
+    struct Node
+    {
+        /// Value to return when it expires
+        T Value;
+
+        /// Tick the value expires on
+        uint64_t Expiry;
+
+        /// Order of the value among values due on the same tick
+        uint64_t Order;
+
+        /// Number of values scheduled before this one
+        uint64_t Sequence;
+
+        /// Previous entry in the slot or NIL
+        uint32_t Prev;
+
+        /// Next entry in the slot, next free entry or NIL
+        uint32_t Next;
+
+        /// Incremented each time the entry is freed
+        uint32_t Generation;
+
+        /// Wheel and slot the entry is in or FREE
+        uint16_t Slot;
+    };
+
+    /**
+     * Add an entry to the slot it belongs in relative to the current tick
+     * after every entry that comes before it. New entries usually go at the
+     * end; entries cascaded down may have to step back past entries that
+     * were scheduled after them.
+     * @param index Index of the entry in the slab
+     */
+    void Link(uint32_t index)
+    {
+        Node& node = mNodes[index];
+
+        uint64_t distance = node.Expiry - mCurrent;
+        uint64_t tick = node.Expiry;
+
+        uint32_t level = 0;
+        while(level < (LEVEL_COUNT - 1) &&
+            distance >= ((uint64_t)1 << (SLOT_BITS * (level + 1))))
+        {
+            level++;
+        }
+
+        if(distance > MAX_DISTANCE)
+        {
+            // Park it as far out as the last wheel goes.
+            tick = mCurrent + MAX_DISTANCE;
+        }
+
+        uint32_t slot = level * SLOT_COUNT + (uint32_t)((tick >>
+            (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+
+        uint32_t prev = mTails[slot];
+
+        while(NIL != prev && (node.Order < mNodes[prev].Order ||
+            (node.Order == mNodes[prev].Order &&
+            node.Sequence < mNodes[prev].Sequence)))
+        {
+            prev = mNodes[prev].Prev;
+        }
+
+        node.Slot = (uint16_t)slot;
+        node.Prev = prev;
+        node.Next = NIL != prev ? mNodes[prev].Next : mHeads[slot];
+
+        if(NIL != node.Prev)
+        {
+            mNodes[node.Prev].Next = index;
+        }
+        else
+        {
+            mHeads[slot] = index;
+        }
+
+        if(NIL != node.Next)
+        {
+            mNodes[node.Next].Prev = index;
+        }
+        else
+        {
+            mTails[slot] = index;
+        }
+
+        mOccupied[slot / 64] |= (uint64_t)1 << (slot % 64);
+    }
+
+    /**
+     * Remove an entry from its slot.
+     * @param index Index of the entry in the slab
+     */
+    void Unlink(uint32_t index)
+    {
+        Node& node = mNodes[index];
+
+        if(NIL != node.Prev)
+        {
+            mNodes[node.Prev].Next = node.Next;
+        }
+        else
+        {
+            mHeads[node.Slot] = node.Next;
+
+            if(NIL == node.Next)
+            {
+                mOccupied[node.Slot / 64] &= ~((uint64_t)1 <<
+                    (node.Slot % 64));
+            }
+        }
+
+        if(NIL != node.Next)
+        {
+            mNodes[node.Next].Prev = node.Prev;
+        }
+        else
+        {
+            mTails[node.Slot] = node.Prev;
+        }
+    }
+
+    /**
+     * Return an entry to the free list.
+     * @param index Index of the entry in the slab
+     */
+    void Free(uint32_t index)
+    {
+        Node& node = mNodes[index];
+        node.Value = T();
+        node.Slot = FREE;
+        node.Generation++;
+        node.Next = mFree;
+
+        mFree = index;
+        mSize--;
+    }
+
+    /**
+     * Empty the slot a tick falls in.
+     * @param level Wheel the slot is in
+     * @param tick Tick to get the slot for
+     * @return Index of the first entry that was in the slot or NIL
+     */
+    uint32_t TakeSlot(uint32_t level, uint64_t tick)
+    {
+        uint32_t slot = level * SLOT_COUNT + (uint32_t)((tick >>
+            (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+
+        uint32_t index = mHeads[slot];
+
+        mHeads[slot] = NIL;
+        mTails[slot] = NIL;
+        mOccupied[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+
+        return index;
+    }
+
+    /**
+     * Find the first slot with anything in it.
+     * @param level Wheel to search
+     * @param start First slot in the wheel to check
+     * @return First occupied slot at or after the start or NIL
+     */
+    uint32_t FindSlot(uint32_t level, uint32_t start) const
+    {
+        for(uint32_t slot = start; slot < SLOT_COUNT; )
+        {
+            uint64_t bits = mOccupied[(level * SLOT_COUNT + slot) / 64] >>
+                (slot % 64);
+
+            if(0 != bits)
+            {
+                while(0 == (bits & 1))
+                {
+                    bits >>= 1;
+                    slot++;
+                }
+
+                return slot;
+            }
+
+            slot = (slot | 63) + 1;
+        }
+
+        return NIL;
+    }
+
+    /// Tick the wheel has advanced to
+    uint64_t mCurrent;
+
+    /// First entry in each slot of each wheel
+    uint32_t mHeads[LEVEL_COUNT * SLOT_COUNT];
+
+    /// Last entry in each slot of each wheel
+    uint32_t mTails[LEVEL_COUNT * SLOT_COUNT];
+
+    /// One bit for each slot that has anything in it
+    uint64_t mOccupied[LEVEL_COUNT * SLOT_COUNT / 64];
+
+    /// Slab of entries for scheduled values
+    std::vector<Node> mNodes;
+
+    /// First free entry in the slab or NIL
+    uint32_t mFree;
+
+    /// Number of scheduled values
+    size_t mSize;
+
+    /// Number of values scheduled so far
+    uint64_t mSequence;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_TIMINGWHEEL_H
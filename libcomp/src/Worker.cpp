@@ -94,59 +94,62 @@ void Worker::Start(const libcomp::String& name, bool blocking)
 
 void Worker::Run(MessageQueue<Message::Message*> *pMessageQueue)
 {
-    std::list<libcomp::Message::Message*> msgs;
-    pMessageQueue->DequeueAll(msgs);
+    pMessageQueue->DequeueAll(mMessages);
 
-    for(auto pMessage : msgs)
+    for(auto pMessage : mMessages)
     {
-        // Check for a shutdown message.
-        libcomp::Message::Shutdown *pShutdown = dynamic_cast<
-            libcomp::Message::Shutdown*>(pMessage);
+        HandleMessage(pMessage);
+    }
 
-        // Check for an execute message.
-        libcomp::Message::Execute *pExecute = dynamic_cast<
-            libcomp::Message::Execute*>(pMessage);
+    mMessages.clear();
+}
 
-        // Do not handle any more messages if a shutdown was sent.
-        if(nullptr != pShutdown || !mRunning)
-        {
-            mRunning = false;
-        }
-        else if(nullptr != pExecute)
+void Worker::HandleMessage(libcomp::Message::Message *pMessage)
+{
+    // Shutdown and execute messages are handled by the worker itself.
+    // Dispatch on the message type rather than casting every message.
+    auto type = pMessage->GetType();
+
+    // Do not handle any more messages if a shutdown was sent.
+    if(libcomp::Message::MessageType::MESSAGE_TYPE_SHUTDOWN == type ||
+        !mRunning)
+    {
+        mRunning = false;
+    }
+    else if(libcomp::Message::MessageType::MESSAGE_TYPE_EXECUTE == type)
+    {
+        // Run the code now.
+        static_cast<libcomp::Message::Execute*>(pMessage)->Run();
+    }
+    else
+    {
+        // Attempt to find a manager to process this message.
+        auto it = mManagers.find(type);
+
+        // Process the message if the manager is valid.
+        if(it == mManagers.end())
         {
-            // Run the code now.
-            pExecute->Run();
+            LOG_ERROR(libcomp::String("Unhandled message type: %1\n").Arg(
+                static_cast<std::size_t>(type)));
         }
         else
         {
-            // Attempt to find a manager to process this message.
-            auto it = mManagers.find(pMessage->GetType());
+            auto manager = it->second;
 
-            // Process the message if the manager is valid.
-            if(it == mManagers.end())
+            if(!manager)
             {
-                LOG_ERROR(libcomp::String("Unhandled message type: %1\n").Arg(
-                    static_cast<std::size_t>(pMessage->GetType())));
+                LOG_ERROR("Manager is null!\n");
             }
-            else
+            else if(!manager->ProcessMessage(pMessage))
             {
-                auto manager = it->second;
-
-                if(!manager)
-                {
-                    LOG_ERROR("Manager is null!\n");
-                }
-                else if(!manager->ProcessMessage(pMessage))
-                {
-                    LOG_ERROR(libcomp::String("Failed to process message:\n"
-                        "%1\n").Arg(pMessage->Dump()));
-                }
+                LOG_ERROR(libcomp::String("Failed to process message:\n"
+                    "%1\n").Arg(pMessage->Dump()));
             }
         }
-
-        // Free the message now.
-        delete pMessage;
     }
+
+    // Free the message now.
+    delete pMessage;
 }
 
 void Worker::Shutdown()
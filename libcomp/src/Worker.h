@@ -39,6 +39,7 @@
 #include <memory>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace libcomp
 {
@@ -114,7 +115,7 @@ public:
      * @sa BaseServer::GetNextConnectionWorker
      * @return The number of active references to the message queue
      */
-    long AssignmentCount() const;
+    virtual long AssignmentCount() const;
 
     /**
      * Executes code in the worker thread.
@@ -140,12 +141,23 @@ public:
     }
 
 protected:
+    /**
+     * Handle a message with the worker or the appropriate @ref Manager
+     * configured for the worker. The message is freed after it is handled.
+     * @param pMessage Message to handle
+     */
+    void HandleMessage(libcomp::Message::Message *pMessage);
+
     /**
      * Clean up the worker, deleting the thread if it exists and resetting
      * the message queue.  This is called by the destructor.
      */
     virtual void Cleanup();
 
+    /// Messages dequeued by @ref Run but not handled yet. This is kept
+    /// between calls so the vector does not have to grow again each time.
+    std::vector<libcomp::Message::Message*> mMessages;
+
 private:
     /// Signifier that the worker should continue running
     bool mRunning;
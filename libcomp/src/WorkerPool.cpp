@@ -0,0 +1,264 @@
+/**
+ * @file libcomp/src/WorkerPool.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pool of workers that share the connection message queues.
+ *
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WorkerPool.h"
+
+// Standard C++11 Includes
+#include <chrono>
+
+using namespace libcomp;
+
+WorkerPool::WorkerPool() : mReadyCount(0), mIdleCount(0)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    // Free any messages that were never handled.
+    for(auto& readyList : mReadyLists)
+    {
+        for(auto queue : readyList->queues)
+        {
+            std::list<libcomp::Message::Message*> msgs;
+            queue->DequeueAny(msgs);
+
+            for(auto pMessage : msgs)
+            {
+                delete pMessage;
+            }
+        }
+    }
+}
+
+std::shared_ptr<PooledWorker> WorkerPool::CreateWorker()
+{
+    auto readyList = std::unique_ptr<ReadyList>(new ReadyList);
+    readyList->depth = 0;
+
+    mReadyLists.push_back(std::move(readyList));
+
+    return std::make_shared<PooledWorker>(shared_from_this(),
+        mReadyLists.size() - 1);
+}
+
+void WorkerPool::Schedule(size_t index, const std::shared_ptr<Queue_t>& queue)
+{
+    auto& readyList = mReadyLists[index];
+    {
+        std::lock_guard<std::mutex> lock(readyList->lock);
+        readyList->queues.push_back(queue);
+        readyList->depth++;
+
+        // This pairs with the idle count and the ready count check in Wait
+        // so at least one side sees the other.
+        mReadyCount++;
+    }
+
+    if(0 < mIdleCount.load())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mIdleLock);
+        }
+
+        mIdleCondition.notify_one();
+    }
+}
+
+std::shared_ptr<WorkerPool::Queue_t> WorkerPool::Next(size_t index)
+{
+    size_t count = mReadyLists.size();
+
+    // Check the worker's own list first then every other list in turn.
+    for(size_t i = 0; i < count; i++)
+    {
+        auto& readyList = mReadyLists[(index + i) % count];
+
+        if(0 == readyList->depth.load())
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(readyList->lock);
+
+        if(!readyList->queues.empty())
+        {
+            auto queue = readyList->queues.front();
+            readyList->queues.pop_front();
+            readyList->depth--;
+            mReadyCount--;
+
+            return queue;
+        }
+    }
+
+    return nullptr;
+}
+
+void WorkerPool::Wait(const std::atomic<bool>& signalled)
+{
+    std::unique_lock<std::mutex> lock(mIdleLock);
+
+    mIdleCount++;
+    mIdleCondition.wait(lock, [this, &signalled]()
+    {
+        return signalled.load() || 0 < mReadyCount.load();
+    });
+    mIdleCount--;
+}
+
+void WorkerPool::WakeAll()
+{
+    {
+        std::lock_guard<std::mutex> lock(mIdleLock);
+    }
+
+    mIdleCondition.notify_all();
+}
+
+size_t WorkerPool::GetQueueDepth(size_t index) const
+{
+    return mReadyLists[index]->depth.load();
+}
+
+PooledWorker::PooledWorker(const std::shared_ptr<WorkerPool>& pool,
+    size_t index) : mPool(pool), mIndex(index), mSignalled(false),
+    mAssignments(std::make_shared<std::atomic<long>>(0)), mBusyTime(0)
+{
+    // Shutdown and execute messages sent to the worker itself wake it up
+    // no matter which queue it is waiting on.
+    GetMessageQueue()->SetReadyHandler([this]()
+    {
+        mSignalled.store(true);
+        mPool->WakeAll();
+    });
+}
+
+PooledWorker::~PooledWorker()
+{
+}
+
+std::shared_ptr<WorkerPool::Queue_t> PooledWorker::CreateConnectionQueue()
+{
+    auto assignments = mAssignments;
+    (*assignments)++;
+
+    auto queue = std::shared_ptr<WorkerPool::Queue_t>(
+        new WorkerPool::Queue_t, [assignments](WorkerPool::Queue_t *pQueue)
+        {
+            (*assignments)--;
+            delete pQueue;
+        });
+
+    // The connection holding the queue is the one enqueuing so the queue
+    // is always still around when the handler is called.
+    std::weak_ptr<WorkerPool::Queue_t> weakQueue = queue;
+    std::weak_ptr<WorkerPool> weakPool = mPool;
+    size_t index = mIndex;
+
+    queue->SetReadyHandler([weakQueue, weakPool, index]()
+    {
+        auto readyQueue = weakQueue.lock();
+        auto pool = weakPool.lock();
+
+        if(readyQueue && pool)
+        {
+            pool->Schedule(index, readyQueue);
+        }
+    });
+
+    return queue;
+}
+
+void PooledWorker::Run(MessageQueue<Message::Message*> *pMessageQueue)
+{
+    // Handle the messages sent to the worker itself first.
+    mSignalled.store(false);
+
+    do
+    {
+        pMessageQueue->DequeueAny(mMessages);
+
+        for(auto pMessage : mMessages)
+        {
+            HandleMessage(pMessage);
+        }
+
+        mMessages.clear();
+    } while(pMessageQueue->Release());
+
+    if(!IsRunning())
+    {
+        return;
+    }
+
+    auto queue = mPool->Next(mIndex);
+
+    if(!queue)
+    {
+        mPool->Wait(mSignalled);
+
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Run the messages that are in the queue now. If more come in after
+    // this the queue goes to the back of the list so other connections
+    // get a turn.
+    queue->DequeueAny(mMessages);
+
+    for(auto pMessage : mMessages)
+    {
+        HandleMessage(pMessage);
+    }
+
+    mMessages.clear();
+
+    if(queue->Release())
+    {
+        mPool->Schedule(mIndex, queue);
+    }
+
+    mBusyTime += (uint64_t)std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::steady_clock::now() -
+        start).count();
+}
+
+long PooledWorker::AssignmentCount() const
+{
+    return mAssignments->load();
+}
+
+size_t PooledWorker::GetQueueDepth() const
+{
+    return mPool->GetQueueDepth(mIndex);
+}
+
+uint64_t PooledWorker::GetBusyTime() const
+{
+    return mBusyTime.load();
+}
@@ -0,0 +1,219 @@
+/**
+ * @file libcomp/src/WorkerPool.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pool of workers that share the connection message queues.
+ *
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_WORKERPOOL_H
+#define LIBCOMP_SRC_WORKERPOOL_H
+
+// libcomp Includes
+#include "Worker.h"
+
+// Standard C++11 Includes
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace libcomp
+{
+
+class PooledWorker;
+
+/**
+ * Scheduler shared by the workers that handle connections. Every connection
+ * has its own message queue with a home worker. When a queue gets messages
+ * it is added to its home worker's list of ready queues and whichever worker
+ * takes it off a list runs every message in it before releasing it. Only
+ * one worker can hold a queue at a time so the messages of a connection are
+ * always handled in order. Workers with nothing to do steal ready queues
+ * from the other workers so one busy connection does not stall every other
+ * connection assigned to the same worker.
+ */
+class WorkerPool : public std::enable_shared_from_this<WorkerPool>
+{
+public:
+    /// Message queue type the connections enqueue to
+    typedef MessageQueue<Message::Message*> Queue_t;
+
+    /**
+     * Create an empty pool.
+     */
+    WorkerPool();
+
+    /**
+     * Cleanup the pool and any messages still queued for a worker.
+     */
+    ~WorkerPool();
+
+    /**
+     * Create a worker in the pool. This must not be called once any worker
+     * in the pool has started.
+     * @return Pointer to the new worker
+     */
+    std::shared_ptr<PooledWorker> CreateWorker();
+
+    /**
+     * Add a connection queue to a worker's list of ready queues.
+     * @param index Index of the worker in the pool
+     * @param queue Queue with messages to run
+     */
+    void Schedule(size_t index, const std::shared_ptr<Queue_t>& queue);
+
+    /**
+     * Take the next ready queue for a worker, stealing one from another
+     * worker if it has none of its own.
+     * @param index Index of the worker in the pool
+     * @return Queue to run or null if no queue is ready
+     */
+    std::shared_ptr<Queue_t> Next(size_t index);
+
+    /**
+     * Block until a queue is ready or the worker is signalled.
+     * @param signalled Flag set when the worker has its own messages
+     */
+    void Wait(const std::atomic<bool>& signalled);
+
+    /**
+     * Wake every worker waiting in @ref Wait.
+     */
+    void WakeAll();
+
+    /**
+     * Get the number of queues waiting to run on a worker.
+     * @param index Index of the worker in the pool
+     * @return Number of queues waiting to run on the worker
+     */
+    size_t GetQueueDepth(size_t index) const;
+
+private:
+    /**
+     * Ready queues for one worker.
+     */
+    struct ReadyList
+    {
+        /// Mutex lock to use when modifying the list
+        std::mutex lock;
+
+        /// Queues with messages in the order they became ready
+        std::deque<std::shared_ptr<Queue_t>> queues;
+
+        /// Number of queues in the list
+        std::atomic<size_t> depth;
+    };
+
+    /// Ready queues for each worker by index
+    std::vector<std::unique_ptr<ReadyList>> mReadyLists;
+
+    /// Number of queues in every ready list
+    std::atomic<size_t> mReadyCount;
+
+    /// Number of workers waiting for a queue
+    std::atomic<size_t> mIdleCount;
+
+    /// Mutex lock to use when waiting for a queue
+    std::mutex mIdleLock;
+
+    /// Blocking condition to wait for when no queue is ready
+    std::condition_variable mIdleCondition;
+};
+
+/**
+ * Worker in a @ref WorkerPool. The worker handles its own message queue as
+ * any other worker would but otherwise runs the connection queues
+ * scheduled on the pool.
+ */
+class PooledWorker : public Worker
+{
+public:
+    /**
+     * Create a new worker. Use @ref WorkerPool::CreateWorker instead.
+     * @param pool Pool the worker belongs to
+     * @param index Index of the worker in the pool
+     */
+    PooledWorker(const std::shared_ptr<WorkerPool>& pool, size_t index);
+
+    /**
+     * Cleanup the worker.
+     */
+    virtual ~PooledWorker();
+
+    /**
+     * Create a message queue for a new connection that runs on this worker
+     * unless it is stolen by another worker in the pool.
+     * @return Message queue for the connection
+     */
+    std::shared_ptr<WorkerPool::Queue_t> CreateConnectionQueue();
+
+    /**
+     * Handle the worker's own messages then run one ready connection queue
+     * or wait for one.
+     * @param pMessageQueue The worker's own message queue
+     */
+    virtual void Run(libcomp::MessageQueue<
+        libcomp::Message::Message*> *pMessageQueue);
+
+    /**
+     * Get the number of connection queues created by this worker that
+     * still exist.
+     * @sa BaseServer::GetNextConnectionWorker
+     * @return The number of connections assigned to the worker
+     */
+    virtual long AssignmentCount() const;
+
+    /**
+     * Get the number of connection queues waiting to run on this worker.
+     * @return Number of queues waiting to run on the worker
+     */
+    size_t GetQueueDepth() const;
+
+    /**
+     * Get the total time the worker has spent handling messages from
+     * connection queues.
+     * @return Busy time in microseconds
+     */
+    uint64_t GetBusyTime() const;
+
+private:
+    /// Pool the worker belongs to
+    std::shared_ptr<WorkerPool> mPool;
+
+    /// Index of the worker in the pool
+    size_t mIndex;
+
+    /// Indicates the worker's own message queue has messages
+    std::atomic<bool> mSignalled;
+
+    /// Number of connection queues assigned to the worker
+    std::shared_ptr<std::atomic<long>> mAssignments;
+
+    /// Time spent handling messages from connection queues in microseconds
+    std::atomic<uint64_t> mBusyTime;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_WORKERPOOL_H
@@ -0,0 +1,394 @@
+/**
+ * @file libcomp/tests/ChannelConnection.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the channel connection packet encoding.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <ChannelConnection.h>
+#include <Constants.h>
+#include <Decrypt.h>
+
+// zlib Includes
+#include <zlib.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/**
+ * Build a command similar to a zone wide entity update.
+ * @param p Packet to write the command to
+ */
+void WriteCommand(Packet& p)
+{
+    p.WriteU16Little(0x0016);
+    p.WriteS32Little(1234);
+
+    for(int32_t i = 0; i < 16; i++)
+    {
+        p.WriteFloat((float)i * 10.f);
+        p.WriteS32Little(i);
+    }
+}
+
+/**
+ * Build a small command similar to an entity movement update.
+ * @param p Packet to write the command to
+ * @param entityID ID of the entity that moved
+ */
+void WriteMove(Packet& p, int32_t entityID)
+{
+    p.WriteU16Little(0x0010);
+    p.WriteS32Little(entityID);
+    p.WriteFloat((float)entityID * 0.5f);
+    p.WriteFloat((float)entityID * -0.25f);
+    p.WriteFloat(1.5f);
+    p.WriteU32Little(0);
+}
+
+/**
+ * Build the commands for a batch of about the given size.
+ * @param size Number of bytes of command data to write
+ * @param seed Seed for the commands in the batch
+ * @return Commands in the batch
+ */
+std::list<ReadOnlyPacket> MakeBatch(uint32_t size, int32_t seed)
+{
+    std::list<ReadOnlyPacket> packets;
+
+    uint32_t total = 0;
+    while(total < size)
+    {
+        Packet command;
+
+        if(total + 256 < size)
+        {
+            WriteCommand(command);
+        }
+        else
+        {
+            WriteMove(command, seed++);
+        }
+
+        total += command.Size() + 4;
+        packets.emplace_back(std::move(command));
+    }
+
+    return packets;
+}
+
+/**
+ * Compress a channel batch the way it was done before the compression
+ * state was kept: a new zlib stream and a copy of the data for every batch.
+ * @param packets Commands in the batch
+ * @param finalPacket Packet to write the batch to
+ * @return true if the batch was built
+ */
+bool BuildCompressedPacketUncached(const std::list<ReadOnlyPacket>& packets,
+    Packet& finalPacket)
+{
+    Packet data;
+    for(auto& packet : packets)
+    {
+        data.WriteU16Big((uint16_t)(packet.Size() + 2));
+        data.WriteU16Little((uint16_t)(packet.Size() + 2));
+        data.WriteArray(packet.ConstData(), packet.Size());
+    }
+
+    uLong originalSize = data.Size();
+    std::vector<uint8_t> copy(data.ConstData(), data.ConstData() +
+        originalSize);
+    std::vector<uint8_t> out(compressBound(originalSize));
+
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+
+    if(Z_OK != deflateInit(&strm, Z_DEFAULT_COMPRESSION))
+    {
+        return false;
+    }
+
+    strm.avail_in = (uInt)originalSize;
+    strm.next_in = &copy[0];
+    strm.avail_out = (uInt)out.size();
+    strm.next_out = &out[0];
+
+    bool compressed = Z_STREAM_END == deflate(&strm, Z_FINISH) &&
+        strm.total_out < originalSize;
+    uLong compressedSize = compressed ? strm.total_out : originalSize;
+
+    deflateEnd(&strm);
+
+    finalPacket.WriteBlank(2 * sizeof(uint32_t));
+    finalPacket.WriteArray("gzip", 4);
+    finalPacket.WriteS32Little((int32_t)originalSize);
+    finalPacket.WriteS32Little((int32_t)compressedSize);
+    finalPacket.WriteArray("lv6", 4);
+    finalPacket.WriteArray(compressed ? &out[0] : &copy[0],
+        (uint32_t)compressedSize);
+
+    return true;
+}
+
+/**
+ * Read a batch back the way the client does.
+ * @param finalPacket Batch built by @ref ChannelConnection
+ * @param data Uncompressed command data
+ * @return true if the batch header was valid and the data decompressed
+ */
+bool ReadBatch(const Packet& finalPacket, std::vector<uint8_t>& data)
+{
+    Packet p(finalPacket.ConstData(), finalPacket.Size());
+    p.Seek(2 * sizeof(uint32_t));
+
+    if(0x677A6970 != p.ReadU32Big()) // "gzip"
+    {
+        return false;
+    }
+
+    int32_t originalSize = p.ReadS32Little();
+    int32_t compressedSize = p.ReadS32Little();
+
+    if(0x6C763600 != p.ReadU32Big() || // "lv6\0"
+        (int32_t)p.Left() != compressedSize)
+    {
+        return false;
+    }
+
+    data.resize((size_t)originalSize);
+
+    if(compressedSize == originalSize)
+    {
+        p.ReadArray(&data[0], (uint32_t)originalSize);
+
+        return true;
+    }
+
+    uLongf written = (uLongf)originalSize;
+
+    return Z_OK == uncompress(&data[0], &written,
+        (const Bytef*)p.ConstData() + p.Tell(), (uLong)compressedSize) &&
+        written == (uLongf)originalSize;
+}
+
+/// Batch sizes (in bytes of command data) to replay, shaped like a busy
+/// zone: mostly movement and status updates with the odd zone entry.
+const uint32_t BATCH_SIZES[] = {
+    24, 24, 26, 28, 30, 44, 48, 52, 60, 72, 88, 96, 120, 140, 180, 240,
+    24, 28, 30, 48, 52, 64, 96, 160, 320, 480, 640, 1200, 2400, 6000,
+};
+
+} // namespace
+
+TEST(ChannelConnection, CompressedBatches)
+{
+    for(uint32_t size : BATCH_SIZES)
+    {
+        auto packets = MakeBatch(size, (int32_t)size);
+
+        Packet finalPacket;
+        ASSERT_TRUE(ChannelConnection::BuildCompressedPacket(packets,
+            finalPacket));
+
+        // The data comes back out exactly as it went in.
+        std::vector<uint8_t> data;
+        ASSERT_TRUE(ReadBatch(finalPacket, data));
+
+        std::vector<uint8_t> expected;
+        for(auto& packet : packets)
+        {
+            Packet sizes;
+            sizes.WriteU16Big((uint16_t)(packet.Size() + 2));
+            sizes.WriteU16Little((uint16_t)(packet.Size() + 2));
+
+            expected.insert(expected.end(), sizes.ConstData(),
+                sizes.ConstData() + sizes.Size());
+            expected.insert(expected.end(), packet.ConstData(),
+                packet.ConstData() + packet.Size());
+        }
+
+        EXPECT_EQ(expected, data);
+
+        // Small batches are not compressed.
+        if((uint32_t)CHANNEL_COMPRESS_THRESHOLD > data.size())
+        {
+            EXPECT_EQ(finalPacket.Size(), CHANNEL_HEADER_SIZE +
+                (uint32_t)data.size());
+        }
+    }
+}
+
+TEST(ChannelConnection, EncodedMatchesCompressed)
+{
+    Packet command;
+    WriteCommand(command);
+
+    std::list<ReadOnlyPacket> packets;
+    packets.emplace_back(ReadOnlyPacket(Packet(command)));
+
+    Packet expected;
+    ASSERT_TRUE(ChannelConnection::BuildCompressedPacket(packets, expected));
+
+    auto encoded = ChannelConnection::EncodePacket(command);
+    ASSERT_EQ(expected.Size(), encoded->Compressed.Size());
+    EXPECT_EQ(0, memcmp(expected.ConstData(),
+        encoded->Compressed.ConstData(), expected.Size()));
+
+    // The original command data moved into the encoded packet.
+    EXPECT_EQ(0, command.Size());
+    EXPECT_EQ(packets.front().Size(), encoded->Command.Size());
+}
+
+TEST(ChannelConnection, BroadcastBenchmark)
+{
+    BF_KEY key;
+    BF_set_key(&key, 8, reinterpret_cast<const unsigned char*>("benchkey"));
+
+    const int BROADCAST_COUNT = 200;
+
+    for(int recipients : { 10, 50, 200 })
+    {
+        // Every recipient compresses and encrypts its own copy.
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < BROADCAST_COUNT; i++)
+        {
+            Packet command;
+            WriteCommand(command);
+
+            for(int r = 0; r < recipients; r++)
+            {
+                std::list<ReadOnlyPacket> packets;
+                packets.emplace_back(ReadOnlyPacket(Packet(command)));
+
+                Packet finalPacket;
+                ChannelConnection::BuildCompressedPacket(packets,
+                    finalPacket);
+                Decrypt::EncryptPacket(key, finalPacket);
+            }
+        }
+        auto perClientTime = std::chrono::duration_cast<
+            std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start).count();
+
+        // The command is compressed once and each recipient only
+        // encrypts a copy.
+        start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < BROADCAST_COUNT; i++)
+        {
+            Packet command;
+            WriteCommand(command);
+
+            auto encoded = ChannelConnection::EncodePacket(command);
+            for(int r = 0; r < recipients; r++)
+            {
+                Packet finalPacket(encoded->Compressed.ConstData(),
+                    encoded->Compressed.Size());
+                Decrypt::EncryptPacket(key, finalPacket);
+            }
+        }
+        auto encodedTime = std::chrono::duration_cast<
+            std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start).count();
+
+        std::cout << "[ BENCHMARK] " << recipients << " recipients: "
+            << "per client " << (perClientTime / BROADCAST_COUNT)
+            << " us, encoded once " << (encodedTime / BROADCAST_COUNT)
+            << " us per broadcast" << std::endl;
+
+        EXPECT_LE(encodedTime, perClientTime);
+    }
+}
+
+TEST(ChannelConnection, BatchBenchmark)
+{
+    const int REPLAY_COUNT = 2000;
+
+    std::vector<std::list<ReadOnlyPacket>> batches;
+    for(uint32_t size : BATCH_SIZES)
+    {
+        batches.push_back(MakeBatch(size, (int32_t)size));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    uint64_t uncachedBytes = 0;
+    for(int i = 0; i < REPLAY_COUNT; i++)
+    {
+        for(auto& packets : batches)
+        {
+            Packet finalPacket;
+            BuildCompressedPacketUncached(packets, finalPacket);
+            uncachedBytes += finalPacket.Size();
+        }
+    }
+    auto uncachedTime = std::chrono::duration_cast<
+        std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    uint64_t bytes = 0;
+    for(int i = 0; i < REPLAY_COUNT; i++)
+    {
+        for(auto& packets : batches)
+        {
+            Packet finalPacket;
+            ChannelConnection::BuildCompressedPacket(packets, finalPacket);
+            bytes += finalPacket.Size();
+        }
+    }
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "[ BENCHMARK] " << (REPLAY_COUNT * (int)batches.size())
+        << " batches: new stream per batch " << (uncachedTime / 1000)
+        << " ms (" << (uncachedBytes / 1024) << " KiB), reused stream "
+        << (time / 1000) << " ms (" << (bytes / 1024) << " KiB)"
+        << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
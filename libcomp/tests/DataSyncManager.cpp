@@ -0,0 +1,294 @@
+/**
+ * @file libcomp/tests/DataSyncManager.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the data sync manager.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <DatabaseSQLite3.h>
+#include <DataSyncManager.h>
+#include <Item.h>
+#include <Packet.h>
+#include <ReadOnlyPacket.h>
+
+// Standard C++11 Includes
+#include <cstdio>
+#include <iostream>
+#include <list>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Number of records synchronized by the tests.
+const size_t RECORD_COUNT = 1000;
+
+/// Number of records written to each sync packet.
+const size_t RECORDS_PER_PACKET = 25;
+
+/**
+ * SQLite3 database that counts the queries made to load objects.
+ */
+class CountingDatabase : public DatabaseSQLite3
+{
+public:
+    /**
+     * Create the database.
+     * @param config Configuration for the database
+     */
+    CountingDatabase(const std::shared_ptr<
+        objects::DatabaseConfigSQLite3>& config) :
+        DatabaseSQLite3(config), LoadCount(0)
+    {
+    }
+
+    using DatabaseSQLite3::LoadObjects;
+
+    virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
+        size_t typeHash, DatabaseBind *pValue)
+    {
+        LoadCount++;
+
+        return DatabaseSQLite3::LoadObjects(typeHash, pValue);
+    }
+
+    /// Number of queries made to load objects.
+    size_t LoadCount;
+};
+
+/**
+ * Sync manager that sends the records it synchronizes to itself.
+ */
+class LoopbackSyncManager : public DataSyncManager
+{
+public:
+    /**
+     * Create the sync manager.
+     * @param db Database the items are stored in
+     * @param deltaSync true if the field values should be sent
+     */
+    LoopbackSyncManager(const std::shared_ptr<Database>& db, bool deltaSync)
+    {
+        auto cfg = std::make_shared<ObjectConfig>("Item", false, db);
+        cfg->DeltaSync = deltaSync;
+
+        mRegisteredTypes["Item"] = cfg;
+    }
+
+    /**
+     * Send the updated items back to this manager in as many packets as
+     * needed.
+     * @param items Items that have been updated
+     * @return Number of bytes sent
+     */
+    size_t Sync(const std::vector<std::shared_ptr<objects::Item>>& items)
+    {
+        std::list<libcomp::Packet> packets;
+
+        for(size_t i = 0; i < items.size(); i += RECORDS_PER_PACKET)
+        {
+            std::set<std::shared_ptr<libcomp::Object>> updates;
+            for(size_t k = i; k < items.size() &&
+                k < (i + RECORDS_PER_PACKET); k++)
+            {
+                updates.insert(items[k]);
+            }
+
+            packets.emplace_back();
+            BuildOutgoing(packets.back(), "Item", updates, {}, true);
+        }
+
+        // Change the database so any value loaded from it is wrong
+        SaveStackSize(items, 7);
+
+        size_t size = 0;
+        for(auto& p : packets)
+        {
+            size += p.Size();
+
+            libcomp::ReadOnlyPacket r(std::move(p));
+            r.Seek(2);
+
+            EXPECT_TRUE(SyncIncoming(r));
+            EXPECT_EQ(r.Left(), 0u);
+        }
+
+        return size;
+    }
+
+    /**
+     * Change the stack size of the items and save them.
+     * @param items Items to update
+     * @param stackSize Stack size to set on each item
+     */
+    void SaveStackSize(const std::vector<std::shared_ptr<
+        objects::Item>>& items, uint16_t stackSize)
+    {
+        auto db = mRegisteredTypes["Item"]->DB;
+
+        auto changes = DatabaseChangeSet::Create();
+        for(auto& item : items)
+        {
+            item->SetStackSize(stackSize);
+            changes->Update(item);
+        }
+
+        EXPECT_TRUE(db->ProcessChangeSet(changes));
+    }
+};
+
+/**
+ * Get the config for a test database in the working directory.
+ * @param name Name of the database file
+ * @return Database config
+ */
+std::shared_ptr<objects::DatabaseConfigSQLite3> GetConfig(const String& name)
+{
+    auto config = std::make_shared<objects::DatabaseConfigSQLite3>();
+    config->SetDatabaseType("world");
+    config->SetDatabaseName(name);
+    config->SetFileDirectory("./");
+
+    return config;
+}
+
+/**
+ * Insert a number of items into the database.
+ * @param db Database to insert the items into
+ * @return Items that were inserted
+ */
+std::vector<std::shared_ptr<objects::Item>> InsertItems(Database& db)
+{
+    std::vector<std::shared_ptr<objects::Item>> items;
+
+    auto changes = DatabaseChangeSet::Create();
+    for(size_t i = 0; i < RECORD_COUNT; i++)
+    {
+        auto item = std::make_shared<objects::Item>();
+        item->SetType((uint32_t)(1000 + i));
+        item->SetBoxSlot((int8_t)(i % 50));
+        item->SetStackSize(1);
+
+        changes->Insert(item);
+        items.push_back(item);
+    }
+
+    EXPECT_TRUE(db.ProcessChangeSet(changes));
+
+    return items;
+}
+
+/**
+ * Check that every item has the supplied stack size.
+ * @param items Items to check
+ * @param stackSize Expected stack size
+ */
+void CheckStackSize(const std::vector<std::shared_ptr<objects::Item>>& items,
+    uint16_t stackSize)
+{
+    for(auto& item : items)
+    {
+        auto synced = std::dynamic_pointer_cast<objects::Item>(
+            PersistentObject::GetObjectByUUID(item->GetUUID()));
+        ASSERT_NE(synced, nullptr);
+        EXPECT_EQ(synced->GetStackSize(), stackSize);
+    }
+}
+
+} // namespace
+
+TEST(DataSyncManager, DeltaSync)
+{
+    PersistentObject::Initialize();
+
+    (void)std::remove("./test_deltasync.sqlite3");
+
+    auto db = std::make_shared<CountingDatabase>(
+        GetConfig("test_deltasync"));
+    ASSERT_TRUE(db->Open());
+    ASSERT_TRUE(db->Setup());
+
+    auto items = InsertItems(*db);
+
+    // Sending only the UUID reloads every record from the database
+    LoopbackSyncManager legacy(db, false);
+    legacy.SaveStackSize(items, 2);
+
+    db->LoadCount = 0;
+    size_t legacySize = legacy.Sync(items);
+    size_t legacyLoads = db->LoadCount;
+
+    EXPECT_EQ(legacyLoads, RECORD_COUNT);
+    CheckStackSize(items, 7);
+
+    // The first delta sync sends every field, the next only the changes
+    LoopbackSyncManager delta(db, true);
+    delta.SaveStackSize(items, 2);
+
+    db->LoadCount = 0;
+    size_t fullSize = delta.Sync(items);
+
+    EXPECT_EQ(db->LoadCount, 0u);
+    CheckStackSize(items, 2);
+
+    delta.SaveStackSize(items, 3);
+
+    db->LoadCount = 0;
+    size_t deltaSize = delta.Sync(items);
+    size_t deltaLoads = db->LoadCount;
+
+    EXPECT_EQ(deltaLoads, 0u);
+    CheckStackSize(items, 3);
+    EXPECT_LT(deltaSize, fullSize);
+
+    std::cout << "[ BENCHMARK] " << RECORD_COUNT << " records: UUID sync "
+        << legacyLoads << " loads (" << legacySize << " bytes), full sync "
+        << fullSize << " bytes, delta sync " << deltaLoads << " loads ("
+        << deltaSize << " bytes)" << std::endl;
+
+    items.clear();
+
+    EXPECT_TRUE(db->Close());
+
+    (void)std::remove("./test_deltasync.sqlite3");
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
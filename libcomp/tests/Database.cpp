@@ -4,11 +4,11 @@
  *
  * @author COMP Omega <compomega@tutanota.com>
  *
- * @brief Test the SQLite3 database backend.
+ * @brief Test the database.
  *
  * This file is part of the COMP_hack Library (libcomp).
  *
- * Copyright (C) 2014-2016 COMP_hack Team <compomega@tutanota.com>
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU Affero General Public License as
@@ -28,17 +28,621 @@
 #include <gtest/gtest.h>
 #include <PopIgnore.h>
 
+// libcomp Includes
+#include <DatabaseBind.h>
 #include <DatabaseSQLite3.h>
+#include <DatabaseStatementCache.h>
+#include <Item.h>
+#include <ItemBox.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <list>
+#include <set>
+#include <sstream>
+#include <vector>
 
 using namespace libcomp;
 
+namespace
+{
+
+/**
+ * Get the config for a test database in the working directory.
+ * @param name Name of the database file
+ * @return Database config
+ */
+std::shared_ptr<objects::DatabaseConfigSQLite3> GetConfig(const String& name)
+{
+    auto config = std::make_shared<objects::DatabaseConfigSQLite3>();
+    config->SetDatabaseType("world");
+    config->SetDatabaseName(name);
+    config->SetFileDirectory("./");
+
+    return config;
+}
+
+/**
+ * Remove the file for a test database.
+ * @param name Name of the database file
+ */
+void RemoveDatabase(const String& name)
+{
+    (void)std::remove(String("./%1.sqlite3").Arg(name).C());
+}
+
+/**
+ * Save the items of a number of characters the way the channel does when
+ * they log out, with one change set per character.
+ * @param db Database to save the items to
+ * @param characterCount Number of characters to save
+ * @param itemCount Number of items each character has
+ * @return Time taken in microseconds
+ */
+int64_t SaveItems(DatabaseSQLite3& db, int characterCount, int itemCount)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for(int c = 0; c < characterCount; c++)
+    {
+        auto changes = DatabaseChangeSet::Create();
+
+        for(int i = 0; i < itemCount; i++)
+        {
+            auto item = std::make_shared<objects::Item>();
+            item->SetType((uint32_t)(1000 + i));
+            item->SetBoxSlot((int8_t)i);
+            item->SetStackSize((uint16_t)(c % 99 + 1));
+
+            changes->Insert(item);
+        }
+
+        EXPECT_TRUE(db.ProcessChangeSet(changes));
+    }
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+
+/**
+ * Insert a number of full item boxes into the database.
+ * @param db Database to insert the boxes into
+ * @param boxCount Number of boxes to insert
+ * @return Boxes that were inserted
+ */
+std::list<std::shared_ptr<objects::ItemBox>> InsertItemBoxes(Database& db,
+    int boxCount)
+{
+    std::list<std::shared_ptr<objects::ItemBox>> boxes;
+
+    auto changes = DatabaseChangeSet::Create();
+    for(int b = 0; b < boxCount; b++)
+    {
+        auto box = std::make_shared<objects::ItemBox>();
+        EXPECT_TRUE(PersistentObject::Register(box));
+
+        for(size_t i = 0; i < 50; i++)
+        {
+            auto item = std::make_shared<objects::Item>();
+            EXPECT_TRUE(PersistentObject::Register(item));
+
+            item->SetType((uint32_t)(1000 + i));
+            item->SetBoxSlot((int8_t)i);
+            item->SetItemBox(box->GetUUID());
+
+            box->SetItems(i, item);
+            changes->Insert(item);
+        }
+
+        changes->Insert(box);
+        boxes.push_back(box);
+    }
+
+    EXPECT_TRUE(db.ProcessChangeSet(changes));
+
+    return boxes;
+}
+
+/**
+ * Load item boxes and every item in them the way the channel does when a
+ * character logs in.
+ * @param db Database to load from
+ * @param boxUUIDs UUIDs of the boxes to load
+ * @param prefetch true if each level should be loaded with batched queries
+ * @return Number of items loaded
+ */
+size_t LoadItemBoxes(const std::shared_ptr<Database>& db,
+    const std::list<libobjgen::UUID>& boxUUIDs, bool prefetch)
+{
+    std::list<std::shared_ptr<objects::ItemBox>> boxes;
+    std::list<std::shared_ptr<objects::Item>> prefetched;
+
+    if(prefetch)
+    {
+        boxes = PersistentObject::Prefetch<objects::ItemBox>(db, boxUUIDs);
+
+        std::list<libobjgen::UUID> itemUUIDs;
+        for(auto& box : boxes)
+        {
+            for(auto& item : box->GetItems())
+            {
+                itemUUIDs.push_back(item.GetUUID());
+            }
+        }
+
+        prefetched = PersistentObject::Prefetch<objects::Item>(db,
+            itemUUIDs);
+    }
+
+    size_t loaded = 0;
+    for(auto& boxUUID : boxUUIDs)
+    {
+        auto box = PersistentObject::LoadObjectByUUID<objects::ItemBox>(db,
+            boxUUID);
+        if(!box) continue;
+
+        for(size_t i = 0; i < 50; i++)
+        {
+            auto item = box->GetItems(i);
+            if(!item.IsNull() && item.Get(db))
+            {
+                loaded++;
+            }
+        }
+    }
+
+    return loaded;
+}
+
+} // namespace
+
 TEST(SQLite3, OpenCloseDatabase)
 {
-    DatabaseSQLite3 db;
+    RemoveDatabase("test_openclose");
+
+    DatabaseSQLite3 db(GetConfig("test_openclose"));
 
-    ASSERT_TRUE(db.Open(":memory:"));
+    ASSERT_TRUE(db.Open());
     ASSERT_TRUE(db.IsOpen());
     ASSERT_TRUE(db.Close());
+    ASSERT_FALSE(db.IsOpen());
+
+    RemoveDatabase("test_openclose");
+}
+
+TEST(SQLite3, StatementCacheReopen)
+{
+    PersistentObject::Initialize();
+
+    RemoveDatabase("test_reopen");
+
+    DatabaseSQLite3 db(GetConfig("test_reopen"));
+    ASSERT_TRUE(db.Open());
+    ASSERT_TRUE(db.Setup());
+
+    DatabaseStatementCache::ResetStats();
+
+    SaveItems(db, 2, 1);
+
+    auto stats = DatabaseStatementCache::ResetStats();
+    EXPECT_EQ(stats.Misses, 1u);
+    EXPECT_EQ(stats.Hits, 1u);
+
+    // Statements prepared on the old connection must not be reused
+    ASSERT_TRUE(db.Close());
+    ASSERT_TRUE(db.Open());
+
+    SaveItems(db, 1, 1);
+
+    stats = DatabaseStatementCache::ResetStats();
+    EXPECT_EQ(stats.Misses, 1u);
+    EXPECT_EQ(stats.Hits, 0u);
+
+    ASSERT_TRUE(db.Close());
+
+    RemoveDatabase("test_reopen");
+}
+
+TEST(SQLite3, LoadObjectsByUUID)
+{
+    PersistentObject::Initialize();
+
+    RemoveDatabase("test_loadbyuuid");
+
+    auto db = std::make_shared<DatabaseSQLite3>(GetConfig("test_loadbyuuid"));
+    ASSERT_TRUE(db->Open());
+    ASSERT_TRUE(db->Setup());
+
+    auto boxes = InsertItemBoxes(*db, 6);
+
+    std::list<libobjgen::UUID> boxUUIDs;
+    std::list<libobjgen::UUID> itemUUIDs;
+    for(auto& box : boxes)
+    {
+        boxUUIDs.push_back(box->GetUUID());
+
+        for(auto& item : box->GetItems())
+        {
+            itemUUIDs.push_back(item.GetUUID());
+        }
+    }
+
+    // Null and repeated UUIDs are not matched twice.
+    auto uuids = itemUUIDs;
+    uuids.push_back(itemUUIDs.front());
+    uuids.push_back(NULLUUID);
+
+    DatabaseStatementCache::ResetStats();
+
+    auto loaded = db->LoadObjectsByUUID(typeid(objects::Item).hash_code(),
+        "UID", uuids);
+    EXPECT_EQ(loaded.size(), itemUUIDs.size());
+
+    // 300 items take one batch of 256 and one padded up to 64.
+    auto stats = DatabaseStatementCache::ResetStats();
+    EXPECT_EQ(stats.Hits + stats.Misses, 2u);
+
+    loaded = db->LoadObjectsByUUID(typeid(objects::Item).hash_code(),
+        "ItemBox", boxUUIDs);
+    EXPECT_EQ(loaded.size(), itemUUIDs.size());
+    loaded.clear();
+
+    // Everything is still cached so there is nothing to prefetch.
+    DatabaseStatementCache::ResetStats();
+
+    EXPECT_TRUE(PersistentObject::Prefetch<objects::Item>(db,
+        itemUUIDs).empty());
+
+    stats = DatabaseStatementCache::ResetStats();
+    EXPECT_EQ(stats.Hits + stats.Misses, 0u);
+
+    // Once released the boxes and items load with one query per level.
+    boxes.clear();
+
+    EXPECT_EQ(LoadItemBoxes(db, boxUUIDs, true), itemUUIDs.size());
+
+    stats = DatabaseStatementCache::ResetStats();
+    EXPECT_EQ(stats.Hits + stats.Misses, 3u);
+
+    EXPECT_TRUE(db->Close());
+    RemoveDatabase("test_loadbyuuid");
+}
+
+TEST(SQLite3, StatementCacheBenchmark)
+{
+    PersistentObject::Initialize();
+
+    const int CHARACTER_COUNT = 10000;
+    const int ITEM_COUNT = 10;
+
+    int64_t times[2] = { 0, 0 };
+    DatabaseStatementCache::Stats stats[2];
+
+    for(int cached = 0; cached < 2; cached++)
+    {
+        String name = String("test_statementcache%1").Arg(cached);
+        RemoveDatabase(name);
+
+        DatabaseSQLite3 db(GetConfig(name));
+        db.SetStatementCacheCapacity(cached ? DatabaseStatementCache::
+            DEFAULT_CAPACITY : 0);
+
+        ASSERT_TRUE(db.Open());
+        ASSERT_TRUE(db.Setup());
+
+        DatabaseStatementCache::ResetStats();
+
+        times[cached] = SaveItems(db, CHARACTER_COUNT, ITEM_COUNT);
+        stats[cached] = DatabaseStatementCache::ResetStats();
+
+        {
+            auto query = db.Prepare("SELECT COUNT(1) FROM `Item`;");
+            EXPECT_TRUE(query.Execute());
+            EXPECT_TRUE(query.Next());
+
+            int64_t count = 0;
+            EXPECT_TRUE(query.GetValue(0, count));
+            EXPECT_EQ(count, CHARACTER_COUNT * ITEM_COUNT);
+        }
+
+        EXPECT_TRUE(db.Close());
+        RemoveDatabase(name);
+    }
+
+    std::cout << "[ BENCHMARK] " << CHARACTER_COUNT << " characters with "
+        << ITEM_COUNT << " items: uncached " << (times[0] / 1000)
+        << " ms, cached " << (times[1] / 1000) << " ms ("
+        << stats[1].Hits << " statements reused, " << stats[1].Misses
+        << " prepared)" << std::endl;
+
+    // Every item uses the same insert statement
+    EXPECT_EQ(stats[0].Hits, 0u);
+    EXPECT_EQ(stats[1].Misses, 1u);
+    EXPECT_EQ(stats[1].Hits,
+        (uint64_t)(CHARACTER_COUNT * ITEM_COUNT - 1));
+}
+
+TEST(SQLite3, PrefetchBenchmark)
+{
+    PersistentObject::Initialize();
+
+    const int LOGIN_COUNT = 50;
+    const int BOX_COUNT = 10;
+
+    RemoveDatabase("test_prefetch");
+
+    auto db = std::make_shared<DatabaseSQLite3>(GetConfig("test_prefetch"));
+    ASSERT_TRUE(db->Open());
+    ASSERT_TRUE(db->Setup());
+
+    // Keep only the UUIDs so each login starts with an empty cache.
+    std::list<libobjgen::UUID> boxUUIDs;
+    for(auto& box : InsertItemBoxes(*db, BOX_COUNT))
+    {
+        boxUUIDs.push_back(box->GetUUID());
+    }
+
+    int64_t times[2] = { 0, 0 };
+    uint64_t queries[2] = { 0, 0 };
+
+    for(int prefetch = 0; prefetch < 2; prefetch++)
+    {
+        DatabaseStatementCache::ResetStats();
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for(int i = 0; i < LOGIN_COUNT; i++)
+        {
+            EXPECT_EQ(LoadItemBoxes(db, boxUUIDs, prefetch != 0),
+                (size_t)(BOX_COUNT * 50));
+        }
+
+        times[prefetch] = std::chrono::duration_cast<
+            std::chrono::microseconds>(std::chrono::high_resolution_clock
+                ::now() - start).count();
+
+        auto stats = DatabaseStatementCache::ResetStats();
+        queries[prefetch] = (stats.Hits + stats.Misses) / LOGIN_COUNT;
+    }
+
+    EXPECT_TRUE(db->Close());
+    RemoveDatabase("test_prefetch");
+
+    std::cout << "[ BENCHMARK] " << LOGIN_COUNT << " logins with "
+        << BOX_COUNT << " item boxes: one at a time " << queries[0]
+        << " queries and " << (times[0] / LOGIN_COUNT) << " us per login, "
+        "prefetched " << queries[1] << " queries and "
+        << (times[1] / LOGIN_COUNT) << " us per login" << std::endl;
+
+    // Every box and item one at a time versus one query per level.
+    EXPECT_EQ(queries[0], (uint64_t)(BOX_COUNT * 51));
+    EXPECT_EQ(queries[1], 3u);
+}
+
+TEST(SQLite3, DirtyFields)
+{
+    PersistentObject::Initialize();
+
+    RemoveDatabase("test_dirtyfields");
+
+    auto db = std::make_shared<DatabaseSQLite3>(
+        GetConfig("test_dirtyfields"));
+    ASSERT_TRUE(db->Open());
+    ASSERT_TRUE(db->Setup());
+
+    auto item = std::make_shared<objects::Item>();
+    item->SetType(1000);
+    item->SetStackSize(1);
+
+    EXPECT_TRUE(item->IsDirty());
+    ASSERT_TRUE(item->Insert(db));
+    EXPECT_FALSE(item->IsDirty());
+
+    // Saving an unchanged object does not touch the database.
+    DatabaseStatementCache::ResetStats();
+
+    EXPECT_TRUE(item->Update(db));
+
+    auto stats = DatabaseStatementCache::ResetStats();
+    EXPECT_EQ(stats.Hits + stats.Misses, 0u);
+
+    // Change another column behind the object's back.
+    {
+        auto query = db->Prepare("UPDATE Item SET Type = 2000 "
+            "WHERE UID = :UID;");
+        ASSERT_TRUE(query.Bind("UID", item->GetUUID()));
+        ASSERT_TRUE(query.Execute());
+    }
+
+    item->SetStackSize(5);
+    EXPECT_TRUE(item->IsDirty());
+
+    // Only the changed column is bound.
+    auto values = item->GetMemberBindValues(false, false);
+    ASSERT_EQ(values.size(), 1u);
+    EXPECT_TRUE(values.front()->GetColumn() == "StackSize");
+
+    for(auto value : values)
+    {
+        delete value;
+    }
+
+    // Reloading keeps the change that has not been saved yet.
+    ASSERT_EQ(PersistentObject::LoadObjectByUUID<objects::Item>(db,
+        item->GetUUID(), true), item);
+    EXPECT_EQ(item->GetType(), 2000u);
+    EXPECT_EQ(item->GetStackSize(), 5);
+
+    // Saving it does not write back the stale value of the other column.
+    item->SetType(1000);
+
+    for(auto value : item->GetMemberBindValues())
+    {
+        delete value;
+    }
+
+    item->SetStackSize(7);
+
+    EXPECT_TRUE(item->Update(db));
+    EXPECT_FALSE(item->IsDirty());
+
+    ASSERT_EQ(PersistentObject::LoadObjectByUUID<objects::Item>(db,
+        item->GetUUID(), true), item);
+    EXPECT_EQ(item->GetType(), 2000u);
+    EXPECT_EQ(item->GetStackSize(), 7);
+
+    EXPECT_TRUE(db->Close());
+    RemoveDatabase("test_dirtyfields");
+}
+
+TEST(SQLite3, DirtyFieldsBenchmark)
+{
+    PersistentObject::Initialize();
+
+    const int ITEM_COUNT = 1000;
+    const int ROUND_COUNT = 100;
+
+    RemoveDatabase("test_dirtybench");
+
+    auto db = std::make_shared<DatabaseSQLite3>(
+        GetConfig("test_dirtybench"));
+    ASSERT_TRUE(db->Open());
+    ASSERT_TRUE(db->Setup());
+
+    std::vector<std::shared_ptr<objects::Item>> items;
+    {
+        auto changes = DatabaseChangeSet::Create();
+        for(int i = 0; i < ITEM_COUNT; i++)
+        {
+            auto item = std::make_shared<objects::Item>();
+            item->SetType((uint32_t)(1000 + i));
+            item->SetStackSize(1);
+
+            changes->Insert(item);
+            items.push_back(item);
+        }
+
+        ASSERT_TRUE(db->ProcessChangeSet(changes));
+    }
+
+    // Stand in for the update path as it was: serialize the whole object
+    // and look every column up in a set of changed field names.
+    std::list<std::string> columns;
+    for(auto value : items.front()->GetMemberBindValues(true, false))
+    {
+        columns.push_back(value->GetColumn().ToUtf8());
+        delete value;
+    }
+
+    size_t legacyBound = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for(int r = 0; r < ROUND_COUNT; r++)
+    {
+        for(auto& item : items)
+        {
+            item->SetStackSize((uint16_t)(r + 2));
+
+            std::set<std::string> dirtyFields;
+            dirtyFields.insert("StackSize");
+
+            std::stringstream objstream;
+            EXPECT_TRUE(item->Save(objstream));
+
+            for(auto& column : columns)
+            {
+                if(dirtyFields.find(column) != dirtyFields.end())
+                {
+                    legacyBound++;
+                }
+            }
+
+            for(auto value : item->GetMemberBindValues())
+            {
+                delete value;
+            }
+        }
+    }
+
+    int64_t legacyTime = std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::high_resolution_clock::now()
+            - start).count();
+
+    size_t bitsetBound = 0;
+    start = std::chrono::high_resolution_clock::now();
+
+    for(int r = 0; r < ROUND_COUNT; r++)
+    {
+        for(auto& item : items)
+        {
+            item->SetStackSize((uint16_t)(r + 2));
+
+            if(item->IsDirty())
+            {
+                for(auto value : item->GetMemberBindValues())
+                {
+                    bitsetBound++;
+                    delete value;
+                }
+            }
+        }
+    }
+
+    int64_t bitsetTime = std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::high_resolution_clock::now()
+            - start).count();
+
+    // Write the same updates through the database.
+    start = std::chrono::high_resolution_clock::now();
+
+    for(int r = 0; r < ROUND_COUNT; r++)
+    {
+        auto changes = DatabaseChangeSet::Create();
+        for(auto& item : items)
+        {
+            item->SetStackSize((uint16_t)(r + 2));
+            changes->Update(item);
+        }
+
+        EXPECT_TRUE(db->ProcessChangeSet(changes));
+    }
+
+    int64_t dbTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    // Objects that did not change are skipped without a statement.
+    auto changes = DatabaseChangeSet::Create();
+    for(size_t i = 0; i < items.size(); i++)
+    {
+        if(0 == i % 10)
+        {
+            items[i]->SetStackSize(99);
+        }
+
+        changes->Update(items[i]);
+    }
+
+    DatabaseStatementCache::ResetStats();
+
+    EXPECT_TRUE(db->ProcessChangeSet(changes));
+
+    auto stats = DatabaseStatementCache::ResetStats();
+    EXPECT_EQ(stats.Hits + stats.Misses, (uint64_t)(ITEM_COUNT / 10));
+
+    EXPECT_TRUE(db->Close());
+    RemoveDatabase("test_dirtybench");
+
+    EXPECT_EQ(legacyBound, (size_t)(ITEM_COUNT * ROUND_COUNT));
+    EXPECT_EQ(bitsetBound, (size_t)(ITEM_COUNT * ROUND_COUNT));
+
+    std::cout << "[ BENCHMARK] " << (ITEM_COUNT * ROUND_COUNT)
+        << " single field updates: serialize and name lookup "
+        << (legacyTime / 1000) << " ms, dirty bitset " << (bitsetTime / 1000)
+        << " ms, written through SQLite3 in " << (dbTime / 1000) << " ms"
+        << std::endl;
 }
 
 int main(int argc, char *argv[])
@@ -0,0 +1,243 @@
+/**
+ * @file libcomp/tests/DefinitionLookup.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the definition lookup table.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <DefinitionLookup.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace libcomp;
+
+namespace
+{
+
+/**
+ * Stand in for a definition.
+ */
+struct Record
+{
+    /// ID of the definition.
+    int32_t ID;
+};
+
+/**
+ * Build a map of definitions.
+ * @param ids IDs of the definitions to add
+ * @return Map of definitions by ID
+ */
+template<typename K>
+std::unordered_map<K, std::shared_ptr<Record>> MakeRecords(
+    const std::vector<K>& ids)
+{
+    std::unordered_map<K, std::shared_ptr<Record>> records;
+
+    for(K id : ids)
+    {
+        auto record = std::make_shared<Record>();
+        record->ID = (int32_t)id;
+
+        records[id] = record;
+    }
+
+    return records;
+}
+
+/**
+ * Get a definition the way the definition manager has always done it.
+ * @param id ID of the definition
+ * @param records Map of definitions by ID
+ * @return Copy of the pointer to the definition or null
+ */
+template<typename K>
+std::shared_ptr<Record> GetRecordByID(K id,
+    std::unordered_map<K, std::shared_ptr<Record>>& records)
+{
+    auto it = records.find(id);
+
+    return it != records.end() ? it->second : nullptr;
+}
+
+} // namespace
+
+TEST(DefinitionLookup, Dense)
+{
+    auto records = MakeRecords<uint32_t>({ 10, 11, 13, 20 });
+
+    DefinitionLookup<uint32_t, Record> lookup;
+    EXPECT_EQ(lookup.Get(10), nullptr);
+
+    lookup.Build(records);
+    EXPECT_TRUE(lookup.IsDense());
+
+    EXPECT_EQ(lookup.Get(10), records[10].get());
+    EXPECT_EQ(lookup.Get(13), records[13].get());
+    EXPECT_EQ(lookup.Get(20), records[20].get());
+    EXPECT_EQ(lookup.Get(12), nullptr);
+    EXPECT_EQ(lookup.Get(9), nullptr);
+    EXPECT_EQ(lookup.Get(21), nullptr);
+    EXPECT_EQ(lookup.Get(0xFFFFFFFF), nullptr);
+}
+
+TEST(DefinitionLookup, Sparse)
+{
+    auto records = MakeRecords<int32_t>({ -5000000, -2, 7, 3000000 });
+
+    DefinitionLookup<int32_t, Record> lookup;
+    lookup.Build(records);
+    EXPECT_FALSE(lookup.IsDense());
+
+    EXPECT_EQ(lookup.Get(-5000000), records[-5000000].get());
+    EXPECT_EQ(lookup.Get(-2), records[-2].get());
+    EXPECT_EQ(lookup.Get(7), records[7].get());
+    EXPECT_EQ(lookup.Get(3000000), records[3000000].get());
+    EXPECT_EQ(lookup.Get(0), nullptr);
+    EXPECT_EQ(lookup.Get(3000001), nullptr);
+
+    // Rebuilding replaces the old contents
+    lookup.Build(MakeRecords<int32_t>({ -1, 0, 1 }));
+    EXPECT_TRUE(lookup.IsDense());
+    EXPECT_EQ(lookup.Get(7), nullptr);
+    EXPECT_NE(lookup.Get(-1), nullptr);
+}
+
+TEST(DefinitionLookup, Benchmark)
+{
+    // Shape the tables like the skill, item and tokusei definitions
+    std::vector<uint32_t> skillIDs, itemIDs;
+    std::vector<int32_t> tokuseiIDs;
+
+    for(uint32_t i = 1; i <= 12000; i++)
+    {
+        skillIDs.push_back(i);
+    }
+
+    for(uint32_t i = 0; i < 20000; i++)
+    {
+        itemIDs.push_back(100 + i * 3);
+    }
+
+    for(int32_t i = 1; i <= 4000; i++)
+    {
+        tokuseiIDs.push_back(i);
+    }
+
+    auto skills = MakeRecords(skillIDs);
+    auto items = MakeRecords(itemIDs);
+    auto tokusei = MakeRecords(tokuseiIDs);
+
+    DefinitionLookup<uint32_t, Record> skillLookup, itemLookup;
+    DefinitionLookup<int32_t, Record> tokuseiLookup;
+    skillLookup.Build(skills);
+    itemLookup.Build(items);
+    tokuseiLookup.Build(tokusei);
+
+    // Replay a fixed trace of skills where each one looks up the skill,
+    // the weapon and bullet items and the active tokusei of the source and
+    // the target
+    const size_t SKILL_COUNT = 200000;
+    const size_t TOKUSEI_PER_SKILL = 24;
+
+    std::mt19937 rng(1234);
+    std::vector<uint32_t> trace;
+    for(size_t i = 0; i < SKILL_COUNT; i++)
+    {
+        trace.push_back(skillIDs[rng() % skillIDs.size()]);
+        trace.push_back(itemIDs[rng() % itemIDs.size()]);
+        trace.push_back(itemIDs[rng() % itemIDs.size()]);
+
+        for(size_t k = 0; k < TOKUSEI_PER_SKILL; k++)
+        {
+            trace.push_back((uint32_t)tokuseiIDs[rng() % tokuseiIDs.size()]);
+        }
+    }
+
+    const size_t STRIDE = 3 + TOKUSEI_PER_SKILL;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    int64_t mapSum = 0;
+    for(size_t i = 0; i < trace.size(); i += STRIDE)
+    {
+        mapSum += GetRecordByID(trace[i], skills)->ID;
+        mapSum += GetRecordByID(trace[i + 1], items)->ID;
+        mapSum += GetRecordByID(trace[i + 2], items)->ID;
+
+        for(size_t k = 3; k < STRIDE; k++)
+        {
+            mapSum += GetRecordByID((int32_t)trace[i + k], tokusei)->ID;
+        }
+    }
+
+    int64_t mapTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+
+    int64_t lookupSum = 0;
+    for(size_t i = 0; i < trace.size(); i += STRIDE)
+    {
+        lookupSum += skillLookup.Get(trace[i])->ID;
+        lookupSum += itemLookup.Get(trace[i + 1])->ID;
+        lookupSum += itemLookup.Get(trace[i + 2])->ID;
+
+        for(size_t k = 3; k < STRIDE; k++)
+        {
+            lookupSum += tokuseiLookup.Get((int32_t)trace[i + k])->ID;
+        }
+    }
+
+    int64_t lookupTime = std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::high_resolution_clock::now()
+            - start).count();
+
+    EXPECT_EQ(mapSum, lookupSum);
+
+    std::cout << "[ BENCHMARK] " << SKILL_COUNT << " skills ("
+        << (trace.size() / 1000) << "k lookups): map and shared_ptr "
+        << (mapTime / 1000) << " ms, lookup table " << (lookupTime / 1000)
+        << " ms" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,244 @@
+/**
+ * @file libcomp/tests/DefinitionSnapshot.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the definition snapshot.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <DefinitionSnapshot.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Path of the snapshot written by the tests.
+const char *SNAPSHOT_PATH = "./test_definitions.snapshot";
+
+/**
+ * Build the contents of a fake table.
+ * @param seed Value that makes each table different
+ * @param size Size of the table
+ * @return Table contents
+ */
+std::vector<char> MakeTable(int seed, size_t size)
+{
+    std::vector<char> data(size);
+
+    for(size_t i = 0; i < size; i++)
+    {
+        data[i] = (char)((i * 31 + (size_t)seed) & 0xFF);
+    }
+
+    return data;
+}
+
+/**
+ * Read every 32-bit value in a stream the way the generated objects do.
+ * @param in Stream to read
+ * @return Sum of the values read
+ */
+uint64_t ReadAll(std::istream& in)
+{
+    uint64_t sum = 0;
+    uint32_t value;
+
+    while(in.read(reinterpret_cast<char*>(&value), sizeof(value)))
+    {
+        sum += value;
+    }
+
+    return sum;
+}
+
+} // namespace
+
+TEST(DefinitionSnapshot, MemoryStream)
+{
+    const char data[] = "0123456789";
+
+    MemoryStreamBuffer buffer(data, 10);
+    std::istream in(&buffer);
+
+    char c;
+    EXPECT_TRUE(in.get(c));
+    EXPECT_EQ(c, '0');
+    EXPECT_EQ(in.tellg(), std::streampos(1));
+
+    in.seekg(4, std::istream::cur);
+    EXPECT_TRUE(in.get(c));
+    EXPECT_EQ(c, '5');
+
+    in.seekg(-1, std::istream::end);
+    EXPECT_TRUE(in.get(c));
+    EXPECT_EQ(c, '9');
+
+    EXPECT_FALSE(in.get(c));
+}
+
+TEST(DefinitionSnapshot, SaveOpen)
+{
+    (void)std::remove(SNAPSHOT_PATH);
+
+    DefinitionSnapshot snapshot;
+    EXPECT_FALSE(snapshot.Open(SNAPSHOT_PATH));
+
+    snapshot.AddTable("A.sbin", 100, 1, MakeTable(1, 13));
+    snapshot.AddTable("B.sbin", 200, 2, MakeTable(2, 4096));
+    EXPECT_TRUE(snapshot.IsStale());
+    ASSERT_TRUE(snapshot.Save(SNAPSHOT_PATH));
+    EXPECT_FALSE(snapshot.IsStale());
+
+    ASSERT_TRUE(snapshot.Open(SNAPSHOT_PATH));
+    EXPECT_GT(snapshot.GetMappedSize(), (size_t)(13 + 4096));
+
+    const char *pData = nullptr;
+    size_t size = 0;
+
+    ASSERT_TRUE(snapshot.GetTable("A.sbin", 100, 1, pData, size));
+    EXPECT_EQ(std::vector<char>(pData, pData + size), MakeTable(1, 13));
+
+    // A changed source file is loaded again
+    EXPECT_FALSE(snapshot.GetTable("B.sbin", 200, 3, pData, size));
+    EXPECT_FALSE(snapshot.GetTable("C.sbin", 300, 1, pData, size));
+
+    snapshot.AddTable("B.sbin", 200, 3, MakeTable(3, 64));
+    EXPECT_TRUE(snapshot.IsStale());
+
+    // Only the tables used are kept
+    ASSERT_TRUE(snapshot.Save(SNAPSHOT_PATH));
+
+    DefinitionSnapshot reopened;
+    ASSERT_TRUE(reopened.Open(SNAPSHOT_PATH));
+
+    ASSERT_TRUE(reopened.GetTable("A.sbin", 100, 1, pData, size));
+    EXPECT_EQ(std::vector<char>(pData, pData + size), MakeTable(1, 13));
+    ASSERT_TRUE(reopened.GetTable("B.sbin", 200, 3, pData, size));
+    EXPECT_EQ(std::vector<char>(pData, pData + size), MakeTable(3, 64));
+    EXPECT_FALSE(reopened.IsStale());
+
+    reopened.Close();
+    snapshot.Close();
+
+    (void)std::remove(SNAPSHOT_PATH);
+}
+
+TEST(DefinitionSnapshot, Benchmark)
+{
+    const int TABLE_COUNT = 60;
+    const size_t TABLE_SIZE = 256 * 1024;
+
+    (void)std::remove(SNAPSHOT_PATH);
+
+    std::vector<std::vector<char>> tables;
+    for(int i = 0; i < TABLE_COUNT; i++)
+    {
+        tables.push_back(MakeTable(i, TABLE_SIZE));
+    }
+
+    // Load by copying the contents into a string stream
+    auto start = std::chrono::high_resolution_clock::now();
+
+    uint64_t copySum = 0;
+    for(auto& table : tables)
+    {
+        std::vector<char> data = table;
+        std::stringstream ss(std::string(data.begin(), data.end()));
+
+        copySum += ReadAll(ss);
+    }
+
+    int64_t copyTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    {
+        DefinitionSnapshot snapshot;
+        for(int i = 0; i < TABLE_COUNT; i++)
+        {
+            snapshot.AddTable(String("%1.sbin").Arg(i), (int64_t)TABLE_SIZE,
+                i, std::vector<char>(tables[(size_t)i]));
+        }
+
+        ASSERT_TRUE(snapshot.Save(SNAPSHOT_PATH));
+    }
+
+    // Load from the mapped snapshot
+    start = std::chrono::high_resolution_clock::now();
+
+    uint64_t snapshotSum = 0;
+    {
+        DefinitionSnapshot snapshot;
+        ASSERT_TRUE(snapshot.Open(SNAPSHOT_PATH));
+
+        for(int i = 0; i < TABLE_COUNT; i++)
+        {
+            const char *pData = nullptr;
+            size_t size = 0;
+
+            ASSERT_TRUE(snapshot.GetTable(String("%1.sbin").Arg(i),
+                (int64_t)TABLE_SIZE, i, pData, size));
+
+            MemoryStreamBuffer buffer(pData, size);
+            std::istream in(&buffer);
+
+            snapshotSum += ReadAll(in);
+        }
+    }
+
+    int64_t snapshotTime = std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::high_resolution_clock::now()
+            - start).count();
+
+    EXPECT_EQ(copySum, snapshotSum);
+
+    std::cout << "[ BENCHMARK] " << TABLE_COUNT << " tables of "
+        << (TABLE_SIZE / 1024) << " KiB: copied " << (copyTime / 1000)
+        << " ms, mapped snapshot " << (snapshotTime / 1000) << " ms"
+        << std::endl;
+
+    (void)std::remove(SNAPSHOT_PATH);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -29,10 +29,59 @@
 #include <PopIgnore.h>
 
 #include <TestObject.h>
+#include <TestObjectE.h>
+#include <TestObjectF.h>
+
+// Definition Includes
+#include <MiCorrectTbl.h>
+#include <MiDevilData.h>
+#include <MiItemData.h>
+#include <MiSkillData.h>
+#include <MiStatusData.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
 
 using namespace libcomp;
 using namespace objects;
 
+namespace
+{
+
+/// Number of allocations made through the global operator new.
+std::atomic<uint64_t> gAllocationCount(0);
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    gAllocationCount++;
+
+    void *pData = std::malloc(size ? size : 1);
+    if(!pData)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pData;
+}
+
+void operator delete(void *pData) noexcept
+{
+    std::free(pData);
+}
+
+void operator delete(void *pData, size_t size) noexcept
+{
+    (void)size;
+
+    std::free(pData);
+}
+
 void WriteMapU16Char(char* map, uint16_t idx, char val)
 {
     uint32_t stringLength = 1;
@@ -370,6 +419,124 @@ TEST(Object, TestObject)
     EXPECT_EQ(TestObject::EnumYN_t::YES, data.GetEnumYN());
 }
 
+TEST(Object, ImmutableObject)
+{
+    TestObjectF data;
+
+    // Immutable objects are filled in while they are loaded
+    EXPECT_TRUE(data.SetArray(1, 7));
+    EXPECT_TRUE(data.AppendIntList(3));
+    EXPECT_TRUE(data.AppendIntList(4));
+    EXPECT_TRUE(data.SetMap(5, "five"));
+    EXPECT_TRUE(data.InsertSet(6));
+
+    // Containers are read in place instead of being copied
+    const std::list<int32_t>& intList = data.GetIntList();
+    EXPECT_EQ(&intList, &data.GetIntList());
+    EXPECT_EQ(2, intList.size());
+    EXPECT_EQ(3, intList.front());
+
+    EXPECT_EQ(&data.GetArray(), &data.GetArray());
+    EXPECT_EQ(7, data.GetArray()[1]);
+    EXPECT_EQ(&data.GetMap(), &data.GetMap());
+    EXPECT_EQ("five", data.GetMap().at(5));
+    EXPECT_EQ(&data.GetSet(), &data.GetSet());
+    EXPECT_TRUE(data.SetContains(6));
+
+    int32_t sum = 0;
+    for(auto it = data.IntListBegin(); it != data.IntListEnd(); ++it)
+    {
+        sum += *it;
+    }
+    EXPECT_EQ(7, sum);
+
+    // Copies still get their own containers
+    TestObjectF copy(data);
+    EXPECT_NE(&copy.GetIntList(), &data.GetIntList());
+    EXPECT_EQ(data.GetIntList(), copy.GetIntList());
+
+    // Mutable objects still return the container by value
+    TestObjectE mutableData;
+    EXPECT_TRUE(mutableData.AppendIntList(3));
+    EXPECT_EQ(mutableData.GetIntList(), std::list<int32_t>({ 3 }));
+}
+
+TEST(Object, FieldViewAllocations)
+{
+    // Shape the objects like the calculated state of the entities in a
+    // busy zone that is read once per tick
+    const size_t ENTITY_COUNT = 200;
+    const int32_t TOKUSEI_COUNT = 25;
+
+    std::vector<TestObjectE> entities(ENTITY_COUNT);
+    for(auto& entity : entities)
+    {
+        for(int32_t i = 1; i <= TOKUSEI_COUNT; i++)
+        {
+            EXPECT_TRUE(entity.SetIntMap(i, 1));
+        }
+    }
+
+    uint64_t start = gAllocationCount;
+
+    uint64_t copySum = 0;
+    for(auto& entity : entities)
+    {
+        for(auto pair : entity.GetIntMap())
+        {
+            copySum += pair.second;
+        }
+    }
+
+    uint64_t copyAllocations = gAllocationCount - start;
+
+    start = gAllocationCount;
+
+    uint64_t viewSum = 0;
+    for(auto& entity : entities)
+    {
+        for(auto& pair : entity.IntMapView())
+        {
+            viewSum += pair.second;
+        }
+    }
+
+    uint64_t viewAllocations = gAllocationCount - start;
+
+    EXPECT_EQ(copySum, viewSum);
+    EXPECT_EQ(0, viewAllocations);
+
+    std::cout << "[ BENCHMARK] allocations per tick for " << ENTITY_COUNT
+        << " entities with " << TOKUSEI_COUNT << " tokusei: copy "
+        << copyAllocations << ", view " << viewAllocations << std::endl;
+
+    // The view still holds the field lock
+    {
+        auto view = entities[0].IntMapView();
+        EXPECT_EQ((size_t)TOKUSEI_COUNT, view->size());
+
+        // Reading from the same thread does not deadlock
+        EXPECT_EQ(1, entities[0].GetIntMap(1));
+    }
+
+    EXPECT_TRUE(entities[0].SetIntMap(1, 2));
+}
+
+TEST(Object, DefinitionSizes)
+{
+    // Report the size of the definitions that are loaded by the thousands
+    // now that they no longer carry a field lock each
+    std::cout << "[ BENCHMARK] bytes per object (field lock was "
+        << sizeof(std::mutex) << " bytes): MiCorrectTbl "
+        << sizeof(MiCorrectTbl) << ", MiDevilData " << sizeof(MiDevilData)
+        << ", MiItemData " << sizeof(MiItemData) << ", MiSkillData "
+        << sizeof(MiSkillData) << ", MiStatusData " << sizeof(MiStatusData)
+        << std::endl;
+
+    EXPECT_LT(sizeof(MiCorrectTbl), sizeof(libcomp::Object) +
+        sizeof(std::mutex));
+}
+
 int main(int argc, char *argv[])
 {
     try
@@ -359,6 +359,72 @@ TEST(MariaDB, ChangeSet)
     EXPECT_FALSE(db.IsOpen());
 }
 
+TEST(MariaDB, WriteBehind)
+{
+    auto config = GetConfig();
+    MariaDBAccount::RegisterPersistentType();
+
+    DatabaseMariaDB db(config);
+
+    EXPECT_TRUE(db.Open());
+    EXPECT_TRUE(db.Setup());
+
+    EXPECT_TRUE(db.StartWriteBehind());
+    EXPECT_FALSE(db.StartWriteBehind());
+
+    std::list<std::shared_ptr<MariaDBAccount>> accounts;
+    for(int32_t i = 0; i < 3; i++)
+    {
+        auto account = std::make_shared<MariaDBAccount>();
+        account->Register(account);
+        account->SetUsername(String("writebehind%1").Arg(i));
+        account->SetCP(0);
+
+        db.QueueInsert(account);
+        accounts.push_back(account);
+    }
+
+    // Inserts for all three accounts are written in one batch
+    EXPECT_TRUE(db.ProcessTransactionQueue().empty());
+    db.StopWriteBehind();
+
+    EXPECT_TRUE(db.StartWriteBehind());
+
+    // The repeated update to the first account is dropped
+    for(auto account : accounts)
+    {
+        account->SetCP(50);
+
+        db.QueueUpdate(account);
+        db.QueueUpdate(accounts.front());
+    }
+
+    auto stats = db.ResetTransactionQueueStats();
+    EXPECT_EQ(stats.QueueDepth, 6u);
+
+    EXPECT_TRUE(db.ProcessTransactionQueue().empty());
+    db.StopWriteBehind();
+
+    stats = db.ResetTransactionQueueStats();
+    EXPECT_EQ(stats.QueueDepth, 0u);
+    EXPECT_EQ(stats.FlushCount, 1u);
+    EXPECT_EQ(stats.Coalesced, 2u);
+
+    auto query = db.Prepare("SELECT COUNT(1) FROM `Account`"
+        " WHERE `CP` = 50;");
+    EXPECT_TRUE(query.Execute());
+    EXPECT_TRUE(query.Next());
+
+    int64_t count = 0;
+    EXPECT_TRUE(query.GetValue(0, count));
+    EXPECT_EQ(count, 3);
+
+    EXPECT_TRUE(db.Execute("DROP DATABASE IF EXISTS comp_hack_test;"));
+
+    EXPECT_TRUE(db.Close());
+    EXPECT_FALSE(db.IsOpen());
+}
+
 int main(int argc, char *argv[])
 {
     try
@@ -0,0 +1,373 @@
+/**
+ * @file libcomp/tests/MessageQueue.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the message queue.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <MessageQueue.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Number of allocations made by any thread
+std::atomic<uint64_t> gAllocationCount(0);
+
+/**
+ * Stand in for the queue as it was before: a list guarded by a mutex.
+ */
+template<class T>
+class LockedQueue
+{
+public:
+    /**
+     * Enqueue a message.
+     * @param item Message to add
+     */
+    void Enqueue(T item)
+    {
+        std::lock_guard<std::mutex> lock(mQueueLock);
+        bool wasEmpty = mQueue.empty();
+        mQueue.push_back(item);
+
+        if(wasEmpty)
+        {
+            mEmptyCondition.notify_one();
+        }
+    }
+
+    /**
+     * Dequeue all the messages and wait if its empty.
+     * @param destinationQueue List to add the messages to
+     */
+    void DequeueAll(std::list<T>& destinationQueue)
+    {
+        std::unique_lock<std::mutex> lock(mQueueLock);
+        mEmptyCondition.wait(lock, [this]() { return !mQueue.empty(); });
+        destinationQueue.splice(destinationQueue.end(), mQueue);
+    }
+
+private:
+    /// The list of messages
+    std::list<T> mQueue;
+
+    /// Mutex lock to use when modifying the queue
+    std::mutex mQueueLock;
+
+    /// Blocking condition to wait for when no messages are queued
+    std::condition_variable mEmptyCondition;
+};
+
+/**
+ * Enqueue messages from several threads and dequeue them on this one.
+ * @param queue Queue to test
+ * @param producerCount Number of threads adding messages
+ * @param messageCount Number of messages each thread adds
+ * @param allocations Set to the number of allocations made while the
+ *  messages were enqueued and dequeued
+ * @return Time in microseconds to dequeue every message or -1 if the
+ *  messages from any one thread were out of order
+ */
+template<typename Container, typename Q>
+int64_t RunProducers(Q& queue, uint32_t producerCount, uint32_t messageCount,
+    uint64_t& allocations)
+{
+    std::vector<std::thread> producers;
+    std::vector<uint32_t> nextSequence(producerCount, 0);
+
+    producers.reserve(producerCount);
+
+    uint64_t startAllocations = gAllocationCount.load();
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for(uint32_t p = 0; p < producerCount; p++)
+    {
+        producers.push_back(std::thread([&queue, p, messageCount]()
+        {
+            for(uint32_t i = 0; i < messageCount; i++)
+            {
+                queue.Enqueue(((uint64_t)p << 32) | i);
+            }
+        }));
+    }
+
+    bool ordered = true;
+    uint64_t remaining = (uint64_t)producerCount * messageCount;
+
+    Container msgs;
+    while(remaining > 0)
+    {
+        queue.DequeueAll(msgs);
+
+        for(uint64_t msg : msgs)
+        {
+            uint32_t p = (uint32_t)(msg >> 32);
+
+            if(nextSequence[p]++ != (uint32_t)msg)
+            {
+                ordered = false;
+            }
+        }
+
+        remaining -= msgs.size();
+        msgs.clear();
+    }
+
+    int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    allocations = gAllocationCount.load() - startAllocations;
+
+    for(auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    return ordered ? elapsed : -1;
+}
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    gAllocationCount++;
+
+    void *pData = std::malloc(size ? size : 1);
+
+    if(!pData)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pData;
+}
+
+void operator delete(void *pData) noexcept
+{
+    std::free(pData);
+}
+
+void operator delete(void *pData, size_t size) noexcept
+{
+    (void)size;
+
+    std::free(pData);
+}
+
+TEST(MessageQueue, Order)
+{
+    MessageQueue<int> queue;
+
+    std::list<int> batch = { 2, 3, 4 };
+    queue.Enqueue(1);
+    queue.Enqueue(batch);
+    queue.Enqueue(5);
+    EXPECT_TRUE(batch.empty());
+
+    // An empty batch is ignored
+    queue.Enqueue(batch);
+
+    EXPECT_EQ(queue.Dequeue(), 1);
+    EXPECT_EQ(queue.Dequeue(), 2);
+
+    queue.Enqueue(6);
+
+    std::list<int> msgs;
+    queue.DequeueAll(msgs);
+    EXPECT_EQ(msgs, std::list<int>({ 3, 4, 5, 6 }));
+
+    msgs.clear();
+    queue.DequeueAny(msgs);
+    EXPECT_TRUE(msgs.empty());
+}
+
+TEST(MessageQueue, Overflow)
+{
+    MessageQueue<int> queue;
+
+    // Fill the ring and spill into the overflow with single messages and
+    // batches mixed together.
+    int next = 0;
+    for(int i = 0; i < 300; i++)
+    {
+        if(0 == (i % 7))
+        {
+            std::list<int> batch = { next, next + 1, next + 2 };
+            queue.Enqueue(batch);
+            next += 3;
+        }
+        else
+        {
+            queue.Enqueue(next++);
+        }
+    }
+
+    // Free some of the ring. Messages keep going to the overflow until the
+    // ring is empty so they stay in order.
+    for(int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(queue.Dequeue(), i);
+    }
+
+    for(int i = 0; i < 20; i++)
+    {
+        queue.Enqueue(next++);
+    }
+
+    std::vector<int> msgs;
+    queue.DequeueAll(msgs);
+    ASSERT_EQ(msgs.size(), (size_t)(next - 10));
+
+    for(size_t i = 0; i < msgs.size(); i++)
+    {
+        EXPECT_EQ(msgs[i], (int)i + 10);
+    }
+
+    // The ring is used again once the overflow is taken.
+    queue.Enqueue(next);
+    EXPECT_EQ(queue.Dequeue(), next);
+}
+
+TEST(MessageQueue, NoAllocations)
+{
+    MessageQueue<int> queue;
+    std::vector<int> msgs;
+
+    // The first pass grows the vectors.
+    for(int pass = 0; pass < 2; pass++)
+    {
+        uint64_t startAllocations = gAllocationCount.load();
+
+        for(int i = 0; i < 1000; i++)
+        {
+            for(int j = 0; j < 100; j++)
+            {
+                queue.Enqueue(j);
+            }
+
+            queue.DequeueAll(msgs);
+            msgs.clear();
+
+            queue.Enqueue(i);
+            queue.Dequeue();
+        }
+
+        uint64_t allocations = gAllocationCount.load() - startAllocations;
+
+        if(1 == pass)
+        {
+            EXPECT_EQ(allocations, 0u);
+        }
+    }
+}
+
+TEST(MessageQueue, Wakeup)
+{
+    MessageQueue<int> queue;
+
+    // The consumer must be woken by a message added while it waits
+    std::thread producer([&queue]()
+    {
+        for(int i = 0; i < 100; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            queue.Enqueue(i);
+        }
+    });
+
+    for(int i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(queue.Dequeue(), i);
+    }
+
+    producer.join();
+}
+
+TEST(MessageQueue, MultipleProducers)
+{
+    MessageQueue<uint64_t> queue;
+
+    uint64_t allocations;
+    EXPECT_GE(RunProducers<std::list<uint64_t>>(queue, 8, 20000,
+        allocations), 0);
+    EXPECT_GE(RunProducers<std::vector<uint64_t>>(queue, 8, 20000,
+        allocations), 0);
+}
+
+TEST(MessageQueue, Benchmark)
+{
+    const uint32_t PRODUCER_COUNT = 4;
+    const uint32_t MESSAGE_COUNT = 250000;
+
+    const uint64_t TOTAL_COUNT = (uint64_t)PRODUCER_COUNT * MESSAGE_COUNT;
+
+    uint64_t lockedAllocations;
+    LockedQueue<uint64_t> lockedQueue;
+    int64_t lockedTime = RunProducers<std::list<uint64_t>>(lockedQueue,
+        PRODUCER_COUNT, MESSAGE_COUNT, lockedAllocations);
+
+    uint64_t queueAllocations;
+    MessageQueue<uint64_t> queue;
+    int64_t queueTime = RunProducers<std::vector<uint64_t>>(queue,
+        PRODUCER_COUNT, MESSAGE_COUNT, queueAllocations);
+
+    EXPECT_GE(lockedTime, 0);
+    EXPECT_GE(queueTime, 0);
+
+    // Only the overflow blocks and the consumer vectors allocate.
+    EXPECT_LT(queueAllocations, TOTAL_COUNT / 16);
+
+    std::cout << "[ BENCHMARK] " << PRODUCER_COUNT << " producers x "
+        << (MESSAGE_COUNT / 1000) << "k messages: locked list "
+        << (lockedTime / 1000) << " ms (" << lockedAllocations
+        << " allocations), message queue " << (queueTime / 1000) << " ms ("
+        << queueAllocations << " allocations)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -29,6 +29,7 @@
 #include <PopIgnore.h>
 
 #include <Packet.h>
+#include <PacketBufferPool.h>
 
 using namespace libcomp;
 
@@ -74,6 +75,81 @@ TEST(Packet, MoveAssignment)
     EXPECT_EQ(String(&a.ReadArray(1)[0], 1), "z");
 }
 
+TEST(Packet, GrowBuffer)
+{
+    Packet p;
+
+    // Write enough data to move the packet through every size class.
+    for(uint32_t i = 0; i < (MAX_PACKET_SIZE / 4); i++)
+    {
+        p.WriteU32Little(i);
+    }
+
+    EXPECT_EQ(p.Size(), MAX_PACKET_SIZE);
+    EXPECT_EQ(p.Free(), 0);
+
+    // Every value must have survived the buffer moves.
+    p.Rewind();
+
+    for(uint32_t i = 0; i < (MAX_PACKET_SIZE / 4); i++)
+    {
+        ASSERT_EQ(p.ReadU32Little(), i);
+    }
+
+    EXPECT_ANY_THROW(p.WriteU8(0));
+
+    // Direct access must also be able to use the whole packet.
+    Packet d;
+    char *pData = d.Direct(MAX_PACKET_SIZE);
+    pData[MAX_PACKET_SIZE - 1] = 'z';
+
+    d.Seek(MAX_PACKET_SIZE - 1);
+    EXPECT_EQ(d.ReadS8(), 'z');
+
+    // Copies keep all the data.
+    Packet c(p);
+    EXPECT_EQ(c.Size(), MAX_PACKET_SIZE);
+
+    c.Seek(MAX_PACKET_SIZE - 4);
+    EXPECT_EQ(c.ReadU32Little(), (MAX_PACKET_SIZE / 4) - 1);
+}
+
+TEST(Packet, BufferPool)
+{
+    EXPECT_EQ(PacketBufferPool::GetCapacity(0),
+        PacketBufferPool::SMALL_BUFFER_SIZE);
+    EXPECT_EQ(PacketBufferPool::GetCapacity(
+        PacketBufferPool::SMALL_BUFFER_SIZE + 1),
+        PacketBufferPool::MEDIUM_BUFFER_SIZE);
+    EXPECT_EQ(PacketBufferPool::GetCapacity(MAX_PACKET_SIZE),
+        PacketBufferPool::LARGE_BUFFER_SIZE);
+    EXPECT_EQ(PacketBufferPool::GetCapacity(MAX_PACKET_SIZE + 1), 0);
+
+    // Warm up the free list for small buffers.
+    {
+        Packet p;
+        p.WriteU32Little(1);
+    }
+
+    PacketBufferPool::ResetStats();
+
+    // Small packets released on this thread should be reused.
+    for(int i = 0; i < 100; i++)
+    {
+        Packet p;
+        p.WriteArray("abc", 3);
+
+        ReadOnlyPacket r(std::move(p));
+        EXPECT_EQ(r.Size(), 3);
+    }
+
+    auto stats = PacketBufferPool::ResetStats();
+    EXPECT_EQ(stats.Acquired, 100);
+    EXPECT_EQ(stats.Allocated, 0);
+    EXPECT_EQ(stats.AllocatedBytes, 0);
+    EXPECT_EQ(stats.SavedBytes, 100 * MAX_PACKET_SIZE);
+}
+
 int main(int argc, char *argv[])
 {
     try
@@ -0,0 +1,238 @@
+/**
+ * @file libcomp/tests/PersistentObject.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the persistent object cache.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <Item.h>
+#include <PersistentObject.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Number of threads looking up objects in the benchmark.
+const size_t THREAD_COUNT = 4;
+
+/// Number of lookups each thread makes in the benchmark.
+const size_t LOOKUP_COUNT = 250000;
+
+/**
+ * Stand in for the cache as it was before: one map keyed on the UUID
+ * string behind a single lock.
+ */
+class StringCache
+{
+public:
+    /**
+     * Add an object to the cache.
+     * @param obj Object to add
+     */
+    void Register(const std::shared_ptr<PersistentObject>& obj)
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mCached[obj->GetUUID().ToString()] = obj;
+    }
+
+    /**
+     * Look up an object in the cache.
+     * @param uuid UUID of the object
+     * @return Pointer to the object or null
+     */
+    std::shared_ptr<PersistentObject> Get(const libobjgen::UUID& uuid)
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        auto it = mCached.find(uuid.ToString());
+        return it != mCached.end() ? it->second.lock() : nullptr;
+    }
+
+private:
+    /// Mutex to lock accessing the cache
+    std::mutex mLock;
+
+    /// Map of objects by their UUID string
+    std::unordered_map<std::string, std::weak_ptr<PersistentObject>> mCached;
+};
+
+/**
+ * Look up objects from a number of threads at once.
+ * @param uuids UUIDs to look up
+ * @param lookup Function to look up a UUID with
+ * @return Time taken in microseconds
+ */
+template<typename Function>
+int64_t LookupAll(const std::vector<libobjgen::UUID>& uuids,
+    Function&& lookup)
+{
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for(size_t t = 0; t < THREAD_COUNT; t++)
+    {
+        threads.push_back(std::thread([&uuids, &lookup, t]()
+        {
+            std::mt19937 rng((uint32_t)t);
+
+            for(size_t i = 0; i < LOOKUP_COUNT; i++)
+            {
+                EXPECT_NE(lookup(uuids[rng() % uuids.size()]), nullptr);
+            }
+        }));
+    }
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+} // namespace
+
+TEST(PersistentObject, Cache)
+{
+    auto item = std::make_shared<objects::Item>();
+    ASSERT_TRUE(PersistentObject::Register(item));
+
+    auto uuid = item->GetUUID();
+    EXPECT_FALSE(uuid.IsNull());
+    EXPECT_EQ(PersistentObject::GetObjectByUUID(uuid), item);
+
+    // A second live object can't take the same UUID.
+    auto copy = std::make_shared<objects::Item>();
+    EXPECT_FALSE(PersistentObject::Register(copy, uuid));
+
+    // Once the object is gone its entry does not block the UUID.
+    item.reset();
+    EXPECT_EQ(PersistentObject::GetObjectByUUID(uuid), nullptr);
+    EXPECT_TRUE(PersistentObject::Register(copy, uuid));
+    EXPECT_EQ(PersistentObject::GetObjectByUUID(uuid), copy);
+
+    // Unregistered objects are removed right away.
+    copy->Unregister();
+    EXPECT_EQ(PersistentObject::GetObjectByUUID(uuid), nullptr);
+
+    (void)PersistentObject::SweepCache();
+    (void)PersistentObject::ResetCacheStats();
+
+    // Destroyed objects are left for the sweep.
+    std::vector<libobjgen::UUID> uuids;
+    for(int i = 0; i < 100; i++)
+    {
+        auto temp = std::make_shared<objects::Item>();
+        ASSERT_TRUE(PersistentObject::Register(temp));
+        uuids.push_back(temp->GetUUID());
+    }
+
+    for(auto& tempUUID : uuids)
+    {
+        EXPECT_EQ(PersistentObject::GetObjectByUUID(tempUUID), nullptr);
+    }
+
+    EXPECT_EQ(PersistentObject::SweepCache(), 100u);
+    EXPECT_EQ(PersistentObject::SweepCache(), 0u);
+
+    auto stats = PersistentObject::ResetCacheStats();
+    EXPECT_EQ(stats.Lookups, 100u);
+    EXPECT_EQ(stats.Hits, 0u);
+    EXPECT_EQ(stats.Swept, 100u);
+    EXPECT_EQ(stats.Cached, 0u);
+}
+
+TEST(PersistentObject, CacheBenchmark)
+{
+    // Cache about as many objects as a busy channel has loaded.
+    const size_t OBJECT_COUNT = 50000;
+
+    StringCache stringCache;
+    std::vector<std::shared_ptr<objects::Item>> items;
+    std::vector<libobjgen::UUID> uuids;
+
+    for(size_t i = 0; i < OBJECT_COUNT; i++)
+    {
+        auto item = std::make_shared<objects::Item>();
+        ASSERT_TRUE(PersistentObject::Register(item));
+
+        stringCache.Register(item);
+        items.push_back(item);
+        uuids.push_back(item->GetUUID());
+    }
+
+    int64_t stringTime = LookupAll(uuids, [&stringCache](
+        const libobjgen::UUID& uuid)
+    {
+        return stringCache.Get(uuid);
+    });
+
+    (void)PersistentObject::ResetCacheStats();
+
+    int64_t shardTime = LookupAll(uuids, [](const libobjgen::UUID& uuid)
+    {
+        return PersistentObject::GetObjectByUUID(uuid);
+    });
+
+    auto stats = PersistentObject::ResetCacheStats();
+    EXPECT_EQ(stats.Lookups, (uint64_t)(THREAD_COUNT * LOOKUP_COUNT));
+    EXPECT_EQ(stats.Hits, stats.Lookups);
+
+    std::cout << "[ BENCHMARK] " << (THREAD_COUNT * LOOKUP_COUNT / 1000)
+        << "k lookups on " << THREAD_COUNT << " threads: string keyed map "
+        << (stringTime / 1000) << " ms, sharded cache " << (shardTime / 1000)
+        << " ms (" << stats.Contended << " contended)" << std::endl;
+
+    items.clear();
+    EXPECT_EQ(PersistentObject::SweepCache(), OBJECT_COUNT);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -32,7 +32,10 @@
 #include <Decrypt.h>
 #include <Log.h>
 #include <Packet.h>
+#include <Randomizer.h>
 #include <ScriptEngine.h>
+#include <ScriptEnginePool.h>
+#include <ServerDataManager.h>
 #include <TestObject.h>
 #include <TestObjectA.h>
 #include <TestObjectB.h>
@@ -40,8 +43,70 @@
 #include <TestObjectD.h>
 #include <TestObjectE.h>
 
+// Standard C++11 Includes
+#include <chrono>
+#include <iostream>
+
 using namespace libcomp;
 
+namespace
+{
+
+/// Script similar to a typical custom action script.
+const char *ACTION_CUSTOM_SCRIPT =
+    "function define(script)\n"
+    "{\n"
+    "    script.Name = \"benchmark\";\n"
+    "    script.Type = \"actioncustom\";\n"
+    "    return 0;\n"
+    "}\n"
+    "\n"
+    "function run(source, params)\n"
+    "{\n"
+    "    local total = 0;\n"
+    "    foreach(p in params)\n"
+    "    {\n"
+    "        total += p.tointeger();\n"
+    "    }\n"
+    "\n"
+    "    local p = Packet();\n"
+    "    p.WriteS32Little(source);\n"
+    "    p.WriteS32Little(total);\n"
+    "    p.WriteS32Little(Randomizer.RNG(0, 100));\n"
+    "\n"
+    "    return p.Size() == 12 ? 0 : -1;\n"
+    "}\n";
+
+/**
+ * Bind the types used by the benchmark script.
+ * @param engine Script engine to bind to
+ */
+void BindActionCustom(ScriptEngine& engine)
+{
+    engine.Using<Packet>();
+    engine.Using<Randomizer>();
+}
+
+/**
+ * Run the benchmark script's run function.
+ * @param engine Script engine the script was evaluated on
+ * @return true if the script succeeded
+ */
+bool RunActionCustom(ScriptEngine& engine)
+{
+    Sqrat::Array sqParams(engine.GetVM());
+    sqParams.Append("1");
+    sqParams.Append("2");
+    sqParams.Append("3");
+
+    Sqrat::Function f(Sqrat::RootTable(engine.GetVM()), "run");
+    auto result = !f.IsNull() ? f.Evaluate<int32_t>(1, sqParams) : 0;
+
+    return result && *result == 0;
+}
+
+} // namespace
+
 TEST(ScriptEngine, EvalCompileError)
 {
     ScriptEngine engine;
@@ -1103,6 +1168,190 @@ TEST(ScriptEngine, Integer64)
     Log::GetSingletonPtr()->ClearHooks();
 }
 
+TEST(ScriptEngine, Bytecode)
+{
+    ScriptEngine compiler;
+
+    std::vector<char> bytecode;
+    ASSERT_TRUE(compiler.Compile(
+        "function Add(a, b) { return a + b; }", bytecode));
+    EXPECT_FALSE(bytecode.empty());
+
+    // The compiling engine does not run the script
+    EXPECT_TRUE(Sqrat::RootTable(compiler.GetVM()).GetFunction(
+        "Add").IsNull());
+
+    ScriptEngine engine;
+    ASSERT_TRUE(engine.EvalBytecode(bytecode));
+
+    Sqrat::Function f(Sqrat::RootTable(engine.GetVM()), "Add");
+    auto result = f.Evaluate<int32_t>(2, 3);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, 5);
+
+    // Truncated bytecode must fail instead of reading past the end
+    bytecode.resize(bytecode.size() / 2);
+
+    ScriptEngine engine2;
+    EXPECT_FALSE(engine2.EvalBytecode(bytecode));
+}
+
+TEST(ScriptEngine, ResetRootState)
+{
+    ScriptEngine engine;
+    engine.Using<Packet>();
+
+    EXPECT_TRUE(engine.Eval("baseValue <- 1;"));
+    engine.SaveRootState();
+
+    EXPECT_TRUE(engine.Eval("function run() { return baseValue; }"));
+    engine.Using<Randomizer>();
+
+    engine.ResetRootState();
+
+    auto root = Sqrat::RootTable(engine.GetVM());
+    EXPECT_TRUE(root.GetFunction("run").IsNull());
+    EXPECT_TRUE(root.GetSlot("Randomizer").IsNull());
+    EXPECT_FALSE(root.GetSlot("baseValue").IsNull());
+    EXPECT_FALSE(root.GetSlot("Packet").IsNull());
+
+    // Removed bindings can be made again
+    engine.Using<Randomizer>();
+    EXPECT_FALSE(root.GetSlot("Randomizer").IsNull());
+}
+
+TEST(ScriptEngine, Pool)
+{
+    ScriptEnginePool::ResetStats();
+
+    int prepareCount = 0;
+    auto prepare = [&prepareCount](ScriptEngine& engine)
+        {
+            BindActionCustom(engine);
+            prepareCount++;
+        };
+
+    ScriptEngine *pFirst = nullptr;
+    {
+        auto engine = ScriptEnginePool::Acquire("test", prepare);
+        pFirst = engine.get();
+
+        EXPECT_TRUE(engine->Eval("leftover <- 1;"));
+    }
+
+    {
+        auto engine = ScriptEnginePool::Acquire("test", prepare);
+        EXPECT_EQ(pFirst, engine.get());
+        EXPECT_TRUE(Sqrat::RootTable(engine->GetVM()).GetSlot(
+            "leftover").IsNull());
+
+        // A second engine is needed while the first is in use
+        auto engine2 = ScriptEnginePool::Acquire("test", prepare);
+        EXPECT_NE(engine.get(), engine2.get());
+    }
+
+    EXPECT_EQ(prepareCount, 2);
+
+    auto stats = ScriptEnginePool::GetStats();
+    EXPECT_EQ(stats.Acquired, 3u);
+    EXPECT_EQ(stats.Created, 2u);
+}
+
+TEST(ScriptEngine, PoolConstTable)
+{
+    ScriptEnginePool::ResetStats();
+
+    // Same shape as the actioncustom profile bound by the channel
+    auto prepare = [](ScriptEngine& engine)
+        {
+            Sqrat::Enumeration rEnum(engine.GetVM());
+            rEnum.Const("SUCCESS", 0);
+            rEnum.Const("FAIL", -1);
+            rEnum.Const("LOG_OFF", 1);
+
+            Sqrat::ConstTable(engine.GetVM()).Enum("Result_t", rEnum);
+        };
+
+    ServerScript script;
+    script.Path = "result.nut";
+    script.Source =
+        "function run()\n"
+        "{\n"
+        "    return Result_t.LOG_OFF;\n"
+        "}\n";
+
+    // The script must still be checked by an engine without the const
+    // table when it is loaded
+    {
+        ScriptEngine loader;
+        ASSERT_TRUE(loader.Eval(script.Source, script.Path));
+    }
+
+    for(int i = 0; i < 2; i++)
+    {
+        auto engine = ScriptEnginePool::Acquire("consttable", prepare);
+        ASSERT_TRUE(ScriptEnginePool::EvalScript(engine, script));
+
+        Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "run");
+        auto result = f.Evaluate<int32_t>();
+        ASSERT_TRUE(result);
+        EXPECT_EQ(*result, 1);
+    }
+
+    auto stats = ScriptEnginePool::ResetStats();
+    EXPECT_EQ(stats.SourceCompiles, 1u);
+    EXPECT_EQ(stats.BytecodeHits, 1u);
+}
+
+TEST(ScriptEngine, PoolBenchmark)
+{
+    const int RUN_COUNT = 1000;
+
+    ServerScript script;
+    script.Source = ACTION_CUSTOM_SCRIPT;
+
+    // Create, bind and compile for every run
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < RUN_COUNT; i++)
+    {
+        auto engine = std::make_shared<ScriptEngine>();
+        BindActionCustom(*engine);
+
+        ASSERT_TRUE(engine->Eval(script.Source));
+        ASSERT_TRUE(RunActionCustom(*engine));
+    }
+    auto freshTime = std::chrono::duration_cast<
+        std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    ScriptEnginePool::ResetStats();
+
+    // Reuse a pooled engine and load the bytecode
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < RUN_COUNT; i++)
+    {
+        auto engine = ScriptEnginePool::Acquire("benchmark",
+            &BindActionCustom);
+
+        ASSERT_TRUE(ScriptEnginePool::EvalScript(engine, script));
+        ASSERT_TRUE(RunActionCustom(*engine));
+    }
+    auto pooledTime = std::chrono::duration_cast<
+        std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    auto stats = ScriptEnginePool::ResetStats();
+    EXPECT_EQ(stats.Created, 1u);
+    EXPECT_EQ(stats.SourceCompiles, 1u);
+    EXPECT_EQ(stats.BytecodeHits, (uint64_t)(RUN_COUNT - 1));
+
+    std::cout << "[ BENCHMARK] actioncustom: fresh engine "
+        << (freshTime * 1000 / RUN_COUNT) << " ns, pooled engine "
+        << (pooledTime * 1000 / RUN_COUNT) << " ns per run ("
+        << (stats.Acquired - stats.Created) << "/" << stats.Acquired
+        << " engines reused)" << std::endl;
+}
+
 int main(int argc, char *argv[])
 {
     try
@@ -0,0 +1,287 @@
+/**
+ * @file libcomp/tests/SpatialGrid.cpp
+ * @ingroup libcomp
+ *
+ * @author HACKfrost
+ *
+ * @brief Spatial grid index unit tests and benchmark.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <SpatialGrid.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Simple stand-in for an entity position in a zone.
+struct TestEntity
+{
+    int32_t ID;
+    float X;
+    float Y;
+};
+
+/// Size of the test area in each direction (a large field zone).
+const float AREA_SIZE = 40000.f;
+
+/// Cell size used by the zone index.
+const float CELL_SIZE = 1000.f;
+
+/// Radius used by the queries (default AI aggro range).
+const float QUERY_RADIUS = 2000.f;
+
+std::vector<TestEntity> CreateEntities(size_t count, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-AREA_SIZE * 0.5f,
+        AREA_SIZE * 0.5f);
+
+    std::vector<TestEntity> entities;
+    for(size_t i = 0; i < count; i++)
+    {
+        TestEntity e;
+        e.ID = (int32_t)i + 1;
+        e.X = dist(rng);
+        e.Y = dist(rng);
+
+        entities.push_back(e);
+    }
+
+    return entities;
+}
+
+size_t LinearScan(const std::vector<TestEntity>& entities, float x, float y,
+    float radius, std::set<int32_t>* ids = nullptr)
+{
+    float rSquared = radius * radius;
+
+    size_t count = 0;
+    for(auto& e : entities)
+    {
+        float dx = e.X - x;
+        float dy = e.Y - y;
+        if(dx * dx + dy * dy <= rSquared)
+        {
+            count++;
+
+            if(ids)
+            {
+                ids->insert(e.ID);
+            }
+        }
+    }
+
+    return count;
+}
+
+size_t GridScan(const SpatialGrid<int32_t>& grid,
+    const std::vector<TestEntity>& entities, float x, float y, float radius,
+    std::vector<int32_t>& candidates, std::set<int32_t>* ids = nullptr)
+{
+    float rSquared = radius * radius;
+
+    candidates.clear();
+    grid.QueryRadius(x, y, radius, candidates);
+
+    size_t count = 0;
+    for(int32_t id : candidates)
+    {
+        auto& e = entities[(size_t)(id - 1)];
+
+        float dx = e.X - x;
+        float dy = e.Y - y;
+        if(dx * dx + dy * dy <= rSquared)
+        {
+            count++;
+
+            if(ids)
+            {
+                ids->insert(e.ID);
+            }
+        }
+    }
+
+    return count;
+}
+
+} // namespace
+
+TEST(SpatialGrid, UpdateRemove)
+{
+    SpatialGrid<int32_t> grid;
+    grid.Reset(0.f, 0.f, 1000.f, 1000.f, 100.f);
+
+    grid.Update(1, 50.f, 50.f, 50.f, 50.f);
+    grid.Update(2, 950.f, 950.f, 950.f, 950.f);
+
+    // Spans multiple cells but must only be reported once
+    grid.Update(3, 0.f, 0.f, 1000.f, 1000.f);
+
+    EXPECT_EQ(3, (int)grid.Count());
+    EXPECT_TRUE(grid.Contains(3));
+
+    std::vector<int32_t> results;
+    grid.Query(0.f, 0.f, 150.f, 150.f, results);
+    EXPECT_EQ(std::set<int32_t>({ 1, 3 }),
+        std::set<int32_t>(results.begin(), results.end()));
+    EXPECT_EQ(2, (int)results.size());
+
+    results.clear();
+    grid.Query(0.f, 0.f, 1000.f, 1000.f, results);
+    EXPECT_EQ(3, (int)results.size());
+
+    // Move the first entry to the other corner
+    grid.Update(1, 900.f, 900.f, 900.f, 900.f);
+
+    results.clear();
+    grid.Query(0.f, 0.f, 150.f, 150.f, results);
+    EXPECT_EQ(std::vector<int32_t>({ 3 }), results);
+
+    EXPECT_TRUE(grid.Remove(3));
+    EXPECT_FALSE(grid.Remove(3));
+
+    results.clear();
+    grid.Query(800.f, 800.f, 1000.f, 1000.f, results);
+    EXPECT_EQ(std::set<int32_t>({ 1, 2 }),
+        std::set<int32_t>(results.begin(), results.end()));
+}
+
+TEST(SpatialGrid, OutOfBounds)
+{
+    SpatialGrid<int32_t> grid;
+    grid.Reset(0.f, 0.f, 1000.f, 1000.f, 100.f);
+
+    // Entries outside of the bounds are clamped to the edge cells
+    grid.Update(1, -5000.f, -5000.f, -5000.f, -5000.f);
+    grid.Update(2, 5000.f, 5000.f, 5000.f, 5000.f);
+
+    std::vector<int32_t> results;
+    grid.QueryRadius(-5000.f, -5000.f, 10.f, results);
+    EXPECT_EQ(std::vector<int32_t>({ 1 }), results);
+
+    results.clear();
+    grid.QueryRadius(5000.f, 5000.f, 10.f, results);
+    EXPECT_EQ(std::vector<int32_t>({ 2 }), results);
+}
+
+TEST(SpatialGrid, MatchesLinearScan)
+{
+    std::mt19937 rng(1234);
+
+    auto entities = CreateEntities(1000, rng);
+
+    SpatialGrid<int32_t> grid;
+    grid.Reset(-AREA_SIZE * 0.5f, -AREA_SIZE * 0.5f, AREA_SIZE * 0.5f,
+        AREA_SIZE * 0.5f, CELL_SIZE);
+
+    for(auto& e : entities)
+    {
+        grid.Update(e.ID, e.X, e.Y, e.X, e.Y);
+    }
+
+    std::vector<int32_t> candidates;
+    for(auto& e : entities)
+    {
+        std::set<int32_t> expected;
+        std::set<int32_t> actual;
+
+        LinearScan(entities, e.X, e.Y, QUERY_RADIUS, &expected);
+        GridScan(grid, entities, e.X, e.Y, QUERY_RADIUS, candidates,
+            &actual);
+
+        ASSERT_EQ(expected, actual);
+    }
+}
+
+TEST(SpatialGrid, Benchmark)
+{
+    for(size_t count : { 100u, 1000u, 5000u })
+    {
+        std::mt19937 rng(5678);
+
+        auto entities = CreateEntities(count, rng);
+
+        SpatialGrid<int32_t> grid;
+        grid.Reset(-AREA_SIZE * 0.5f, -AREA_SIZE * 0.5f, AREA_SIZE * 0.5f,
+            AREA_SIZE * 0.5f, CELL_SIZE);
+
+        for(auto& e : entities)
+        {
+            grid.Update(e.ID, e.X, e.Y, e.X, e.Y);
+        }
+
+        // Each entity queries around itself once, the same as one AI
+        // retarget pass over every entity in the zone
+        size_t linearFound = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for(auto& e : entities)
+        {
+            linearFound += LinearScan(entities, e.X, e.Y, QUERY_RADIUS);
+        }
+        auto linearTime = std::chrono::duration_cast<
+            std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start).count();
+
+        size_t gridFound = 0;
+        std::vector<int32_t> candidates;
+        start = std::chrono::high_resolution_clock::now();
+        for(auto& e : entities)
+        {
+            // Move each entity slightly to include index maintenance
+            grid.Update(e.ID, e.X, e.Y, e.X + 1.f, e.Y + 1.f);
+
+            gridFound += GridScan(grid, entities, e.X, e.Y, QUERY_RADIUS,
+                candidates);
+        }
+        auto gridTime = std::chrono::duration_cast<
+            std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start).count();
+
+        EXPECT_EQ(linearFound, gridFound);
+
+        std::cout << "[ BENCHMARK] " << count << " entities: linear "
+            << linearTime << " us, grid " << gridTime << " us"
+            << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
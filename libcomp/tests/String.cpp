@@ -28,7 +28,15 @@
 #include <gtest/gtest.h>
 #include <PopIgnore.h>
 
+// libcomp Includes
+#include <Convert.h>
 #include <CString.h>
+#include <Packet.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cstring>
+#include <iostream>
 
 using namespace libcomp;
 
@@ -424,6 +432,166 @@ TEST(String, ArgUnderscoreBug)
     EXPECT_EQ("idx_a_b", indexName);
 }
 
+TEST(String, Iterator)
+{
+    String s = "@aµϢ←侩🂡🃵";
+
+    std::vector<String::CodePoint> codePoints;
+    for(String::CodePoint cp : s)
+    {
+        codePoints.push_back(cp);
+    }
+
+    ASSERT_EQ(codePoints.size(), s.Length());
+
+    for(size_t i = 0; i < s.Length(); i++)
+    {
+        EXPECT_EQ(codePoints[i], s.At(i));
+    }
+
+    String empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+    EXPECT_TRUE(String("abc").IsAscii());
+    EXPECT_FALSE(s.IsAscii());
+
+    // A lone invalid byte counts as a character but is not ASCII.
+    String invalid(std::string("a\xFF" "b"));
+    EXPECT_EQ(invalid.Length(), invalid.Size());
+    EXPECT_FALSE(invalid.IsAscii());
+    EXPECT_FALSE((String("a") + invalid).IsAscii());
+    EXPECT_TRUE(s.Left(2).IsAscii());
+}
+
+TEST(String, EncodePacket)
+{
+    const unsigned char cp932[] = {
+        0x8d, 0xa1, 0x93, 0xfa, 0x82, 0xcd, 0x8c, 0x8e, 0x97, 0x6a, 0x93, 0xfa,
+        0x82, 0xc5, 0x82, 0xb7, 0x81, 0x42
+    };
+
+    const unsigned char cp1252[] = {
+        0x43, 0x61, 0x66, 0xe9, 0x20, 0x80, 0x35
+    };
+
+    // Encode straight into the packet and check the exact bytes.
+    Packet p;
+    p.WriteString16Little(Convert::ENCODING_CP932, "今日は月曜日です。",
+        false);
+    p.WriteString16Little(Convert::ENCODING_CP1252, "Café €5", false);
+
+    ASSERT_EQ(p.Size(), sizeof(cp932) + sizeof(cp1252) + 4);
+
+    p.Rewind();
+    EXPECT_EQ(p.ReadU16Little(), sizeof(cp932));
+    EXPECT_EQ(memcmp(p.ConstData() + p.Tell(), cp932, sizeof(cp932)), 0);
+
+    p.Skip(static_cast<uint32_t>(sizeof(cp932)));
+    EXPECT_EQ(p.ReadU16Little(), sizeof(cp1252));
+    EXPECT_EQ(memcmp(p.ConstData() + p.Tell(), cp1252, sizeof(cp1252)), 0);
+
+    p.Rewind();
+    EXPECT_EQ(p.ReadString16Little(Convert::ENCODING_CP932, false),
+        "今日は月曜日です。");
+    EXPECT_EQ(p.ReadString16Little(Convert::ENCODING_CP1252, false),
+        "Café €5");
+}
+
+TEST(String, EncodeBenchmark)
+{
+    const int ITERATIONS = 100;
+
+    const char *samples[] = { "今日は月曜日です。", "Monday" };
+    const size_t lengths[] = { 8, 64, 1024 };
+
+    for(const char *szSample : samples)
+    {
+        for(size_t length : lengths)
+        {
+            // Build a string with the requested number of characters.
+            String sample(szSample);
+            String str;
+
+            while(str.Length() < length)
+            {
+                str += sample;
+            }
+
+            str = str.Left(length);
+
+            // Decode the string with the iterator.
+            auto start = std::chrono::high_resolution_clock::now();
+
+            size_t decoded = 0;
+            for(int i = 0; i < ITERATIONS; i++)
+            {
+                for(String::CodePoint cp : str)
+                {
+                    if(cp)
+                    {
+                        decoded++;
+                    }
+                }
+            }
+
+            auto iterTime = std::chrono::duration_cast<
+                std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count();
+
+            EXPECT_EQ(decoded, length * (size_t)ITERATIONS);
+
+            // Encode the string into a vector and straight into a packet.
+            std::vector<char> expected = Convert::ToEncoding(
+                Convert::ENCODING_CP932, str, false);
+
+            start = std::chrono::high_resolution_clock::now();
+
+            size_t encoded = 0;
+            for(int i = 0; i < ITERATIONS; i++)
+            {
+                encoded += Convert::ToEncoding(Convert::ENCODING_CP932,
+                    str, false).size();
+            }
+
+            auto encodeTime = std::chrono::duration_cast<
+                std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count();
+
+            EXPECT_EQ(encoded, expected.size() * (size_t)ITERATIONS);
+            EXPECT_EQ(Convert::SizeEncoded(Convert::ENCODING_CP932, str),
+                expected.size());
+
+            Packet p;
+
+            start = std::chrono::high_resolution_clock::now();
+
+            for(int i = 0; i < ITERATIONS; i++)
+            {
+                p.Clear();
+                p.WriteString16Little(Convert::ENCODING_CP932, str, false);
+            }
+
+            auto packetTime = std::chrono::duration_cast<
+                std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start).count();
+
+            ASSERT_EQ(p.Size(), expected.size() + 2);
+            EXPECT_EQ(memcmp(p.ConstData() + 2, &expected[0],
+                expected.size()), 0);
+
+            p.Rewind();
+            EXPECT_EQ(p.ReadString16Little(Convert::ENCODING_CP932, false),
+                str);
+
+            std::cout << "[ BENCHMARK] " << (str.IsAscii() ? "ASCII" :
+                "Japanese") << " string of " << length << " characters x "
+                << ITERATIONS << ": iterator " << iterTime
+                << " us, CP932 encode " << encodeTime
+                << " us, CP932 packet write " << packetTime << " us"
+                << std::endl;
+        }
+    }
+}
+
 int main(int argc, char *argv[])
 {
     try
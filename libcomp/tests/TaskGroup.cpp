@@ -0,0 +1,137 @@
+/**
+ * @file libcomp/tests/TaskGroup.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the task group.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <TaskGroup.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace libcomp;
+
+TEST(TaskGroup, RunAll)
+{
+    const size_t TASK_COUNT = 100;
+
+    std::vector<int> results(TASK_COUNT, 0);
+
+    TaskGroup tasks;
+    for(size_t i = 0; i < TASK_COUNT; i++)
+    {
+        tasks.Add(String("%1").Arg((uint64_t)i), [&results, i]()
+            {
+                results[i]++;
+
+                return true;
+            });
+    }
+
+    EXPECT_EQ(tasks.Size(), TASK_COUNT);
+    EXPECT_TRUE(tasks.Run(4));
+
+    for(size_t i = 0; i < TASK_COUNT; i++)
+    {
+        EXPECT_EQ(results[i], 1);
+    }
+}
+
+TEST(TaskGroup, Failure)
+{
+    std::atomic<int> count(0);
+
+    TaskGroup tasks;
+    for(int i = 0; i < 10; i++)
+    {
+        tasks.Add("task", [&count, i]()
+            {
+                count++;
+
+                return 3 != i;
+            });
+    }
+
+    // Every task is run even though one failed
+    EXPECT_FALSE(tasks.Run(3));
+    EXPECT_EQ(count, 10);
+
+    TaskGroup empty;
+    EXPECT_TRUE(empty.Run());
+}
+
+TEST(TaskGroup, Benchmark)
+{
+    const int TASK_COUNT = 56;
+    const auto TASK_TIME = std::chrono::milliseconds(5);
+
+    int64_t times[2];
+
+    for(int parallel = 0; parallel < 2; parallel++)
+    {
+        TaskGroup tasks;
+        for(int i = 0; i < TASK_COUNT; i++)
+        {
+            tasks.Add("table", [TASK_TIME]()
+                {
+                    // Stand in for reading and decrypting a file
+                    std::this_thread::sleep_for(TASK_TIME);
+
+                    return true;
+                });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_TRUE(tasks.Run(parallel ? 0 : 1));
+        times[parallel] = std::chrono::duration_cast<
+            std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                start).count();
+    }
+
+    std::cout << "[ BENCHMARK] " << TASK_COUNT << " tasks: serial "
+        << times[0] << " ms, parallel " << times[1] << " ms on "
+        << std::thread::hardware_concurrency() << " thread(s)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
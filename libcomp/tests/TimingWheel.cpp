@@ -0,0 +1,518 @@
+/**
+ * @file libcomp/tests/TimingWheel.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the timing wheel and the timer manager built on it.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <TimerManager.h>
+#include <TimingWheel.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/**
+ * Stand in for a timer event as the timer manager kept them before.
+ */
+struct SetEvent
+{
+    /// Tick the event expires on
+    uint64_t Expiry;
+
+    /// Value of the event
+    uint32_t Value;
+};
+
+/**
+ * Order events by expiry like the timer manager did before.
+ */
+struct SetEventComp
+{
+    /**
+     * Compare two events.
+     * @param lhs First event
+     * @param rhs Second event
+     * @return true if the first event expires first
+     */
+    bool operator()(const SetEvent *lhs, const SetEvent *rhs) const
+    {
+        return lhs->Expiry < rhs->Expiry;
+    }
+};
+
+} // namespace
+
+TEST(TimingWheel, Order)
+{
+    TimingWheel<uint32_t> wheel(1000);
+
+    // Cover every wheel and values beyond the last one.
+    std::mt19937_64 rng(1234);
+    std::vector<uint64_t> expiries;
+
+    for(uint32_t i = 0; i < 20000; i++)
+    {
+        uint64_t distance;
+
+        switch(i % 5)
+        {
+        case 0:
+            distance = rng() % 256;
+            break;
+        case 1:
+            distance = rng() % 65536;
+            break;
+        case 2:
+            distance = rng() % (1 << 24);
+            break;
+        case 3:
+            distance = rng() % ((uint64_t)1 << 32);
+            break;
+        default:
+            distance = ((uint64_t)1 << 32) + rng() % ((uint64_t)1 << 34);
+            break;
+        }
+
+        expiries.push_back(1001 + distance);
+        wheel.Schedule(1001 + distance, i);
+    }
+
+    EXPECT_EQ(wheel.Size(), expiries.size());
+
+    // Values scheduled for the current tick or before expire next tick.
+    expiries.push_back(1001);
+    wheel.Schedule(5, (uint32_t)expiries.size() - 1);
+
+    std::vector<bool> expired(expiries.size(), false);
+    size_t expiredCount = 0;
+    uint64_t now = 1000;
+    uint64_t last = 0;
+    bool ordered = true;
+    bool early = false;
+    bool late = false;
+
+    while(0 != wheel.Size())
+    {
+        // Jump ahead by a random amount (sometimes by a lot).
+        uint64_t step = 1 + rng() % ((rng() % 8) ? 4096 : ((uint64_t)1 << 30));
+        uint64_t previous = now;
+        now += step;
+
+        wheel.Advance(now, [&](uint32_t& value, uint64_t& expiry)
+        {
+            if(expiry < last)
+            {
+                ordered = false;
+            }
+
+            if(expiries[value] > now)
+            {
+                early = true;
+            }
+
+            if(expiries[value] <= previous)
+            {
+                late = true;
+            }
+
+            last = expiry;
+            expired[value] = true;
+            expiredCount++;
+
+            return false;
+        });
+
+        EXPECT_EQ(wheel.GetCurrentTick(), now);
+    }
+
+    EXPECT_TRUE(ordered);
+    EXPECT_FALSE(early);
+    EXPECT_FALSE(late);
+    EXPECT_EQ(expiredCount, expiries.size());
+    EXPECT_EQ(wheel.GetNextTick(), UINT64_MAX);
+}
+
+TEST(TimingWheel, Cancel)
+{
+    TimingWheel<uint32_t> wheel;
+    std::vector<TimingWheel<uint32_t>::Handle> handles;
+
+    for(uint32_t i = 0; i < 1000; i++)
+    {
+        handles.push_back(wheel.Schedule(1 + i * 97, i));
+    }
+
+    // Cancel every other value.
+    for(uint32_t i = 0; i < 1000; i += 2)
+    {
+        uint32_t value = 0;
+        EXPECT_TRUE(wheel.Cancel(handles[i], &value));
+        EXPECT_EQ(value, i);
+        EXPECT_FALSE(wheel.Cancel(handles[i]));
+        EXPECT_FALSE(wheel.IsScheduled(handles[i]));
+    }
+
+    EXPECT_EQ(wheel.Size(), 500u);
+
+    // A stale handle does not match a value that reuses its slot.
+    auto reused = wheel.Schedule(10, 5000);
+    EXPECT_EQ(reused.Index, handles[998].Index);
+    EXPECT_FALSE(wheel.Cancel(handles[998]));
+    EXPECT_TRUE(wheel.Cancel(reused));
+
+    EXPECT_FALSE(wheel.Cancel(TimingWheel<uint32_t>::Handle()));
+
+    std::list<uint32_t> expired;
+    wheel.Advance(1000 * 97, expired);
+
+    ASSERT_EQ(expired.size(), 500u);
+
+    uint32_t expected = 1;
+    for(uint32_t value : expired)
+    {
+        EXPECT_EQ(value, expected);
+        expected += 2;
+    }
+
+    // Values that expired can't be cancelled.
+    EXPECT_FALSE(wheel.Cancel(handles[1]));
+}
+
+TEST(TimingWheel, Rearm)
+{
+    TimingWheel<uint32_t> wheel;
+    auto handle = wheel.Schedule(100, 7);
+
+    std::vector<uint64_t> runs;
+
+    for(uint64_t now = 0; now < 1000; now += 30)
+    {
+        wheel.Advance(now, [&runs](uint32_t& value, uint64_t& expiry)
+        {
+            EXPECT_EQ(value, 7u);
+
+            runs.push_back(expiry);
+            expiry += 100;
+
+            return true;
+        });
+    }
+
+    EXPECT_EQ(runs, std::vector<uint64_t>({ 100, 200, 300, 400, 500, 600,
+        700, 800, 900 }));
+
+    // The handle is kept while the value is scheduled again.
+    EXPECT_TRUE(wheel.IsScheduled(handle));
+    EXPECT_TRUE(wheel.Cancel(handle));
+    EXPECT_EQ(wheel.Size(), 0u);
+}
+
+TEST(TimingWheel, SameTickOrder)
+{
+    TimingWheel<uint32_t> wheel;
+    std::list<uint32_t> expired;
+
+    // Values linked straight into the first wheel.
+    std::vector<TimingWheel<uint32_t>::Handle> handles;
+    for(uint32_t i = 0; i < 5; i++)
+    {
+        handles.push_back(wheel.Schedule(5, i));
+    }
+
+    // Cancelling the last value must leave the slot able to append.
+    EXPECT_TRUE(wheel.Cancel(handles[4]));
+    wheel.Schedule(5, 4);
+
+    EXPECT_TRUE(wheel.Cancel(handles[1]));
+
+    wheel.Advance(5, expired);
+    EXPECT_EQ(expired, std::list<uint32_t>({ 0, 2, 3, 4 }));
+
+    // Values cascaded down from a higher wheel.
+    expired.clear();
+    for(uint32_t i = 10; i < 14; i++)
+    {
+        wheel.Schedule(1000, i);
+    }
+
+    wheel.Advance(1000, expired);
+    EXPECT_EQ(expired, std::list<uint32_t>({ 10, 11, 12, 13 }));
+
+    // Values cascaded down after later values were added straight to the
+    // first wheel slot still expire first.
+    expired.clear();
+    wheel.Schedule(1300, 20);
+    wheel.Schedule(1300, 21);
+    wheel.Advance(1200, expired);
+    wheel.Schedule(1300, 22);
+    wheel.Schedule(1300, 23);
+
+    wheel.Advance(1300, expired);
+    EXPECT_EQ(expired, std::list<uint32_t>({ 20, 21, 22, 23 }));
+
+    // The order given expires first within a tick.
+    expired.clear();
+    wheel.Schedule(1400, 30, 2);
+    wheel.Schedule(1400, 31, 1);
+    wheel.Advance(1390, expired);
+    wheel.Schedule(1400, 32, 1);
+    wheel.Schedule(1400, 33, 0);
+
+    wheel.Advance(1400, expired);
+    EXPECT_EQ(expired, std::list<uint32_t>({ 33, 31, 32, 30 }));
+
+    // Random schedules and advances must expire in the same order as a
+    // map keyed by tick, order and schedule order.
+    std::mt19937 rng(156);
+    std::uniform_int_distribution<uint64_t> distanceDist(1, 70000);
+    std::uniform_int_distribution<uint64_t> orderDist(0, 3);
+    std::uniform_int_distribution<uint64_t> stepDist(0, 300);
+
+    std::map<std::tuple<uint64_t, uint64_t, uint32_t>, uint32_t> reference;
+    std::list<uint32_t> expected;
+    expired.clear();
+
+    uint64_t now = wheel.GetCurrentTick();
+    for(uint32_t i = 0; i < 2000; i++)
+    {
+        uint64_t expiry = now + distanceDist(rng) % (i % 2 ? 300 : 70000);
+        uint64_t order = orderDist(rng);
+
+        wheel.Schedule(expiry, i, order);
+        reference[std::make_tuple(expiry, order, i)] = i;
+
+        now += stepDist(rng);
+        wheel.Advance(now, expired);
+
+        while(!reference.empty() &&
+            std::get<0>(reference.begin()->first) <= now)
+        {
+            expected.push_back(reference.begin()->second);
+            reference.erase(reference.begin());
+        }
+    }
+
+    wheel.Advance(UINT32_MAX, expired);
+
+    for(auto& pair : reference)
+    {
+        expected.push_back(pair.second);
+    }
+
+    EXPECT_EQ(expired, expected);
+}
+
+TEST(TimerManager, Cancel)
+{
+    TimerManager timers;
+    std::atomic<int> runs(0);
+
+    auto handle = timers.ScheduleEvent(std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(50), [](std::atomic<int> *pRuns)
+        {
+            (*pRuns)++;
+        }, &runs);
+
+    (void)timers.ScheduleEvent(std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(10), [](std::atomic<int> *pRuns)
+        {
+            (*pRuns) += 10;
+        }, &runs);
+
+    EXPECT_TRUE(timers.CancelEvent(handle));
+    EXPECT_FALSE(timers.CancelEvent(handle));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    EXPECT_EQ(runs.load(), 10);
+}
+
+TEST(TimerManager, Queue)
+{
+    TimerManager timers;
+
+    auto queue = std::make_shared<TimerManager::Queue_t>();
+    auto timerThread = std::this_thread::get_id();
+    int runs = 0;
+
+    auto handle = timers.QueuePeriodicEvent(queue,
+        std::chrono::milliseconds(5), [&]()
+        {
+            timerThread = std::this_thread::get_id();
+            runs++;
+        });
+
+    (void)timers.QueueEventIn(queue, 0, [&]()
+    {
+        runs += 100;
+    });
+
+    // Run the expired events here instead of on the timer thread.
+    for(int i = 0; i < 4; i++)
+    {
+        auto pMessage = queue->Dequeue();
+        ASSERT_EQ(pMessage->GetType(),
+            Message::MessageType::MESSAGE_TYPE_EXECUTE);
+
+        static_cast<Message::Execute*>(pMessage)->Run();
+
+        delete pMessage;
+    }
+
+    EXPECT_EQ(runs, 103);
+    EXPECT_EQ(timerThread, std::this_thread::get_id());
+    EXPECT_TRUE(timers.CancelEvent(handle));
+
+    // Drop anything queued before the event was cancelled.
+    std::list<Message::Message*> messages;
+    queue->DequeueAny(messages);
+
+    for(auto pMessage : messages)
+    {
+        delete pMessage;
+    }
+}
+
+TEST(TimingWheel, Benchmark)
+{
+    // Schedule timers out to ten minutes in milliseconds like the skill,
+    // status effect and zone timers do and then cancel all of them.
+    const uint32_t TIMER_COUNT = 1000000;
+
+    std::mt19937 rng(1234);
+    std::vector<uint64_t> expiries;
+
+    for(uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        expiries.push_back(1 + rng() % 600000);
+    }
+
+    std::vector<uint32_t> order;
+    for(uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        order.push_back(i);
+    }
+
+    std::shuffle(order.begin(), order.end(), rng);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::multiset<SetEvent*, SetEventComp> events;
+    std::vector<SetEvent*> pointers;
+    pointers.reserve(TIMER_COUNT);
+
+    for(uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        SetEvent *pEvent = new SetEvent;
+        pEvent->Expiry = expiries[i];
+        pEvent->Value = i;
+
+        events.insert(pEvent);
+        pointers.push_back(pEvent);
+    }
+
+    size_t setCancelled = 0;
+    for(uint32_t i : order)
+    {
+        // Find the exact event among those with the same expiry.
+        auto range = events.equal_range(pointers[i]);
+        for(auto it = range.first; it != range.second; it++)
+        {
+            if(*it == pointers[i])
+            {
+                events.erase(it);
+                delete pointers[i];
+                setCancelled++;
+                break;
+            }
+        }
+    }
+
+    int64_t setTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+
+    TimingWheel<uint32_t> wheel;
+    std::vector<TimingWheel<uint32_t>::Handle> handles;
+    handles.reserve(TIMER_COUNT);
+
+    for(uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        handles.push_back(wheel.Schedule(expiries[i], i));
+    }
+
+    size_t wheelCancelled = 0;
+    for(uint32_t i : order)
+    {
+        if(wheel.Cancel(handles[i]))
+        {
+            wheelCancelled++;
+        }
+    }
+
+    int64_t wheelTime = std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::high_resolution_clock::now()
+            - start).count();
+
+    EXPECT_EQ(setCancelled, (size_t)TIMER_COUNT);
+    EXPECT_EQ(wheelCancelled, (size_t)TIMER_COUNT);
+    EXPECT_TRUE(events.empty());
+    EXPECT_EQ(wheel.Size(), 0u);
+
+    std::cout << "[ BENCHMARK] " << TIMER_COUNT << " timers scheduled and "
+        "cancelled: multiset " << (setTime / 1000) << " ms, timing wheel "
+        << (wheelTime / 1000) << " ms" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,212 @@
+/**
+ * @file libcomp/tests/WorkerPool.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the connection worker pool.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+// libcomp Includes
+#include <WorkerPool.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/**
+ * Enqueue code to run on a connection queue.
+ * @param queue Connection queue to add the code to
+ * @param f Code to run
+ */
+void Enqueue(const std::shared_ptr<WorkerPool::Queue_t>& queue,
+    std::function<void()> f)
+{
+    queue->Enqueue(new Message::ExecuteImpl<>(std::move(f)));
+}
+
+/**
+ * Wait for a condition to be true.
+ * @param f Condition to check
+ * @return true if the condition was met within a few seconds
+ */
+bool WaitFor(std::function<bool()> f)
+{
+    for(int i = 0; i < 5000 && !f(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return f();
+}
+
+} // namespace
+
+TEST(WorkerPool, ConnectionOrder)
+{
+    const int CONNECTION_COUNT = 8;
+    const int MESSAGE_COUNT = 250;
+
+    auto pool = std::make_shared<WorkerPool>();
+
+    std::vector<std::shared_ptr<PooledWorker>> workers;
+    for(int i = 0; i < 4; i++)
+    {
+        workers.push_back(pool->CreateWorker());
+    }
+
+    for(auto worker : workers)
+    {
+        worker->Start("worker");
+    }
+
+    std::vector<std::shared_ptr<WorkerPool::Queue_t>> queues;
+    std::vector<std::atomic<int>> next(CONNECTION_COUNT);
+    std::vector<std::atomic<int>> running(CONNECTION_COUNT);
+    std::atomic<bool> failed(false);
+
+    for(int c = 0; c < CONNECTION_COUNT; c++)
+    {
+        // Put every connection on the same worker so the others must steal
+        queues.push_back(workers[0]->CreateConnectionQueue());
+        next[(size_t)c] = 0;
+        running[(size_t)c] = 0;
+    }
+
+    EXPECT_EQ(workers[0]->AssignmentCount(), CONNECTION_COUNT);
+    EXPECT_EQ(workers[1]->AssignmentCount(), 0);
+
+    for(int i = 0; i < MESSAGE_COUNT; i++)
+    {
+        for(size_t c = 0; c < (size_t)CONNECTION_COUNT; c++)
+        {
+            Enqueue(queues[c], [&next, &running, &failed, c, i]()
+            {
+                // Messages for one connection never run at the same time
+                // and always run in the order they were added.
+                if(0 != running[c]++ || next[c] != i)
+                {
+                    failed = true;
+                }
+
+                next[c]++;
+                running[c]--;
+            });
+        }
+    }
+
+    EXPECT_TRUE(WaitFor([&next]()
+    {
+        for(auto& n : next)
+        {
+            if(MESSAGE_COUNT != n)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }));
+
+    EXPECT_FALSE(failed);
+
+    queues.clear();
+    EXPECT_EQ(workers[0]->AssignmentCount(), 0);
+
+    for(auto worker : workers)
+    {
+        worker->Shutdown();
+    }
+
+    for(auto worker : workers)
+    {
+        worker->Join();
+    }
+}
+
+TEST(WorkerPool, Steal)
+{
+    auto pool = std::make_shared<WorkerPool>();
+    auto homeWorker = pool->CreateWorker();
+    auto otherWorker = pool->CreateWorker();
+
+    homeWorker->Start("home");
+    otherWorker->Start("other");
+
+    auto busyQueue = homeWorker->CreateConnectionQueue();
+    auto otherQueue = homeWorker->CreateConnectionQueue();
+
+    std::atomic<bool> release(false);
+    std::atomic<bool> otherDone(false);
+
+    // One connection holds a worker until the other connection assigned
+    // to the same worker has been run.
+    Enqueue(busyQueue, [&release]()
+    {
+        WaitFor([&release]() { return release.load(); });
+    });
+
+    Enqueue(otherQueue, [&otherDone]()
+    {
+        otherDone = true;
+    });
+
+    EXPECT_TRUE(WaitFor([&otherDone]() { return otherDone.load(); }));
+
+    release = true;
+
+    EXPECT_TRUE(WaitFor([homeWorker, otherWorker]()
+    {
+        return 0 == homeWorker->GetQueueDepth() &&
+            0 == otherWorker->GetQueueDepth();
+    }));
+
+    homeWorker->Shutdown();
+    otherWorker->Shutdown();
+    homeWorker->Join();
+    otherWorker->Join();
+
+    EXPECT_LT(0u, homeWorker->GetBusyTime() + otherWorker->GetBusyTime());
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
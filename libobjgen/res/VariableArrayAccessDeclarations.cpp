@@ -1,3 +1,4 @@
 @VAR_TYPE@ Get@VAR_CAMELCASE_NAME@(size_t index);
 bool Set@VAR_CAMELCASE_NAME@(size_t index, @VAR_ARG_TYPE@ val);
-size_t @VAR_CAMELCASE_NAME@Count() const;
\ No newline at end of file
+size_t @VAR_CAMELCASE_NAME@Count() const;
+@VAR_VIEW_TYPE@ @VAR_CAMELCASE_NAME@View() const;
\ No newline at end of file
@@ -1,6 +1,6 @@
 @VAR_TYPE@ @OBJECT_NAME@::Get@VAR_CAMELCASE_NAME@(size_t index)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(@ELEMENT_COUNT@ <= index)
     {
         return @VAR_TYPE@{};
@@ -11,7 +11,7 @@
 
 bool @OBJECT_NAME@::Set@VAR_CAMELCASE_NAME@(size_t index, @VAR_ARG_TYPE@ val)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(@ELEMENT_COUNT@ <= index || !Validate@VAR_CAMELCASE_NAME@Entry(val))
     {
         return false;
@@ -26,4 +26,9 @@ bool @OBJECT_NAME@::Set@VAR_CAMELCASE_NAME@(size_t index, @VAR_ARG_TYPE@ val)
 size_t @OBJECT_NAME@::@VAR_CAMELCASE_NAME@Count() const
 {
     return @VAR_NAME@.size();
+}
+
+@VAR_VIEW_TYPE@ @OBJECT_NAME@::@VAR_CAMELCASE_NAME@View() const
+{
+    return @VAR_VIEW_TYPE@(@FIELD_VIEW_LOCK@@VAR_NAME@);
 }
\ No newline at end of file
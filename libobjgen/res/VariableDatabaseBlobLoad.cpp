@@ -1,10 +1,5 @@
 ([&]()
 {
-    if(mDirtyFields.find(@COLUMN_NAME@) != mDirtyFields.end())
-    {
-        return true;
-    }
-
     std::vector<char> value;
 
     if(!query.GetValue(@COLUMN_NAME@, value))
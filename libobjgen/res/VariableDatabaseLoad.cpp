@@ -1,10 +1,5 @@
 ([&]()
 {
-    if(mDirtyFields.find(@COLUMN_NAME@) != mDirtyFields.end())
-    {
-        return true;
-    }
-
     @DATABASE_TYPE@ value;
 
     if(!query.GetValue(@COLUMN_NAME@, value))
@@ -1,10 +1,5 @@
 ([&]()
 {
-    if(mDirtyFields.find(@COLUMN_NAME@) != mDirtyFields.end())
-    {
-        return true;
-    }
-
     libobjgen::UUID value;
 
     if(!query.GetValue(@COLUMN_NAME@, value))
@@ -6,4 +6,5 @@ bool Remove@VAR_CAMELCASE_NAME@(size_t index);
 void Clear@VAR_CAMELCASE_NAME@();
 size_t @VAR_CAMELCASE_NAME@Count() const;
 std::list<@VAR_TYPE@>::const_iterator @VAR_CAMELCASE_NAME@Begin() const;
-std::list<@VAR_TYPE@>::const_iterator @VAR_CAMELCASE_NAME@End() const;
\ No newline at end of file
+std::list<@VAR_TYPE@>::const_iterator @VAR_CAMELCASE_NAME@End() const;
+@VAR_VIEW_TYPE@ @VAR_CAMELCASE_NAME@View() const;
\ No newline at end of file
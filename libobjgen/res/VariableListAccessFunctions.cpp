@@ -1,6 +1,6 @@
 @VAR_TYPE@ @OBJECT_NAME@::Get@VAR_CAMELCASE_NAME@(size_t index)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(@VAR_NAME@.size() <= index)
     {
         return @VAR_TYPE@{};
@@ -13,7 +13,7 @@
 
 bool @OBJECT_NAME@::Append@VAR_CAMELCASE_NAME@(@VAR_ARG_TYPE@ val)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(!Validate@VAR_CAMELCASE_NAME@Entry(val))
     {
         return false;
@@ -26,7 +26,7 @@ bool @OBJECT_NAME@::Append@VAR_CAMELCASE_NAME@(@VAR_ARG_TYPE@ val)
 
 bool @OBJECT_NAME@::Prepend@VAR_CAMELCASE_NAME@(@VAR_ARG_TYPE@ val)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(!Validate@VAR_CAMELCASE_NAME@Entry(val))
     {
         return false;
@@ -39,7 +39,7 @@ bool @OBJECT_NAME@::Prepend@VAR_CAMELCASE_NAME@(@VAR_ARG_TYPE@ val)
 
 bool @OBJECT_NAME@::Insert@VAR_CAMELCASE_NAME@(size_t index, @VAR_ARG_TYPE@ val)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(@VAR_NAME@.size() <= index || !Validate@VAR_CAMELCASE_NAME@Entry(val))
     {
         return false;
@@ -55,7 +55,7 @@ bool @OBJECT_NAME@::Insert@VAR_CAMELCASE_NAME@(size_t index, @VAR_ARG_TYPE@ val)
 
 bool @OBJECT_NAME@::Remove@VAR_CAMELCASE_NAME@(size_t index)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(@VAR_NAME@.size() <= index)
     {
         return false;
@@ -71,7 +71,7 @@ bool @OBJECT_NAME@::Remove@VAR_CAMELCASE_NAME@(size_t index)
 
 void @OBJECT_NAME@::Clear@VAR_CAMELCASE_NAME@()
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     @VAR_NAME@.clear();
     @PERSISTENT_CODE@
 }
@@ -89,4 +89,9 @@ std::list<@VAR_TYPE@>::const_iterator @OBJECT_NAME@::@VAR_CAMELCASE_NAME@Begin()
 std::list<@VAR_TYPE@>::const_iterator @OBJECT_NAME@::@VAR_CAMELCASE_NAME@End() const
 {
     return @VAR_NAME@.end();
+}
+
+@VAR_VIEW_TYPE@ @OBJECT_NAME@::@VAR_CAMELCASE_NAME@View() const
+{
+    return @VAR_VIEW_TYPE@(@FIELD_VIEW_LOCK@@VAR_NAME@);
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
-.Prop<std::list<@VAR_TYPE@> (@OBJECT_NAME@::*)() const>(
+.Prop<@VAR_GETTER_TYPE@ (@OBJECT_NAME@::*)() const>(
     "@VAR_CAMELCASE_NAME@", &@OBJECT_NAME@::Get@VAR_CAMELCASE_NAME@, &@OBJECT_NAME@::Set@VAR_CAMELCASE_NAME@)
-.Overload<std::list<@VAR_TYPE@> (@OBJECT_NAME@::*)() const>(
+.Overload<@VAR_GETTER_TYPE@ (@OBJECT_NAME@::*)() const>(
     "Get@VAR_CAMELCASE_NAME@", &@OBJECT_NAME@::Get@VAR_CAMELCASE_NAME@)
 .Func("Set@VAR_CAMELCASE_NAME@", &@OBJECT_NAME@::Set@VAR_CAMELCASE_NAME@)
 .Overload<@VAR_TYPE@ (@OBJECT_NAME@::*)(size_t)>(
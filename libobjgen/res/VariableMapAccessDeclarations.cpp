@@ -6,4 +6,5 @@ bool Remove@VAR_CAMELCASE_NAME@(@VAR_KEY_ARG_TYPE@ key);
 void Clear@VAR_CAMELCASE_NAME@();
 size_t @VAR_CAMELCASE_NAME@Count() const;
 std::unordered_map<@VAR_KEY_TYPE@, @VAR_VALUE_TYPE@>::const_iterator @VAR_CAMELCASE_NAME@Begin() const;
-std::unordered_map<@VAR_KEY_TYPE@, @VAR_VALUE_TYPE@>::const_iterator @VAR_CAMELCASE_NAME@End() const;
\ No newline at end of file
+std::unordered_map<@VAR_KEY_TYPE@, @VAR_VALUE_TYPE@>::const_iterator @VAR_CAMELCASE_NAME@End() const;
+@VAR_VIEW_TYPE@ @VAR_CAMELCASE_NAME@View() const;
\ No newline at end of file
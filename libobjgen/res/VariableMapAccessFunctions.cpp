@@ -1,6 +1,6 @@
 @VAR_VALUE_TYPE@ @OBJECT_NAME@::Get@VAR_CAMELCASE_NAME@(@VAR_KEY_ARG_TYPE@ key)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     auto iter = @VAR_NAME@.find(key);
     if(iter != @VAR_NAME@.end())
     {
@@ -28,7 +28,7 @@ std::list<@VAR_KEY_TYPE@> @OBJECT_NAME@::Get@VAR_CAMELCASE_NAME@Keys() const
 
 bool @OBJECT_NAME@::Set@VAR_CAMELCASE_NAME@(@VAR_KEY_ARG_TYPE@ key, @VAR_VALUE_ARG_TYPE@ val)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(!Validate@VAR_CAMELCASE_NAME@Entry(key, val))
     {
         return false;
@@ -42,7 +42,7 @@ bool @OBJECT_NAME@::Set@VAR_CAMELCASE_NAME@(@VAR_KEY_ARG_TYPE@ key, @VAR_VALUE_A
 
 bool @OBJECT_NAME@::Remove@VAR_CAMELCASE_NAME@(@VAR_KEY_ARG_TYPE@ key)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     auto iter = @VAR_NAME@.find(key);
     if(iter != @VAR_NAME@.end())
     {
@@ -56,7 +56,7 @@ bool @OBJECT_NAME@::Remove@VAR_CAMELCASE_NAME@(@VAR_KEY_ARG_TYPE@ key)
 
 void @OBJECT_NAME@::Clear@VAR_CAMELCASE_NAME@()
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     @VAR_NAME@.clear();
     @PERSISTENT_CODE@
 }
@@ -74,4 +74,9 @@ std::unordered_map<@VAR_KEY_TYPE@, @VAR_VALUE_TYPE@>::const_iterator @OBJECT_NAM
 std::unordered_map<@VAR_KEY_TYPE@, @VAR_VALUE_TYPE@>::const_iterator @OBJECT_NAME@::@VAR_CAMELCASE_NAME@End() const
 {
     return @VAR_NAME@.end();
+}
+
+@VAR_VIEW_TYPE@ @OBJECT_NAME@::@VAR_CAMELCASE_NAME@View() const
+{
+    return @VAR_VIEW_TYPE@(@FIELD_VIEW_LOCK@@VAR_NAME@);
 }
\ No newline at end of file
@@ -1,20 +1,30 @@
 std::list<libcomp::DatabaseBind*> @OBJECT_NAME@::GetMemberBindValues(bool retrieveAll, bool clearChanges)
 {
+    static_assert(@FIELD_COUNT@ <= libcomp::PersistentObject::MAX_FIELDS,
+        "@OBJECT_NAME@ has too many fields to track changes for");
+
     std::list<libcomp::DatabaseBind*> values;
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
 
     @BINDS@
 
     if(clearChanges)
     {
-        mDirtyFields.clear();
+        mDirtyFields.reset();
     }
     return values;
 }
 
+bool @OBJECT_NAME@::IsDirty() const
+{
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
+
+    return mDirtyFields.any();
+}
+
 bool @OBJECT_NAME@::LoadDatabaseValues(libcomp::DatabaseQuery& query)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
 
     @GET_DATABASE_VALUES@
 
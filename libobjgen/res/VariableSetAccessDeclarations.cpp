@@ -5,4 +5,5 @@ void Clear@VAR_CAMELCASE_NAME@();
 size_t @VAR_CAMELCASE_NAME@Count() const;
 std::set<@VAR_TYPE@>::const_iterator @VAR_CAMELCASE_NAME@Begin() const;
 std::set<@VAR_TYPE@>::const_iterator @VAR_CAMELCASE_NAME@End() const;
-std::list<@VAR_TYPE@> Get@VAR_CAMELCASE_NAME@List() const;
\ No newline at end of file
+std::list<@VAR_TYPE@> Get@VAR_CAMELCASE_NAME@List() const;
+@VAR_VIEW_TYPE@ @VAR_CAMELCASE_NAME@View() const;
\ No newline at end of file
@@ -1,12 +1,12 @@
 bool @OBJECT_NAME@::@VAR_CAMELCASE_NAME@Contains(@VAR_ARG_TYPE@ val)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     return @VAR_NAME@.find(val) != @VAR_NAME@.end();
 }
 
 bool @OBJECT_NAME@::Insert@VAR_CAMELCASE_NAME@(@VAR_ARG_TYPE@ val)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     if(!Validate@VAR_CAMELCASE_NAME@Entry(val))
     {
         return false;
@@ -20,7 +20,7 @@ bool @OBJECT_NAME@::Insert@VAR_CAMELCASE_NAME@(@VAR_ARG_TYPE@ val)
 
 bool @OBJECT_NAME@::Remove@VAR_CAMELCASE_NAME@(@VAR_ARG_TYPE@ val)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
 
     @VAR_NAME@.erase(val);
     @PERSISTENT_CODE@
@@ -30,7 +30,7 @@ bool @OBJECT_NAME@::Remove@VAR_CAMELCASE_NAME@(@VAR_ARG_TYPE@ val)
 
 void @OBJECT_NAME@::Clear@VAR_CAMELCASE_NAME@()
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    @FIELD_LOCK@
     @VAR_NAME@.clear();
     @PERSISTENT_CODE@
 }
@@ -59,4 +59,9 @@ std::list<@VAR_TYPE@> @OBJECT_NAME@::Get@VAR_CAMELCASE_NAME@List() const
     }
 
     return results;
+}
+
+@VAR_VIEW_TYPE@ @OBJECT_NAME@::@VAR_CAMELCASE_NAME@View() const
+{
+    return @VAR_VIEW_TYPE@(@FIELD_VIEW_LOCK@@VAR_NAME@);
 }
\ No newline at end of file
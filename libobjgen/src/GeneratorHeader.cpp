@@ -146,12 +146,25 @@ std::string GeneratorHeader::GenerateClass(const MetaObject& obj)
         << "> InheritedConstruction(const libcomp::String& name);" << std::endl;
     ss << std::endl;
 
+    // The first object in the chain declares the field lock. Immutable
+    // objects are never changed once loaded so they go without one.
+    bool fieldLock = obj.GetBaseObject().empty() && !obj.IsImmutable();
+
     std::string utilDeclarations = utilStream.str();
-    if(utilDeclarations.length() > 0)
+    if(utilDeclarations.length() > 0 || fieldLock)
     {
         ss << "protected:" << utilDeclarations << std::endl;
     }
 
+    if(fieldLock)
+    {
+        ss << Tab() << "/// Mutex to lock accessing the object fields"
+            << std::endl;
+        ss << Tab() << "mutable libcomp::ObjectFieldLock mFieldLock;"
+            << std::endl;
+        ss << std::endl;
+    }
+
     ss << "private:" << std::endl;
 
     for(auto it = obj.VariablesBegin(); it != obj.VariablesEnd(); ++it)
@@ -679,13 +679,14 @@ bool GeneratorSource::GeneratePersistentObjectFunctions(const MetaObject& obj,
     std::stringstream& ss)
 {
     std::stringstream binds;
+    size_t fieldIndex = 0;
     for(auto it = obj.VariablesBegin(); it != obj.VariablesEnd(); ++it)
     {
         auto var = *it;
 
         //Only return fields to save if the record is new or the field was updated
-        binds << Tab() << "if(retrieveAll || mDirtyFields.find(\"" << var->GetName() <<
-            "\") != mDirtyFields.end())" << std::endl;
+        binds << Tab() << "if(retrieveAll || mDirtyFields.test(" <<
+            fieldIndex++ << "))" << std::endl;
         binds << Tab() << "{" << std::endl;
         binds << Tab(1) << "values.push_back((" << var->GetBindValueCode(
             *this, GetMemberName(var)) << ")());" << std::endl;
@@ -694,12 +695,15 @@ bool GeneratorSource::GeneratePersistentObjectFunctions(const MetaObject& obj,
     }
 
     std::stringstream dbValues;
+    fieldIndex = 0;
     for(auto it = obj.VariablesBegin(); it != obj.VariablesEnd(); ++it)
     {
         auto var = *it;
 
-        dbValues << Tab() << "if(!" << var->GetDatabaseLoadCode(
-            *this, GetMemberName(var)) << ")" << std::endl;
+        //Do not overwrite fields that were updated but not saved yet
+        dbValues << Tab() << "if(!mDirtyFields.test(" << fieldIndex++ <<
+            ") && !" << var->GetDatabaseLoadCode(*this, GetMemberName(var))
+            << ")" << std::endl;
         dbValues << Tab() << "{" << std::endl;
         dbValues << Tab(2) << "return false;" << std::endl;
         dbValues << Tab() << "}" << std::endl;
@@ -708,6 +712,7 @@ bool GeneratorSource::GeneratePersistentObjectFunctions(const MetaObject& obj,
 
     std::map<std::string, std::string> replacements;
     replacements["@OBJECT_NAME@"] = obj.GetName();
+    replacements["@FIELD_COUNT@"] = std::to_string(fieldIndex);
     replacements["@BINDS@"] = binds.str();
     replacements["@GET_DATABASE_VALUES@"] = dbValues.str();
 
@@ -46,7 +46,7 @@ using namespace libobjgen;
 
 MetaObject::MetaObject()
     : mNamespace("objects"), mScriptEnabled(false), mPersistent(false),
-    mInheritedConstruction(false)
+    mInheritedConstruction(false), mImmutable(false)
 {
 }
 
@@ -99,6 +99,16 @@ void MetaObject::SetScriptEnabled(bool scriptEnabled)
     mScriptEnabled = scriptEnabled;
 }
 
+bool MetaObject::IsImmutable() const
+{
+    return mImmutable;
+}
+
+void MetaObject::SetImmutable(bool immutable)
+{
+    mImmutable = immutable;
+}
+
 std::string MetaObject::GetSourceLocation() const
 {
     return mSourceLocation;
@@ -288,7 +298,8 @@ bool MetaObject::IsValid() const
         (mNamespace.empty() || IsValidIdentifier(mNamespace)) &&
         (mVariables.size() > 0 || !mBaseObject.empty()) &&
         (mPersistent || mSourceLocation.empty()) &&
-        (!mPersistent || mBaseObject.empty());
+        (!mPersistent || mBaseObject.empty()) &&
+        (!mPersistent || !mImmutable);
 }
 
 bool MetaObject::Load(std::istream& stream)
@@ -383,6 +394,11 @@ bool MetaObject::Save(tinyxml2::XMLDocument& doc,
         pObjectElement->SetAttribute("scriptenabled", "true");
     }
 
+    if(IsImmutable())
+    {
+        pObjectElement->SetAttribute("immutable", "true");
+    }
+
     root.InsertEndChild(pObjectElement);
 
     for(auto var : mVariables)
@@ -72,6 +72,9 @@ public:
     bool IsScriptEnabled() const;
     void SetScriptEnabled(bool scriptEnabled);
 
+    bool IsImmutable() const;
+    void SetImmutable(bool immutable);
+
     std::string GetSourceLocation() const;
     void SetSourceLocation(const std::string& location);
 
@@ -112,6 +115,7 @@ private:
     bool mScriptEnabled;
     bool mPersistent;
     bool mInheritedConstruction;
+    bool mImmutable;
     std::string mSourceLocation;
 
     VariableList mVariables;
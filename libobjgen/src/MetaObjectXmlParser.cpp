@@ -82,6 +82,7 @@ bool MetaObjectXmlParser::LoadTypeInformation(const tinyxml2::XMLDocument& doc,
         const char *szInheritedConstruction = root.Attribute(
             "inherited-construction");
         const char *szScriptEnabled = root.Attribute("scriptenabled");
+        const char *szImmutable = root.Attribute("immutable");
 
         if(nullptr != szName && mObject->SetName(szName))
         {
@@ -127,6 +128,12 @@ bool MetaObjectXmlParser::LoadTypeInformation(const tinyxml2::XMLDocument& doc,
                 mObject->mScriptEnabled = false;
             }
 
+            if(nullptr != szImmutable)
+            {
+                mObject->mImmutable = Generator::GetXmlAttributeBoolean(
+                    szImmutable);
+            }
+
             std::stringstream ss;
             if(mObject->mPersistent && !mObject->mBaseObject.empty())
             {
@@ -137,6 +144,11 @@ bool MetaObjectXmlParser::LoadTypeInformation(const tinyxml2::XMLDocument& doc,
                 ss << "Non-persistent object has a source location"
                     " set: " + mObject->mName;
             }
+            else if(mObject->mPersistent && mObject->mImmutable)
+            {
+                ss << "Persistent object can not be immutable: "
+                    + mObject->mName;
+            }
 
             mError = ss.str();
         }
@@ -343,9 +355,9 @@ bool MetaObjectXmlParser::FinalizeObjectAndReferences(const std::string& object)
         return false;
     }
 
+    auto baseObject = Generator::GetObjectName(mObject->GetBaseObject());
     if(mObject->IsScriptEnabled())
     {
-        auto baseObject = Generator::GetObjectName(mObject->GetBaseObject());
         if(!baseObject.empty() &&
             !GetKnownObject(baseObject)->IsScriptEnabled())
         {
@@ -360,6 +372,20 @@ bool MetaObjectXmlParser::FinalizeObjectAndReferences(const std::string& object)
         }
     }
 
+    // Only the first object in the chain declares the field lock so the
+    // whole chain must agree on whether it has one
+    if(!baseObject.empty() && GetKnownObject(baseObject)->IsImmutable() !=
+        mObject->IsImmutable())
+    {
+        std::stringstream ss;
+        ss << "Object is derived from an object that does not match"
+            " its immutable setting: " << object;
+
+        mError = ss.str();
+
+        return false;
+    }
+
     // Now that everything in the chain is loaded up and we know there are no
     // circular refs, set the reference field dynamic sizes
     if(!SetReferenceFieldDynamicSizes(refs))
@@ -527,6 +527,60 @@ std::string MetaVariable::GetGetterCode(const Generator& generator,
     return ss.str();
 }
 
+std::string MetaVariable::GetGetterType(const MetaObject& object) const
+{
+    // Immutable objects do not change once they are loaded so containers
+    // can be read in place instead of being copied on every call.
+    if(object.IsImmutable())
+    {
+        switch(GetMetaType())
+        {
+            case MetaVariableType_t::TYPE_ARRAY:
+            case MetaVariableType_t::TYPE_LIST:
+            case MetaVariableType_t::TYPE_MAP:
+            case MetaVariableType_t::TYPE_SET:
+                return GetArgumentType();
+            default:
+                break;
+        }
+    }
+
+    return GetCodeType();
+}
+
+std::string MetaVariable::GetFieldViewType() const
+{
+    return "libcomp::ObjectFieldView<" + GetCodeType() + ">";
+}
+
+std::string MetaVariable::GetFieldLockCode(const MetaObject& object)
+{
+    return object.IsImmutable() ? "" :
+        "std::lock_guard<std::recursive_mutex> lock(mFieldLock);";
+}
+
+std::string MetaVariable::GetDirtyFieldCode(const MetaObject& object) const
+{
+    if(!object.IsPersistent())
+    {
+        return "";
+    }
+
+    // Changes are tracked by the ordinal of the field in the object
+    size_t fieldIndex = 0;
+    for(auto it = object.VariablesBegin(); it != object.VariablesEnd(); ++it)
+    {
+        if((*it)->GetName() == GetName())
+        {
+            return "mDirtyFields.set(" + std::to_string(fieldIndex) + ");";
+        }
+
+        fieldIndex++;
+    }
+
+    return "";
+}
+
 std::string MetaVariable::GetBindValueCode(const Generator& generator,
     const std::string& name, size_t tabLevel) const
 {
@@ -564,11 +618,13 @@ std::string MetaVariable::GetSetterCode(const Generator& generator,
 
     std::stringstream ss;
 
-    ss << generator.Tab(tabLevel) <<
-        "std::lock_guard<std::mutex> lock(mFieldLock);" << std::endl;
+    std::string lockCode = GetFieldLockCode(object);
+    if(!lockCode.empty())
+    {
+        ss << generator.Tab(tabLevel) << lockCode << std::endl;
+    }
 
-    std::string persistentCode = object.IsPersistent() ?
-        ("mDirtyFields.insert(\"" + GetName() + "\");") : "";
+    std::string persistentCode = GetDirtyFieldCode(object);
     if(condition.empty())
     {
         ss << generator.Tab(tabLevel) << name << " = "
@@ -596,7 +652,7 @@ std::string MetaVariable::GetAccessDeclarations(const Generator& generator,
     const MetaObject& object, const std::string& name, size_t tabLevel) const
 {
     std::stringstream ss;
-    ss << generator.Tab(tabLevel) << GetCodeType() << " Get"
+    ss << generator.Tab(tabLevel) << GetGetterType(object) << " Get"
         << generator.GetCapitalName(*this) << "() const;" << std::endl;
     ss << generator.Tab(tabLevel) << "bool Set"
         << generator.GetCapitalName(*this) << "("
@@ -645,7 +701,7 @@ std::string MetaVariable::GetAccessFunctions(const Generator& generator,
 
     auto objName = object.GetName();
 
-    ss << GetCodeType() << " " << objName << "::" << "Get"
+    ss << GetGetterType(object) << " " << objName << "::" << "Get"
         << generator.GetCapitalName(*this) << "() const" << std::endl;
     ss << "{" << std::endl;
     ss << GetGetterCode(generator, name);
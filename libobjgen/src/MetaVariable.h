@@ -147,6 +147,8 @@ public:
     virtual std::string GetDefaultValueCode() const;
     virtual std::string GetGetterCode(const Generator& generator,
         const std::string& name, size_t tabLevel = 1) const;
+    std::string GetGetterType(const MetaObject& object) const;
+    std::string GetFieldViewType() const;
     virtual std::string GetBindValueCode(const Generator& generator,
         const std::string& name, size_t tabLevel = 1) const;
     virtual std::string GetDatabaseLoadCode(const Generator& generator,
@@ -180,6 +182,9 @@ public:
     static std::shared_ptr<MetaVariable> CreateType(
         const std::string& typeName);
 
+    static std::string GetFieldLockCode(const MetaObject& object);
+    std::string GetDirtyFieldCode(const MetaObject& object) const;
+
 protected:
     static std::shared_ptr<MetaVariable> CreateType(
         const MetaVariable::MetaVariableType_t type,
@@ -431,6 +431,7 @@ std::string MetaVariableArray::GetAccessDeclarations(const Generator& generator,
         replacements["@VAR_TYPE@"] = mElementType->GetCodeType();
         replacements["@VAR_ARG_TYPE@"] = mElementType->GetArgumentType();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
+        replacements["@VAR_VIEW_TYPE@"] = GetFieldViewType();
 
         ss << generator.ParseTemplate(tabLevel,
             "VariableArrayAccessDeclarations", replacements) << std::endl;
@@ -454,8 +455,11 @@ std::string MetaVariableArray::GetAccessFunctions(const Generator& generator,
         replacements["@OBJECT_NAME@"] = object.GetName();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
         replacements["@ELEMENT_COUNT@"] = std::to_string(mElementCount);
-        replacements["@PERSISTENT_CODE@"] = object.IsPersistent() ?
-            ("mDirtyFields.insert(\"" + GetName() + "\");") : "";
+        replacements["@PERSISTENT_CODE@"] = GetDirtyFieldCode(object);
+        replacements["@FIELD_LOCK@"] = GetFieldLockCode(object);
+        replacements["@VAR_VIEW_TYPE@"] = GetFieldViewType();
+        replacements["@FIELD_VIEW_LOCK@"] = object.IsImmutable() ? ""
+            : "mFieldLock, ";
 
         ss << std::endl << generator.ParseTemplate(0, "VariableArrayAccessFunctions",
             replacements) << std::endl;
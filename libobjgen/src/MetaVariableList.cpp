@@ -347,6 +347,7 @@ std::string MetaVariableList::GetAccessDeclarations(const Generator& generator,
         replacements["@VAR_TYPE@"] = mElementType->GetCodeType();
         replacements["@VAR_ARG_TYPE@"] = mElementType->GetArgumentType();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
+        replacements["@VAR_VIEW_TYPE@"] = GetFieldViewType();
 
         ss << generator.ParseTemplate(tabLevel,
             "VariableListAccessDeclarations", replacements) << std::endl;
@@ -369,8 +370,11 @@ std::string MetaVariableList::GetAccessFunctions(const Generator& generator,
         replacements["@VAR_ARG_TYPE@"] = mElementType->GetArgumentType();
         replacements["@OBJECT_NAME@"] = object.GetName();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
-        replacements["@PERSISTENT_CODE@"] = object.IsPersistent() ?
-            ("mDirtyFields.insert(\"" + GetName() + "\");") : "";
+        replacements["@PERSISTENT_CODE@"] = GetDirtyFieldCode(object);
+        replacements["@FIELD_LOCK@"] = GetFieldLockCode(object);
+        replacements["@VAR_VIEW_TYPE@"] = GetFieldViewType();
+        replacements["@FIELD_VIEW_LOCK@"] = object.IsImmutable() ? ""
+            : "mFieldLock, ";
 
         ss << std::endl << generator.ParseTemplate(0, "VariableListAccessFunctions",
             replacements) << std::endl;
@@ -439,6 +443,7 @@ std::string MetaVariableList::GetAccessScriptBindings(const Generator& generator
         replacements["@VAR_ARG_TYPE@"] = mElementType->GetArgumentType();
         replacements["@OBJECT_NAME@"] = object.GetName();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
+        replacements["@VAR_GETTER_TYPE@"] = GetGetterType(object);
 
         ss << generator.ParseTemplate(tabLevel,
             "VariableListAccessScriptBindings", replacements) << std::endl;
@@ -378,6 +378,7 @@ std::string MetaVariableMap::GetAccessDeclarations(const Generator& generator,
         replacements["@VAR_VALUE_TYPE@"] = mValueElementType->GetCodeType();
         replacements["@VAR_VALUE_ARG_TYPE@"] = mValueElementType->GetArgumentType();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
+        replacements["@VAR_VIEW_TYPE@"] = GetFieldViewType();
 
         ss << generator.ParseTemplate(tabLevel,
             "VariableMapAccessDeclarations", replacements) << std::endl;
@@ -402,8 +403,11 @@ std::string MetaVariableMap::GetAccessFunctions(const Generator& generator,
         replacements["@VAR_VALUE_ARG_TYPE@"] = mValueElementType->GetArgumentType();
         replacements["@OBJECT_NAME@"] = object.GetName();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
-        replacements["@PERSISTENT_CODE@"] = object.IsPersistent() ?
-            ("mDirtyFields.insert(\"" + GetName() + "\");") : "";
+        replacements["@PERSISTENT_CODE@"] = GetDirtyFieldCode(object);
+        replacements["@FIELD_LOCK@"] = GetFieldLockCode(object);
+        replacements["@VAR_VIEW_TYPE@"] = GetFieldViewType();
+        replacements["@FIELD_VIEW_LOCK@"] = object.IsImmutable() ? ""
+            : "mFieldLock, ";
 
         ss << std::endl << generator.ParseTemplate(0, "VariableMapAccessFunctions",
             replacements) << std::endl;
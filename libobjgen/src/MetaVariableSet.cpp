@@ -347,6 +347,7 @@ std::string MetaVariableSet::GetAccessDeclarations(const Generator& generator,
         replacements["@VAR_TYPE@"] = mElementType->GetCodeType();
         replacements["@VAR_ARG_TYPE@"] = mElementType->GetArgumentType();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
+        replacements["@VAR_VIEW_TYPE@"] = GetFieldViewType();
 
         ss << generator.ParseTemplate(tabLevel,
             "VariableSetAccessDeclarations", replacements) << std::endl;
@@ -369,8 +370,11 @@ std::string MetaVariableSet::GetAccessFunctions(const Generator& generator,
         replacements["@VAR_ARG_TYPE@"] = mElementType->GetArgumentType();
         replacements["@OBJECT_NAME@"] = object.GetName();
         replacements["@VAR_CAMELCASE_NAME@"] = generator.GetCapitalName(*this);
-        replacements["@PERSISTENT_CODE@"] = object.IsPersistent() ?
-            ("mDirtyFields.insert(\"" + GetName() + "\");") : "";
+        replacements["@PERSISTENT_CODE@"] = GetDirtyFieldCode(object);
+        replacements["@FIELD_LOCK@"] = GetFieldLockCode(object);
+        replacements["@VAR_VIEW_TYPE@"] = GetFieldViewType();
+        replacements["@FIELD_VIEW_LOCK@"] = object.IsImmutable() ? ""
+            : "mFieldLock, ";
 
         ss << std::endl << generator.ParseTemplate(0, "VariableSetAccessFunctions",
             replacements) << std::endl;
@@ -177,6 +177,19 @@ bool libobjgen::UUID::IsNull() const
     return 0 == mTimeAndVersion && 0 == mClockSequenceAndNode;
 }
 
+size_t libobjgen::UUID::Hash() const
+{
+    // Both halves are mostly random already so a multiply and fold of each
+    // is enough to spread them over every bit of the result.
+    uint64_t h = mTimeAndVersion ^ (mClockSequenceAndNode *
+        0x9E3779B97F4A7C15ULL);
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ULL;
+    h ^= h >> 32;
+
+    return static_cast<size_t>(h);
+}
+
 bool libobjgen::UUID::operator==(UUID other) const
 {
     return mTimeAndVersion == other.mTimeAndVersion &&
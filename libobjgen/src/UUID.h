@@ -31,6 +31,7 @@
 #include <stdint.h>
 
 // Standard C++ Includes
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,12 @@ public:
 
     bool IsNull() const;
 
+    /**
+     * Hash the UUID without converting it to a string.
+     * @return Hash of the 128-bit value
+     */
+    size_t Hash() const;
+
     bool operator==(UUID other) const;
     bool operator!=(UUID other) const;
 
@@ -63,4 +70,26 @@ private:
 
 } // namespace libcomp
 
+namespace std
+{
+
+/**
+ * Allow UUIDs to key hashed containers directly.
+ */
+template<>
+struct hash<libobjgen::UUID>
+{
+    /**
+     * Hash a UUID.
+     * @param uuid UUID to hash
+     * @return Hash of the UUID
+     */
+    size_t operator()(const libobjgen::UUID& uuid) const
+    {
+        return uuid.Hash();
+    }
+};
+
+} // namespace std
+
 #endif // LIBOBJGEN_SRC_UUID_H
@@ -86,6 +86,15 @@ TEST(MetaObject, Validate)
     obj.SetPersistent(true);
 
     ASSERT_TRUE(obj.IsValid());
+
+    obj.SetImmutable(true);
+
+    ASSERT_FALSE(obj.IsValid())
+        << "Attempting to validate a persistent immutable object.";
+
+    obj.SetImmutable(false);
+
+    ASSERT_TRUE(obj.IsValid());
 }
 
 TEST(MetaObject, StreamCopy)
@@ -362,6 +371,54 @@ TEST(MetaObjectXmlParser, ScriptEnabledCheck)
     ASSERT_TRUE(obj3Ref->IsScriptReference());
 }
 
+TEST(MetaObjectXmlParser, ImmutableCheck)
+{
+    auto xml = 
+        "<objects>"
+            "<object name='Object1' persistent='false' immutable='true'>"
+                "<member name='Field1' type='u8'/>"
+            "</object>"
+            "<object name='Object2' baseobject='Object1' persistent='false'>"
+                "<member name='Field2' type='u8'/>"
+            "</object>"
+            "<object name='Object3' immutable='true'>"
+                "<member name='Field3' type='u8'/>"
+            "</object>"
+        "</objects>";
+
+    MetaObjectXmlParser parser;
+
+    tinyxml2::XMLDocument doc;
+    doc.Parse(xml);
+
+    tinyxml2::XMLElement *pObjectXml = doc.RootElement()->FirstChildElement("object");
+
+    ASSERT_TRUE(parser.LoadTypeInformation(doc, *pObjectXml));
+    pObjectXml = pObjectXml->NextSiblingElement("object");
+    ASSERT_TRUE(parser.LoadTypeInformation(doc, *pObjectXml));
+
+    //Persistent objects can not be immutable
+    pObjectXml = pObjectXml->NextSiblingElement("object");
+    ASSERT_FALSE(parser.LoadTypeInformation(doc, *pObjectXml));
+
+    //The derived object must match the base object
+    ASSERT_TRUE(parser.FinalizeObjectAndReferences("Object1"));
+    ASSERT_FALSE(parser.FinalizeObjectAndReferences("Object2"));
+
+    //Reset and make the derived object immutable too
+    parser = MetaObjectXmlParser();
+
+    pObjectXml = doc.RootElement()->FirstChildElement("object");
+    ASSERT_TRUE(parser.LoadTypeInformation(doc, *pObjectXml));
+    pObjectXml = pObjectXml->NextSiblingElement("object");
+    pObjectXml->SetAttribute("immutable", "true");
+    ASSERT_TRUE(parser.LoadTypeInformation(doc, *pObjectXml));
+
+    ASSERT_TRUE(parser.FinalizeObjectAndReferences("Object2"));
+    ASSERT_TRUE(parser.GetKnownObject("Object1")->IsImmutable());
+    ASSERT_TRUE(parser.GetKnownObject("Object2")->IsImmutable());
+}
+
 TEST(MetaObjectXmlParser, ParseAllObjectAttributes)
 {
     auto xml = 
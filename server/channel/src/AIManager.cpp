@@ -261,6 +261,11 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
     if(updated.size() > 0)
     {
         auto zConnections = zone->GetConnectionList();
+
+        // With area of interest filtering only the clients that can see
+        // the entity are updated
+        bool filtered = zone->GetAOIRadius() > 0.f;
+
         RelativeTimeMap timeMap;
         for(auto entity : updated)
         {
@@ -269,6 +274,19 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
             // Check if the entity's position or rotation has updated
             if(now == entity->GetOriginTicks())
             {
+                std::list<std::shared_ptr<ChannelClientConnection>> interested;
+                if(filtered)
+                {
+                    interested = zone->GetInterestedConnections(
+                        entity->GetEntityID());
+                }
+
+                auto& connections = filtered ? interested : zConnections;
+                if(connections.size() == 0)
+                {
+                    continue;
+                }
+
                 if(entity->IsMoving())
                 {
                     libcomp::Packet p;
@@ -282,7 +300,7 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
 
                     timeMap[p.Size()] = now;
                     timeMap[p.Size() + 4] = entity->GetDestinationTicks();
-                    ChannelClientConnection::SendRelativeTimePacket(zConnections, p,
+                    ChannelClientConnection::SendRelativeTimePacket(connections, p,
                         timeMap, true);
                 }
                 else if(entity->IsRotating())
@@ -294,7 +312,7 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
 
                     timeMap[p.Size()] = now;
                     timeMap[p.Size() + 4] = entity->GetDestinationTicks();
-                    ChannelClientConnection::SendRelativeTimePacket(zConnections, p,
+                    ChannelClientConnection::SendRelativeTimePacket(connections, p,
                         timeMap, true);
                 }
                 else
@@ -308,7 +326,7 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
                     p.WriteFloat(entity->GetDestinationY());
 
                     timeMap[p.Size()] = entity->GetDestinationTicks();
-                    ChannelClientConnection::SendRelativeTimePacket(zConnections, p,
+                    ChannelClientConnection::SendRelativeTimePacket(connections, p,
                         timeMap, true);
                 }
             }
@@ -909,7 +927,7 @@ bool AIManager::UpdateState(const std::shared_ptr<ActiveEntityState>& eState,
 
     // If no target exists and the next target time has passed, search now
     if(canAct && aiState->GetTargetEntityID() <= 0 &&
-        eState->GetOpponentIDs().size() == 0 &&
+        !eState->HasOpponent() &&
         (!aiState->GetNextTargetTime() || aiState->GetNextTargetTime() <= now))
     {
         // If still in the ignore state, fail to target until it expires
@@ -1307,7 +1325,7 @@ bool AIManager::UpdateEnemyState(
     {
         // If we're wandering but have opponents (typically from being hit)
         // try to target one of them and stop here if we do
-        if(eState->GetOpponentIDs().size() > 0 &&
+        if(eState->HasOpponent() &&
             Retarget(eState, now, isNight))
         {
             return false;
@@ -1758,9 +1776,8 @@ std::shared_ptr<ActiveEntityState> AIManager::Retarget(
     float sourceX = eState->GetCurrentX();
     float sourceY = eState->GetCurrentY();
 
-    auto opponentIDs = eState->GetOpponentIDs();
     std::list<std::shared_ptr<ActiveEntityState>> possibleTargets;
-    if(opponentIDs.size() > 0)
+    if(eState->HasOpponent())
     {
         // Currently in combat, only pull from opponents. Use deaggro
         // distance instead of the normal aggro distance since the AI
@@ -1770,7 +1787,7 @@ std::shared_ptr<ActiveEntityState> AIManager::Retarget(
 
         for(auto entity : inRange)
         {
-            if(opponentIDs.find(entity->GetEntityID()) != opponentIDs.end()
+            if(eState->HasOpponent(entity->GetEntityID())
                 && entity->IsAlive() && entity->Ready() &&
                 !entity->GetAIIgnored())
             {
@@ -110,7 +110,7 @@ bool AIState::SetStatus(AIStatus_t status, bool isDefault)
 
     bool statusChanged = false;
     {
-        std::lock_guard<std::mutex> lock(mFieldLock);
+        std::lock_guard<std::recursive_mutex> lock(mFieldLock);
         mStatusChanged = statusChanged = mStatus != status;
 
         mPreviousStatus = mStatus;
@@ -163,7 +163,7 @@ bool AIState::StatusChanged() const
 
 void AIState::ResetStatusChanged()
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
     mStatusChanged = false;
 }
 
@@ -225,7 +225,7 @@ std::shared_ptr<AICommand> AIState::GetCurrentCommand() const
 void AIState::QueueCommand(const std::shared_ptr<AICommand>& command,
     bool interrupt)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
     if(interrupt)
     {
         mCommandQueue.push_front(command);
@@ -245,7 +245,7 @@ void AIState::QueueCommand(const std::shared_ptr<AICommand>& command,
 
 void AIState::ClearCommands()
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
     mCommandQueue.clear();
     mCurrentCommand = nullptr;
 }
@@ -253,7 +253,7 @@ void AIState::ClearCommands()
 std::shared_ptr<AICommand> AIState::PopCommand(
     const std::shared_ptr<AICommand>& specific)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
     if(specific)
     {
         mCommandQueue.remove_if([specific]
@@ -284,7 +284,7 @@ void AIState::ResetSkillsMapped()
 {
     SetSkillsMapped(false);
 
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
     mSkillMap.clear();
 }
 
@@ -295,6 +295,6 @@ AISkillMap_t AIState::GetSkillMap() const
 
 void AIState::SetSkillMap(const AISkillMap_t& skillMap)
 {
-    std::lock_guard<std::mutex> lock(mFieldLock);
+    std::lock_guard<std::recursive_mutex> lock(mFieldLock);
     mSkillMap = skillMap;
 }
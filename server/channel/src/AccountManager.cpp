@@ -44,9 +44,11 @@
 #include <Clan.h>
 #include <ClanMember.h>
 #include <CultureData.h>
+#include <Demon.h>
 #include <DemonBox.h>
 #include <DemonQuest.h>
 #include <DigitalizeState.h>
+#include <EntityStats.h>
 #include <EventCounter.h>
 #include <EventState.h>
 #include <Expertise.h>
@@ -62,6 +64,7 @@
 #include <PvPMatch.h>
 #include <Quest.h>
 #include <ServerZone.h>
+#include <StatusEffect.h>
 
 // channel Includes
 #include "ChannelServer.h"
@@ -70,6 +73,7 @@
 #include "EventManager.h"
 #include "ManagerConnection.h"
 #include "MatchManager.h"
+#include "PerformanceTimer.h"
 #include "TokuseiManager.h"
 #include "ZoneManager.h"
 
@@ -137,7 +141,14 @@ void AccountManager::HandleLoginResponse(const std::shared_ptr<
     libcomp::Packet reply;
     reply.WritePacketCode(ChannelToClientPacketCode_t::PACKET_LOGIN);
 
-    if(InitializeCharacter(character, state))
+    PerformanceTimer perf(server.get());
+    perf.Start();
+
+    bool initialized = InitializeCharacter(character, state);
+
+    perf.Stop("InitializeCharacter");
+
+    if(initialized)
     {
         auto characterManager = server->GetCharacterManager();
         auto definitionManager = server->GetDefinitionManager();
@@ -809,6 +820,135 @@ bool AccountManager::InitializeCharacter(libcomp::ObjectReference<
         return false;
     }
 
+    // Load the rest of the object graph a level at a time with one query
+    // per type instead of one per object. The objects are held here so the
+    // references below find them in the cache.
+    std::list<std::shared_ptr<libcomp::PersistentObject>> prefetched;
+    auto prefetch = [&db, &prefetched](size_t typeHash,
+        const std::list<libobjgen::UUID>& uuids)
+    {
+        prefetched.splice(prefetched.end(), libcomp::PersistentObject::
+            Prefetch(typeHash, db, uuids));
+    };
+
+    std::list<libobjgen::UUID> itemBoxUUIDs;
+    for(auto itemBox : character->GetItemBoxes())
+    {
+        itemBoxUUIDs.push_back(itemBox.GetUUID());
+    }
+
+    for(auto itemBox : worldData->GetItemBoxes())
+    {
+        itemBoxUUIDs.push_back(itemBox.GetUUID());
+    }
+
+    std::list<libobjgen::UUID> demonBoxUUIDs;
+    demonBoxUUIDs.push_back(character->GetCOMP().GetUUID());
+    for(auto box : worldData->GetDemonBoxes())
+    {
+        demonBoxUUIDs.push_back(box.GetUUID());
+    }
+
+    std::list<libobjgen::UUID> uuids;
+    for(auto expertise : character->GetExpertises())
+    {
+        uuids.push_back(expertise.GetUUID());
+    }
+
+    prefetch(typeid(objects::Expertise).hash_code(), uuids);
+
+    uuids.clear();
+    for(auto hotbar : character->GetHotbars())
+    {
+        uuids.push_back(hotbar.GetUUID());
+    }
+
+    prefetch(typeid(objects::Hotbar).hash_code(), uuids);
+
+    uuids.clear();
+    for(auto qPair : character->GetQuests())
+    {
+        uuids.push_back(qPair.second.GetUUID());
+    }
+
+    prefetch(typeid(objects::Quest).hash_code(), uuids);
+    prefetch(typeid(objects::ItemBox).hash_code(), itemBoxUUIDs);
+    prefetch(typeid(objects::DemonBox).hash_code(), demonBoxUUIDs);
+
+    // Load the items in every box together to check for orphans
+    std::unordered_map<libobjgen::UUID,
+        std::list<std::shared_ptr<objects::Item>>> itemsByBox;
+    for(auto obj : db->LoadObjectsByUUID(typeid(objects::Item).hash_code(),
+        "ItemBox", itemBoxUUIDs))
+    {
+        auto item = std::dynamic_pointer_cast<objects::Item>(obj);
+        if(item)
+        {
+            itemsByBox[item->GetItemBox()].push_back(item);
+        }
+
+        prefetched.push_back(obj);
+    }
+
+    uuids.clear();
+    for(auto box : demonBoxUUIDs)
+    {
+        auto demonBox = std::dynamic_pointer_cast<objects::DemonBox>(
+            libcomp::PersistentObject::GetObjectByUUID(box));
+        if(demonBox)
+        {
+            for(auto demon : demonBox->GetDemons())
+            {
+                uuids.push_back(demon.GetUUID());
+            }
+        }
+    }
+
+    prefetch(typeid(objects::Demon).hash_code(), uuids);
+
+    std::list<libobjgen::UUID> statsUUIDs;
+    std::list<libobjgen::UUID> skillUUIDs;
+    std::list<libobjgen::UUID> effectUUIDs;
+    std::list<libobjgen::UUID> equipUUIDs;
+    for(auto effect : character->GetStatusEffects())
+    {
+        effectUUIDs.push_back(effect.GetUUID());
+    }
+
+    for(auto equip : character->GetEquippedItems())
+    {
+        equipUUIDs.push_back(equip.GetUUID());
+    }
+
+    for(auto demonUUID : uuids)
+    {
+        auto demon = std::dynamic_pointer_cast<objects::Demon>(
+            libcomp::PersistentObject::GetObjectByUUID(demonUUID));
+        if(!demon) continue;
+
+        statsUUIDs.push_back(demon->GetCoreStats().GetUUID());
+
+        for(auto iSkill : demon->GetInheritedSkills())
+        {
+            skillUUIDs.push_back(iSkill.GetUUID());
+        }
+
+        for(auto effect : demon->GetStatusEffects())
+        {
+            effectUUIDs.push_back(effect.GetUUID());
+        }
+
+        for(auto equipment : demon->GetEquippedItems())
+        {
+            equipUUIDs.push_back(equipment.GetUUID());
+        }
+    }
+
+    prefetch(typeid(objects::EntityStats).hash_code(), statsUUIDs);
+    prefetch(typeid(objects::InheritedSkill).hash_code(), skillUUIDs);
+    prefetch(typeid(objects::StatusEffect).hash_code(), effectUUIDs);
+    prefetch(typeid(objects::Item).hash_code(), equipUUIDs);
+
     // Item boxes and items
     std::list<libcomp::ObjectReference<objects::ItemBox>> allBoxes;
     for(auto itemBox : character->GetItemBoxes())
@@ -836,9 +976,7 @@ bool AccountManager::InitializeCharacter(libcomp::ObjectReference<
             return false;
         }
 
-        // Load all items together
-        auto allBoxItems = objects::Item::LoadItemListByItemBox(db,
-            itemBox.GetUUID());
+        auto& allBoxItems = itemsByBox[itemBox.GetUUID()];
 
         // Check to make sure all items in slots in the ItemBox are valid
         std::set<size_t> openSlots;
@@ -32,6 +32,7 @@
 #include <Log.h>
 #include <PacketCodes.h>
 #include <Randomizer.h>
+#include <ScriptEnginePool.h>
 #include <ServerDataManager.h>
 
 // Standard C++11 Includes
@@ -110,6 +111,7 @@
 #include "EventManager.h"
 #include "ManagerConnection.h"
 #include "MatchManager.h"
+#include "PerformanceTimer.h"
 #include "TokuseiManager.h"
 #include "ZoneManager.h"
 
@@ -206,8 +208,11 @@ void ActionManager::PerformActions(
         }
     }
 
-    for(auto action : actions)
+    for(auto actionIter = actions.begin(); actionIter != actions.end();
+        actionIter++)
     {
+        auto action = *actionIter;
+
         if(ctx.ChannelChanged)
         {
             if(action->GetSourceContext() !=
@@ -222,6 +227,28 @@ void ActionManager::PerformActions(
             continue;
         }
 
+        if(action->GetActionType() ==
+            objects::Action::ActionType_t::ZONE_CHANGE ||
+            action->GetActionType() ==
+            objects::Action::ActionType_t::ZONE_INSTANCE)
+        {
+            // Zone changes requested while zone groups are updating in
+            // parallel only happen once every group has finished so run
+            // this action and the rest of the list after that instead of
+            // against the zone the client is about to leave
+            std::list<std::shared_ptr<objects::Action>> remaining(
+                actionIter, actions.end());
+            if(mServer.lock()->GetZoneManager()->QueueZoneTickMerge(
+                [this, ctx, remaining]()
+                {
+                    PerformActions(ctx.Client, remaining, ctx.SourceEntityID,
+                        ctx.CurrentZone, ctx.Options);
+                }))
+            {
+                break;
+            }
+        }
+
         ctx.Action = action;
 
         auto it = mActionHandlers.find(action->GetActionType());
@@ -754,6 +781,7 @@ bool ActionManager::ZoneChange(ActionContext& ctx)
             eState->SetCurrentX(x);
             eState->SetCurrentY(y);
             eState->SetCurrentRotation(rotation);
+            eState->UpdateSpatialIndex();
         }
 
         return true;
@@ -3237,27 +3265,32 @@ bool ActionManager::RunScript(ActionContext& ctx)
     auto script = serverDataManager->GetScript(act->GetScriptID());
     if(script && script->Type.ToLower() == "actioncustom")
     {
-        auto engine = std::make_shared<libcomp::ScriptEngine>();
+        PerformanceTimer perf(server.get());
+        perf.Start();
 
-        // Bind some defaults
-        engine->Using<ChannelServer>();
-        engine->Using<CharacterState>();
-        engine->Using<DemonState>();
-        engine->Using<EnemyState>();
-        engine->Using<Zone>();
-        engine->Using<libcomp::Randomizer>();
+        auto engine = libcomp::ScriptEnginePool::Acquire("actioncustom",
+            [](libcomp::ScriptEngine& e)
+            {
+                // Bind some defaults
+                e.Using<ChannelServer>();
+                e.Using<CharacterState>();
+                e.Using<DemonState>();
+                e.Using<EnemyState>();
+                e.Using<Zone>();
+                e.Using<libcomp::Randomizer>();
 
-        // Bind the results enum
-        {
-            Sqrat::Enumeration e(engine->GetVM());
-            e.Const("SUCCESS", (int32_t)ActionRunScriptResult_t::SUCCESS);
-            e.Const("FAIL", (int32_t)ActionRunScriptResult_t::FAIL);
-            e.Const("LOG_OFF", (int32_t)ActionRunScriptResult_t::LOG_OFF);
+                // Bind the results enum
+                Sqrat::Enumeration rEnum(e.GetVM());
+                rEnum.Const("SUCCESS",
+                    (int32_t)ActionRunScriptResult_t::SUCCESS);
+                rEnum.Const("FAIL", (int32_t)ActionRunScriptResult_t::FAIL);
+                rEnum.Const("LOG_OFF",
+                    (int32_t)ActionRunScriptResult_t::LOG_OFF);
 
-            Sqrat::ConstTable(engine->GetVM()).Enum("Result_t", e);
-        }
+                Sqrat::ConstTable(e.GetVM()).Enum("Result_t", rEnum);
+            });
 
-        if(!engine->Eval(script->Source))
+        if(!libcomp::ScriptEnginePool::EvalScript(engine, *script))
         {
             return false;
         }
@@ -3289,6 +3322,8 @@ bool ActionManager::RunScript(ActionContext& ctx)
                 server,
                 sqParams) : 0;
 
+        perf.Stop(libcomp::String("RunScript %1").Arg(script->Name));
+
         if(scriptResult)
         {
             switch((ActionRunScriptResult_t)*scriptResult)
@@ -3397,6 +3432,21 @@ bool ActionManager::VerifyZone(ActionContext& ctx,
     return true;
 }
 
+void ActionManager::BindTransformScript(libcomp::ScriptEngine& engine)
+{
+    // Bind some defaults
+    engine.Using<CharacterState>();
+    engine.Using<DemonState>();
+    engine.Using<EnemyState>();
+    engine.Using<Zone>();
+    engine.Using<libcomp::Randomizer>();
+
+    // The action is stored in the root table (instead of a local
+    // prepended to the script) so the script can be loaded from the
+    // bytecode compiled the first time it was run
+    engine.Eval("function prepare(a) { ::action <- a; return 0; }");
+}
+
 bool ActionManager::PrepareTransformScript(ActionContext& ctx,
     std::shared_ptr<libcomp::ScriptEngine> engine)
 {
@@ -3406,20 +3456,7 @@ bool ActionManager::PrepareTransformScript(ActionContext& ctx,
         ? serverDataManager->GetScript(act->GetTransformScriptID()) : nullptr;
     if(script && script->Type.ToLower() == "actiontransform")
     {
-        // Bind some defaults
-        engine->Using<CharacterState>();
-        engine->Using<DemonState>();
-        engine->Using<EnemyState>();
-        engine->Using<Zone>();
-        engine->Using<libcomp::Randomizer>();
-
-        auto src = libcomp::String("local action;\n"
-            "function prepare(a) { action = a; return 0; }\n%1")
-            .Arg(script->Source);
-        if(engine->Eval(src))
-        {
-            return true;
-        }
+        return libcomp::ScriptEnginePool::EvalScript(engine, *script);
     }
 
     return false;
@@ -31,6 +31,7 @@
 // libcomp Includes
 #include <EnumMap.h>
 #include <ScriptEngine.h>
+#include <ScriptEnginePool.h>
 
 // object Includes
 #include <Action.h>
@@ -100,7 +101,9 @@ public:
     ~ActionManager();
 
     /**
-     * Perform the list of actions on behalf of the client.
+     * Perform the list of actions on behalf of the client. If a zone change
+     * is reached while zone groups are being updated in parallel, it and
+     * the actions after it are performed once every group has finished.
      * @param client Client to perform the actions for.
      * @param actions List of actions to perform.
      * @param sourceEntityID ID of the entity performing the actions.
@@ -366,8 +369,13 @@ private:
             // Make a copy and transform
             ptr = std::make_shared<T>(*ptr);
 
-            auto engine = std::make_shared<libcomp::ScriptEngine>();
-            engine->Using<T>();
+            auto engine = libcomp::ScriptEnginePool::Acquire(
+                std::string("actiontransform:") + typeid(T).name(),
+                [](libcomp::ScriptEngine& e)
+                {
+                    e.Using<T>();
+                    BindTransformScript(e);
+                });
             if(PrepareTransformScript(ctx, engine))
             {
                 // Store the action for transformation
@@ -410,6 +418,13 @@ private:
      */
     bool VerifyZone(ActionContext& ctx, const libcomp::String& typeName);
 
+    /**
+     * Bind the default types and the action 'prepare' function used by
+     * every transformation script to a new pooled script engine.
+     * @param engine Script engine to bind to
+     */
+    static void BindTransformScript(libcomp::ScriptEngine& engine);
+
     /**
      * Prepare the transformation script from the action on the supplied
      * script engine.
@@ -167,6 +167,8 @@ void ActiveEntityState::Move(float xPos, float yPos, uint64_t now)
         SetDestinationX(xPos);
         SetDestinationY(yPos);
         SetDestinationTicks((uint64_t)(now + addMicro));
+
+        UpdateSpatialIndex();
     }
 }
 
@@ -198,6 +200,8 @@ void ActiveEntityState::Stop(uint64_t now)
     SetOriginY(GetCurrentY());
     SetOriginRotation(GetCurrentRotation());
     SetOriginTicks(now);
+
+    UpdateSpatialIndex();
 }
 
 bool ActiveEntityState::IsAlive() const
@@ -430,6 +434,15 @@ void ActiveEntityState::RefreshCurrentPosition(uint64_t now)
     }
 }
 
+void ActiveEntityState::UpdateSpatialIndex()
+{
+    auto zone = mCurrentZone;
+    if(zone)
+    {
+        zone->UpdateEntityPosition(*this);
+    }
+}
+
 bool ActiveEntityState::UpdatePendingCombatants(int32_t entityID,
     uint64_t executeTime)
 {
@@ -618,6 +631,10 @@ void ActiveEntityState::SetZone(const std::shared_ptr<Zone>& zone, bool updatePr
 
     mCurrentZone = zone;
 
+    // The previous zone's index is cleaned up when the entity is removed
+    // from it, only the new zone needs to be updated
+    UpdateSpatialIndex();
+
     RegisterNextEffectTime();
 }
 
@@ -759,6 +776,15 @@ const std::unordered_map<uint32_t, std::shared_ptr<objects::StatusEffect>>&
     return mStatusEffects;
 }
 
+libcomp::ObjectFieldView<std::unordered_map<uint32_t,
+    std::shared_ptr<objects::StatusEffect>>, std::mutex>
+    ActiveEntityState::StatusEffectsView()
+{
+    return libcomp::ObjectFieldView<std::unordered_map<uint32_t,
+        std::shared_ptr<objects::StatusEffect>>, std::mutex>(mLock,
+        mStatusEffects);
+}
+
 bool ActiveEntityState::StatusEffectActive(uint32_t effectType)
 {
     std::lock_guard<std::mutex> lock(mLock);
@@ -2842,7 +2868,7 @@ void ActiveEntityState::GetAdditionalCorrectTbls(
     // 1) Gather skill adjustments
     for(auto skillID : GetCurrentSkills())
     {
-        auto skillData = definitionManager->GetSkillData(skillID);
+        auto skillData = definitionManager->LookupSkillData(skillID);
         auto common = skillData->GetCommon();
 
         bool include = false;
@@ -2885,9 +2911,9 @@ void ActiveEntityState::GetAdditionalCorrectTbls(
     }
 
     // 3) Gather tokusei effective adjustments
-    for(auto tPair : calcState->GetEffectiveTokusei())
+    for(auto& tPair : calcState->EffectiveTokuseiView())
     {
-        auto tokusei = definitionManager->GetTokuseiData(tPair.first);
+        auto tokusei = definitionManager->LookupTokuseiData(tPair.first);
         if(tokusei && (tokusei->CorrectValuesCount() > 0 ||
             tokusei->TokuseiCorrectValuesCount() > 0))
         {
@@ -3114,9 +3140,10 @@ std::set<uint32_t> ActiveEntityState::GetEffectiveTokuseiSkills(
 {
     std::set<uint32_t> skillIDs;
 
-    for(auto tPair : GetCalculatedState()->GetEffectiveTokusei())
+    auto calcState = GetCalculatedState();
+    for(auto& tPair : calcState->EffectiveTokuseiView())
     {
-        auto tokusei = definitionManager->GetTokuseiData(tPair.first);
+        auto tokusei = definitionManager->LookupTokuseiData(tPair.first);
         if(tokusei)
         {
             for(auto aspect : tokusei->GetAspects())
@@ -403,6 +403,14 @@ public:
      */
     void RefreshCurrentPosition(uint64_t now);
 
+    /**
+     * Update the current zone's spatial index with the entity's origin,
+     * current and destination positions. This is called by Move, Stop and
+     * SetZone but must also be called any time the position values are
+     * set directly or the entity will not be found by area queries.
+     */
+    void UpdateSpatialIndex();
+
     /**
      * Update the entity's current pending combatants, removing any that
      * are no longer valid and adding the supplied values if the time supplied
@@ -546,6 +554,17 @@ public:
     const std::unordered_map<uint32_t,
         std::shared_ptr<objects::StatusEffect>>& GetStatusEffects() const;
 
+    /**
+     * Get a view of the current status effect map that holds the entity
+     * lock until it goes out of scope so the map is not copied. No other
+     * function on the entity that locks it may be called while the view
+     * exists.
+     * @return Locked view of the current status effects by type ID
+     */
+    libcomp::ObjectFieldView<std::unordered_map<uint32_t,
+        std::shared_ptr<objects::StatusEffect>>, std::mutex>
+        StatusEffectsView();
+
     /**
      * Determine if the supplied status effect is active on the entity
      * @param effectType Status effect type to look for
@@ -64,22 +64,40 @@ void ChannelClientConnection::Kill()
 void ChannelClientConnection::BroadcastPacket(const std::list<std::shared_ptr<
     ChannelClientConnection>>& clients, libcomp::Packet& packet, bool queue)
 {
-    if(queue)
+    if(clients.size() == 1)
     {
-        for(auto client : clients)
+        // Nothing to share, send it like normal
+        if(queue)
         {
-            client->QueuePacketCopy(packet);
+            clients.front()->QueuePacketCopy(packet);
+        }
+        else
+        {
+            clients.front()->SendPacket(packet);
         }
     }
-    else
+    else if(clients.size() > 1)
     {
-        std::list<std::shared_ptr<libcomp::TcpConnection>> connections;
-        for(auto client : clients)
+        // Compress the packet once for every client that ends up sending
+        // it by itself. Queued packets leave the original intact.
+        std::shared_ptr<EncodedPacket> encoded;
+        if(queue)
+        {
+            libcomp::Packet pCopy(packet);
+            encoded = EncodePacket(pCopy);
+        }
+        else
         {
-            connections.push_back(client);
+            encoded = EncodePacket(packet);
         }
 
-        libcomp::TcpConnection::BroadcastPacket(connections, packet);
+        for(auto client : clients)
+        {
+            if(client)
+            {
+                client->SendEncodedPacket(encoded, queue);
+            }
+        }
     }
 }
 
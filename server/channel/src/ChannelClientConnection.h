@@ -85,6 +85,8 @@ public:
 
     /**
      * Broadcast the supplied packet to each client connection in the list.
+     * The packet is compressed once and the compressed data is reused by
+     * every connection that sends it without any other packets.
      * @param clients List of client connections to send the packet to
      * @param packet Packet to send to the supplied clients
      * @param queue Optional parameter to queue packets for the supplied connections
@@ -31,8 +31,10 @@
 #include <Log.h>
 #include <ManagerSystem.h>
 #include <MessageTick.h>
+#include <PacketBufferPool.h>
 #include <PacketCodes.h>
 #include <ScriptEngine.h>
+#include <ScriptEnginePool.h>
 #include <ServerDataManager.h>
 
 // object Includes
@@ -97,7 +99,8 @@ namespace libcomp
 ChannelServer::ChannelServer(const char *szProgram,
     std::shared_ptr<objects::ServerConfig> config,
     std::shared_ptr<libcomp::ServerCommandLineParser> commandLine) :
-    libcomp::BaseServer(szProgram, config, commandLine), mAccountManager(0),
+    libcomp::BaseServer(szProgram, config, commandLine),
+    mScheduledWork(GetServerTime() / 1000), mAccountManager(0),
     mActionManager(0), mAIManager(0), mCharacterManager(0), mChatManager(0),
     mEventManager(0), mFusionManager(0), mMatchManager(0), mSkillManager(0),
     mZoneManager(0), mDefinitionManager(0), mServerDataManager(0),
@@ -129,6 +132,7 @@ bool ChannelServer::Initialize()
     auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
 
     mDefinitionManager = new libcomp::DefinitionManager();
+    mDefinitionManager->SetSnapshotPath(conf->GetDefinitionSnapshot());
     if(!mDefinitionManager->LoadAllData(GetDataStore()))
     {
         return false;
@@ -726,6 +730,7 @@ bool ChannelServer::Initialize()
     }
 
     mZoneManager = new ZoneManager(channelPtr);
+    mZoneManager->StartZoneTickWorkers(conf->GetZoneTickThreads());
 
     // Now connect to the world server.
     auto worldConnection = std::make_shared<
@@ -763,6 +768,20 @@ void ChannelServer::Cleanup()
         mTickThread.join();
     }
 
+    if(mZoneManager)
+    {
+        mZoneManager->StopZoneTickWorkers();
+    }
+
+    // Write anything still queued before shutting down
+    for(auto db : { mWorldDatabase, mLobbyDatabase })
+    {
+        if(db)
+        {
+            db->StopWriteBehind();
+        }
+    }
+
     mDefaultCharacterObjectMap.clear();
 }
 
@@ -775,6 +794,15 @@ ChannelServer::~ChannelServer()
         mTickThread.join();
     }
 
+    // Free any scheduled work that never ran
+    std::list<libcomp::Message::Execute*> scheduled;
+    mScheduledWork.Clear(scheduled);
+
+    for(auto msg : scheduled)
+    {
+        delete msg;
+    }
+
     delete mAccountManager;
     delete mActionManager;
     delete mAIManager;
@@ -944,7 +972,19 @@ std::shared_ptr<libcomp::Database> ChannelServer::GetWorldDatabase() const
 
 void ChannelServer::SetWorldDatabase(const std::shared_ptr<libcomp::Database>& database)
 {
+    if(mWorldDatabase)
+    {
+        mWorldDatabase->StopWriteBehind();
+    }
+
     mWorldDatabase = database;
+
+    if(mWorldDatabase)
+    {
+        // Write queued changes on a separate thread so the tick is not
+        // held up by the database
+        mWorldDatabase->StartWriteBehind();
+    }
 }
 
 std::shared_ptr<libcomp::Database> ChannelServer::GetLobbyDatabase() const
@@ -954,7 +994,19 @@ std::shared_ptr<libcomp::Database> ChannelServer::GetLobbyDatabase() const
 
 void ChannelServer::SetLobbyDatabase(const std::shared_ptr<libcomp::Database>& database)
 {
+    if(mLobbyDatabase)
+    {
+        mLobbyDatabase->StopWriteBehind();
+    }
+
     mLobbyDatabase = database;
+
+    if(mLobbyDatabase)
+    {
+        // Write queued changes on a separate thread so the tick is not
+        // held up by the database
+        mLobbyDatabase->StartWriteBehind();
+    }
 }
 
 bool ChannelServer::RegisterServer(uint8_t channelID)
@@ -1120,7 +1172,8 @@ void ChannelServer::Tick()
     mZoneManager->UpdateActiveZoneStates();
     perf.Stop("UpdateActiveZoneStates");
 
-    // Process queued world database changes
+    // Process queued world database changes (written by the write-behind
+    // thread, this only collects failures from earlier flushes)
     perf.Start();
     auto worldFailures = mWorldDatabase->ProcessTransactionQueue();
     perf.Stop("WorldDatabaseTransactions");
@@ -1157,45 +1210,79 @@ void ChannelServer::Tick()
     }
 
     perf.Start();
-    std::map<ServerTime, std::list<libcomp::Message::Execute*>> schedule;
+    std::list<libcomp::Message::Message*> schedule;
     {
         std::lock_guard<std::mutex> lock(mLock);
 
         // Retrieve all work scheduled for the current time or before
-        for(auto it = mScheduledWork.begin(); it != mScheduledWork.end(); it++)
-        {
-            if(it->first <= tickTime)
+        mScheduledWork.Advance(tickTime / 1000, [&schedule]
+            (libcomp::Message::Execute*& msg, uint64_t& expiry)
             {
-                schedule[it->first] = it->second;
-            }
-            else
-            {
-                break;
-            }
-        }
+                (void)expiry;
 
-        // Clear all scheduled work retrieved from the member map
-        for(auto it = schedule.begin(); it != schedule.end(); it++)
-        {
-            mScheduledWork.erase(it->first);
-        }
+                schedule.push_back(msg);
+
+                return false;
+            });
     }
 
     // Queue any work that has been scheduled
-    if(schedule.size() > 0)
+    mQueueWorker.GetMessageQueue()->Enqueue(schedule);
+    perf.Stop("ScheduleWork");
+
+    tickPerf.Stop("Tick");
+
+    auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
+    if(conf->GetPerfMonitorEnabled())
     {
-        auto queue = mQueueWorker.GetMessageQueue();
-        for(auto it = schedule.begin(); it != schedule.end(); it++)
+        // Report the packet buffers used since the last tick
+        auto stats = libcomp::PacketBufferPool::ResetStats();
+
+        LOG_DEBUG(libcomp::String("PERF: PacketBuffers %1 acquired, %2"
+            " allocated (%3 bytes), %4 bytes saved\n").Arg(stats.Acquired)
+            .Arg(stats.Allocated).Arg(stats.AllocatedBytes)
+            .Arg(stats.SavedBytes));
+
+        // Report the queued database writes
+        for(auto dbPair : { std::make_pair("World", mWorldDatabase),
+            std::make_pair("Lobby", mLobbyDatabase) })
         {
-            for(auto it2 = it->second.begin(); it2 != it->second.end(); it2++)
-            {
-                queue->Enqueue(*it2);
-            }
+            auto dbStats = dbPair.second->ResetTransactionQueueStats();
+            LOG_DEBUG(libcomp::String("PERF: %1DatabaseQueue %2 objects"
+                " queued, %3 flushes (%4 us total, %5 us max), %6 writes"
+                " coalesced\n").Arg(dbPair.first).Arg(dbStats.QueueDepth)
+                .Arg(dbStats.FlushCount).Arg(dbStats.FlushTime)
+                .Arg(dbStats.MaxFlushTime).Arg(dbStats.Coalesced));
         }
-    }
-    perf.Stop("ScheduleWork");
 
-    tickPerf.Stop("Tick");
+        // Report the persistent object cache lookups
+        auto cacheStats = libcomp::PersistentObject::ResetCacheStats();
+        if(cacheStats.Lookups)
+        {
+            LOG_DEBUG(libcomp::String("PERF: ObjectCache %1 lookups (%2/s,"
+                " %3% hits), %4 contended, %5 cached, %6 swept\n")
+                .Arg(cacheStats.Lookups).Arg(cacheStats.LookupsPerSecond)
+                .Arg(100 * cacheStats.Hits / cacheStats.Lookups)
+                .Arg(cacheStats.Contended).Arg(cacheStats.Cached)
+                .Arg(cacheStats.Swept));
+        }
+
+        // Report how often scripts skipped creating a VM or compiling
+        auto scriptStats = libcomp::ScriptEnginePool::ResetStats();
+        uint64_t evalCount = scriptStats.BytecodeHits +
+            scriptStats.SourceCompiles;
+        if(scriptStats.Acquired || evalCount)
+        {
+            LOG_DEBUG(libcomp::String("PERF: Scripts %1 engines acquired"
+                " (%2% reused), %3 evaluated (%4% from bytecode)\n")
+                .Arg(scriptStats.Acquired)
+                .Arg(scriptStats.Acquired ? (100 * (scriptStats.Acquired -
+                    scriptStats.Created) / scriptStats.Acquired) : 0)
+                .Arg(evalCount)
+                .Arg(evalCount ? (100 * scriptStats.BytecodeHits / evalCount)
+                    : 0));
+        }
+    }
 }
 
 void ChannelServer::StartGameTick()
@@ -1321,16 +1408,20 @@ void ChannelServer::ScheduleRecurringActions()
     auto clock = GetWorldClockTime();
     mTokuseiManager->RecalcTimedTokusei(clock);
 
-    // Schedule the world clock to tick once every second
+    // Schedule the world clock to tick once every second. The timer only
+    // queues the work so it runs on the async queue worker alongside the
+    // tick and any database work queued there instead of on the timer
+    // thread.
     auto sch = std::chrono::milliseconds(1000);
-    mTimerManager.SchedulePeriodicEvent(sch, []
+    mTimerManager.QueuePeriodicEvent(mQueueWorker.GetMessageQueue(), sch, []
         (ChannelServer* pServer)
         {
             pServer->HandleClockEvents();
         }, this);
 
     // Schedule the demon quest reset for next midnight
-    mTimerManager.ScheduleEventIn((int)GetTimeUntilMidnight(), []
+    mTimerManager.QueueEventIn(mQueueWorker.GetMessageQueue(),
+        (int)GetTimeUntilMidnight(), []
         (ChannelServer* pServer)
         {
             pServer->HandleDemonQuestReset();
@@ -1439,7 +1530,8 @@ void ChannelServer::HandleDemonQuestReset()
 
     // Reset timer to run again (24 hours from now if still midnight)
     uint32_t next = GetTimeUntilMidnight();
-    mTimerManager.ScheduleEventIn((int)(next ? next : 86400), []
+    mTimerManager.QueueEventIn(mQueueWorker.GetMessageQueue(),
+        (int)(next ? next : 86400), []
         (ChannelServer* pServer)
         {
             pServer->HandleDemonQuestReset();
@@ -31,6 +31,7 @@
 #include <InternalConnection.h>
 #include <BaseServer.h>
 #include <ManagerConnection.h>
+#include <TimingWheel.h>
 #include <Worker.h>
 
 // object Includes
@@ -421,8 +422,11 @@ public:
         auto msg = new libcomp::Message::ExecuteImpl<Args...>(
             std::forward<Function>(f), std::forward<Args>(args)...);
 
+        // Round up to the next millisecond so the work is never queued
+        // before the timestamp. Work that lands on the same millisecond
+        // is queued by timestamp and then in the order it was scheduled.
         std::lock_guard<std::mutex> lock(mLock);
-        mScheduledWork[timestamp].push_back(msg);
+        mScheduledWork.Schedule((timestamp + 999) / 1000, msg, timestamp);
 
         return true;
     }
@@ -467,10 +471,9 @@ protected:
      */
     void RecalcNextWorldEventTime();
 
-    /// Timestamp ordered map of prepared Execute messages and timestamps
-    /// associated to when they should be queued following a server tick
-    std::map<ServerTime,
-        std::list<libcomp::Message::Execute*>> mScheduledWork;
+    /// Timing wheel of prepared Execute messages to queue following the
+    /// server tick at or after their timestamp (in milliseconds)
+    libcomp::TimingWheel<libcomp::Message::Execute*> mScheduledWork;
 
     /// Map of world clock times to the type of event that will
     /// occur at that time. Types include:
@@ -109,6 +109,7 @@ bool ChannelSyncManager::Initialize()
     mRegisteredTypes["SearchEntry"] = cfg;
 
     cfg = std::make_shared<ObjectConfig>("Account", false, lobbyDB);
+    cfg->DeltaSync = true;
 
     mRegisteredTypes["Account"] = cfg;
 
@@ -120,6 +121,7 @@ bool ChannelSyncManager::Initialize()
     mRegisteredTypes["CharacterLogin"] = cfg;
 
     cfg = std::make_shared<ObjectConfig>("CharacterProgress", false, worldDB);
+    cfg->DeltaSync = true;
 
     mRegisteredTypes["CharacterProgress"] = cfg;
 
@@ -1517,6 +1517,7 @@ void CharacterManager::SummonDemon(const std::shared_ptr<
     dState->SetStatusEffectsActive(true, definitionManager);
     dState->SetDestinationX(cState->GetDestinationX());
     dState->SetDestinationY(cState->GetDestinationY());
+    dState->UpdateSpatialIndex();
 
     if(dState->GetMaxHP() > maxHP)
     {
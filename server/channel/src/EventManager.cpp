@@ -875,13 +875,10 @@ bool EventManager::EvaluateEventCondition(EventContext& ctx, const std::shared_p
             auto script = serverDataManager->GetScript(scriptCondition->GetScriptID());
             if(script && script->Type.ToLower() == "eventcondition")
             {
-                auto engine = std::make_shared<libcomp::ScriptEngine>();
-                engine->Using<CharacterState>();
-                engine->Using<DemonState>();
-                engine->Using<Zone>();
-                engine->Using<libcomp::Randomizer>();
+                auto engine = libcomp::ScriptEnginePool::Acquire(
+                    "eventcondition", &EventManager::BindConditionScript);
 
-                if(engine->Eval(script->Source))
+                if(libcomp::ScriptEnginePool::EvalScript(engine, *script))
                 {
                     Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "check");
 
@@ -3950,13 +3947,10 @@ void EventManager::HandleNext(EventContext& ctx)
             auto script = serverDataManager->GetScript(branchScriptID);
             if(script && script->Type.ToLower() == "eventbranchlogic")
             {
-                auto engine = std::make_shared<libcomp::ScriptEngine>();
-                engine->Using<CharacterState>();
-                engine->Using<DemonState>();
-                engine->Using<Zone>();
-                engine->Using<libcomp::Randomizer>();
+                auto engine = libcomp::ScriptEnginePool::Acquire(
+                    "eventcondition", &EventManager::BindConditionScript);
 
-                if(engine->Eval(script->Source))
+                if(libcomp::ScriptEnginePool::EvalScript(engine, *script))
                 {
                     Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "check");
 
@@ -4576,6 +4570,29 @@ bool EventManager::HandleWebGame(const std::shared_ptr<
     return true;
 }
 
+void EventManager::BindConditionScript(libcomp::ScriptEngine& engine)
+{
+    engine.Using<CharacterState>();
+    engine.Using<DemonState>();
+    engine.Using<Zone>();
+    engine.Using<libcomp::Randomizer>();
+}
+
+void EventManager::BindTransformScript(libcomp::ScriptEngine& engine)
+{
+    // Bind some defaults
+    engine.Using<CharacterState>();
+    engine.Using<DemonState>();
+    engine.Using<EnemyState>();
+    engine.Using<Zone>();
+    engine.Using<libcomp::Randomizer>();
+
+    // The event is stored in the root table (instead of a local
+    // prepended to the script) so the script can be loaded from the
+    // bytecode compiled the first time it was run
+    engine.Eval("function prepare(e) { ::event <- e; return 0; }");
+}
+
 bool EventManager::PrepareTransformScript(EventContext& ctx,
     std::shared_ptr<libcomp::ScriptEngine> engine)
 {
@@ -4585,20 +4602,7 @@ bool EventManager::PrepareTransformScript(EventContext& ctx,
         ? serverDataManager->GetScript(e->GetTransformScriptID()) : nullptr;
     if(script && script->Type.ToLower() == "eventtransform")
     {
-        // Bind some defaults
-        engine->Using<CharacterState>();
-        engine->Using<DemonState>();
-        engine->Using<EnemyState>();
-        engine->Using<Zone>();
-        engine->Using<libcomp::Randomizer>();
-
-        auto src = libcomp::String("local event;\n"
-            "function prepare(e) { event = e; return 0; }\n%1")
-            .Arg(script->Source);
-        if(engine->Eval(src))
-        {
-            return true;
-        }
+        return libcomp::ScriptEnginePool::EvalScript(engine, *script);
     }
 
     return false;
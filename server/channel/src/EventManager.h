@@ -31,6 +31,7 @@
 // libcomp Includes
 #include <EnumMap.h>
 #include <ScriptEngine.h>
+#include <ScriptEnginePool.h>
 
 // object Includes
 #include <DemonQuest.h>
@@ -573,8 +574,13 @@ private:
             // Make a copy and transform
             ptr = std::make_shared<T>(*ptr);
 
-            auto engine = std::make_shared<libcomp::ScriptEngine>();
-            engine->Using<T>();
+            auto engine = libcomp::ScriptEnginePool::Acquire(
+                std::string("eventtransform:") + typeid(T).name(),
+                [](libcomp::ScriptEngine& e)
+                {
+                    e.Using<T>();
+                    BindTransformScript(e);
+                });
             if(PrepareTransformScript(ctx, engine))
             {
                 // Store the event for transformation
@@ -599,6 +605,20 @@ private:
         return VerifyITime(ctx, ptr) ? ptr : nullptr;
     }
 
+    /**
+     * Bind the default types used by condition and branch logic scripts
+     * to a new pooled script engine.
+     * @param engine Script engine to bind to
+     */
+    static void BindConditionScript(libcomp::ScriptEngine& engine);
+
+    /**
+     * Bind the default types and the event 'prepare' function used by
+     * every transformation script to a new pooled script engine.
+     * @param engine Script engine to bind to
+     */
+    static void BindTransformScript(libcomp::ScriptEngine& engine);
+
     /**
      * Prepare the transformation script from the event on the supplied
      * script engine.
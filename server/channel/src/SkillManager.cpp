@@ -2738,10 +2738,24 @@ bool SkillManager::ProcessSkillResult(std::shared_ptr<objects::ActivatedAbility>
                     break;
                 }
 
+                // Only check entities near the bounding box of the polygon,
+                // expanded to always include the source
+                Point rectMin(effectiveSource->GetCurrentX(),
+                    effectiveSource->GetCurrentY());
+                Point rectMax = rectMin;
+                for(auto& corner : rect)
+                {
+                    rectMin.x = std::min(rectMin.x, corner.x);
+                    rectMin.y = std::min(rectMin.y, corner.y);
+                    rectMax.x = std::max(rectMax.x, corner.x);
+                    rectMax.y = std::max(rectMax.y, corner.y);
+                }
+
                 // Gather entities in the polygon as well as ones bisected
                 // by the boundaries on their hitbox
                 uint64_t now = ChannelServer::GetServerTime();
-                for(auto t : zone->GetActiveEntities())
+                for(auto t : zone->GetActiveEntitiesInRect(rectMin.x,
+                    rectMin.y, rectMax.x, rectMax.y, true))
                 {
                     if(t == effectiveSource)
                     {
@@ -3796,6 +3810,7 @@ void SkillManager::ProcessSkillResultFinal(const std::shared_ptr<ProcessingSkill
                         target.EntityState->SetDestinationX(effectiveTarget->GetCurrentX());
                         target.EntityState->SetDestinationY(effectiveTarget->GetCurrentY());
                         target.EntityState->SetDestinationTicks(hitStopTime);
+                        target.EntityState->UpdateSpatialIndex();
                     }
                     break;
                 case 5:
@@ -3808,6 +3823,7 @@ void SkillManager::ProcessSkillResultFinal(const std::shared_ptr<ProcessingSkill
                         target.EntityState->SetDestinationX(source->GetCurrentX());
                         target.EntityState->SetDestinationY(source->GetCurrentY());
                         target.EntityState->SetDestinationTicks(hitStopTime);
+                        target.EntityState->UpdateSpatialIndex();
                     }
                     break;
                 case 0:
@@ -4253,7 +4269,7 @@ std::shared_ptr<ProcessingSkill> SkillManager::GetProcessingSkill(
     {
         auto weapon = cSource ? cSource->GetEntity()->GetEquippedItems((size_t)
             objects::MiItemBasicData::EquipType_t::EQUIP_TYPE_WEAPON).Get() : nullptr;
-        auto weaponDef = weapon ? definitionManager->GetItemData(weapon->GetType()) : nullptr;
+        auto weaponDef = weapon ? definitionManager->LookupItemData(weapon->GetType()) : nullptr;
 
         if(weaponDef)
         {
@@ -4279,7 +4295,7 @@ std::shared_ptr<ProcessingSkill> SkillManager::GetProcessingSkill(
                     // If the bullet has an affinity, use that instead
                     auto bullet = cSource ? cSource->GetEntity()->GetEquippedItems((size_t)
                         objects::MiItemBasicData::EquipType_t::EQUIP_TYPE_BULLETS).Get() : nullptr;
-                    auto bulletDef = bullet ? definitionManager->GetItemData(bullet->GetType()) : nullptr;
+                    auto bulletDef = bullet ? definitionManager->LookupItemData(bullet->GetType()) : nullptr;
                     if(bulletDef && bulletDef->GetCommon()->GetAffinity() != 0)
                     {
                         skill->EffectiveAffinity = bulletDef->GetCommon()->GetAffinity();
@@ -4290,7 +4306,7 @@ std::shared_ptr<ProcessingSkill> SkillManager::GetProcessingSkill(
                 {
                     // Weapon affinity comes from the basic effect (if one is set)
                     uint32_t basicEffect = weapon->GetBasicEffect();
-                    auto bWeaponDef = definitionManager->GetItemData(
+                    auto bWeaponDef = definitionManager->LookupItemData(
                         basicEffect ? basicEffect : weapon->GetType());
                     if(bWeaponDef)
                     {
@@ -4399,18 +4415,21 @@ std::shared_ptr<objects::CalculatedEntityState> SkillManager::GetCalculatedState
         // CAN become active given the correct target (only valid for source)
         std::unordered_map<int32_t, uint16_t> stillPendingSkillTokusei;
 
-        auto effectiveTokusei = calcState->GetEffectiveTokusei();
-        auto pendingSkillTokusei = calcState->GetPendingSkillTokusei();
-        auto aspects = calcState->GetExistingTokuseiAspects();
+        // The effective tokusei and aspects are only copied if a pending
+        // tokusei becomes active
+        std::unordered_map<int32_t, uint16_t> effectiveTokusei;
+        std::set<int8_t> aspects;
 
+        // Evaluating the conditions can lock the other entity so the
+        // pending tokusei are copied out instead of viewed in place
         bool modified = false;
-        for(auto pair : pendingSkillTokusei)
+        for(auto& pair : TokuseiManager::GetTokuseiCounts(calcState, true))
         {
-            auto tokusei = definitionManager->GetTokuseiData(pair.first);
+            auto tokusei = definitionManager->LookupTokuseiData(pair.first);
             if(tokusei)
             {
-                auto sourceConditions = tokusei->GetSkillConditions();
-                auto targetConditions = tokusei->GetSkillTargetConditions();
+                auto& sourceConditions = tokusei->GetSkillConditions();
+                auto& targetConditions = tokusei->GetSkillTargetConditions();
                 if((sourceConditions.size() > 0 && isTarget) ||
                     (targetConditions.size() > 0 && !isTarget))
                 {
@@ -4424,6 +4443,12 @@ std::shared_ptr<objects::CalculatedEntityState> SkillManager::GetCalculatedState
                     conditions, pSkill, otherState);
                 if(eval == 1)
                 {
+                    if(!modified)
+                    {
+                        effectiveTokusei = calcState->GetEffectiveTokusei();
+                        aspects = calcState->GetExistingTokuseiAspects();
+                    }
+
                     effectiveTokusei[tokusei->GetID()] = pair.second;
                     modified = true;
 
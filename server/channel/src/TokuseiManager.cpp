@@ -762,19 +762,23 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::list<st
         auto calcState = eState->GetCalculatedState();
         for(bool skillMode : { false, true })
         {
+            // Only compared in place, nothing else is locked while the
+            // view is held
             auto& selfMap = newMaps[eState->GetEntityID()][skillMode];
-            auto currentTokusei = skillMode ? calcState->GetPendingSkillTokusei()
-                : calcState->GetEffectiveTokusei();
-            if(currentTokusei.size() != selfMap.size())
+            auto currentTokusei = skillMode
+                ? calcState->PendingSkillTokuseiView()
+                : calcState->EffectiveTokuseiView();
+            if(currentTokusei->size() != selfMap.size())
             {
                 updated = true;
             }
             else
             {
-                for(auto pair : selfMap)
+                for(auto& pair : selfMap)
                 {
-                    if(currentTokusei.find(pair.first) == currentTokusei.end() ||
-                        currentTokusei[pair.first] != pair.second)
+                    auto it = currentTokusei->find(pair.first);
+                    if(it == currentTokusei->end() ||
+                        it->second != pair.second)
                     {
                         updated = true;
                         break;
@@ -1533,6 +1537,24 @@ bool TokuseiManager::EvaluateTokuseiCondition(const std::shared_ptr<ActiveEntity
     return Compare(partnerValue, condition, false);
 }
 
+std::vector<std::pair<int32_t, uint16_t>> TokuseiManager::GetTokuseiCounts(
+    const std::shared_ptr<objects::CalculatedEntityState>& calcState,
+    bool skillPending)
+{
+    if(skillPending)
+    {
+        auto view = calcState->PendingSkillTokuseiView();
+        return std::vector<std::pair<int32_t, uint16_t>>(view.begin(),
+            view.end());
+    }
+    else
+    {
+        auto view = calcState->EffectiveTokuseiView();
+        return std::vector<std::pair<int32_t, uint16_t>>(view.begin(),
+            view.end());
+    }
+}
+
 double TokuseiManager::CalculateAttributeValue(ActiveEntityState* eState, int32_t value,
     int32_t base, const std::shared_ptr<objects::TokuseiAttributes>& attributes,
     std::shared_ptr<objects::CalculatedEntityState> calcState)
@@ -1753,10 +1775,9 @@ double TokuseiManager::GetAspectSum(const std::shared_ptr<ActiveEntityState>& eS
         }
 
         auto definitionManager = mServer.lock()->GetDefinitionManager();
-        auto effectiveTokusei = calcState->GetEffectiveTokusei();
-        for(auto pair : effectiveTokusei)
+        for(auto& pair : GetTokuseiCounts(calcState, false))
         {
-            auto tokusei = definitionManager->GetTokuseiData(pair.first);
+            auto tokusei = definitionManager->LookupTokuseiData(pair.first);
 
             double val = 0.0;
             for(auto aspect : tokusei->GetAspects())
@@ -1810,10 +1831,9 @@ std::unordered_map<int32_t, double> TokuseiManager::GetAspectMap(
         }
 
         auto definitionManager = mServer.lock()->GetDefinitionManager();
-        auto effectiveTokusei = calcState->GetEffectiveTokusei();
-        for(auto pair : effectiveTokusei)
+        for(auto& pair : GetTokuseiCounts(calcState, false))
         {
-            auto tokusei = definitionManager->GetTokuseiData(pair.first);
+            auto tokusei = definitionManager->LookupTokuseiData(pair.first);
 
             double mod = 0.0;
             for(auto aspect : tokusei->GetAspects())
@@ -1865,10 +1885,9 @@ std::list<double> TokuseiManager::GetAspectValueList(const std::shared_ptr<
         }
 
         auto definitionManager = mServer.lock()->GetDefinitionManager();
-        auto effectiveTokusei = calcState->GetEffectiveTokusei();
-        for(auto pair : effectiveTokusei)
+        for(auto& pair : GetTokuseiCounts(calcState, false))
         {
-            auto tokusei = definitionManager->GetTokuseiData(pair.first);
+            auto tokusei = definitionManager->LookupTokuseiData(pair.first);
 
             double val = 0.0;
             for(auto aspect : tokusei->GetAspects())
@@ -1917,7 +1936,7 @@ void TokuseiManager::RecalcTimedTokusei(WorldClock& clock)
             bool setActive = true;
             bool isActive = tPair.second;
 
-            auto tokusei = definitionManager->GetTokuseiData(tPair.first);
+            auto tokusei = definitionManager->LookupTokuseiData(tPair.first);
             for(auto condition : tokusei->GetConditions())
             {
                 switch(condition->GetType())
@@ -2082,12 +2101,12 @@ void TokuseiManager::RecalcCostAdjustments(const std::shared_ptr<
         std::list<std::pair<double, double>>>> defMap;
 
     // EffectiveTokusei have no skill conditions
-    for(auto tPair : calcState->GetEffectiveTokusei())
+    for(auto& tPair : GetTokuseiCounts(calcState, false))
     {
         if(mCostAdjustmentTokusei.find(tPair.first) !=
             mCostAdjustmentTokusei.end())
         {
-            auto tokusei = definitionManager->GetTokuseiData(tPair.first);
+            auto tokusei = definitionManager->LookupTokuseiData(tPair.first);
 
             double hpCost = 0.0;
             double mpCost = 0.0;
@@ -2117,12 +2136,12 @@ void TokuseiManager::RecalcCostAdjustments(const std::shared_ptr<
     }
 
     // PendingSkillTokusei have set condition types
-    for(auto tPair : calcState->GetPendingSkillTokusei())
+    for(auto& tPair : GetTokuseiCounts(calcState, true))
     {
         if(mCostAdjustmentTokusei.find(tPair.first) !=
             mCostAdjustmentTokusei.end())
         {
-            auto tokusei = definitionManager->GetTokuseiData(tPair.first);
+            auto tokusei = definitionManager->LookupTokuseiData(tPair.first);
 
             std::map<uint8_t, std::set<uint32_t>> conditions;
             for(auto condition : tokusei->GetSkillConditions())
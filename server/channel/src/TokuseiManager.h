@@ -33,6 +33,9 @@
 #include <TokuseiCondition.h>
 #include <TokuseiSkillCondition.h>
 
+// Standard C++11 Includes
+#include <vector>
+
 // channel Includes
 #include "ActiveEntityState.h"
 
@@ -175,6 +178,19 @@ public:
         const std::shared_ptr<objects::TokuseiAttributes>& attributes,
         std::shared_ptr<objects::CalculatedEntityState> calcState = nullptr);
 
+    /**
+     * Copy the IDs and counts of the effective or pending skill tokusei out
+     * of a calculated state. The field lock is only held while copying so
+     * it is not held while calculating values that can lock other entities.
+     * @param calcState Calculated state to copy the tokusei from
+     * @param skillPending true to copy the pending skill tokusei, false to
+     *  copy the effective tokusei
+     * @return Tokusei IDs paired with the number of times each applies
+     */
+    static std::vector<std::pair<int32_t, uint16_t>> GetTokuseiCounts(
+        const std::shared_ptr<objects::CalculatedEntityState>& calcState,
+        bool skillPending);
+
     /**
      * Calculate the sum of all instances of a specific aspect value on the supplied entity.
      * @param eState Pointer to the tokusei source
@@ -31,6 +31,7 @@
 #include <ScriptEngine.h>
 
 // C++ Standard Includes
+#include <algorithm>
 #include <cmath>
 
 // object Includes
@@ -61,6 +62,19 @@
 
 using namespace channel;
 
+/// Width and height of each spatial index cell. This is roughly half of the
+/// default AI aggro range so most queries touch a 5x5 block of cells.
+const float SPATIAL_CELL_SIZE = 1000.f;
+
+/// Half of the width and height covered by the spatial index when the zone
+/// has no geometry to size it from
+const float SPATIAL_DEFAULT_EXTENT = 20000.f;
+
+/// Multiplier applied to the area of interest radius before an entity a
+/// client can see is removed so entities moving along the edge of the
+/// radius are not repeatedly shown and removed
+const float AOI_LEAVE_SCALE = 1.25f;
+
 namespace libcomp
 {
     template<>
@@ -130,11 +144,14 @@ namespace libcomp
 }
 
 Zone::Zone(uint32_t id, const std::shared_ptr<objects::ServerZone>& definition)
-    : mNextRentalExpiration(0), mNextEncounterID(1)
+    : mMaxHitboxExtend(0.f), mNextRentalExpiration(0), mNextEncounterID(1)
 {
     SetDefinition(definition);
     SetID(id);
 
+    mSpatialIndex.Reset(-SPATIAL_DEFAULT_EXTENT, -SPATIAL_DEFAULT_EXTENT,
+        SPATIAL_DEFAULT_EXTENT, SPATIAL_DEFAULT_EXTENT, SPATIAL_CELL_SIZE);
+
     mHasRespawns = definition->PlasmaSpawnsCount() > 0;
 
     if(!mHasRespawns)
@@ -195,6 +212,16 @@ const std::shared_ptr<ZoneGeometry> Zone::GetGeometry() const
 void Zone::SetGeometry(const std::shared_ptr<ZoneGeometry>& geometry)
 {
     mGeometry = geometry;
+
+    if(geometry && geometry->Shapes.size() > 0)
+    {
+        // Size the spatial index to fit every shape in the geometry
+        auto& bounds = geometry->GetBoundaries();
+
+        std::lock_guard<std::mutex> lock(mSpatialLock);
+        mSpatialIndex.Reset(bounds[0].x, bounds[0].y, bounds[1].x,
+            bounds[1].y, SPATIAL_CELL_SIZE);
+    }
 }
 
 std::shared_ptr<ZoneInstance> Zone::GetInstance() const
@@ -279,6 +306,8 @@ void Zone::RemoveConnection(const std::shared_ptr<ChannelClientConnection>& clie
         }
     }
 
+    ResetAreaOfInterest(worldCID);
+
     std::lock_guard<std::mutex> lock(mLock);
     mConnections.erase(state->GetWorldCID());
 
@@ -658,7 +687,24 @@ const std::list<std::shared_ptr<ActiveEntityState>>
 
     float rSquared = (float)std::pow(radius, 2);
 
-    for(auto active : GetActiveEntities())
+    // Widen the search area to include any entity the hitbox check below
+    // could still pass
+    double searchRadius = radius;
+    if(useHitbox)
+    {
+        float maxExtend;
+        {
+            std::lock_guard<std::mutex> lock(mSpatialLock);
+            maxExtend = mMaxHitboxExtend;
+        }
+
+        searchRadius = std::max(radius, std::sqrt(std::max(radius +
+            std::pow(maxExtend, 2), 0.0)));
+    }
+
+    for(auto active : GetSpatialCandidates((float)(x - searchRadius),
+        (float)(y - searchRadius), (float)(x + searchRadius),
+        (float)(y + searchRadius)))
     {
         active->RefreshCurrentPosition(now);
 
@@ -683,6 +729,277 @@ const std::list<std::shared_ptr<ActiveEntityState>>
     return results;
 }
 
+const std::list<std::shared_ptr<ActiveEntityState>>
+    Zone::GetActiveEntitiesInRect(float minX, float minY, float maxX,
+        float maxY, bool useHitbox)
+{
+    std::list<std::shared_ptr<ActiveEntityState>> results;
+
+    uint64_t now = ChannelServer::GetServerTime();
+
+    float maxExtend = 0.f;
+    if(useHitbox)
+    {
+        std::lock_guard<std::mutex> lock(mSpatialLock);
+        maxExtend = mMaxHitboxExtend;
+    }
+
+    for(auto active : GetSpatialCandidates(minX - maxExtend,
+        minY - maxExtend, maxX + maxExtend, maxY + maxExtend))
+    {
+        active->RefreshCurrentPosition(now);
+
+        float extend = useHitbox
+            ? (float)active->GetHitboxSize() * 10.f : 0.f;
+
+        float eX = active->GetCurrentX();
+        float eY = active->GetCurrentY();
+        if(eX + extend >= minX && eX - extend <= maxX &&
+            eY + extend >= minY && eY - extend <= maxY)
+        {
+            results.push_back(active);
+        }
+    }
+
+    return results;
+}
+
+void Zone::UpdateEntityPosition(const ActiveEntityState& entity)
+{
+    int32_t entityID = entity.GetEntityID();
+    if(entityID <= 0)
+    {
+        return;
+    }
+
+    // Index the full movement path so the entity can be found anywhere
+    // it could be interpolated to before the next update
+    float minX = std::min(entity.GetCurrentX(),
+        std::min(entity.GetOriginX(), entity.GetDestinationX()));
+    float minY = std::min(entity.GetCurrentY(),
+        std::min(entity.GetOriginY(), entity.GetDestinationY()));
+    float maxX = std::max(entity.GetCurrentX(),
+        std::max(entity.GetOriginX(), entity.GetDestinationX()));
+    float maxY = std::max(entity.GetCurrentY(),
+        std::max(entity.GetOriginY(), entity.GetDestinationY()));
+
+    float extend = (float)entity.GetHitboxSize() * 10.f;
+
+    std::lock_guard<std::mutex> lock(mSpatialLock);
+    mSpatialIndex.Update(entityID, minX, minY, maxX, maxY);
+
+    if(extend > mMaxHitboxExtend)
+    {
+        mMaxHitboxExtend = extend;
+    }
+}
+
+void Zone::UpdateAreaOfInterest(
+    std::unordered_map<int32_t, std::list<int32_t>>& entered,
+    std::unordered_map<int32_t, std::list<int32_t>>& left)
+{
+    float radius = GetAOIRadius();
+    if(radius <= 0.f)
+    {
+        return;
+    }
+
+    uint64_t now = ChannelServer::GetServerTime();
+
+    std::unordered_map<int32_t, std::shared_ptr<ActiveEntityState>> entities;
+    for(auto eState : GetEnemiesAndAllies())
+    {
+        entities[eState->GetEntityID()] = eState;
+    }
+
+    // Find the entities in range of each client before locking as the
+    // spatial query needs the other zone locks
+    std::unordered_map<int32_t, std::pair<float, float>> positions;
+    std::unordered_map<int32_t, std::list<int32_t>> inRange;
+    for(auto client : GetConnectionList())
+    {
+        auto state = client->GetClientState();
+        auto cState = state->GetCharacterState();
+        cState->RefreshCurrentPosition(now);
+
+        float x = cState->GetCurrentX();
+        float y = cState->GetCurrentY();
+
+        int32_t worldCID = state->GetWorldCID();
+        positions[worldCID] = std::make_pair(x, y);
+
+        auto& ids = inRange[worldCID];
+        for(auto eState : GetActiveEntitiesInRadius(x, y, (double)radius))
+        {
+            if(entities.find(eState->GetEntityID()) != entities.end())
+            {
+                ids.push_back(eState->GetEntityID());
+            }
+        }
+    }
+
+    float leaveSquared = (float)std::pow(radius * AOI_LEAVE_SCALE, 2);
+
+    std::lock_guard<std::mutex> lock(mAOILock);
+
+    // Forget entities that are no longer in the zone
+    for(auto it = mAOIViewers.begin(); it != mAOIViewers.end();)
+    {
+        if(entities.find(it->first) == entities.end())
+        {
+            for(int32_t worldCID : it->second)
+            {
+                auto vIter = mAOIVisible.find(worldCID);
+                if(vIter != mAOIVisible.end())
+                {
+                    vIter->second.erase(it->first);
+                }
+            }
+
+            it = mAOIViewers.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    // Forget clients that are no longer in the zone
+    for(auto it = mAOIVisible.begin(); it != mAOIVisible.end();)
+    {
+        if(positions.find(it->first) == positions.end())
+        {
+            for(int32_t entityID : it->second)
+            {
+                mAOIViewers[entityID].erase(it->first);
+            }
+
+            it = mAOIVisible.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    // Clients that were just sent the zone can see every entity
+    for(auto& pPair : positions)
+    {
+        if(mAOIVisible.find(pPair.first) == mAOIVisible.end())
+        {
+            auto& visible = mAOIVisible[pPair.first];
+            for(auto& ePair : entities)
+            {
+                visible.insert(ePair.first);
+                mAOIViewers[ePair.first].insert(pPair.first);
+            }
+        }
+    }
+
+    // Entities spawned since the last refresh were shown to every client
+    for(auto& ePair : entities)
+    {
+        if(mAOIViewers.find(ePair.first) == mAOIViewers.end())
+        {
+            auto& viewers = mAOIViewers[ePair.first];
+            for(auto& vPair : mAOIVisible)
+            {
+                vPair.second.insert(ePair.first);
+                viewers.insert(vPair.first);
+            }
+        }
+    }
+
+    for(auto& pPair : positions)
+    {
+        int32_t worldCID = pPair.first;
+        float x = pPair.second.first;
+        float y = pPair.second.second;
+
+        auto& visible = mAOIVisible[worldCID];
+        for(int32_t entityID : inRange[worldCID])
+        {
+            if(visible.insert(entityID).second)
+            {
+                mAOIViewers[entityID].insert(worldCID);
+                entered[worldCID].push_back(entityID);
+            }
+        }
+
+        for(auto it = visible.begin(); it != visible.end();)
+        {
+            auto eState = entities[*it];
+            eState->RefreshCurrentPosition(now);
+
+            if(eState->GetDistance(x, y, true) > leaveSquared)
+            {
+                mAOIViewers[*it].erase(worldCID);
+                left[worldCID].push_back(*it);
+
+                it = visible.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+}
+
+void Zone::ResetAreaOfInterest(int32_t worldCID)
+{
+    std::lock_guard<std::mutex> lock(mAOILock);
+
+    auto it = mAOIVisible.find(worldCID);
+    if(it != mAOIVisible.end())
+    {
+        for(int32_t entityID : it->second)
+        {
+            mAOIViewers[entityID].erase(worldCID);
+        }
+
+        mAOIVisible.erase(it);
+    }
+}
+
+std::list<std::shared_ptr<ChannelClientConnection>>
+    Zone::GetInterestedConnections(int32_t entityID)
+{
+    std::set<int32_t> viewers;
+    bool filtered = false;
+    {
+        std::lock_guard<std::mutex> lock(mAOILock);
+
+        auto it = mAOIViewers.find(entityID);
+        if(it != mAOIViewers.end())
+        {
+            viewers = it->second;
+            filtered = true;
+        }
+    }
+
+    if(!filtered)
+    {
+        // Not an enemy or ally, filtering is disabled or the entity has
+        // spawned since the last refresh
+        return GetConnectionList();
+    }
+
+    std::list<std::shared_ptr<ChannelClientConnection>> connections;
+
+    std::lock_guard<std::mutex> lock(mLock);
+    for(int32_t worldCID : viewers)
+    {
+        auto it = mConnections.find(worldCID);
+        if(it != mConnections.end())
+        {
+            connections.push_back(it->second);
+        }
+    }
+
+    return connections;
+}
+
 std::shared_ptr<AllyState> Zone::GetAlly(int32_t id)
 {
     return std::dynamic_pointer_cast<AllyState>(GetEntity(id));
@@ -984,15 +1301,59 @@ const std::list<std::shared_ptr<ServerObjectState>> Zone::GetServerObjects() con
 
 void Zone::RegisterEntityState(const std::shared_ptr<objects::EntityStateObject>& state)
 {
-    std::lock_guard<std::mutex> lock(mLock);
-    mAllEntities[state->GetEntityID()] = state;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mAllEntities[state->GetEntityID()] = state;
+    }
+
+    auto active = std::dynamic_pointer_cast<ActiveEntityState>(state);
+    if(active)
+    {
+        UpdateEntityPosition(*active);
+    }
 }
 
 void Zone::UnregisterEntityState(int32_t entityID)
 {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mAllEntities.erase(entityID);
+        mPendingDespawnEntities.erase(entityID);
+    }
+
+    std::lock_guard<std::mutex> lock(mSpatialLock);
+    mSpatialIndex.Remove(entityID);
+}
+
+std::list<std::shared_ptr<ActiveEntityState>> Zone::GetSpatialCandidates(
+    float minX, float minY, float maxX, float maxY)
+{
+    std::vector<int32_t> entityIDs;
+    {
+        std::lock_guard<std::mutex> lock(mSpatialLock);
+        mSpatialIndex.Query(minX, minY, maxX, maxY, entityIDs);
+    }
+
+    std::list<std::shared_ptr<ActiveEntityState>> results;
+
     std::lock_guard<std::mutex> lock(mLock);
-    mAllEntities.erase(entityID);
-    mPendingDespawnEntities.erase(entityID);
+    for(int32_t entityID : entityIDs)
+    {
+        // The index can contain entities that have set the zone but have
+        // not been registered yet so skip anything not found
+        auto it = mAllEntities.find(entityID);
+        if(it != mAllEntities.end())
+        {
+            auto active = std::dynamic_pointer_cast<ActiveEntityState>(
+                it->second);
+            if(active)
+            {
+                results.push_back(active);
+            }
+        }
+    }
+
+    return results;
 }
 
 std::shared_ptr<objects::EntityStateObject> Zone::GetEntity(int32_t id)
@@ -1700,6 +2061,12 @@ void Zone::Cleanup()
     mPlasma.clear();
     mActors.clear();
     mAllEntities.clear();
+
+    {
+        std::lock_guard<std::mutex> spatialLock(mSpatialLock);
+        mSpatialIndex.Clear();
+    }
+
     mSpawnGroups.clear();
     mSpawnLocationGroups.clear();
     mStaggeredSpawns.clear();
@@ -36,6 +36,9 @@
 #include "EntityState.h"
 #include "ZoneGeometry.h"
 
+// libcomp Includes
+#include <SpatialGrid.h>
+
 // object Includes
 #include <ServerZoneInstanceVariant.h>
 #include <ZoneObject.h>
@@ -295,6 +298,67 @@ public:
         GetActiveEntitiesInRadius(float x, float y, double radius,
             bool useHitbox = false);
 
+    /**
+     * Get all active entities in the zone within a supplied rectangle
+     * @param minX Minimum X coordinate of the rectangle
+     * @param minY Minimum Y coordinate of the rectangle
+     * @param maxX Maximum X coordinate of the rectangle
+     * @param maxY Maximum Y coordinate of the rectangle
+     * @param useHitbox If true, the entities' hitboxes will be used to
+     *  determine if they are in the rectangle, even if the center point
+     *  is not
+     * @return List of pointers to active entities in the rectangle
+     */
+    const std::list<std::shared_ptr<ActiveEntityState>>
+        GetActiveEntitiesInRect(float minX, float minY, float maxX,
+            float maxY, bool useHitbox = false);
+
+    /**
+     * Update the spatial index used by the radius and rectangle queries
+     * with the entity's current position and movement path. This is
+     * handled by @ref ActiveEntityState::UpdateSpatialIndex and should
+     * not need to be called directly.
+     * @param entity Active entity in the zone to update
+     */
+    void UpdateEntityPosition(const ActiveEntityState& entity);
+
+    /**
+     * Refresh which enemies and allies each client in the zone can see when
+     * area of interest filtering is enabled (AOIRadius is above zero).
+     * Entities that come within the radius of a client's character are
+     * returned as entered and entities the client can see that move past
+     * the radius (plus a margin so entities on the edge do not flicker)
+     * are returned as left. Entities spawned since the last refresh and
+     * clients that were just sent the zone are treated as visible since
+     * spawns and zone population are still sent to the whole zone.
+     * @param entered Output map of world CIDs to the IDs of entities that
+     *  should be shown to the client
+     * @param left Output map of world CIDs to the IDs of entities that
+     *  should be removed from the client
+     */
+    void UpdateAreaOfInterest(
+        std::unordered_map<int32_t, std::list<int32_t>>& entered,
+        std::unordered_map<int32_t, std::list<int32_t>>& left);
+
+    /**
+     * Forget which enemies and allies a client can see so every one is
+     * treated as visible on the next area of interest refresh. This should
+     * be called whenever every entity in the zone is sent to the client.
+     * @param worldCID World CID of the client
+     */
+    void ResetAreaOfInterest(int32_t worldCID);
+
+    /**
+     * Get the client connections that should be sent updates about an
+     * entity. With area of interest filtering enabled this is every client
+     * that can see the entity if it is an enemy or ally, otherwise every
+     * client in the zone.
+     * @param entityID ID of the entity being updated
+     * @return List of client connections interested in the entity
+     */
+    std::list<std::shared_ptr<ChannelClientConnection>>
+        GetInterestedConnections(int32_t entityID);
+
     /**
      * Get an entity instance by it's ID.
      * @param id Instance ID of the entity.
@@ -779,6 +843,19 @@ private:
      */
     void UnregisterEntityState(int32_t entityID);
 
+    /**
+     * Get all active entities registered in the spatial index cells that
+     * overlap the supplied area. Positions are not refreshed and the
+     * entities are not guaranteed to be within the area.
+     * @param minX Minimum X coordinate of the area
+     * @param minY Minimum Y coordinate of the area
+     * @param maxX Maximum X coordinate of the area
+     * @param maxY Maximum Y coordinate of the area
+     * @return List of pointers to active entities that could be in the area
+     */
+    std::list<std::shared_ptr<ActiveEntityState>> GetSpatialCandidates(
+        float minX, float minY, float maxX, float maxY);
+
     /**
      * Register a new spawned entity to the zone stored spots and group field
      * @param state Pointer to the state of the spawned entity
@@ -914,6 +991,22 @@ private:
     /// Geometry information bound to the zone
     std::shared_ptr<ZoneGeometry> mGeometry;
 
+    /// Uniform grid of active entity IDs by position, sized from the
+    /// geometry bounds
+    libcomp::SpatialGrid<int32_t> mSpatialIndex;
+
+    /// Largest hitbox extension of any active entity added to the spatial
+    /// index, used to widen queries that include hitboxes
+    float mMaxHitboxExtend;
+
+    /// Enemy and ally IDs visible to each client by world CID when area of
+    /// interest filtering is enabled
+    std::unordered_map<int32_t, std::set<int32_t>> mAOIVisible;
+
+    /// World CIDs of the clients that can see each enemy and ally by
+    /// entity ID when area of interest filtering is enabled
+    std::unordered_map<int32_t, std::set<int32_t>> mAOIViewers;
+
     /// Dynamic map information bound to the zone
     std::shared_ptr<DynamicMap> mDynamicMap;
 
@@ -935,6 +1028,14 @@ private:
 
     /// Server lock for shared resources
     std::mutex mLock;
+
+    /// Lock for the spatial index, separate from the shared resource lock
+    /// as entities update their position while that lock may be held
+    std::mutex mSpatialLock;
+
+    /// Lock for the area of interest state, separate from the shared
+    /// resource lock as it is checked for each entity update sent
+    std::mutex mAOILock;
 };
 
 } // namespace channel
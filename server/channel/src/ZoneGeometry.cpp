@@ -27,15 +27,50 @@
 
 #include "ZoneGeometry.h"
 
+// libcomp Includes
+#include <Log.h>
+
 // Standard C++11 includes
+#include <algorithm>
 #include <cmath>
+#include <functional>
+#include <limits>
 #include <map>
+#include <queue>
 
 // object includes
+#include <QmpBoundary.h>
+#include <QmpBoundaryLine.h>
 #include <QmpElement.h>
+#include <QmpFile.h>
+#include <QmpNavPoint.h>
 
 using namespace channel;
 
+namespace
+{
+
+/// Largest nav graph that gets a table of the shortest path between every
+/// pair of points. Larger graphs use an A* search instead to keep the table
+/// (which grows with the square of the point count) small.
+const size_t NAV_ROUTE_TABLE_MAX = 256;
+
+/// Nav route table entry for a point that cannot be reached.
+const uint16_t NAV_ROUTE_NONE = 0xFFFF;
+
+/// Nav graph index for a point that has not been reached.
+const uint32_t NAV_INDEX_NONE = 0xFFFFFFFF;
+
+/// Nav graph index and distance pair sorted smallest distance first in a
+/// priority queue.
+typedef std::pair<float, uint32_t> NavQueueEntry_t;
+
+/// Priority queue returning the smallest distance first.
+typedef std::priority_queue<NavQueueEntry_t, std::vector<NavQueueEntry_t>,
+    std::greater<NavQueueEntry_t>> NavQueue_t;
+
+} // namespace
+
 Point::Point() : x(0.f), y(0.f)
 {
 }
@@ -189,40 +224,558 @@ ZoneSpotShape::ZoneSpotShape()
 {
 }
 
+ZoneGeometry::ZoneGeometry() : mGridBuilt(false), mNavHeuristicScale(0.f)
+{
+}
+
 bool ZoneGeometry::Collides(const Line& path, Point& point, Line& surface,
     std::shared_ptr<ZoneShape>& shape, const std::set<
-    uint32_t> disabledBarriers) const
+    uint32_t>& disabledBarriers) const
 {
-    std::map<float, std::pair<std::shared_ptr<ZoneShape>, std::pair<
-        const Line*, Point>>> collisions;
-    for(auto s : Shapes)
+    if(!mGridBuilt)
+    {
+        return CollidesLinear(path, point, surface, shape, disabledBarriers);
+    }
+
+    // Scratch lists are kept per thread so steady state checks do not
+    // allocate
+    thread_local std::vector<uint32_t> candidates;
+    thread_local std::vector<CollisionHit> hits;
+
+    candidates.clear();
+    hits.clear();
+
+    mCollisionGrid.Query(path.first.x, path.first.y, path.second.x,
+        path.second.y, candidates);
+
+    Point p;
+    float dist = 0.f;
+    for(uint32_t lineIdx : candidates)
     {
-        bool disabled = s->Element ? disabledBarriers.find(s->Element->GetID())
-            != disabledBarriers.end() : false;
-        if(!disabled && s->Collides(path, point, surface))
+        const GridLine& gridLine = mGridLines[lineIdx];
+        const ZoneQmpShape& s = *mIndexedShapes[gridLine.ShapeIndex];
+        if(ShapeEnabled(s, disabledBarriers) &&
+            LineBlocks(s, *gridLine.Surface, path, p, dist))
         {
-            float dSquared = (float)(std::pow((path.first.x - point.x), 2)
-                + std::pow((path.first.y - point.y), 2));
-            std::pair<const Line*, Point> p(&surface, point);
-            collisions[dSquared] = std::pair<std::shared_ptr<ZoneShape>,
-                std::pair<const Line*, Point>>(shape, p);
+            CollisionHit hit;
+            hit.Surface = gridLine.Surface;
+            hit.Shape = &mIndexedShapes[gridLine.ShapeIndex];
+            hit.ShapeIndex = gridLine.ShapeIndex;
+            hit.LineIndex = gridLine.LineIndex;
+            hit.Distance = dist;
+            hit.Intersection = p;
+            hits.push_back(hit);
         }
     }
-    
-    // If a collision exists, return true with the closest point, surface
-    // and shape in the output params
-    if(collisions.size() > 0)
+
+    if(hits.size() > 1)
     {
-        auto pair = collisions.begin()->second;
-        point = pair.second.second;
-        surface = *pair.second.first;
-        shape = pair.first;
-        return true;
+        // Restore the original shape and line order so ties resolve the
+        // same way as a full check
+        std::sort(hits.begin(), hits.end(), [](const CollisionHit& a,
+            const CollisionHit& b)
+            {
+                return a.ShapeIndex < b.ShapeIndex ||
+                    (a.ShapeIndex == b.ShapeIndex &&
+                        a.LineIndex < b.LineIndex);
+            });
     }
-    else
+
+    return SelectClosest(hits, path, point, surface, shape);
+}
+
+bool ZoneGeometry::CollidesLinear(const Line& path, Point& point,
+    Line& surface, std::shared_ptr<ZoneShape>& shape, const std::set<
+    uint32_t>& disabledBarriers) const
+{
+    thread_local std::vector<CollisionHit> hits;
+
+    hits.clear();
+
+    Point p;
+    float dist = 0.f;
+    uint32_t shapeIdx = 0;
+    for(auto& s : Shapes)
+    {
+        if(ShapeEnabled(*s, disabledBarriers))
+        {
+            uint32_t lineIdx = 0;
+            for(const Line& line : s->Lines)
+            {
+                if(LineBlocks(*s, line, path, p, dist))
+                {
+                    CollisionHit hit;
+                    hit.Surface = &line;
+                    hit.Shape = &s;
+                    hit.ShapeIndex = shapeIdx;
+                    hit.LineIndex = lineIdx;
+                    hit.Distance = dist;
+                    hit.Intersection = p;
+                    hits.push_back(hit);
+                }
+
+                lineIdx++;
+            }
+        }
+
+        shapeIdx++;
+    }
+
+    return SelectClosest(hits, path, point, surface, shape);
+}
+
+void ZoneGeometry::LoadQmpShapes(
+    const std::shared_ptr<objects::QmpFile>& qmpFile)
+{
+    std::unordered_map<uint32_t,
+        std::shared_ptr<objects::QmpElement>> elementMap;
+    for(auto qmpElem : qmpFile->GetElements())
+    {
+        Elements.push_back(qmpElem);
+        elementMap[qmpElem->GetID()] = qmpElem;
+    }
+
+    std::unordered_map<uint32_t, std::list<Line>> lineMap;
+    for(auto qmpBoundary : qmpFile->GetBoundaries())
+    {
+        for(auto qmpLine : qmpBoundary->GetLines())
+        {
+            Line l(Point((float)qmpLine->GetX1(), (float)qmpLine->GetY1()),
+                Point((float)qmpLine->GetX2(), (float)qmpLine->GetY2()));
+            lineMap[qmpLine->GetElementID()].push_back(l);
+        }
+    }
+
+    uint32_t instanceID = 1;
+    for(auto pair : lineMap)
+    {
+        // Build a complete shape from the lines provided
+        // If there is a gap in the shape, it is a line instead
+        // of a full shape
+        auto lines = pair.second;
+
+        std::shared_ptr<ZoneQmpShape> shape;
+        Line firstLine;
+        Point* connectPoint = 0;
+        while(lines.size() > 0)
+        {
+            if(!shape)
+            {
+                // Lines still exist, start a new shape
+                shape = std::make_shared<ZoneQmpShape>();
+                shape->ShapeID = pair.first;
+                shape->Element = elementMap[pair.first];
+                shape->OneWay = shape->Element->GetType() ==
+                    objects::QmpElement::Type_t::ONE_WAY;
+
+                shape->Lines.push_back(lines.front());
+                lines.pop_front();
+                firstLine = shape->Lines.front();
+                connectPoint = &shape->Lines.back().second;
+            }
+
+            bool connected = false;
+            for(auto it = lines.begin(); it != lines.end(); it++)
+            {
+                if(it->first == *connectPoint)
+                {
+                    shape->Lines.push_back(*it);
+                    connected = true;
+                }
+                else if(it->second == *connectPoint)
+                {
+                    if(shape->OneWay)
+                    {
+                        LOG_DEBUG(libcomp::String("Inverted one way"
+                            " directional line encountered in shape:"
+                            " %1\n").Arg(shape->Element->GetName()));
+                    }
+
+                    shape->Lines.push_back(Line(it->second, it->first));
+                    connected = true;
+                }
+
+                if(connected)
+                {
+                    connectPoint = &shape->Lines.back().second;
+                    lines.erase(it);
+                    break;
+                }
+            }
+
+            if(!connected || lines.size() == 0)
+            {
+                shape->InstanceID = instanceID++;
+
+                if(*connectPoint == firstLine.first)
+                {
+                    // Solid shape completed
+                    shape->IsLine = false;
+                }
+
+                Shapes.push_back(shape);
+
+                // Determine the boundaries of the completed shape
+                std::list<float> xVals;
+                std::list<float> yVals;
+
+                for(Line& line : shape->Lines)
+                {
+                    for(const Point& p : { line.first, line.second })
+                    {
+                        xVals.push_back(p.x);
+                        yVals.push_back(p.y);
+                    }
+                }
+
+                xVals.sort([](const float& a, const float& b)
+                    {
+                        return a < b;
+                    });
+
+                yVals.sort([](const float& a, const float& b)
+                    {
+                        return a < b;
+                    });
+
+                shape->Boundaries[0] = Point(xVals.front(), yVals.front());
+                shape->Boundaries[1] = Point(xVals.back(), yVals.back());
+
+                // If we still have more lines, start a new shape at the start
+                // of the loop
+                shape = nullptr;
+            }
+        }
+    }
+
+    // Shapes are complete, index their lines before any collision checks
+    BuildCollisionGrid();
+}
+
+void ZoneGeometry::BuildCollisionGrid()
+{
+    mIndexedShapes.clear();
+    mGridLines.clear();
+
+    mBoundaries[0] = mBoundaries[1] = Point();
+    if(Shapes.size() > 0)
+    {
+        mBoundaries = Shapes.front()->Boundaries;
+    }
+
+    for(auto& s : Shapes)
+    {
+        mBoundaries[0].x = std::min(mBoundaries[0].x, s->Boundaries[0].x);
+        mBoundaries[0].y = std::min(mBoundaries[0].y, s->Boundaries[0].y);
+        mBoundaries[1].x = std::max(mBoundaries[1].x, s->Boundaries[1].x);
+        mBoundaries[1].y = std::max(mBoundaries[1].y, s->Boundaries[1].y);
+    }
+
+    mCollisionGrid.Reset(mBoundaries[0].x, mBoundaries[0].y,
+        mBoundaries[1].x, mBoundaries[1].y, 500.f);
+
+    uint32_t shapeIdx = 0;
+    for(auto& s : Shapes)
+    {
+        mIndexedShapes.push_back(s);
+
+        uint32_t lineIdx = 0;
+        for(const Line& line : s->Lines)
+        {
+            GridLine gridLine;
+            gridLine.Surface = &line;
+            gridLine.ShapeIndex = shapeIdx;
+            gridLine.LineIndex = lineIdx++;
+
+            mCollisionGrid.Update((uint32_t)mGridLines.size(),
+                line.first.x, line.first.y, line.second.x, line.second.y);
+            mGridLines.push_back(gridLine);
+        }
+
+        shapeIdx++;
+    }
+
+    mGridBuilt = true;
+}
+
+const std::array<Point, 2>& ZoneGeometry::GetBoundaries() const
+{
+    return mBoundaries;
+}
+
+void ZoneGeometry::BuildNavigation()
+{
+    mNavIDs.clear();
+    mNavIndexes.clear();
+    mNavPositions.clear();
+    mNavEdges.clear();
+    mNavRoutes.clear();
+
+    // Order the points by ID so the graph is the same every time
+    for(auto& pair : NavPoints)
+    {
+        mNavIDs.push_back(pair.first);
+    }
+
+    std::sort(mNavIDs.begin(), mNavIDs.end());
+
+    for(uint32_t pointID : mNavIDs)
+    {
+        auto n = NavPoints[pointID];
+
+        mNavIndexes[pointID] = (uint32_t)mNavPositions.size();
+        mNavPositions.push_back(Point((float)n->GetX(), (float)n->GetY()));
+    }
+
+    // Only connect points that are still in the graph and scale the A*
+    // estimate down so it never exceeds the distance of any connection
+    mNavHeuristicScale = 1.f;
+    mNavEdges.resize(mNavIDs.size());
+    for(size_t i = 0; i < mNavIDs.size(); i++)
+    {
+        auto n = NavPoints[mNavIDs[i]];
+        for(auto& dist : n->GetDistances())
+        {
+            auto it = mNavIndexes.find(dist.first);
+            if(it == mNavIndexes.end())
+            {
+                continue;
+            }
+
+            mNavEdges[i].push_back(std::make_pair(it->second, dist.second));
+
+            float direct = mNavPositions[i].GetDistance(
+                mNavPositions[it->second]);
+            if(direct > 0.f)
+            {
+                mNavHeuristicScale = std::max(0.f, std::min(
+                    mNavHeuristicScale, dist.second / direct));
+            }
+        }
+    }
+
+    size_t count = mNavIDs.size();
+    if(count <= NAV_ROUTE_TABLE_MAX)
+    {
+        mNavRoutes.resize(count * count, NAV_ROUTE_NONE);
+
+        std::vector<uint32_t> previous;
+        for(size_t source = 0; source < count; source++)
+        {
+            SearchNavGraph((uint32_t)source, previous);
+
+            for(size_t dest = 0; dest < count; dest++)
+            {
+                if(previous[dest] != NAV_INDEX_NONE)
+                {
+                    mNavRoutes[source * count + dest] =
+                        (uint16_t)previous[dest];
+                }
+            }
+        }
+    }
+}
+
+std::list<uint32_t> ZoneGeometry::GetShortestPath(uint32_t sourceID,
+    uint32_t destID) const
+{
+    if(mNavRoutes.empty())
+    {
+        // Too many points for a route table
+        return GetShortestPathSearch(sourceID, destID);
+    }
+
+    std::list<uint32_t> result;
+
+    auto sourceIter = mNavIndexes.find(sourceID);
+    auto destIter = mNavIndexes.find(destID);
+    if(sourceIter == mNavIndexes.end() || destIter == mNavIndexes.end())
+    {
+        return result;
+    }
+
+    uint32_t source = sourceIter->second;
+    uint32_t dest = destIter->second;
+
+    // Walk back from the destination through the route table
+    size_t count = mNavIDs.size();
+    uint32_t current = dest;
+    while(current != source)
+    {
+        result.push_front(mNavIDs[current]);
+
+        uint16_t previous = mNavRoutes[source * count + current];
+        if(previous == NAV_ROUTE_NONE)
+        {
+            // Not reachable
+            result.clear();
+            return result;
+        }
+
+        current = previous;
+    }
+
+    result.push_front(sourceID);
+
+    return result;
+}
+
+std::list<uint32_t> ZoneGeometry::GetShortestPathSearch(uint32_t sourceID,
+    uint32_t destID) const
+{
+    auto sourceIter = mNavIndexes.find(sourceID);
+    auto destIter = mNavIndexes.find(destID);
+    if(sourceIter == mNavIndexes.end() || destIter == mNavIndexes.end())
+    {
+        return std::list<uint32_t>();
+    }
+
+    return SearchNavGraph(sourceIter->second, destIter->second);
+}
+
+std::shared_ptr<objects::QmpNavPoint> ZoneGeometry::GetClosestVisibleNavPoint(
+    const Point& p, const std::set<uint32_t>& disabledBarriers) const
+{
+    // Check the points closest first, only ordering as many as needed
+    std::vector<std::pair<float, const std::shared_ptr<
+        objects::QmpNavPoint>*>> points;
+    points.reserve(NavPoints.size());
+
+    for(auto& pair : NavPoints)
+    {
+        float xDiff = (float)pair.second->GetX() - p.x;
+        float yDiff = (float)pair.second->GetY() - p.y;
+
+        points.push_back(std::make_pair(xDiff * xDiff + yDiff * yDiff,
+            &pair.second));
+    }
+
+    auto closer = [](const std::pair<float, const std::shared_ptr<
+        objects::QmpNavPoint>*>& a, const std::pair<float,
+        const std::shared_ptr<objects::QmpNavPoint>*>& b)
+        {
+            return a.first > b.first;
+        };
+
+    std::make_heap(points.begin(), points.end(), closer);
+
+    Point point;
+    Line surface;
+    std::shared_ptr<ZoneShape> shape;
+    while(!points.empty())
+    {
+        std::pop_heap(points.begin(), points.end(), closer);
+
+        auto& n = *points.back().second;
+
+        Line l(p, Point((float)n->GetX(), (float)n->GetY()));
+        if(!Collides(l, point, surface, shape, disabledBarriers))
+        {
+            return n;
+        }
+
+        points.pop_back();
+    }
+
+    return nullptr;
+}
+
+float ZoneGeometry::GetPathDistance(const std::list<uint32_t>& path) const
+{
+    float distance = 0.f;
+
+    auto prev = path.end();
+    for(auto it = path.begin(); it != path.end(); it++)
+    {
+        if(prev != path.end())
+        {
+            auto pIter = NavPoints.find(*prev);
+            if(pIter == NavPoints.end())
+            {
+                return -1.f;
+            }
+
+            auto distances = pIter->second->GetDistances();
+            auto dIter = distances.find(*it);
+            if(dIter == distances.end())
+            {
+                return -1.f;
+            }
+
+            distance += dIter->second;
+        }
+
+        prev = it;
+    }
+
+    return distance;
+}
+
+bool ZoneGeometry::LineBlocks(const ZoneShape& shape, const Line& line,
+    const Line& path, Point& point, float& dist)
+{
+    if(!line.Intersect(path, point, dist))
     {
         return false;
     }
+
+    // If the first point of the line being drawn is to the right of the
+    // direction of the path, allow pass through
+    return !shape.OneWay ||
+        ((path.second.x - path.first.x) * (line.first.y - path.first.y) -
+        (path.second.y - path.first.y) * (line.first.x - path.first.x)) >= 0;
+}
+
+bool ZoneGeometry::ShapeEnabled(const ZoneQmpShape& shape,
+    const std::set<uint32_t>& disabledBarriers)
+{
+    return shape.Active && (!shape.Element || disabledBarriers.find(
+        shape.Element->GetID()) == disabledBarriers.end());
+}
+
+bool ZoneGeometry::SelectClosest(const std::vector<CollisionHit>& hits,
+    const Line& path, Point& point, Line& surface,
+    std::shared_ptr<ZoneShape>& shape)
+{
+    const CollisionHit* closest = nullptr;
+    float closestDist = 0.f;
+
+    auto it = hits.begin();
+    while(it != hits.end())
+    {
+        // Find the closest line for the shape, later lines win distance
+        // ties
+        auto best = it;
+        uint32_t shapeIdx = it->ShapeIndex;
+        for(it++; it != hits.end() && it->ShapeIndex == shapeIdx; it++)
+        {
+            if(it->Distance <= best->Distance)
+            {
+                best = it;
+            }
+        }
+
+        // Compare shapes by the distance to their closest point, later
+        // shapes win distance ties
+        const Point& bp = best->Intersection;
+        float dSquared = (float)(std::pow((path.first.x - bp.x), 2)
+            + std::pow((path.first.y - bp.y), 2));
+        if(!closest || dSquared <= closestDist)
+        {
+            closest = &(*best);
+            closestDist = dSquared;
+        }
+    }
+
+    if(closest)
+    {
+        point = closest->Intersection;
+        surface = *closest->Surface;
+        shape = *closest->Shape;
+        return true;
+    }
+
+    return false;
 }
 
 bool ZoneGeometry::Collides(const Line& path, Point& point) const
@@ -230,4 +783,107 @@ bool ZoneGeometry::Collides(const Line& path, Point& point) const
     Line surface;
     std::shared_ptr<ZoneShape> shape;
     return Collides(path, point, surface, shape);
-}
\ No newline at end of file
+}
+
+std::list<uint32_t> ZoneGeometry::SearchNavGraph(uint32_t source,
+    uint32_t dest) const
+{
+    std::list<uint32_t> result;
+
+    size_t count = mNavIDs.size();
+    const Point& target = mNavPositions[dest];
+
+    std::vector<float> distances(count, std::numeric_limits<float>::max());
+    std::vector<uint32_t> previous(count, NAV_INDEX_NONE);
+    std::vector<bool> closed(count, false);
+
+    NavQueue_t open;
+    distances[source] = 0.f;
+    open.push(NavQueueEntry_t(0.f, source));
+
+    while(!open.empty())
+    {
+        uint32_t current = open.top().second;
+        open.pop();
+
+        if(closed[current])
+        {
+            continue;
+        }
+
+        if(current == dest)
+        {
+            break;
+        }
+
+        closed[current] = true;
+
+        for(auto& edge : mNavEdges[current])
+        {
+            float dist = distances[current] + edge.second;
+            if(!closed[edge.first] && dist < distances[edge.first])
+            {
+                distances[edge.first] = dist;
+                previous[edge.first] = current;
+
+                open.push(NavQueueEntry_t(dist + mNavHeuristicScale *
+                    mNavPositions[edge.first].GetDistance(target),
+                    edge.first));
+            }
+        }
+    }
+
+    if(source != dest && previous[dest] == NAV_INDEX_NONE)
+    {
+        // Not reachable
+        return result;
+    }
+
+    for(uint32_t current = dest; current != source;
+        current = previous[current])
+    {
+        result.push_front(mNavIDs[current]);
+    }
+
+    result.push_front(mNavIDs[source]);
+
+    return result;
+}
+
+void ZoneGeometry::SearchNavGraph(uint32_t source,
+    std::vector<uint32_t>& previous) const
+{
+    size_t count = mNavIDs.size();
+
+    std::vector<float> distances(count, std::numeric_limits<float>::max());
+    std::vector<bool> closed(count, false);
+    previous.assign(count, NAV_INDEX_NONE);
+
+    NavQueue_t open;
+    distances[source] = 0.f;
+    open.push(NavQueueEntry_t(0.f, source));
+
+    while(!open.empty())
+    {
+        uint32_t current = open.top().second;
+        open.pop();
+
+        if(closed[current])
+        {
+            continue;
+        }
+
+        closed[current] = true;
+
+        for(auto& edge : mNavEdges[current])
+        {
+            float dist = distances[current] + edge.second;
+            if(!closed[edge.first] && dist < distances[edge.first])
+            {
+                distances[edge.first] = dist;
+                previous[edge.first] = current;
+                open.push(NavQueueEntry_t(dist, edge.first));
+            }
+        }
+    }
+}
@@ -30,17 +30,20 @@
 
 // libcomp Includes
 #include <CString.h>
+#include <SpatialGrid.h>
 
 // Standard C++11 includes
 #include <array>
 #include <list>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace objects
 {
 class MiSpotData;
 class QmpElement;
+class QmpFile;
 class QmpNavPoint;
 }
 
@@ -232,7 +235,14 @@ class ZoneGeometry
 {
 public:
     /**
-     * Determines if the supplied path collides with any shape
+     * Create a new empty geometry container
+     */
+    ZoneGeometry();
+
+    /**
+     * Determines if the supplied path collides with any shape. If the
+     * collision grid has been built, only the lines near the path will
+     * be checked.
      * @param path Line representing a path
      * @param point Output parameter to set where the intersection occurs
      * @param surface Output parameter to return the first line to be
@@ -246,7 +256,7 @@ public:
      */
     bool Collides(const Line& path, Point& point,
         Line& surface, std::shared_ptr<ZoneShape>& shape,
-        const std::set<uint32_t> disabledBarriers = {}) const;
+        const std::set<uint32_t>& disabledBarriers = {}) const;
 
     /**
      * Determines if the supplied path collides with any shape
@@ -256,6 +266,101 @@ public:
      */
     bool Collides(const Line& path, Point& point) const;
 
+    /**
+     * Determines if the supplied path collides with any shape by checking
+     * every line of every shape. This returns the same result as
+     * @ref Collides and is used to verify and benchmark the collision grid.
+     * @param path Line representing a path
+     * @param point Output parameter to set where the intersection occurs
+     * @param surface Output parameter to return the first line to be
+     *  intersected by the path
+     * @param shape Output parameter to return the first shape the path
+     *  will collide with
+     * @param disabledBarriers Set of element IDs that should not count as
+     *  a collision
+     * @return true if the line collides, false if it does not
+     */
+    bool CollidesLinear(const Line& path, Point& point,
+        Line& surface, std::shared_ptr<ZoneShape>& shape,
+        const std::set<uint32_t>& disabledBarriers = {}) const;
+
+    /**
+     * Build a shape from the boundary lines of each element in a QMP file,
+     * add the elements and shapes to the geometry and build the collision
+     * grid. Nav points are left to the caller.
+     * @param qmpFile QMP file to build the shapes from
+     */
+    void LoadQmpShapes(const std::shared_ptr<objects::QmpFile>& qmpFile);
+
+    /**
+     * Build the static line grid used to accelerate collision checks.
+     * This must be called once all shapes have been added and the shapes
+     * must not change afterwards.
+     */
+    void BuildCollisionGrid();
+
+    /**
+     * Get the top left-most and bottom right-most points of all shapes
+     * @return Boundary points of all shapes
+     */
+    const std::array<Point, 2>& GetBoundaries() const;
+
+    /**
+     * Build the routing data used to find paths between nav points. Small
+     * nav graphs get a table of the shortest path between every pair of
+     * points while larger graphs are searched with A* when a path is
+     * requested. This must be called once the nav points have been set
+     * and the nav points must not change afterwards.
+     */
+    void BuildNavigation();
+
+    /**
+     * Calculate the shortest path between two nav points. If the nav graph
+     * has too many points for a route table, @ref GetShortestPathSearch is
+     * used instead. @ref BuildNavigation must be called first.
+     * @param sourceID Source point ID
+     * @param destID Destination point ID
+     * @return List of the shortest path of points to move to in order,
+     *  starting with the source and ending with the destination or empty
+     *  if no path exists
+     */
+    std::list<uint32_t> GetShortestPath(uint32_t sourceID,
+        uint32_t destID) const;
+
+    /**
+     * Calculate the shortest path between two nav points with an A* search
+     * of the nav graph. This is used by @ref GetShortestPath for nav graphs
+     * too large for a route table and returns a path of the same length.
+     * @ref BuildNavigation must be called first.
+     * @param sourceID Source point ID
+     * @param destID Destination point ID
+     * @return List of the shortest path of points to move to in order,
+     *  starting with the source and ending with the destination or empty
+     *  if no path exists
+     */
+    std::list<uint32_t> GetShortestPathSearch(uint32_t sourceID,
+        uint32_t destID) const;
+
+    /**
+     * Get the nav point closest to the supplied point that can be reached
+     * from it without colliding with any shape.
+     * @param p Point to start from
+     * @param disabledBarriers Set of element IDs that should not count as
+     *  a collision
+     * @return Pointer to the closest visible nav point or null if none
+     *  are visible
+     */
+    std::shared_ptr<objects::QmpNavPoint> GetClosestVisibleNavPoint(
+        const Point& p, const std::set<uint32_t>& disabledBarriers = {}) const;
+
+    /**
+     * Get the total distance of a path between nav points.
+     * @param path List of nav point IDs in the path
+     * @return Total distance of the path or a negative value if the path
+     *  is not connected
+     */
+    float GetPathDistance(const std::list<uint32_t>& path) const;
+
     /// QMP filename where the geometry was loaded from
     libcomp::String QmpFilename;
 
@@ -270,6 +375,145 @@ public:
     /// area only.
     std::unordered_map<uint32_t,
         std::shared_ptr<objects::QmpNavPoint>> NavPoints;
+
+private:
+    /**
+     * Line stored in the collision grid along with the position of it and
+     * its shape in the original shape order.
+     */
+    struct GridLine
+    {
+        /// Pointer to the line in the shape's line list
+        const Line* Surface;
+
+        /// Index of the shape in the shape list
+        uint32_t ShapeIndex;
+
+        /// Index of the line in the shape's line list
+        uint32_t LineIndex;
+    };
+
+    /**
+     * Path intersection with a single line.
+     */
+    struct CollisionHit
+    {
+        /// Pointer to the line intersected
+        const Line* Surface;
+
+        /// Pointer to the shape the line belongs to
+        const std::shared_ptr<ZoneQmpShape>* Shape;
+
+        /// Index of the shape in the shape list
+        uint32_t ShapeIndex;
+
+        /// Index of the line in the shape's line list
+        uint32_t LineIndex;
+
+        /// Squared distance from the path start to the intersection
+        float Distance;
+
+        /// Point of intersection
+        Point Intersection;
+    };
+
+    /**
+     * Check if a path intersects a shape's line, accounting for one way
+     * lines that can be passed through.
+     * @param shape Shape the line belongs to
+     * @param line Line to check
+     * @param path Line representing a path
+     * @param point Output parameter to set where the intersection occurs
+     * @param dist Output parameter to set the squared distance from the
+     *  path start to the intersection
+     * @return true if the path is blocked by the line
+     */
+    static bool LineBlocks(const ZoneShape& shape, const Line& line,
+        const Line& path, Point& point, float& dist);
+
+    /**
+     * Check if a shape is currently able to collide with a path.
+     * @param shape Shape to check
+     * @param disabledBarriers Set of element IDs that should not count as
+     *  a collision
+     * @return true if the shape can collide
+     */
+    static bool ShapeEnabled(const ZoneQmpShape& shape,
+        const std::set<uint32_t>& disabledBarriers);
+
+    /**
+     * Select the closest collision from a set of line hits sorted by shape
+     * and line index. The closest line is selected per shape first and the
+     * closest of those is selected afterwards. Distance ties are won by
+     * the later line or shape.
+     * @param hits Line hits sorted by shape then line index
+     * @param path Line representing a path
+     * @param point Output parameter to set where the intersection occurs
+     * @param surface Output parameter to return the intersected line
+     * @param shape Output parameter to return the intersected shape
+     * @return true if any hit exists
+     */
+    static bool SelectClosest(const std::vector<CollisionHit>& hits,
+        const Line& path, Point& point, Line& surface,
+        std::shared_ptr<ZoneShape>& shape);
+
+    /**
+     * Find the shortest path between two nav points with an A* search
+     * over the nav graph.
+     * @param source Index of the source nav point
+     * @param dest Index of the destination nav point
+     * @return List of the shortest path of points to move to in order or
+     *  empty if no path exists
+     */
+    std::list<uint32_t> SearchNavGraph(uint32_t source, uint32_t dest) const;
+
+    /**
+     * Find the shortest path from one nav point to every other nav point
+     * with Dijkstra's algorithm.
+     * @param source Index of the source nav point
+     * @param previous Output parameter set to the index of the point
+     *  before each point on its shortest path from the source
+     */
+    void SearchNavGraph(uint32_t source,
+        std::vector<uint32_t>& previous) const;
+
+    /// Shapes in the same order as the shape list for indexed access
+    std::vector<std::shared_ptr<ZoneQmpShape>> mIndexedShapes;
+
+    /// All lines from all shapes stored in the collision grid, keyed by
+    /// position in this list
+    std::vector<GridLine> mGridLines;
+
+    /// Uniform grid of line indexes by line bounding box
+    libcomp::SpatialGrid<uint32_t> mCollisionGrid;
+
+    /// Top left-most and bottom right-most points of all shapes
+    std::array<Point, 2> mBoundaries;
+
+    /// true if the collision grid has been built
+    bool mGridBuilt;
+
+    /// Nav point IDs by index in the nav graph
+    std::vector<uint32_t> mNavIDs;
+
+    /// Nav point indexes in the nav graph by ID
+    std::unordered_map<uint32_t, uint32_t> mNavIndexes;
+
+    /// Nav point positions by index in the nav graph
+    std::vector<Point> mNavPositions;
+
+    /// Index and distance of each nav point connected to a nav point by
+    /// index in the nav graph
+    std::vector<std::vector<std::pair<uint32_t, float>>> mNavEdges;
+
+    /// For small nav graphs, the index of the point before the destination
+    /// on the shortest path from the source, stored at
+    /// source * point count + destination
+    std::vector<uint16_t> mNavRoutes;
+
+    /// Multiplier applied to the straight line distance between two nav
+    /// points so the A* estimate never exceeds the nav graph distance
+    float mNavHeuristicScale;
 };
 
 /**
@@ -35,7 +35,6 @@
 #include <MiZoneData.h>
 #include <MiZoneFileData.h>
 #include <QmpBoundary.h>
-#include <QmpBoundaryLine.h>
 #include <QmpElement.h>
 #include <QmpFile.h>
 #include <QmpNavPoint.h>
@@ -115,134 +114,19 @@ bool ZoneGeometryLoader::LoadZoneQMP(
     auto geometry = std::make_shared<ZoneGeometry>();
     geometry->QmpFilename = filename;
 
-    std::unordered_map<uint32_t,
-        std::shared_ptr<objects::QmpElement>> elementMap;
-    for(auto qmpElem : qmpFile->GetElements())
-    {
-        geometry->Elements.push_back(qmpElem);
-        elementMap[qmpElem->GetID()] = qmpElem;
-    }
+    // Build the shapes and index their lines before any collision checks
+    geometry->LoadQmpShapes(qmpFile);
 
-    std::unordered_map<uint32_t, std::list<Line>> lineMap;
     std::unordered_map<uint32_t,
         std::shared_ptr<objects::QmpNavPoint>> navPoints;
     for(auto qmpBoundary : qmpFile->GetBoundaries())
     {
-        for(auto qmpLine : qmpBoundary->GetLines())
-        {
-            Line l(Point((float)qmpLine->GetX1(), (float)qmpLine->GetY1()),
-                Point((float)qmpLine->GetX2(), (float)qmpLine->GetY2()));
-            lineMap[qmpLine->GetElementID()].push_back(l);
-        }
-
         for(auto navPoint : qmpBoundary->GetNavPoints())
         {
             navPoints[navPoint->GetPointID()] = navPoint;
         }
     }
 
-    uint32_t instanceID = 1;
-    for(auto pair : lineMap)
-    {
-        // Build a complete shape from the lines provided
-        // If there is a gap in the shape, it is a line instead
-        // of a full shape
-        auto lines = pair.second;
-
-        std::shared_ptr<ZoneQmpShape> shape;
-        Line firstLine;
-        Point* connectPoint = 0;
-        while(lines.size() > 0)
-        {
-            if(!shape)
-            {
-                // Lines still exist, start a new shape
-                shape = std::make_shared<ZoneQmpShape>();
-                shape->ShapeID = pair.first;
-                shape->Element = elementMap[pair.first];
-                shape->OneWay = shape->Element->GetType() ==
-                    objects::QmpElement::Type_t::ONE_WAY;
-
-                shape->Lines.push_back(lines.front());
-                lines.pop_front();
-                firstLine = shape->Lines.front();
-                connectPoint = &shape->Lines.back().second;
-            }
-
-            bool connected = false;
-            for(auto it = lines.begin(); it != lines.end(); it++)
-            {
-                if(it->first == *connectPoint)
-                {
-                    shape->Lines.push_back(*it);
-                    connected = true;
-                }
-                else if(it->second == *connectPoint)
-                {
-                    if(shape->OneWay)
-                    {
-                        LOG_DEBUG(libcomp::String("Inverted one way"
-                            " directional line encountered in shape:"
-                            " %1\n").Arg(shape->Element->GetName()));
-                    }
-
-                    shape->Lines.push_back(Line(it->second, it->first));
-                    connected = true;
-                }
-
-                if(connected)
-                {
-                    connectPoint = &shape->Lines.back().second;
-                    lines.erase(it);
-                    break;
-                }
-            }
-
-            if(!connected || lines.size() == 0)
-            {
-                shape->InstanceID = instanceID++;
-
-                if(*connectPoint == firstLine.first)
-                {
-                    // Solid shape completed
-                    shape->IsLine = false;
-                }
-
-                geometry->Shapes.push_back(shape);
-
-                // Determine the boundaries of the completed shape
-                std::list<float> xVals;
-                std::list<float> yVals;
-
-                for(Line& line : shape->Lines)
-                {
-                    for(const Point& p : { line.first, line.second })
-                    {
-                        xVals.push_back(p.x);
-                        yVals.push_back(p.y);
-                    }
-                }
-
-                xVals.sort([](const float& a, const float& b)
-                    {
-                        return a < b;
-                    });
-
-                yVals.sort([](const float& a, const float& b)
-                    {
-                        return a < b;
-                    });
-
-                shape->Boundaries[0] = Point(xVals.front(), yVals.front());
-                shape->Boundaries[1] = Point(xVals.back(), yVals.back());
-
-                // If we still have more lines, start a new shape at the start
-                // of the loop
-                shape = nullptr;
-            }
-        }
-    }
-
     // If any zone-in spots exist, remove all navpoints that are outside
     // of all play areas by checking if the center point of zone-in spot
     // connects to the points (in large zones this often times cuts the
@@ -349,6 +233,9 @@ bool ZoneGeometryLoader::LoadZoneQMP(
 
     geometry->NavPoints = navPoints;
 
+    // Nav points are final, precompute the routes between them
+    geometry->BuildNavigation();
+
     libcomp::String filterString;
     if(navPoints.size() != navTotal)
     {
@@ -43,6 +43,7 @@
 #include <ActionSpawn.h>
 #include <ActionStartEvent.h>
 #include <Ally.h>
+#include <ChannelConfig.h>
 #include <ChannelLogin.h>
 #include <CharacterLogin.h>
 #include <CharacterProgress.h>
@@ -120,6 +121,10 @@
 
 using namespace channel;
 
+/// true while the current thread is updating a zone group in parallel
+/// with other zone groups
+static thread_local bool tInZoneTickShard = false;
+
 namespace libcomp
 {
     template<>
@@ -153,12 +158,15 @@ namespace libcomp
 
 ZoneManager::ZoneManager(const std::weak_ptr<ChannelServer>& server)
     : mTrackingRefresh(0), mNextZoneID(1), mNextZoneInstanceID(1),
-    mServer(server)
+    mZoneTickNextShard(0), mZoneTickShardsRemaining(0), mZoneTickTime(0),
+    mZoneTickNight(false), mZoneTickWorkersRunning(false), mServer(server)
 {
 }
 
 ZoneManager::~ZoneManager()
 {
+    StopZoneTickWorkers();
+
     for(auto zPair : mZones)
     {
         zPair.second->Cleanup();
@@ -444,6 +452,23 @@ bool ZoneManager::EnterZone(const std::shared_ptr<ChannelClientConnection>& clie
     uint32_t zoneID, uint32_t dynamicMapID, float xCoord, float yCoord, float rotation,
     bool forceLeave)
 {
+    // The zone being entered may be updating on another thread so apply
+    // the change once every zone group has finished
+    if(QueueZoneTickMerge([this, client, zoneID, dynamicMapID, xCoord,
+        yCoord, rotation, forceLeave]()
+        {
+            if(!EnterZone(client, zoneID, dynamicMapID, xCoord, yCoord,
+                rotation, forceLeave))
+            {
+                LOG_ERROR(libcomp::String("Failed to add client to zone"
+                    " %1 (%2) after the zone tick.\n").Arg(zoneID)
+                    .Arg(dynamicMapID));
+            }
+        }))
+    {
+        return true;
+    }
+
     auto state = client->GetClientState();
     auto cState = state->GetCharacterState();
     auto dState = state->GetDemonState();
@@ -742,6 +767,7 @@ bool ZoneManager::EnterZone(const std::shared_ptr<ChannelClientConnection>& clie
         eState->SetCurrentX(xCoord);
         eState->SetCurrentY(yCoord);
         eState->SetCurrentRotation(rotation);
+        eState->UpdateSpatialIndex();
     }
 
     server->GetTokuseiManager()->RecalculateParty(state->GetParty());
@@ -992,6 +1018,7 @@ void ZoneManager::LeaveZone(const std::shared_ptr<ChannelClientConnection>& clie
                 cState->SetCurrentX(x);
                 cState->SetCurrentY(y);
                 cState->SetCurrentRotation(rot);
+                cState->UpdateSpatialIndex();
 
                 // Notify the world that the character can relog after
                 // disconnecting until the instance is removed
@@ -1561,6 +1588,21 @@ bool ZoneManager::MoveToInstance(
         }
     }
 
+    // The instance being entered may be updating on another thread so
+    // move once every zone group has finished
+    if(QueueZoneTickMerge([this, client, access, diasporaEnter]()
+        {
+            if(!MoveToInstance(client, access, diasporaEnter))
+            {
+                LOG_ERROR(libcomp::String("Failed to move client to"
+                    " instance %1 after the zone tick.\n")
+                    .Arg(access->GetInstanceID()));
+            }
+        }))
+    {
+        return true;
+    }
+
     auto server = mServer.lock();
     if(access->GetIsLocal())
     {
@@ -1713,7 +1755,10 @@ bool ZoneManager::SendPopulateZoneData(const std::shared_ptr<
         client);
 
     // All zone information is queued and sent together to minimize excess
-    // communication
+    // communication. Every enemy and ally is sent so the area of interest
+    // for the client starts over.
+    zone->ResetAreaOfInterest(state->GetWorldCID());
+
     for(auto enemyState : zone->GetEnemies())
     {
         SendEnemyData(enemyState, client, zone, true);
@@ -2560,7 +2605,12 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
             SVR_CONST.STATUS_DIGITALIZE[1]
         };
 
+    // With area of interest filtering each entity's packets only go to the
+    // clients that can see it
+    bool filtered = zone->GetAOIRadius() > 0.f;
+
     std::list<libcomp::Packet> zonePackets;
+    std::list<std::pair<int32_t, std::list<libcomp::Packet>>> entityPackets;
     std::set<uint32_t> added, updated, removed;
     std::set<std::shared_ptr<ActiveEntityState>> displayStateModified;
     std::set<std::shared_ptr<ActiveEntityState>> recalc;
@@ -2572,26 +2622,35 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
             upkeepCost, added, updated, removed);
         if(!result) continue;
 
-        if(added.size() > 0 || updated.size() > 0)
+        if(filtered)
         {
-            auto effectMap = entity->GetStatusEffects();
+            entityPackets.push_back(std::make_pair(entity->GetEntityID(),
+                std::list<libcomp::Packet>()));
+        }
 
+        auto& packets = filtered ? entityPackets.back().second : zonePackets;
+
+        if(added.size() > 0 || updated.size() > 0)
+        {
             std::list<std::shared_ptr<objects::StatusEffect>> active;
-            for(uint32_t effectType : added)
             {
-                auto it = effectMap.find(effectType);
-                if(it != effectMap.end())
+                auto effectMap = entity->StatusEffectsView();
+                for(uint32_t effectType : added)
                 {
-                    active.push_back(it->second);
+                    auto it = effectMap->find(effectType);
+                    if(it != effectMap->end())
+                    {
+                        active.push_back(it->second);
+                    }
                 }
-            }
 
-            for(uint32_t effectType : updated)
-            {
-                auto it = effectMap.find(effectType);
-                if(it != effectMap.end())
+                for(uint32_t effectType : updated)
                 {
-                    active.push_back(it->second);
+                    auto it = effectMap->find(effectType);
+                    if(it != effectMap->end())
+                    {
+                        active.push_back(it->second);
+                    }
                 }
             }
 
@@ -2599,7 +2658,7 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
             if(characterManager->GetActiveStatusesPacket(p,
                 entity->GetEntityID(), active))
             {
-                zonePackets.push_back(p);
+                packets.push_back(p);
             }
 
             recalc.insert(entity);
@@ -2627,7 +2686,7 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
                 p.WriteS32Little(entity->GetEntityID());
                 p.WriteS32Little(hpAdjusted);
                 p.WriteS32Little(mpAdjusted);
-                zonePackets.push_back(p);
+                packets.push_back(p);
 
                 hpMpRecalc = true;
             }
@@ -2645,7 +2704,7 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
                     ChannelToClientPacketCode_t::PACKET_SKILL_UPKEEP_COST);
                 p.WriteS32Little(entity->GetEntityID());
                 p.WriteU32Little((uint32_t)(-mpAdjusted));
-                zonePackets.push_back(p);
+                packets.push_back(p);
 
                 hpMpRecalc = true;
             }
@@ -2665,7 +2724,7 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
             if(characterManager->GetRemovedStatusesPacket(p,
                 entity->GetEntityID(), removed))
             {
-                zonePackets.push_back(p);
+                packets.push_back(p);
             }
 
             recalc.insert(entity);
@@ -2699,6 +2758,15 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
         ChannelClientConnection::BroadcastPackets(zConnections, zonePackets);
     }
 
+    for(auto& ePair : entityPackets)
+    {
+        if(ePair.second.size() > 0)
+        {
+            ChannelClientConnection::BroadcastPackets(
+                zone->GetInterestedConnections(ePair.first), ePair.second);
+        }
+    }
+
     for(auto eState : recalc)
     {
         // Make sure T-damage is sent first
@@ -2717,6 +2785,60 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
     }
 }
 
+void ZoneManager::UpdateAreaOfInterest(const std::shared_ptr<Zone>& zone)
+{
+    std::unordered_map<int32_t, std::list<int32_t>> entered;
+    std::unordered_map<int32_t, std::list<int32_t>> left;
+    zone->UpdateAreaOfInterest(entered, left);
+
+    if(entered.size() == 0 && left.size() == 0)
+    {
+        return;
+    }
+
+    auto connections = zone->GetConnections();
+
+    std::list<std::shared_ptr<ChannelClientConnection>> updated;
+    for(auto& lPair : left)
+    {
+        auto it = connections.find(lPair.first);
+        if(it != connections.end())
+        {
+            RemoveEntities({ it->second }, lPair.second, 0, true);
+            updated.push_back(it->second);
+        }
+    }
+
+    for(auto& ePair : entered)
+    {
+        auto it = connections.find(ePair.first);
+        if(it == connections.end())
+        {
+            continue;
+        }
+
+        for(int32_t entityID : ePair.second)
+        {
+            auto enemy = zone->GetEnemy(entityID);
+            if(enemy)
+            {
+                SendEnemyData(enemy, it->second, zone, true);
+                continue;
+            }
+
+            auto ally = zone->GetAlly(entityID);
+            if(ally)
+            {
+                SendAllyData(ally, it->second, zone, true);
+            }
+        }
+
+        updated.push_back(it->second);
+    }
+
+    ChannelClientConnection::FlushAllOutgoing(updated);
+}
+
 void ZoneManager::HandleSpecialInstancePopulate(
     const std::shared_ptr<ChannelClientConnection>& client,
     const std::shared_ptr<Zone>& zone)
@@ -2837,26 +2959,21 @@ void ZoneManager::HandleSpecialInstancePopulate(
 void ZoneManager::BroadcastPacket(const std::shared_ptr<ChannelClientConnection>& client,
     libcomp::Packet& p, bool includeSelf)
 {
-    std::list<std::shared_ptr<libcomp::TcpConnection>> connections;
-    for(auto connection : GetZoneConnections(client, includeSelf))
-    {
-        connections.push_back(connection);
-    }
-
-    libcomp::TcpConnection::BroadcastPacket(connections, p);
+    ChannelClientConnection::BroadcastPacket(GetZoneConnections(client,
+        includeSelf), p);
 }
 
 void ZoneManager::BroadcastPacket(const std::shared_ptr<Zone>& zone, libcomp::Packet& p)
 {
     if(nullptr != zone)
     {
-        std::list<std::shared_ptr<libcomp::TcpConnection>> connections;
+        std::list<std::shared_ptr<ChannelClientConnection>> connections;
         for(auto connectionPair : zone->GetConnections())
         {
             connections.push_back(connectionPair.second);
         }
 
-        libcomp::TcpConnection::BroadcastPacket(connections, p);
+        ChannelClientConnection::BroadcastPacket(connections, p);
     }
 }
 
@@ -2870,7 +2987,7 @@ void ZoneManager::SendToRange(const std::shared_ptr<ChannelClientConnection>& cl
 
     cState->RefreshCurrentPosition(now);
 
-    std::list<std::shared_ptr<libcomp::TcpConnection>> zConnections;
+    std::list<std::shared_ptr<ChannelClientConnection>> zConnections;
     if(includeSelf)
     {
         zConnections.push_back(client);
@@ -2888,7 +3005,8 @@ void ZoneManager::SendToRange(const std::shared_ptr<ChannelClientConnection>& cl
             zConnections.push_back(zConnection);
         }
     }
-    libcomp::TcpConnection::BroadcastPacket(zConnections, p);
+
+    ChannelClientConnection::BroadcastPacket(zConnections, p);
 }
 
 std::list<std::shared_ptr<ChannelClientConnection>> ZoneManager::GetZoneConnections(
@@ -4144,7 +4262,6 @@ void ZoneManager::UpdateActiveZoneStates()
 
     // Performance timer to measure tasks.
     PerformanceTimer perf(server.get());
-    PerformanceTimer perf2(server.get());
 
     // Spin through entities with updated status effects
     perf.Start();
@@ -4156,59 +4273,38 @@ void ZoneManager::UpdateActiveZoneStates()
     }
     perf.Stop("UpdateStatusEffectStates");
 
-    auto aiManager = server->GetAIManager();
-
     bool isNight = worldClock.IsNight();
 
-    for(auto zone : zones)
+    bool parallel = false;
     {
-        perf.Start();
-
-        // Despawn first
-        HandleDespawns(zone);
-
-        // Stop combat next
-        for(int32_t combatantID : zone->GetCombatantIDs())
-        {
-            auto entity = zone->StartStopCombat(combatantID, serverTime, true);
-            if(entity)
-            {
-                server->GetCharacterManager()->AddRemoveOpponent(false,
-                    entity, nullptr);
-            }
-        }
-
-        // Update active AI controlled entities
-        perf2.Start();
-        aiManager->UpdateActiveStates(zone, serverTime, isNight);
-        perf2.Stop("Zone AI");
-
-        // Update staggered spawns before doing any normal spawns
-        if(zone->HasStaggeredSpawns(serverTime))
-        {
-            UpdateStaggeredSpawns(zone, serverTime);
-        }
+        std::lock_guard<std::mutex> lock(mZoneTickLock);
+        parallel = mZoneTickWorkers.size() > 0;
+    }
 
-        if(zone->HasRespawns())
+    if(parallel && zones.size() > 1)
+    {
+        UpdateActiveZonesParallel(zones, serverTime, isNight);
+    }
+    else
+    {
+        for(auto zone : zones)
         {
-            // Spawn new enemies next (since they should not immediately act)
-            UpdateSpawnGroups(zone, false, serverTime);
-
-            // Now update plasma spawns
-            UpdatePlasma(zone, serverTime);
+            UpdateActiveZone(zone, serverTime, isNight);
         }
-
-        mTimeRestrictUpdatedZones.erase(zone->GetID());
-
-        perf.Stop(libcomp::String("Zone %1").Arg(zone->GetDefinitionID()));
     }
 
     // Get any updated time restricted zones and clear the list
-    // after retrieval (essentially they "unfreeze" momentarily)
+    // after retrieval (essentially they "unfreeze" momentarily). Active
+    // zones were just updated so they do not need to be handled again.
     {
+        std::lock_guard<std::mutex> lock(mLock);
+        for(auto zone : zones)
+        {
+            mTimeRestrictUpdatedZones.erase(zone->GetID());
+        }
+
         zones.clear();
 
-        std::lock_guard<std::mutex> lock(mLock);
         if(mTimeRestrictUpdatedZones.size() > 0)
         {
             for(auto uniqueID : mTimeRestrictUpdatedZones)
@@ -4298,6 +4394,287 @@ void ZoneManager::UpdateActiveZoneStates()
     }
 }
 
+void ZoneManager::StartZoneTickWorkers(uint8_t threadCount)
+{
+    StopZoneTickWorkers();
+
+    if(threadCount < 2)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mZoneTickLock);
+    mZoneTickWorkersRunning = true;
+
+    // The tick thread updates zones too so it counts as one of the threads
+    for(uint8_t i = 1; i < threadCount; i++)
+    {
+        mZoneTickWorkers.push_back(std::thread([this]()
+        {
+#if !defined(_WIN32)
+            pthread_setname_np(pthread_self(), "zone_tick");
+#endif // !defined(_WIN32)
+
+            RunZoneTickShards(true);
+        }));
+    }
+
+    LOG_DEBUG(libcomp::String("Updating active zones with %1 threads\n")
+        .Arg(threadCount));
+}
+
+void ZoneManager::StopZoneTickWorkers()
+{
+    std::list<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mZoneTickLock);
+        mZoneTickWorkersRunning = false;
+        workers.swap(mZoneTickWorkers);
+    }
+
+    mZoneTickCondition.notify_all();
+
+    for(auto& worker : workers)
+    {
+        if(worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+void ZoneManager::UpdateActiveZone(const std::shared_ptr<Zone>& zone,
+    ServerTime serverTime, bool isNight)
+{
+    auto server = mServer.lock();
+    auto aiManager = server->GetAIManager();
+
+    // Performance timer to measure tasks.
+    PerformanceTimer perf(server.get());
+    PerformanceTimer perf2(server.get());
+
+    perf.Start();
+
+    // Despawn first
+    HandleDespawns(zone);
+
+    // Stop combat next
+    for(int32_t combatantID : zone->GetCombatantIDs())
+    {
+        auto entity = zone->StartStopCombat(combatantID, serverTime, true);
+        if(entity)
+        {
+            server->GetCharacterManager()->AddRemoveOpponent(false,
+                entity, nullptr);
+        }
+    }
+
+    // Update what each client can see before sending AI updates
+    UpdateAreaOfInterest(zone);
+
+    // Update active AI controlled entities
+    perf2.Start();
+    aiManager->UpdateActiveStates(zone, serverTime, isNight);
+    perf2.Stop("Zone AI");
+
+    // Update staggered spawns before doing any normal spawns
+    if(zone->HasStaggeredSpawns(serverTime))
+    {
+        UpdateStaggeredSpawns(zone, serverTime);
+    }
+
+    if(zone->HasRespawns())
+    {
+        // Spawn new enemies next (since they should not immediately act)
+        UpdateSpawnGroups(zone, false, serverTime);
+
+        // Now update plasma spawns
+        UpdatePlasma(zone, serverTime);
+    }
+
+    perf.Stop(libcomp::String("Zone %1").Arg(zone->GetDefinitionID()));
+}
+
+void ZoneManager::UpdateActiveZonesParallel(
+    const std::list<std::shared_ptr<Zone>>& zones, ServerTime serverTime,
+    bool isNight)
+{
+    // Zones in the same instance share instance state and zones in the
+    // same global boss group report to each other so both must stay on
+    // one thread. A zone can be in both so the groups are merged with a
+    // union-find over the zones before the shards are built.
+    const uint64_t INSTANCE_KEY = 1ULL << 32;
+    const uint64_t BOSS_GROUP_KEY = 2ULL << 32;
+
+    std::vector<std::shared_ptr<Zone>> zoneList(zones.begin(), zones.end());
+    std::vector<size_t> parents(zoneList.size());
+    for(size_t i = 0; i < parents.size(); i++)
+    {
+        parents[i] = i;
+    }
+
+    auto find = [&parents](size_t idx)
+        {
+            while(parents[idx] != idx)
+            {
+                parents[idx] = parents[parents[idx]];
+                idx = parents[idx];
+            }
+
+            return idx;
+        };
+
+    std::unordered_map<uint64_t, size_t> keyOwners;
+    auto join = [&](uint64_t key, size_t idx)
+        {
+            auto it = keyOwners.find(key);
+            if(it == keyOwners.end())
+            {
+                keyOwners[key] = idx;
+            }
+            else
+            {
+                size_t a = find(it->second);
+                size_t b = find(idx);
+                if(a != b)
+                {
+                    parents[b] = a;
+                }
+            }
+        };
+
+    for(size_t i = 0; i < zoneList.size(); i++)
+    {
+        auto& zone = zoneList[i];
+        auto def = zone->GetDefinition();
+
+        if(def && def->GetGlobalBossGroup())
+        {
+            join(BOSS_GROUP_KEY | def->GetGlobalBossGroup(), i);
+        }
+
+        if(zone->GetInstanceID())
+        {
+            join(INSTANCE_KEY | zone->GetInstanceID(), i);
+        }
+    }
+
+    std::vector<std::list<std::shared_ptr<Zone>>> shards;
+    std::unordered_map<size_t, size_t> shardIndexes;
+    for(size_t i = 0; i < zoneList.size(); i++)
+    {
+        size_t root = find(i);
+
+        auto it = shardIndexes.find(root);
+        if(it == shardIndexes.end())
+        {
+            shardIndexes[root] = shards.size();
+            shards.push_back({ zoneList[i] });
+        }
+        else
+        {
+            shards[it->second].push_back(zoneList[i]);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mZoneTickLock);
+        mZoneTickShards.swap(shards);
+        mZoneTickNextShard = 0;
+        mZoneTickShardsRemaining = mZoneTickShards.size();
+        mZoneTickTime = serverTime;
+        mZoneTickNight = isNight;
+    }
+
+    mZoneTickCondition.notify_all();
+
+    // Help out until every group has been claimed, then wait for the
+    // workers to finish the rest
+    RunZoneTickShards(false);
+
+    std::list<std::function<void()>> merges;
+    {
+        std::unique_lock<std::mutex> lock(mZoneTickLock);
+        mZoneTickDoneCondition.wait(lock, [this]()
+            {
+                return mZoneTickShardsRemaining == 0;
+            });
+
+        mZoneTickShards.clear();
+        mZoneTickNextShard = 0;
+        merges.swap(mZoneTickMerges);
+    }
+
+    // Apply the cross-zone changes requested by the zone groups now that
+    // nothing else is updating zones
+    for(auto& merge : merges)
+    {
+        merge();
+    }
+}
+
+bool ZoneManager::QueueZoneTickMerge(const std::function<void()>& f)
+{
+    if(!tInZoneTickShard)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mZoneTickLock);
+    mZoneTickMerges.push_back(f);
+
+    return true;
+}
+
+void ZoneManager::RunZoneTickShards(bool worker)
+{
+    std::unique_lock<std::mutex> lock(mZoneTickLock);
+    while(true)
+    {
+        if(worker)
+        {
+            mZoneTickCondition.wait(lock, [this]()
+                {
+                    return !mZoneTickWorkersRunning ||
+                        mZoneTickNextShard < mZoneTickShards.size();
+                });
+
+            if(!mZoneTickWorkersRunning)
+            {
+                return;
+            }
+        }
+        else if(mZoneTickNextShard >= mZoneTickShards.size())
+        {
+            return;
+        }
+
+        // The shard list is not modified until every shard is finished
+        // so it is safe to read the claimed one without the lock
+        auto& shard = mZoneTickShards[mZoneTickNextShard++];
+        ServerTime serverTime = mZoneTickTime;
+        bool isNight = mZoneTickNight;
+
+        lock.unlock();
+
+        tInZoneTickShard = true;
+
+        for(auto& zone : shard)
+        {
+            UpdateActiveZone(zone, serverTime, isNight);
+        }
+
+        tInZoneTickShard = false;
+
+        lock.lock();
+
+        if(--mZoneTickShardsRemaining == 0)
+        {
+            mZoneTickDoneCondition.notify_all();
+        }
+    }
+}
+
 void ZoneManager::Warp(const std::shared_ptr<ChannelClientConnection>& client,
     const std::shared_ptr<ActiveEntityState>& eState, float xPos, float yPos,
     float rot)
@@ -4312,6 +4689,7 @@ void ZoneManager::Warp(const std::shared_ptr<ChannelClientConnection>& client,
     eState->SetDestinationTicks(timestamp);
     eState->SetCurrentX(xPos);
     eState->SetCurrentY(yPos);
+    eState->UpdateSpatialIndex();
 
     libcomp::Packet p;
     p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_WARP);
@@ -6244,6 +6622,7 @@ Point ZoneManager::MoveRelative(const std::shared_ptr<ActiveEntityState>& eState
         eState->SetDestinationX(point.x);
         eState->SetDestinationY(point.y);
         eState->SetDestinationTicks(endTime);
+        eState->UpdateSpatialIndex();
     }
 
     return point;
@@ -6413,41 +6792,11 @@ std::list<Point> ZoneManager::GetShortestPath(const std::shared_ptr<Zone>& zone,
             // shortest path(s) between them and simplify
             std::array<std::shared_ptr<objects::QmpNavPoint>, 2> startPoints;
 
-            size_t idx = 0;
-            for(const Point& p : { source, dest })
-            {
-                std::list<std::pair<float,
-                    std::shared_ptr<objects::QmpNavPoint>>> points;
-                for(auto& pair : geometry->NavPoints)
-                {
-                    float dist = (float)(
-                        std::pow(((float)pair.second->GetX() - p.x), 2)
-                        + std::pow(((float)pair.second->GetY() - p.y), 2));
-                    points.push_back(std::make_pair(dist, pair.second));
-                }
-
-                points.sort([source](
-                    const std::pair<float,
-                        std::shared_ptr<objects::QmpNavPoint>>& a,
-                    const std::pair<float,
-                        std::shared_ptr<objects::QmpNavPoint>>& b)
-                    {
-                        return a.first < b.first;
-                    });
-
-                for(auto& pair : points)
-                {
-                    Line l(p, Point((float)pair.second->GetX(),
-                        (float)pair.second->GetY()));
-                    if(!zone->Collides(l, collidePoint))
-                    {
-                        startPoints[idx] = pair.second;
-                        break;
-                    }
-                }
-
-                idx++;
-            }
+            auto disabledBarriers = zone->GetDisabledBarriers();
+            startPoints[0] = geometry->GetClosestVisibleNavPoint(source,
+                disabledBarriers);
+            startPoints[1] = geometry->GetClosestVisibleNavPoint(dest,
+                disabledBarriers);
 
             if(!startPoints[0] || !startPoints[1])
             {
@@ -6462,7 +6811,7 @@ std::list<Point> ZoneManager::GetShortestPath(const std::shared_ptr<Zone>& zone,
             }
             else
             {
-                auto pointIDs = GetShortestPath(geometry,
+                auto pointIDs = geometry->GetShortestPath(
                     startPoints[0]->GetPointID(),
                     startPoints[1]->GetPointID());
                 if(pointIDs.size() == 0)
@@ -6564,114 +6913,6 @@ std::list<Point> ZoneManager::GetShortestPath(const std::shared_ptr<Zone>& zone,
     return result;
 }
 
-std::list<uint32_t> ZoneManager::GetShortestPath(
-    const std::shared_ptr<ZoneGeometry>& geometry, uint32_t sourceID,
-    uint32_t destID)
-{
-    std::list<uint32_t> result;
-
-    std::set<uint32_t> check;
-    std::unordered_map<uint32_t,
-        std::shared_ptr<objects::QmpNavPoint>> points;
-    std::unordered_map<uint32_t, uint32_t> paths;
-    std::unordered_map<uint32_t, float> distances;
-
-    auto it = geometry->NavPoints.find(sourceID);
-    if(it == geometry->NavPoints.end())
-    {
-        // Error
-        return result;
-    }
-
-    check.insert(sourceID);
-    points[sourceID] = it->second;
-    distances[sourceID] = 0.f;
-
-    // Not found yet
-    distances[destID] = -1.f;
-
-    while(check.size() > 0)
-    {
-        uint32_t pointID = *check.begin();
-        float dist = distances[pointID];
-        check.erase(pointID);
-
-        auto point = geometry->NavPoints[pointID];
-        for(auto& pair : point->GetDistances())
-        {
-            float dist2 = dist + pair.second;
-
-            // Once we find a full path, ignore nodes that go further out
-            // than what we've already found
-            if(distances[destID] != -1.f && dist2 > distances[destID]) continue;
-
-            if(points.find(pair.first) == points.end())
-            {
-                // New point reached
-                it = geometry->NavPoints.find(pair.first);
-                if(it != geometry->NavPoints.end())
-                {
-                    points[pair.first] = it->second;
-                    check.insert(pair.first);
-                    paths[pair.first] = point->GetPointID();
-                    distances[pair.first] = dist2;
-                }
-            }
-            else if(distances[pair.first] > dist2)
-            {
-                // Closer path found, update the chain
-                float delta = dist2 - distances[pair.first];
-                distances[pair.first] = dist2;
-
-                paths[pair.first] = point->GetPointID();
-
-                std::set<uint32_t> affected;
-                affected.insert(pair.first);
-
-                bool repeat = true;
-                while(repeat)
-                {
-                    repeat = false;
-                    for(auto& pair2 : paths)
-                    {
-                        if(affected.find(pair2.first) == affected.end() &&
-                            affected.find(pair2.second) != affected.end())
-                        {
-                            affected.insert(pair2.first);
-                            distances[pair2.first] += delta;
-                            repeat = true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    if(distances[destID] != -1.f)
-    {
-        // End point was found, backtrack to get the path
-        result.push_back(destID);
-
-        uint32_t current = paths[destID];
-        while(current)
-        {
-            result.push_front(current);
-
-            auto pIter = paths.find(current);
-            if(pIter != paths.end())
-            {
-                current = pIter->second;
-            }
-            else
-            {
-                current = 0;
-            }
-        }
-    }
-
-    return result;
-}
-
 float ZoneManager::GetPointToLineDistance(const Line& line, const Point& point)
 {
     float xDiff = line.second.x - line.first.x;
@@ -7258,6 +7499,23 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
             zone->SetMatch(instance->GetMatch());
         }
 
+        // Area of interest filtering is configured by zone type
+        auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(
+            server->GetConfig());
+        if(!instance)
+        {
+            zone->SetAOIRadius(conf->GetAOIRadiusField());
+        }
+        else if(instance->GetVariant() && instance->GetVariant()
+            ->GetInstanceType() == InstanceType_t::DIASPORA)
+        {
+            zone->SetAOIRadius(conf->GetAOIRadiusDiaspora());
+        }
+        else
+        {
+            zone->SetAOIRadius(conf->GetAOIRadiusInstance());
+        }
+
         auto qmpFile = zoneData->GetFile()->GetQmpFile();
         auto geoIter = !qmpFile.IsEmpty()
             ? mZoneGeometry.find(qmpFile.C()) : mZoneGeometry.end();
@@ -36,6 +36,12 @@
 #include "ZoneGeometry.h"
 #include "ZoneInstance.h"
 
+// Standard C++11 Includes
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <vector>
+
 namespace libcomp
 {
 class Packet;
@@ -153,12 +159,25 @@ public:
      * @param forceLeave Optional param that when set to true will force
      *  a call to LeaveZone even if the zone they are moving to is the same
      * @return true if the player entered the zone properly, false if they
-     *  did not
+     *  did not. If called while zone groups are being updated in parallel
+     *  the entry is deferred until every group has finished and true is
+     *  returned before the player has moved. Callers that act on the new
+     *  zone afterwards should defer themselves with @ref QueueZoneTickMerge.
      */
     bool EnterZone(const std::shared_ptr<ChannelClientConnection>& client,
         uint32_t zoneID, uint32_t dynamicMapID, float xCoord, float yCoord,
         float rotation, bool forceLeave = false);
 
+    /**
+     * Queue work that changes another zone to run once every zone group of
+     * the current tick has finished updating. This only queues the work if
+     * called from a zone group being updated in parallel.
+     * @param f Function to run once every zone group has finished
+     * @return true if the work was queued, false if the caller is not
+     *  updating a zone group and should run the work now
+     */
+    bool QueueZoneTickMerge(const std::function<void()>& f);
+
     /**
      * Remove a client connection from a zone
      * @param client Client connection to remove from any associated zone
@@ -261,7 +280,9 @@ public:
      *  client if not specified
      * @param diasporaEnter Optional indicator required to be set if the client
      *  is entering a Diaspora instance as it's entrance criteria is unique
-     * @return true if the move was successful, false if it was not
+     * @return true if the move was successful, false if it was not. Like
+     *  @ref EnterZone, the move is deferred and true is returned if called
+     *  while zone groups are being updated in parallel.
      */
     bool MoveToInstance(const std::shared_ptr<ChannelClientConnection>& client,
         std::shared_ptr<objects::InstanceAccess> access = nullptr,
@@ -628,6 +649,21 @@ public:
      */
     void UpdateActiveZoneStates();
 
+    /**
+     * Start the worker threads used to update independent active zones in
+     * parallel during each tick. Zones sharing an instance or global boss
+     * group are always updated together on the same thread. If fewer than
+     * two threads are requested, active zones are updated serially.
+     * @param threadCount Total number of threads to update zones with,
+     *  including the thread running the tick
+     */
+    void StartZoneTickWorkers(uint8_t threadCount);
+
+    /**
+     * Stop and join all zone tick worker threads.
+     */
+    void StopZoneTickWorkers();
+
     /**
      * Warp an entity to the specified location immediately.
      * @param client Pointer to the client connection to use for gathering zone
@@ -1033,6 +1069,36 @@ public:
         std::list<std::shared_ptr<objects::InstanceAccess>> removes);
 
 private:
+    /**
+     * Update a single active zone's despawns, combat, AI and spawns for
+     * the current tick.
+     * @param zone Pointer to the zone to update
+     * @param serverTime Current server time
+     * @param isNight true if it is currently night time
+     */
+    void UpdateActiveZone(const std::shared_ptr<Zone>& zone,
+        ServerTime serverTime, bool isNight);
+
+    /**
+     * Split the supplied zones into groups that can be updated
+     * independently and update them across the zone tick worker threads.
+     * Returns once every zone has been updated.
+     * @param zones List of active zones to update
+     * @param serverTime Current server time
+     * @param isNight true if it is currently night time
+     */
+    void UpdateActiveZonesParallel(
+        const std::list<std::shared_ptr<Zone>>& zones,
+        ServerTime serverTime, bool isNight);
+
+    /**
+     * Claim and update zone groups from the current tick until none remain
+     * or wait for more if this is a worker thread.
+     * @param worker true if called from a zone tick worker thread, false
+     *  if called from the tick itself
+     */
+    void RunZoneTickShards(bool worker);
+
     /**
      * Select a spot for a spawn group and get it's location.
      * @param useSpotID If the spot ID should be used.
@@ -1075,19 +1141,6 @@ private:
         const std::shared_ptr<objects::InstanceAccess>& toInstance,
         float x = 0.f, float y = 0.f, float rot = 0.f);
 
-    /**
-     * Calculate the shortest path between the supplied source and destination
-     * Qmp points in the same zone geometry. Path optimization between points
-     * is up to the caller to perform.
-     * @param geometry Pointer to a zone geometry definition
-     * @param sourceID Source point ID
-     * @param destID Destination point ID
-     * @return List of the shortest path of points to move to in order
-     */
-    std::list<uint32_t> GetShortestPath(
-        const std::shared_ptr<ZoneGeometry>& geometry,
-        uint32_t sourceID, uint32_t destID);
-
     /**
      * Create an enemy (or ally) in the specified zone at set coordinates
      * but do not add it to the zone yet
@@ -1175,6 +1228,14 @@ private:
     void UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
         uint32_t now);
 
+    /**
+     * Refresh the enemies and allies each client in the supplied zone can
+     * see when area of interest filtering is enabled, showing entities that
+     * came into range and removing those that went out of range
+     * @param zone Pointer to the zone to update
+     */
+    void UpdateAreaOfInterest(const std::shared_ptr<Zone>& zone);
+
     /**
      * Handle all instance specific zone population actions such as entity
      * hiding and timer updating
@@ -1366,6 +1427,42 @@ private:
     /// Server lock for creating or getting existing zones in an instance
     std::mutex mInstanceZoneLock;
 
+    /// Worker threads used to update active zones in parallel
+    std::list<std::thread> mZoneTickWorkers;
+
+    /// Groups of active zones for the current tick that must be updated
+    /// on the same thread
+    std::vector<std::list<std::shared_ptr<Zone>>> mZoneTickShards;
+
+    /// Index of the next zone group to be claimed by a thread
+    size_t mZoneTickNextShard;
+
+    /// Number of zone groups that have not finished updating
+    size_t mZoneTickShardsRemaining;
+
+    /// Server time of the current parallel zone update
+    ServerTime mZoneTickTime;
+
+    /// Night state of the current parallel zone update
+    bool mZoneTickNight;
+
+    /// true while the zone tick worker threads should keep running
+    bool mZoneTickWorkersRunning;
+
+    /// Lock for the zone tick worker state
+    std::mutex mZoneTickLock;
+
+    /// Condition signaled when new zone groups are ready or the zone tick
+    /// workers are being stopped
+    std::condition_variable mZoneTickCondition;
+
+    /// Condition signaled when every zone group has finished updating
+    std::condition_variable mZoneTickDoneCondition;
+
+    /// Zone changes requested while zone groups were being updated in
+    /// parallel, applied on the tick thread once every group finishes
+    std::list<std::function<void()>> mZoneTickMerges;
+
     /// Pointer to the channel server
     std::weak_ptr<ChannelServer> mServer;
 };
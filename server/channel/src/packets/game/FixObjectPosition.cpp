@@ -84,6 +84,7 @@ bool Parsers::FixObjectPosition::Parse(libcomp::ManagerPacket *pPacketManager,
     eState->SetCurrentY(destY);
 
     eState->SetDestinationTicks(stopTime);
+    eState->UpdateSpatialIndex();
 
     libcomp::Packet reply;
     reply.WritePacketCode(ChannelToClientPacketCode_t::PACKET_FIX_OBJECT_POSITION);
@@ -168,6 +168,8 @@ bool Parsers::Move::Parse(libcomp::ManagerPacket *pPacketManager,
     // and kind of irrelavent so mark it right away
     eState->SetCurrentRotation(destRot);
 
+    eState->UpdateSpatialIndex();
+
     if(positionCorrected)
     {
         // Sending the move response back to the player can still be
@@ -122,6 +122,7 @@ bool Parsers::Pivot::Parse(libcomp::ManagerPacket *pPacketManager,
         eState->SetDestinationY(y);
         eState->SetDestinationRotation(rot);
         eState->SetDestinationTicks(now);
+        eState->UpdateSpatialIndex();
 
         ServerTime stopConverted = state->ToServerTime(stopTime);
         uint64_t immobileTime = eState->GetStatusTimes(STATUS_IMMOBILE);
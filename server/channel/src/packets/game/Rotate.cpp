@@ -93,6 +93,7 @@ bool Parsers::Rotate::Parse(libcomp::ManagerPacket *pPacketManager,
 
     eState->SetOriginRotation(eState->GetCurrentRotation());
     eState->SetDestinationRotation(rotation);
+    eState->UpdateSpatialIndex();
 
     // If the entity is still visible to others, relay info
     if(eState->IsClientVisible())
@@ -125,6 +125,7 @@ bool Parsers::StopMovement::Parse(libcomp::ManagerPacket *pPacketManager,
 
     eState->SetOriginTicks(stopTime);
     eState->SetDestinationTicks(stopTime);
+    eState->UpdateSpatialIndex();
 
     // If the entity is still visible to others or the position was corrected,
     // relay info
@@ -63,6 +63,7 @@ bool LobbySyncManager::Initialize()
     // Build the configs
     auto cfg = std::make_shared<ObjectConfig>(
         "Account", true, lobbyDB);
+    cfg->DeltaSync = true;
     cfg->UpdateHandler = &DataSyncManager::Update<LobbySyncManager,
         objects::Account>;
     cfg->DynamicHandler = true;
@@ -87,6 +87,7 @@ bool WorldSyncManager::Initialize()
     mRegisteredTypes["SearchEntry"] = cfg;
 
     cfg = std::make_shared<ObjectConfig>("Account", false, lobbyDB);
+    cfg->DeltaSync = true;
     cfg->UpdateHandler = &DataSyncManager::Update<WorldSyncManager,
         objects::Account>;
 
@@ -106,6 +107,7 @@ bool WorldSyncManager::Initialize()
     mRegisteredTypes["CharacterLogin"] = cfg;
 
     cfg = std::make_shared<ObjectConfig>("CharacterProgress", true, worldDB);
+    cfg->DeltaSync = true;
     cfg->UpdateHandler = &DataSyncManager::Update<WorldSyncManager,
         objects::CharacterProgress>;
 
@@ -117,6 +119,9 @@ bool WorldSyncManager::Initialize()
 
     mRegisteredTypes["EventCounter"] = cfg;
 
+    // Stays a full sync: it is not persistent so there is no database
+    // reload to save and the channel creates the instance or replaces its
+    // access from the whole record
     cfg = std::make_shared<ObjectConfig>("InstanceAccess", true);
     cfg->BuildHandler = &DataSyncManager::New<objects::InstanceAccess>;
     cfg->UpdateHandler = &DataSyncManager::Update<WorldSyncManager,
@@ -0,0 +1,365 @@
+/**
+ * @file tools/zonebench/src/main.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tool to benchmark and verify the zone geometry used by the channel.
+ *
+ * This tool loads QMP zone geometry files from a data store the same way
+ * the channel does and replays random paths through both the collision
+ * grid and a check of every line. It then finds paths between random
+ * pairs of nav points with both the route table and an A* search. Any
+ * result that differs is reported along with the time taken by each.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// libcomp Includes
+#include <CString.h>
+#include <DataStore.h>
+#include <DefinitionManager.h>
+
+// object Includes
+#include <QmpBoundary.h>
+#include <QmpFile.h>
+#include <QmpNavPoint.h>
+
+// channel Includes
+#include <ZoneGeometry.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <random>
+#include <vector>
+
+using namespace channel;
+
+namespace
+{
+
+/// Number of random paths checked against the collision grid per zone.
+const size_t COLLISION_PATH_COUNT = 10000;
+
+/// Longest random path checked against the collision grid. Paths are
+/// roughly the length of a movement or skill range check.
+const float MAX_PATH_LENGTH = 2000.f;
+
+/// Number of random pairs of nav points routed per zone.
+const size_t NAV_PATH_COUNT = 1000;
+
+/**
+ * Get the microseconds elapsed since a time point.
+ * @param start Time point to measure from
+ * @returns Microseconds elapsed since the start
+ */
+int64_t ElapsedMicroseconds(
+    const std::chrono::high_resolution_clock::time_point& start)
+{
+    return (int64_t)std::chrono::duration_cast<
+        std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+/**
+ * Replay random paths through both the linear and grid accelerated
+ * collision checks, report any result that differs and the time taken
+ * by each.
+ * @param geometry Geometry to benchmark with the collision grid built
+ * @returns true if every result matched
+ */
+bool BenchmarkCollisionGrid(
+    const std::shared_ptr<ZoneGeometry>& geometry)
+{
+    if(geometry->Shapes.empty())
+    {
+        return true;
+    }
+
+    auto& bounds = geometry->GetBoundaries();
+
+    // Use a fixed seed so results are repeatable between runs
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> xDist(bounds[0].x, bounds[1].x);
+    std::uniform_real_distribution<float> yDist(bounds[0].y, bounds[1].y);
+    std::uniform_real_distribution<float> offsetDist(-MAX_PATH_LENGTH,
+        MAX_PATH_LENGTH);
+
+    std::vector<Line> paths;
+    paths.reserve(COLLISION_PATH_COUNT);
+    for(size_t i = 0; i < COLLISION_PATH_COUNT; i++)
+    {
+        Point p(xDist(rng), yDist(rng));
+        paths.push_back(Line(p, Point(p.x + offsetDist(rng),
+            p.y + offsetDist(rng))));
+    }
+
+    Point point;
+    Line surface;
+    std::shared_ptr<ZoneShape> shape;
+
+    size_t linearHits = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(auto& path : paths)
+    {
+        if(geometry->CollidesLinear(path, point, surface, shape))
+        {
+            linearHits++;
+        }
+    }
+    auto linearTime = ElapsedMicroseconds(start);
+
+    size_t gridHits = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for(auto& path : paths)
+    {
+        if(geometry->Collides(path, point, surface, shape))
+        {
+            gridHits++;
+        }
+    }
+    auto gridTime = ElapsedMicroseconds(start);
+
+    // Verify every result matches
+    size_t mismatches = 0;
+    for(auto& path : paths)
+    {
+        Point point2;
+        Line surface2;
+        std::shared_ptr<ZoneShape> shape2;
+
+        bool linear = geometry->CollidesLinear(path, point, surface, shape);
+        bool grid = geometry->Collides(path, point2, surface2, shape2);
+        if(linear != grid || (linear && (point != point2 ||
+            !(surface == surface2) || shape != shape2)))
+        {
+            mismatches++;
+        }
+    }
+
+    std::cout << geometry->QmpFilename.C() << ": collision check of "
+        << COLLISION_PATH_COUNT << " paths: linear " << linearTime
+        << " us, grid " << gridTime << " us" << std::endl;
+
+    if(mismatches || linearHits != gridHits)
+    {
+        std::cerr << geometry->QmpFilename.C() << ": collision grid "
+            "results differ from the linear check for " << mismatches
+            << " of " << COLLISION_PATH_COUNT << " paths" << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Find paths between random pairs of nav points with both the route table
+ * and the A* search, report any path length that differs and the time
+ * taken by each. Zones with too many nav points for a route table use the
+ * search for both.
+ * @param geometry Geometry to benchmark with the nav graph built
+ * @returns true if every path found was just as short
+ */
+bool BenchmarkNavigation(const std::shared_ptr<ZoneGeometry>& geometry)
+{
+    if(geometry->NavPoints.size() < 2)
+    {
+        return true;
+    }
+
+    std::vector<uint32_t> pointIDs;
+    for(auto& pair : geometry->NavPoints)
+    {
+        pointIDs.push_back(pair.first);
+    }
+
+    std::sort(pointIDs.begin(), pointIDs.end());
+
+    // Use a fixed seed so results are repeatable between runs
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<size_t> pointDist(0, pointIDs.size() - 1);
+
+    std::vector<std::pair<uint32_t, uint32_t>> paths;
+    paths.reserve(NAV_PATH_COUNT);
+    for(size_t i = 0; i < NAV_PATH_COUNT; i++)
+    {
+        size_t source = pointDist(rng);
+        size_t dest = pointDist(rng);
+        if(source == dest)
+        {
+            dest = (dest + 1) % pointIDs.size();
+        }
+
+        paths.push_back(std::make_pair(pointIDs[source], pointIDs[dest]));
+    }
+
+    size_t searchFound = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(auto& path : paths)
+    {
+        if(!geometry->GetShortestPathSearch(path.first,
+            path.second).empty())
+        {
+            searchFound++;
+        }
+    }
+    auto searchTime = ElapsedMicroseconds(start);
+
+    size_t routeFound = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for(auto& path : paths)
+    {
+        if(!geometry->GetShortestPath(path.first, path.second).empty())
+        {
+            routeFound++;
+        }
+    }
+    auto routeTime = ElapsedMicroseconds(start);
+
+    // Verify every path found is just as short
+    size_t mismatches = 0;
+    for(auto& path : paths)
+    {
+        float search = geometry->GetPathDistance(
+            geometry->GetShortestPathSearch(path.first, path.second));
+        float route = geometry->GetPathDistance(
+            geometry->GetShortestPath(path.first, path.second));
+        if(std::fabs(search - route) > 0.01f * std::max(1.f, search))
+        {
+            mismatches++;
+        }
+    }
+
+    std::cout << geometry->QmpFilename.C() << ": nav paths between "
+        << NAV_PATH_COUNT << " of " << pointIDs.size() << " nav points: "
+        "search " << searchTime << " us, route " << routeTime << " us"
+        << std::endl;
+
+    if(mismatches || searchFound != routeFound)
+    {
+        std::cerr << geometry->QmpFilename.C() << ": nav routes differ "
+            "from the search for " << mismatches << " of " << NAV_PATH_COUNT
+            << " paths" << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Check the arguments and print the usage.
+    if(argc < 3 || libcomp::String(argv[1]) != "--data")
+    {
+        std::cerr << "SYNTAX: comp_zonebench --data DATASTORE [QMP]..."
+            << std::endl;
+
+        return -1;
+    }
+
+    libcomp::DataStore store(argv[0]);
+
+    if(!store.AddSearchPath(argv[2]))
+    {
+        std::cerr << "Failed to add the data store: " << argv[2]
+            << std::endl;
+
+        return -1;
+    }
+
+    std::list<libcomp::String> qmpFiles;
+    for(int i = 3; i < argc; i++)
+    {
+        qmpFiles.push_back(argv[i]);
+    }
+
+    if(qmpFiles.empty())
+    {
+        // Check every zone geometry file in the data store.
+        std::list<libcomp::String> files;
+        std::list<libcomp::String> dirs;
+        std::list<libcomp::String> symLinks;
+
+        if(!store.GetListing("/Map/Zone/Model", files, dirs, symLinks))
+        {
+            std::cerr << "Failed to list the zone geometry files."
+                << std::endl;
+
+            return -1;
+        }
+
+        for(auto& file : files)
+        {
+            if(file.Right(4).ToLower() == ".qmp")
+            {
+                qmpFiles.push_back(file);
+            }
+        }
+    }
+
+    libcomp::DefinitionManager definitionManager;
+
+    int result = 0;
+
+    for(auto& filename : qmpFiles)
+    {
+        auto qmpFile = definitionManager.LoadQmpFile(filename, &store);
+        if(!qmpFile)
+        {
+            std::cerr << "Failed to load zone geometry file: "
+                << filename.C() << std::endl;
+
+            result = -1;
+            continue;
+        }
+
+        auto geometry = std::make_shared<ZoneGeometry>();
+        geometry->QmpFilename = filename;
+        geometry->LoadQmpShapes(qmpFile);
+
+        // Keep every nav point, the channel only drops the points that
+        // can't be reached from a zone-in spot
+        for(auto qmpBoundary : qmpFile->GetBoundaries())
+        {
+            for(auto navPoint : qmpBoundary->GetNavPoints())
+            {
+                geometry->NavPoints[navPoint->GetPointID()] = navPoint;
+            }
+        }
+
+        geometry->BuildNavigation();
+
+        if(!BenchmarkCollisionGrid(geometry))
+        {
+            result = -1;
+        }
+
+        if(!BenchmarkNavigation(geometry))
+        {
+            result = -1;
+        }
+    }
+
+    return result;
+}